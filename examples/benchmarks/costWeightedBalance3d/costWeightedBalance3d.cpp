@@ -0,0 +1,184 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+  * Load balance of a lattice with inhomogeneous dynamics. Benchmark case
+  * for CostWeightedRedistribute3D.
+  *
+  * A 60x40x40 lattice is cut into 128 blocks. A third of the cells use a
+  * regularized BGK model, which is taken to be four times as expensive as
+  * BGK, and a small obstacle is made of bounce-back nodes. The block costs are
+  * computed with computeDynamicsCosts(), and the blocks are attributed to the
+  * processes in three ways: round-robin, balanced by number of cells, and
+  * balanced by cost. For each attribution, the ratio between the largest and
+  * the average cost per process, and the number of overlap cells exchanged
+  * between processes, are printed for several process counts. The lattice
+  * is then run with the round-robin and with the cost-weighted attribution,
+  * on the actual number of processes.
+**/
+
+#include "palabos3D.h"
+#include "palabos3D.hh"   // include full template code
+#include <iostream>
+#include <iomanip>
+#include <numeric>
+#include <algorithm>
+#include <memory>
+
+using namespace plb;
+using namespace std;
+
+typedef double T;
+#define DESCRIPTOR descriptors::D3Q19Descriptor
+
+const plint nx = 60;
+const plint ny = 40;
+const plint nz = 40;
+
+MultiBlockLattice3D<T,DESCRIPTOR>* createLattice(MultiBlockManagement3D const& management)
+{
+    MultiBlockLattice3D<T,DESCRIPTOR>* lattice = new MultiBlockLattice3D<T,DESCRIPTOR> (
+            management,
+            defaultMultiBlockPolicy3D().getBlockCommunicator(),
+            defaultMultiBlockPolicy3D().getCombinedStatistics(),
+            defaultMultiBlockPolicy3D().getMultiCellAccess<T,DESCRIPTOR>(),
+            new BGKdynamics<T,DESCRIPTOR>(1.2) );
+    lattice->periodicity().toggleAll(true);
+    defineDynamics(*lattice, Box3D(0,nx/3-1, 0,ny-1, 0,nz-1),
+                   new RegularizedBGKdynamics<T,DESCRIPTOR>(1.2));
+    defineDynamics(*lattice, Box3D(40,49, 15,24, 15,24), new BounceBack<T,DESCRIPTOR>(1.));
+    initializeAtEquilibrium(*lattice, lattice->getBoundingBox(), (T)1., Array<T,3>((T)0.,(T)0.,(T)0.));
+    initializeAtEquilibrium(*lattice, Box3D(5,15, 3,20, 4,9), (T)1.02, Array<T,3>((T)0.03,(T)-0.01,(T)0.02));
+    lattice->initialize();
+    return lattice;
+}
+
+/// Print the max/mean cost per process, and the number of overlap cells
+///   between blocks of different processes.
+void printBalance( std::string const& name, SparseBlockStructure3D const& sparseBlock,
+                   ThreadAttribution const& attribution, std::map<plint,double> const& costs,
+                   plint numProcesses, plint envelopeWidth )
+{
+    std::vector<double> processCosts(numProcesses, 0.);
+    plint remoteOverlap = 0;
+    std::map<plint,Box3D> const& bulks = sparseBlock.getBulks();
+    std::map<plint,Box3D>::const_iterator it = bulks.begin();
+    for (; it != bulks.end(); ++it) {
+        plint process = attribution.getMpiProcess(it->first);
+        processCosts[process] += costs.find(it->first)->second;
+        std::vector<plint> neighbors;
+        sparseBlock.findNeighbors(it->first, envelopeWidth, neighbors);
+        for (pluint iNeighbor=0; iNeighbor<neighbors.size(); ++iNeighbor) {
+            Box3D overlap;
+            if ( attribution.getMpiProcess(neighbors[iNeighbor]) != process &&
+                 intersect(it->second.enlarge(envelopeWidth),
+                           bulks.find(neighbors[iNeighbor])->second, overlap) )
+            {
+                remoteOverlap += overlap.nCells();
+            }
+        }
+    }
+    double maxCost = *std::max_element(processCosts.begin(), processCosts.end());
+    double meanCost = std::accumulate(processCosts.begin(), processCosts.end(), 0.) / numProcesses;
+    pcout << "    " << std::setw(15) << std::left << name
+          << " max/mean cost: " << std::setw(8) << maxCost/meanCost
+          << " remote overlap: " << remoteOverlap << std::endl;
+}
+
+T runLattice(MultiBlockLattice3D<T,DESCRIPTOR>& lattice, plint numIter, std::string const& name)
+{
+    global::timer(name).start();
+    for (plint iT=0; iT<numIter; ++iT) {
+        lattice.collideAndStream();
+    }
+    global::timer(name).stop();
+    pcout << name << ": " << (T) (lattice.getBoundingBox().nCells()*numIter) /
+                             global::timer(name).getTime() / 1.e6
+          << " Mega site updates per second." << std::endl;
+    return computeAverageEnergy(lattice);
+}
+
+int main(int argc, char* argv[]) {
+
+    plbInit(&argc, &argv);
+
+    plint numIter = 100;
+    try {
+        global::argv(1).read(numIter);
+    }
+    catch(...) { }
+
+    plint envelopeWidth = DESCRIPTOR<T>::vicinity;
+    plint numBlocks = 128;
+    SparseBlockStructure3D sparseBlock = createRegularDistribution3D(nx,ny,nz, 8,4,4);
+    plint numCores = global::mpi().getSize();
+    ExplicitThreadAttribution* roundRobin = new ExplicitThreadAttribution;
+    for (plint iBlock=0; iBlock<numBlocks; ++iBlock) {
+        roundRobin->addBlock(iBlock, iBlock%numCores);
+    }
+    MultiBlockManagement3D roundRobinManagement(sparseBlock, roundRobin, envelopeWidth);
+    MultiBlockLattice3D<T,DESCRIPTOR>* lattice = createLattice(roundRobinManagement);
+
+    std::map<int,double> dynamicsWeights;
+    dynamicsWeights[RegularizedBGKdynamics<T,DESCRIPTOR>(1.).getId()] = 4.;
+    dynamicsWeights[BounceBack<T,DESCRIPTOR>(1.).getId()] = 0.1;
+    std::map<plint,double> costs = computeDynamicsCosts(*lattice, dynamicsWeights);
+    std::map<plint,double> numCells;
+    std::map<plint,Box3D>::const_iterator it = sparseBlock.getBulks().begin();
+    for (; it != sparseBlock.getBulks().end(); ++it) {
+        numCells[it->first] = (double) it->second.nCells();
+    }
+
+    pcout << nx << "x" << ny << "x" << nz << " lattice in " << numBlocks << " blocks." << std::endl;
+    plint processCounts[] = { 3, 4, 5, 8, 16 };
+    for (plint iCount=0; iCount<5; ++iCount) {
+        plint numProcesses = processCounts[iCount];
+        pcout << numProcesses << " processes:" << std::endl;
+        ExplicitThreadAttribution modulo;
+        for (plint iBlock=0; iBlock<numBlocks; ++iBlock) {
+            modulo.addBlock(iBlock, iBlock%numProcesses);
+        }
+        std::auto_ptr<ExplicitThreadAttribution> cellBalanced (
+                CostWeightedRedistribute3D(numCells, 0.05, numProcesses)
+                    .computeAttribution(sparseBlock, envelopeWidth) );
+        std::auto_ptr<ExplicitThreadAttribution> costBalanced (
+                CostWeightedRedistribute3D(costs, 0.05, numProcesses)
+                    .computeAttribution(sparseBlock, envelopeWidth) );
+        printBalance("round-robin", sparseBlock, modulo, costs, numProcesses, envelopeWidth);
+        printBalance("cell-balanced", sparseBlock, *cellBalanced, costs, numProcesses, envelopeWidth);
+        printBalance("cost-weighted", sparseBlock, *costBalanced, costs, numProcesses, envelopeWidth);
+    }
+    pcout << std::endl;
+
+    // Both distributions must yield the same result.
+    MultiBlockLattice3D<T,DESCRIPTOR>* balancedLattice = createLattice (
+            CostWeightedRedistribute3D(costs).redistribute(roundRobinManagement) );
+    T energy = runLattice(*lattice, numIter, "round-robin");
+    T balancedEnergy = runLattice(*balancedLattice, numIter, "cost-weighted");
+    pcout << "Average energy: " << energy << " (round-robin), "
+          << balancedEnergy << " (cost-weighted)." << std::endl;
+
+    delete balancedLattice;
+    delete lattice;
+}
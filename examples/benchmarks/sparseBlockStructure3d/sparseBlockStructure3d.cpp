@@ -0,0 +1,131 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+  * Spatial queries on a sparse block-structure with many blocks. Benchmark
+  * case for SparseBlockStructure3D and MultiBlockManagement3D.
+  *
+  * A cube is tiled with N^3 blocks of 4^3 cells, of which a fifth is kept at
+  * random, and a tenth of the kept blocks is removed again. With N=20, the
+  * structure has 1455 blocks, and with N=80 about 92000 blocks. The program
+  * measures the construction of the structure, a sweep of locate() queries
+  * over the domain, random intersect() queries, and the construction of a
+  * multi-block management with a round-robin attribution of the blocks.
+**/
+
+#include "palabos3D.h"
+#include "palabos3D.hh"   // include full template code
+#include <iostream>
+#include <cstdlib>
+
+using namespace plb;
+using namespace std;
+
+int main(int argc, char* argv[]) {
+
+    plbInit(&argc, &argv);
+
+    plint N;
+    try {
+        global::argv(1).read(N);
+    }
+    catch(...)
+    {
+        pcout << "Wrong parameters. The syntax is " << std::endl;
+        pcout << argv[0] << " N" << std::endl;
+        pcout << "where N^3 is the number of block positions. N=20 yields "
+              << "1455 blocks, and N=80 about 92000 blocks." << std::endl;
+        exit(1);
+    }
+    const plint blockSize = 4;
+    const plint n = N*blockSize;
+
+    srand(3);
+    global::timer("structure").start();
+    SparseBlockStructure3D sparseBlock(Box3D(0,n-1, 0,n-1, 0,n-1));
+    plint nextId = 0;
+    for (plint iX=0; iX<N; ++iX) {
+        for (plint iY=0; iY<N; ++iY) {
+            for (plint iZ=0; iZ<N; ++iZ) {
+                if (rand()%5==0) {
+                    sparseBlock.addBlock (
+                            Box3D( iX*blockSize, (iX+1)*blockSize-1,
+                                   iY*blockSize, (iY+1)*blockSize-1,
+                                   iZ*blockSize, (iZ+1)*blockSize-1 ), nextId++ );
+                }
+            }
+        }
+    }
+    for (plint iRemove=0; iRemove<nextId/10; ++iRemove) {
+        sparseBlock.removeBlock(rand()%nextId);
+    }
+    global::timer("structure").stop();
+    pcout << "Sparse structure with " << sparseBlock.getNumBlocks() << " blocks built in "
+          << global::timer("structure").getTime() << " s." << std::endl;
+
+    // Locate every third cell along y and z.
+    global::timer("locate").start();
+    plint numFound = 0;
+    for (plint iX=0; iX<n; ++iX) {
+        for (plint iY=0; iY<n; iY+=3) {
+            for (plint iZ=0; iZ<n; iZ+=3) {
+                if (sparseBlock.locate(iX,iY,iZ) >= 0) {
+                    ++numFound;
+                }
+            }
+        }
+    }
+    global::timer("locate").stop();
+    pcout << "locate() sweep: " << global::timer("locate").getTime() << " s ("
+          << numFound << " cells found)." << std::endl;
+
+    const plint numQueries = 10000;
+    global::timer("intersect").start();
+    plint numIntersections = 0;
+    for (plint iQuery=0; iQuery<numQueries; ++iQuery) {
+        plint x0 = rand()%n, y0 = rand()%n, z0 = rand()%n;
+        std::vector<plint> ids;
+        std::vector<Box3D> intersections;
+        sparseBlock.intersect( Box3D(x0, x0+rand()%9, y0, y0+rand()%9, z0, z0+rand()%9),
+                               ids, intersections );
+        numIntersections += (plint) ids.size();
+    }
+    global::timer("intersect").stop();
+    pcout << numQueries << " intersect() queries: " << global::timer("intersect").getTime()
+          << " s (" << numIntersections << " intersections)." << std::endl;
+
+    plint numProcs = global::mpi().getSize();
+    ExplicitThreadAttribution* threadAttribution = new ExplicitThreadAttribution;
+    std::map<plint,Box3D> const& bulks = sparseBlock.getBulks();
+    std::map<plint,Box3D>::const_iterator it = bulks.begin();
+    for (; it != bulks.end(); ++it) {
+        threadAttribution->addBlock(it->first, it->first%numProcs);
+    }
+    global::timer("management").start();
+    MultiBlockManagement3D management(sparseBlock, threadAttribution, 1);
+    global::timer("management").stop();
+    pcout << "Management built in " << global::timer("management").getTime() << " s ("
+          << management.getLocalInfo().getNormalOverlaps().size() << " local overlaps)."
+          << std::endl;
+}
@@ -36,6 +36,7 @@
 #include <algorithm>
 #include <string>
 #include <map>
+#include <vector>
 
 namespace plb {
 
@@ -58,6 +59,46 @@ private:
     AtomicBlock3D& block;
 };
 
+/// Selects the populations of envelope cells which must be communicated
+///   after a collide-and-stream step.
+/** Envelope cells are collided and streamed like the bulk, so that after
+ *  the step, a population is only unknown to the recipient if it streamed
+ *  in from a cell of which the recipient has no valid copy. A population of
+ *  cell x with velocity c is communicated if the source cell x-c lies inside
+ *  the domain, but outside all areas in which the recipient holds the same
+ *  data as the sender. Outside the domain, no population is streamed, on
+ *  the sender as well as on the recipient. The external scalars of the
+ *  cells are sent along, so that the envelopes hold a full copy of the
+ *  static data.
+ **/
+struct IncomingPopulations3D {
+    IncomingPopulations3D() { }
+    IncomingPopulations3D(Box3D domain_, std::vector<Box3D> const& shared_)
+        : domain(domain_), shared(shared_)
+    { }
+    /// Tells if populations streamed from the cell (iX,iY,iZ) must be communicated.
+    bool isIncoming(plint iX, plint iY, plint iZ) const {
+        if (!contained(iX,iY,iZ, domain)) {
+            return false;
+        }
+        for (pluint iShared=0; iShared<shared.size(); ++iShared) {
+            if (contained(iX,iY,iZ, shared[iShared])) {
+                return false;
+            }
+        }
+        return true;
+    }
+    IncomingPopulations3D shift(plint deltaX, plint deltaY, plint deltaZ) const {
+        IncomingPopulations3D result(domain.shift(deltaX,deltaY,deltaZ), shared);
+        for (pluint iShared=0; iShared<shared.size(); ++iShared) {
+            result.shared[iShared] = shared[iShared].shift(deltaX,deltaY,deltaZ);
+        }
+        return result;
+    }
+    Box3D domain;
+    std::vector<Box3D> shared;
+};
+
 struct BlockDataTransfer3D {
     virtual ~BlockDataTransfer3D() { }
     virtual void setBlock(AtomicBlock3D& block_) =0;
@@ -82,6 +123,102 @@ struct BlockDataTransfer3D {
     /// Receive data from a byte-stream into the block, and re-map IDs for dynamics if exist.
     virtual void receive( Box3D domain, std::vector<char> const& buffer,
                           modif::ModifT kind, std::map<int,std::string> const& foreignIds ) =0;
+    /// Receive a data structure from a byte-stream in format version 1 of the
+    ///   checkpoint files, in which every cell is stored as its serialized
+    ///   dynamics object followed by its static data.
+    /** By default, the block has no dynamics objects, and the format is the
+     *  same as the one of receive().
+     **/
+    virtual void receiveCellwise( Box3D domain, std::vector<char> const& buffer,
+                                  std::map<int,std::string> const& foreignIds )
+    {
+        receive(domain, buffer, modif::dataStructure, foreignIds);
+    }
+    /// Send the static data of the block into a preallocated buffer of
+    ///   domain.nCells()*staticCellSize() bytes.
+    /** By default, the data is sent through an intermediate std::vector. **/
+    virtual void sendStatic(Box3D domain, char* buffer) const {
+        std::vector<char> tmp;
+        send(domain, tmp, modif::staticVariables);
+        PLB_ASSERT( (plint)tmp.size() == domain.nCells()*staticCellSize() );
+        std::copy(tmp.begin(), tmp.end(), buffer);
+    }
+    /// Receive the static data of the block from a buffer of
+    ///   domain.nCells()*staticCellSize() bytes.
+    /** By default, the data is received through an intermediate std::vector. **/
+    virtual void receiveStatic(Box3D domain, char const* buffer, Dot3D absoluteOffset) {
+        std::vector<char> tmp(buffer, buffer+domain.nCells()*staticCellSize());
+        receive(domain, tmp, modif::staticVariables, absoluteOffset);
+    }
+    /// Address of the static data of the cells in domain, if the block stores
+    ///   it contiguously and in the format of send().
+    /** Serializers then read or write the data in place, instead of copying it
+     *  through a buffer. By default, no address is available and 0 is returned.
+     **/
+    virtual char const* getStaticDataSpan(Box3D domain) const {
+        return 0;
+    }
+    virtual char* getStaticDataSpan(Box3D domain) {
+        return 0;
+    }
+    /// Number of bytes written by sendIncoming().
+    /** By default, the full static data is sent. **/
+    virtual plint incomingSize(Box3D domain, IncomingPopulations3D const& incoming) const {
+        return domain.nCells()*staticCellSize();
+    }
+    /// Send the incoming populations of the cells in domain into a preallocated
+    ///   buffer of incomingSize() bytes.
+    virtual void sendIncoming(Box3D domain, IncomingPopulations3D const& incoming, char* buffer) const {
+        sendStatic(domain, buffer);
+    }
+    /// Receive the incoming populations of the cells in domain from a buffer.
+    virtual void receiveIncoming( Box3D domain, IncomingPopulations3D const& incoming,
+                                  char const* buffer, Dot3D absoluteOffset )
+    {
+        receiveStatic(domain, buffer, absoluteOffset);
+    }
+    /// Extract the data of the cells in region from a buffer which was produced
+    ///   by send() on bufferDomain.
+    /** By default, all cells are assumed to have the same size in the buffer. **/
+    virtual void extract( Box3D bufferDomain, std::vector<char> const& buffer, modif::ModifT kind,
+                          Box3D region, std::vector<char>& regionBuffer ) const
+    {
+        PLB_PRECONDITION( contained(region, bufferDomain) );
+        regionBuffer.clear();
+        if (buffer.empty() || region.nCells()==0) return;
+        plint cellSize = (plint)buffer.size() / bufferDomain.nCells();
+        plint runSize = cellSize*region.getNz();
+        regionBuffer.resize(region.nCells()*cellSize);
+        plint pos = 0;
+        for (plint iX=region.x0; iX<=region.x1; ++iX) {
+            for (plint iY=region.y0; iY<=region.y1; ++iY) {
+                plint start = cellSize * ( (region.z0-bufferDomain.z0) + bufferDomain.getNz() *
+                                           ( (iY-bufferDomain.y0) + bufferDomain.getNy()*(iX-bufferDomain.x0) ) );
+                std::copy(buffer.begin()+start, buffer.begin()+start+runSize, regionBuffer.begin()+pos);
+                pos += runSize;
+            }
+        }
+    }
+    /// Tells whether a buffer produced by send() on a domain is made of a header,
+    ///   followed by the static data of all cells of the domain, in the format
+    ///   of sendStatic().
+    /** Readers can then fetch the header and the static data of a region only,
+     *  and assemble them with extractFromHeader(). By default, this is not the case.
+     **/
+    virtual bool sendsStaticDataLast(modif::ModifT kind) const {
+        return false;
+    }
+    /// Assemble the data of the cells in region, in the format of extract(), from
+    ///   the header of a buffer produced by send() on bufferDomain and from the
+    ///   static data of the region.
+    /** Only available if sendsStaticDataLast() is true for the given kind. **/
+    virtual void extractFromHeader( Box3D bufferDomain, std::vector<char> const& header,
+                                    modif::ModifT kind, Box3D region,
+                                    std::vector<char> const& regionStaticData,
+                                    std::vector<char>& regionBuffer ) const
+    {
+        PLB_ASSERT( false );
+    }
     /// Attribute data between two blocks.
     virtual void attribute(Box3D toDomain, plint deltaX, plint deltaY, plint deltaZ,
                            AtomicBlock3D const& from, modif::ModifT kind) =0;
@@ -91,6 +228,14 @@ struct BlockDataTransfer3D {
     {
         attribute(toDomain, deltaX, deltaY, deltaZ, from, kind);
     }
+protected:
+    /// Tells if the cells of domain are contiguous in a block with the given
+    ///   bounding-box, whose data is stored with z as fastest index.
+    static bool isContiguous(Box3D const& domain, Box3D const& boundingBox) {
+        bool fullZ = domain.getNz()==boundingBox.getNz();
+        bool fullY = domain.getNy()==boundingBox.getNy();
+        return (domain.getNx()==1 || (fullY && fullZ)) && (domain.getNy()==1 || fullZ);
+    }
 };
 
 class AtomicBlock3D : public Block3D {
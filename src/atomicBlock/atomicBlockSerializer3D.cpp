@@ -59,22 +59,39 @@ pluint AtomicBlockSerializer3D::getSize() const {
 
 const char* AtomicBlockSerializer3D::getNextDataBuffer(pluint& bufferSize) const {
     PLB_PRECONDITION( !isEmpty() );
+    BlockDataTransfer3D const& transfer = block.getDataTransfer();
     if (ordering==IndexOrdering::forward || ordering==IndexOrdering::memorySaving) {
-        bufferSize = domain.getNz() * block.getDataTransfer().staticCellSize();
-        buffer.resize(bufferSize);
-        block.getDataTransfer().send(Box3D(iX,iX,iY,iY, domain.z0, domain.z1),
-                                     buffer, modif::staticVariables);
-        ++iY;
+        // The data is read in place from the block whenever it is contiguous,
+        //   in chunks as large as possible: the remaining x-slices of the domain,
+        //   the remaining z-lines of the current x-slice, or one z-line.
+        Box3D chunk(iX, domain.x1, iY, domain.y1, domain.z0, domain.z1);
+        char const* span = iY==domain.y0 ? transfer.getStaticDataSpan(chunk) : 0;
+        if (!span) {
+            chunk.x1 = iX;
+            span = transfer.getStaticDataSpan(chunk);
+        }
+        if (!span) {
+            chunk.y1 = iY;
+            span = transfer.getStaticDataSpan(chunk);
+        }
+        bufferSize = chunk.nCells() * transfer.staticCellSize();
+        if (!span) {
+            buffer.resize(bufferSize);
+            transfer.send(chunk, buffer, modif::staticVariables);
+            span = &buffer[0];
+        }
+        iY = chunk.y1+1;
         if (iY > domain.y1) {
             iY = domain.y0;
-            ++iX;
+            iX = chunk.x1+1;
         }
+        return span;
     }
     else {
-        bufferSize = domain.getNx() * block.getDataTransfer().staticCellSize();
+        bufferSize = domain.getNx() * transfer.staticCellSize();
         buffer.resize(bufferSize);
-        block.getDataTransfer().send(Box3D(domain.x0, domain.x1, iY,iY,iZ,iZ),
-                                           buffer, modif::staticVariables);
+        transfer.send(Box3D(domain.x0, domain.x1, iY,iY,iZ,iZ),
+                      buffer, modif::staticVariables);
         ++iY;
         if (iY > domain.y1) {
             iY = domain.y0;
@@ -100,7 +117,8 @@ AtomicBlockUnSerializer3D::AtomicBlockUnSerializer3D (
         AtomicBlock3D& block_, IndexOrdering::OrderingT ordering_ )
     : block(block_), ordering(ordering_),
       domain(block.getBoundingBox()),
-      iX(domain.x0), iY(domain.y0), iZ(domain.z0)
+      iX(domain.x0), iY(domain.y0), iZ(domain.z0),
+      chunkIsInPlace(false)
 { }
 
 AtomicBlockUnSerializer3D::AtomicBlockUnSerializer3D (
@@ -109,7 +127,8 @@ AtomicBlockUnSerializer3D::AtomicBlockUnSerializer3D (
         IndexOrdering::OrderingT ordering_ )
     : block(block_), ordering(ordering_),
       domain(domain_),
-      iX(domain.x0), iY(domain.y0), iZ(domain.z0)
+      iX(domain.x0), iY(domain.y0), iZ(domain.z0),
+      chunkIsInPlace(false)
 { }
 
 AtomicBlockUnSerializer3D* AtomicBlockUnSerializer3D::clone() const {
@@ -122,11 +141,29 @@ pluint AtomicBlockUnSerializer3D::getSize() const {
 
 char* AtomicBlockUnSerializer3D::getNextDataBuffer(pluint& bufferSize) {
     PLB_PRECONDITION( !isFull() );
+    BlockDataTransfer3D& transfer = block.getDataTransfer();
+    char* span = 0;
     if (ordering==IndexOrdering::forward || ordering==IndexOrdering::memorySaving) {
-        bufferSize = domain.getNz() * block.getDataTransfer().staticCellSize();
+        // The data is written in place in the block whenever it is contiguous,
+        //   as in AtomicBlockSerializer3D.
+        chunk = Box3D(iX, domain.x1, iY, domain.y1, domain.z0, domain.z1);
+        span = iY==domain.y0 ? transfer.getStaticDataSpan(chunk) : 0;
+        if (!span) {
+            chunk.x1 = iX;
+            span = transfer.getStaticDataSpan(chunk);
+        }
+        if (!span) {
+            chunk.y1 = iY;
+            span = transfer.getStaticDataSpan(chunk);
+        }
     }
     else {
-        bufferSize = domain.getNx() * block.getDataTransfer().staticCellSize();
+        chunk = Box3D(domain.x0, domain.x1, iY,iY,iZ,iZ);
+    }
+    bufferSize = chunk.nCells() * transfer.staticCellSize();
+    chunkIsInPlace = span != 0;
+    if (chunkIsInPlace) {
+        return span;
     }
     buffer.resize(bufferSize);
     return &buffer[0];
@@ -134,18 +171,17 @@ char* AtomicBlockUnSerializer3D::getNextDataBuffer(pluint& bufferSize) {
 
 void AtomicBlockUnSerializer3D::commitData() {
     PLB_PRECONDITION( !isFull() );
+    if (!chunkIsInPlace) {
+        block.getDataTransfer().receive(chunk, buffer, modif::staticVariables);
+    }
     if (ordering==IndexOrdering::forward || ordering==IndexOrdering::memorySaving) {
-        block.getDataTransfer().receive(Box3D(iX,iX,iY,iY, domain.z0, domain.z1),
-                                        buffer, modif::staticVariables);
-        ++iY;
+        iY = chunk.y1+1;
         if (iY > domain.y1) {
             iY = domain.y0;
-            ++iX;
+            iX = chunk.x1+1;
         }
     }
     else {
-        block.getDataTransfer().receive(Box3D(domain.x0, domain.x1, iY,iY,iZ,iZ),
-                                        buffer, modif::staticVariables);
         ++iY;
         if (iY > domain.y1) {
             iY = domain.y0;
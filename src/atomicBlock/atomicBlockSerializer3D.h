@@ -72,6 +72,8 @@ private:
     Box3D domain;
     mutable std::vector<char> buffer;
     mutable plint iX, iY, iZ;
+    Box3D chunk;
+    bool chunkIsInPlace;
 };
 
 }  //  namespace plb
@@ -62,6 +62,12 @@ public:
     { }
     virtual ~ContainerBlockData() { }
     virtual ContainerBlockData* clone() const=0;
+    /// Write the state of the data into a byte-stream, when its atomic-block
+    ///   migrates to another process. By default, no state is transmitted.
+    virtual void serialize(std::vector<char>& buffer) const { }
+    /// Restore the state written by serialize(), on a clone of the data
+    ///   prototype of the multi-block.
+    virtual void unserialize(std::vector<char> const& buffer) { }
     void setUniqueID(plint uniqueID_) { uniqueID = uniqueID_; }
     plint getUniqueID() const { return uniqueID; }
 private:
@@ -37,6 +37,7 @@
 #include "core/blockIdentifiers.h"
 #include <vector>
 #include <map>
+#include <typeinfo>
 
 /// All Palabos code is contained in this namespace.
 namespace plb {
@@ -63,6 +64,32 @@ public:
     /// Receive data from a byte-stream into the block, and re-map IDs for dynamics if exist.
     virtual void receive( Box3D domain, std::vector<char> const& buffer,
                           modif::ModifT kind, std::map<int,std::string> const& foreignIds );
+    /// Receive a data structure stored cell by cell, as in format version 1 of
+    ///   the checkpoint files, and re-map IDs for dynamics.
+    virtual void receiveCellwise( Box3D domain, std::vector<char> const& buffer,
+                                  std::map<int,std::string> const& foreignIds );
+    /// Serialize the populations and external scalars straight into a preallocated buffer.
+    virtual void sendStatic(Box3D domain, char* buffer) const;
+    /// Unserialize the populations and external scalars straight from a buffer.
+    virtual void receiveStatic(Box3D domain, char const* buffer, Dot3D absoluteOffset);
+    /// Number of bytes of the populations which stream in from incoming source
+    ///   cells, and of the external scalars of the domain.
+    virtual plint incomingSize(Box3D domain, IncomingPopulations3D const& incoming) const;
+    /// Send the populations which stream in from incoming source cells, and
+    ///   the external scalars of all cells of the domain.
+    virtual void sendIncoming(Box3D domain, IncomingPopulations3D const& incoming, char* buffer) const;
+    virtual void receiveIncoming( Box3D domain, IncomingPopulations3D const& incoming,
+                                  char const* buffer, Dot3D absoluteOffset );
+    /// Extract the cells of region from a buffer produced by send(); with dynamic
+    ///   content, the buffer starts with a dictionary of the dynamics objects.
+    virtual void extract( Box3D bufferDomain, std::vector<char> const& buffer, modif::ModifT kind,
+                          Box3D region, std::vector<char>& regionBuffer ) const;
+    /// With a data structure, the static data follows the dynamics dictionary.
+    virtual bool sendsStaticDataLast(modif::ModifT kind) const;
+    virtual void extractFromHeader( Box3D bufferDomain, std::vector<char> const& header,
+                                    modif::ModifT kind, Box3D region,
+                                    std::vector<char> const& regionStaticData,
+                                    std::vector<char>& regionBuffer ) const;
     /// Attribute data between two lattices.
     virtual void attribute(Box3D toDomain, plint deltaX, plint deltaY, plint deltaZ,
                            AtomicBlock3D const& from, modif::ModifT kind);
@@ -81,6 +108,24 @@ private:
     void receive_all(Box3D domain, std::vector<char> const& buffer);
     void receive_regenerate( Box3D domain, std::vector<char> const& buffer,
                              std::map<int,int> const& idIndirect = (std::map<int,int>()) );
+    void receive_cellwise( Box3D domain, std::vector<char> const& buffer,
+                           std::map<int,int> const& idIndirect );
+
+    /// Append the distinct dynamics objects of the domain to the buffer, each
+    ///   one serialized once, followed by the run-length encoded dictionary
+    ///   ids of the cells.
+    void sendDynamicsDictionary(Box3D domain, std::vector<char>& buffer) const;
+    /// Parse the data written by sendDynamicsDictionary: position of each entry
+    ///   in the buffer, and dictionary id of each cell of the domain. Returns the
+    ///   position of the data which follows.
+    pluint receiveDynamicsDictionary( Box3D domain, std::vector<char> const& buffer,
+                                      std::vector<pluint>& entries,
+                                      std::vector<plint>& cellIds ) const;
+    /// Copy the dictionary written by sendDynamicsDictionary on bufferDomain to
+    ///   regionBuffer, with the runs restricted to the cells of region. Returns
+    ///   the position of the data which follows in buffer.
+    pluint extractDynamicsDictionary( Box3D bufferDomain, std::vector<char> const& buffer,
+                                      Box3D region, std::vector<char>& regionBuffer ) const;
 
     void attribute_static (
         Box3D toDomain, plint deltaX, plint deltaY, plint deltaZ,
@@ -105,6 +150,67 @@ private:
     friend class WaveAbsorptionExternalRhoJcollideAndStream3D;
 };
 
+/// Collision functor for the bulk loops: generic version.
+/** The collision is dispatched through a virtual call to the dynamics
+ *  object of each cell.
+ */
+template<typename T, template<typename U> class Descriptor>
+struct GenericBulkCollision3D {
+    void operator()(Cell<T,Descriptor>& cell, BlockStatistics& statistics) const {
+        cell.collide(statistics);
+    }
+};
+
+/// Collision functor for the bulk loops: homogeneous-dynamics version.
+/** All cells whose dynamics object is of type BulkDynamics, usually because
+ *  they point to the background dynamics of the lattice, are collided through
+ *  a statically dispatched call to BulkDynamics::collide, which the compiler
+ *  is free to inline into the bulk loop. The other cells (boundaries,
+ *  obstacles, ...) fall back to the virtual call. BulkDynamics must be the
+ *  exact dynamic type of the background dynamics.
+ *
+ *  As the choice only depends on the cell, a cell and its copies in the
+ *  envelopes of other blocks are collided by the same code, which the
+ *  stream-only communication relies on.
+ */
+template<typename T, template<typename U> class Descriptor, class BulkDynamics>
+class HomogeneousBulkCollision3D {
+public:
+    HomogeneousBulkCollision3D(Dynamics<T,Descriptor>* backgroundDynamics)
+        : bulkDynamics(static_cast<BulkDynamics*>(backgroundDynamics))
+    {
+        PLB_PRECONDITION( typeid(*backgroundDynamics)==typeid(BulkDynamics) );
+    }
+    void operator()(Cell<T,Descriptor>& cell, BlockStatistics& statistics) const {
+        Dynamics<T,Descriptor>& dynamics = cell.getDynamics();
+        if (&dynamics==bulkDynamics || typeid(dynamics)==typeid(BulkDynamics)) {
+            static_cast<BulkDynamics&>(dynamics).BulkDynamics::collide(cell, statistics);
+        }
+        else {
+            cell.collide(statistics);
+        }
+    }
+private:
+    BulkDynamics* bulkDynamics;
+};
+
+/// Choice of the collision functor used by the collide-and-stream loops.
+/** This generic version always hands GenericBulkCollision3D to function.
+ *  The headers of the dynamics classes specialize it on the base descriptors
+ *  on which they can dispatch the collision of the background dynamics
+ *  statically, through HomogeneousBulkCollision3D. function must accept
+ *  any collision functor. The specializations must be visible wherever the
+ *  collide-and-stream methods of BlockLattice3D are instantiated, which is
+ *  the case when palabos3D.hh is included.
+ */
+template<typename T, template<typename U> class Descriptor, class BaseDescriptor>
+struct BulkCollisionTraits3D {
+    template<class Function>
+    static void dispatch(Dynamics<T,Descriptor>* backgroundDynamics, Function const& function) {
+        function(GenericBulkCollision3D<T,Descriptor>());
+    }
+};
+
 /// A regular lattice for highly efficient 3D LB dynamics.
 /** A block lattice contains a regular array of Cell objects and
  * some useful methods to execute the LB dynamics on the lattice.
@@ -155,6 +261,13 @@ public:
     virtual void collideAndStream(Box3D domain);
     /// Apply first collision, then streaming step to the whole domain
     virtual void collideAndStream();
+    /// First part of a split collideAndStream(domain): collide and stream
+    ///   the cells of domain outside of interior, except for the links
+    ///   which connect them to interior.
+    void collideAndStreamShell(Box3D domain, Box3D interior);
+    /// Second part of a split collideAndStream(domain): collide and stream
+    ///   the cells of interior, and conclude the streaming of the shell.
+    void collideAndStreamInterior(Box3D domain, Box3D interior);
     /// Increment time counter
     /** Warning: don't call this method manually. Instead, call incrementTime()
      *  on the multi-block lattice. Otherwise, the internal time of the multi-block
@@ -174,14 +287,61 @@ public:
     void bulkStream(Box3D domain);
     /// Apply streaming step to boundary cells
     void boundaryStream(Box3D bound, Box3D domain);
+    /// Apply streaming step to the links from the cells of domain to the
+    ///   cells of bound, except to the cells of excluded
+    void linkStream(Box3D bound, Box3D domain, Box3D excluded);
     /// Apply collision and streaming step to bulk (non-boundary) cells
     void bulkCollideAndStream(Box3D domain);
 private:
+    /// Runs one part of the collide-and-stream algorithm with the collision
+    ///   functor it is called with, as chosen by BulkCollisionTraits3D.
+    class CollideAndStreamPart {
+    public:
+        enum Part { whole, shell, bulk };
+        CollideAndStreamPart( BlockLattice3D<T,Descriptor>& lattice_, Part part_,
+                              Box3D domain_, Box3D interior_ );
+        template<class Collision>
+        void operator()(Collision const& collision) const;
+    private:
+        BlockLattice3D<T,Descriptor>& lattice;
+        Part part;
+        Box3D domain, interior;
+    };
+    /// Execute one part of the collide-and-stream algorithm with the
+    ///   collision functor chosen for the background dynamics.
+    void dispatchCollideAndStream ( typename CollideAndStreamPart::Part part,
+                                    Box3D domain, Box3D interior );
+    /// Apply collision step to a 3D sub-box, with a given collision functor.
+    template<class Collision>
+    void collide(Box3D domain, Collision const& collision);
+    /// Implementation of collideAndStream(domain), with a given collision functor.
+    template<class Collision>
+    void collideAndStream(Box3D domain, Collision const& collision);
+    /// Implementation of collideAndStreamShell(domain, interior), with a given
+    ///   collision functor.
+    template<class Collision>
+    void collideAndStreamShell(Box3D domain, Box3D interior, Collision const& collision);
+    /// Choose the traversal for bulkCollideAndStream(domain), with a given
+    ///   collision functor.
+    template<class Collision>
+    void bulkCollideAndStream(Box3D domain, Collision const& collision);
+    /// Choose the sequential traversal for bulkCollideAndStream(domain).
+    template<class Collision>
+    void bulkCollideAndStream ( Box3D domain, Collision const& collision,
+                                BlockStatistics& statistics );
+    /// Split bulkCollideAndStream(domain) among the shared-memory threads.
+    template<class Collision>
+    void threadedBulkCollideAndStream ( Box3D domain, Collision const& collision,
+                                        plint numThreads );
     /// Generic implementation of bulkCollideAndStream(domain).
-    void linearBulkCollideAndStream(Box3D domain);
+    template<class Collision>
+    void linearBulkCollideAndStream ( Box3D domain, Collision const& collision,
+                                      BlockStatistics& statistics );
     /// Cache-efficient implementation of bulkCollideAndStream(domain)for
     ///   nearest-neighbor lattices.
-    void blockwiseBulkCollideAndStream(Box3D domain);
+    template<class Collision>
+    void blockwiseBulkCollideAndStream ( Box3D domain, Collision const& collision,
+                                         BlockStatistics& statistics );
 private:
     /// Helper method for memory allocation
     void allocateAndInitialize();
@@ -195,6 +355,8 @@ private:
     Dynamics<T,Descriptor>* backgroundDynamics;
     Cell<T,Descriptor>     *rawData;
     Cell<T,Descriptor>   ***grid;
+    /// Statistics of the threads in threadedBulkCollideAndStream().
+    std::vector<BlockStatistics> threadStatistics;
 public:
     static CachePolicy3D& cachePolicy();
     template<typename T_, template<typename U_> class Descriptor_>
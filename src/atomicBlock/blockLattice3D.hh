@@ -30,6 +30,7 @@
 
 #include "atomicBlock/blockLattice3D.h"
 #include "core/dynamics.h"
+#include "core/hierarchicSerializer.h"
 #include "core/cell.h"
 #include "core/plbTimer.h"
 #include "latticeBoltzmann/latticeTemplates.h"
@@ -38,9 +39,12 @@
 #include "core/latticeStatistics.h"
 #include "core/dynamicsIdentifiers.h"
 #include "core/plbProfiler.h"
+#include "parallelism/smpManager.h"
 #include <algorithm>
 #include <typeinfo>
+#include <vector>
 #include <cmath>
+#include <cstring>
 
 namespace plb {
 
@@ -188,6 +192,25 @@ void BlockLattice3D<T,Descriptor>::collide(Box3D domain) {
     }
 }
 
+/** The envelope cells of collideAndStream() use the same collision functor
+ *  as the bulk, so that a cell is collided in the same way, whatever part of
+ *  the algorithm treats it.
+ */
+template<typename T, template<typename U> class Descriptor>
+template<class Collision>
+void BlockLattice3D<T,Descriptor>::collide(Box3D domain, Collision const& collision) {
+    PLB_PRECONDITION( contained(domain, this->getBoundingBox()) );
+
+    for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
+        for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
+            for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
+                collision(grid[iX][iY][iZ], this->getInternalStatistics());
+                grid[iX][iY][iZ].revert();
+            }
+        }
+    }
+}
+
 /** \sa collide(int,int,int,int) */
 template<typename T, template<typename U> class Descriptor>
 void BlockLattice3D<T,Descriptor>::collide() {
@@ -255,11 +278,17 @@ void BlockLattice3D<T,Descriptor>::stream()
  */
 template<typename T, template<typename U> class Descriptor>
 void BlockLattice3D<T,Descriptor>::collideAndStream(Box3D domain) {
+    dispatchCollideAndStream(CollideAndStreamPart::whole, domain, domain);
+}
+
+template<typename T, template<typename U> class Descriptor>
+template<class Collision>
+void BlockLattice3D<T,Descriptor>::collideAndStream(Box3D domain, Collision const& collision) {
     // Make sure domain is contained within current lattice
     PLB_PRECONDITION( contained(domain, this->getBoundingBox()) );
 
-    global::profiler().start("collStream");
-    global::profiler().increment("collStreamCells", domain.nCells());
+    global::profiler().start(global::prof::collStream);
+    global::profiler().increment(global::prof::collStreamCells, domain.nCells());
 
     static const plint vicinity = Descriptor<T>::vicinity;
 
@@ -267,22 +296,22 @@ void BlockLattice3D<T,Descriptor>::collideAndStream(Box3D domain) {
     // equal to the range of the lattice vectors (e.g. 1 for D3Q19)
     collide(Box3D(domain.x0,domain.x0+vicinity-1,
                   domain.y0,domain.y1,
-                  domain.z0,domain.z1) );
+                  domain.z0,domain.z1), collision );
     collide(Box3D(domain.x1-vicinity+1,domain.x1,
                   domain.y0,domain.y1,
-                  domain.z0,domain.z1) );
+                  domain.z0,domain.z1), collision );
     collide(Box3D(domain.x0+vicinity,domain.x1-vicinity,
                   domain.y0,domain.y0+vicinity-1,
-                  domain.z0,domain.z1) );
+                  domain.z0,domain.z1), collision );
     collide(Box3D(domain.x0+vicinity,domain.x1-vicinity,
                   domain.y1-vicinity+1,domain.y1,
-                  domain.z0,domain.z1) );
+                  domain.z0,domain.z1), collision );
     collide(Box3D(domain.x0+vicinity,domain.x1-vicinity,
                   domain.y0+vicinity,domain.y1-vicinity,
-                  domain.z0,domain.z0+vicinity-1) );
+                  domain.z0,domain.z0+vicinity-1), collision );
     collide(Box3D(domain.x0+vicinity,domain.x1-vicinity,
                   domain.y0+vicinity,domain.y1-vicinity,
-                  domain.z1-vicinity+1,domain.z1) );
+                  domain.z1-vicinity+1,domain.z1), collision );
 
     // Then, do the efficient collideAndStream algorithm in the bulk,
     // excluding the envelope (this is efficient because there is no
@@ -290,7 +319,7 @@ void BlockLattice3D<T,Descriptor>::collideAndStream(Box3D domain) {
     // region is excluded)
     bulkCollideAndStream(Box3D(domain.x0+vicinity,domain.x1-vicinity,
                                domain.y0+vicinity,domain.y1-vicinity,
-                               domain.z0+vicinity,domain.z1-vicinity) );
+                               domain.z0+vicinity,domain.z1-vicinity), collision );
 
     // Finally, do streaming in the boundary envelope to conclude the
     // collision-stream cycle
@@ -312,7 +341,73 @@ void BlockLattice3D<T,Descriptor>::collideAndStream(Box3D domain) {
     boundaryStream(domain, Box3D(domain.x0+vicinity,domain.x1-vicinity,
                                  domain.y0+vicinity,domain.y1-vicinity,
                                  domain.z1-vicinity+1,domain.z1) );
-    global::profiler().stop("collStream");
+    global::profiler().stop(global::prof::collStream);
+}
+
+/** The cells of interior must be at a distance of at least one lattice
+ *  vicinity from the boundary of domain, or interior must be empty. The
+ *  shell is collided first, and the links between two shell cells are
+ *  streamed. Once this is done, the populations of the shell cells which
+ *  have no neighbor in interior are final, and can be communicated.
+ */
+template<typename T, template<typename U> class Descriptor>
+void BlockLattice3D<T,Descriptor>::collideAndStreamShell(Box3D domain, Box3D interior) {
+    dispatchCollideAndStream(CollideAndStreamPart::shell, domain, interior);
+}
+
+template<typename T, template<typename U> class Descriptor>
+template<class Collision>
+void BlockLattice3D<T,Descriptor>::collideAndStreamShell (
+        Box3D domain, Box3D interior, Collision const& collision )
+{
+    // Make sure domain is contained within current lattice
+    PLB_PRECONDITION( contained(domain, this->getBoundingBox()) );
+
+    if (interior.x1<interior.x0 || interior.y1<interior.y0 || interior.z1<interior.z0) {
+        collideAndStream(domain, collision);
+        return;
+    }
+    PLB_PRECONDITION( contained(interior.enlarge(Descriptor<T>::vicinity), domain) );
+
+    global::profiler().start(global::prof::collStream);
+    global::profiler().increment(global::prof::collStreamCells, domain.nCells()-interior.nCells());
+
+    std::vector<Box3D> shell;
+    except(domain, interior, shell);
+    for (pluint iBox=0; iBox<shell.size(); ++iBox) {
+        collide(shell[iBox], collision);
+    }
+    for (pluint iBox=0; iBox<shell.size(); ++iBox) {
+        linkStream(domain, shell[iBox], interior);
+    }
+    global::profiler().stop(global::prof::collStream);
+}
+
+/** This method must be called after collideAndStreamShell(domain, interior).
+ *  The interior is treated with the efficient bulk algorithm, which can
+ *  access the already collided shell cells. Then, the links from the shell
+ *  to interior, which are left over by collideAndStreamShell(), are streamed.
+ */
+template<typename T, template<typename U> class Descriptor>
+void BlockLattice3D<T,Descriptor>::collideAndStreamInterior(Box3D domain, Box3D interior) {
+    if (interior.x1<interior.x0 || interior.y1<interior.y0 || interior.z1<interior.z0) {
+        return;
+    }
+    PLB_PRECONDITION( contained(interior.enlarge(Descriptor<T>::vicinity), domain) );
+
+    global::profiler().start(global::prof::collStream);
+    global::profiler().increment(global::prof::collStreamCells, interior.nCells());
+
+    bulkCollideAndStream(interior);
+
+    // Only shell cells at a distance smaller than the vicinity have a link to interior.
+    std::vector<Box3D> frontier;
+    except(interior.enlarge(Descriptor<T>::vicinity), interior, frontier);
+    Box3D noExclusion(0,-1, 0,-1, 0,-1);
+    for (pluint iBox=0; iBox<frontier.size(); ++iBox) {
+        linkStream(interior, frontier[iBox], noExclusion);
+    }
+    global::profiler().stop(global::prof::collStream);
 }
 
 /** At the end of this method, finalizeIteration() and
@@ -444,6 +539,34 @@ void BlockLattice3D<T,Descriptor>::boundaryStream(Box3D bound, Box3D domain) {
     }
 }
 
+/** Like boundaryStream(), this method can be applied to any cells. It is
+ *  used to stream a domain piecewise, in which case each link must be
+ *  swapped exactly once.
+ */
+template<typename T, template<typename U> class Descriptor>
+void BlockLattice3D<T,Descriptor>::linkStream(Box3D bound, Box3D domain, Box3D excluded) {
+    // Make sure bound is contained within current lattice
+    PLB_PRECONDITION( contained(bound, this->getBoundingBox()) );
+
+    for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
+        for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
+            for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
+                for (plint iPop=1; iPop<=Descriptor<T>::q/2; ++iPop) {
+                    plint nextX = iX + Descriptor<T>::c[iPop][0];
+                    plint nextY = iY + Descriptor<T>::c[iPop][1];
+                    plint nextZ = iZ + Descriptor<T>::c[iPop][2];
+                    if ( contained(nextX,nextY,nextZ, bound) &&
+                         !contained(nextX,nextY,nextZ, excluded) )
+                    {
+                        std::swap(grid[iX][iY][iZ][iPop+Descriptor<T>::q/2],
+                                  grid[nextX][nextY][nextZ][iPop]);
+                    }
+                }
+            }
+        }
+    }
+}
+
 /** This method is faster than boundaryStream(int,int,int,int,int,int), but it
  * is erroneous when applied to boundary cells.
  * \sa stream(int,int,int,int,int,int)
@@ -479,17 +602,143 @@ void BlockLattice3D<T,Descriptor>::bulkCollideAndStream(Box3D domain) {
     // Make sure domain is contained within current lattice
     PLB_PRECONDITION( contained(domain, this->getBoundingBox()) );
 
-    // if (Descriptor<T>::q==15 || Descriptor<T>::q==19) {
-    if (Descriptor<T>::q==19) {
-        // On nearest-neighbor lattice, use the cache-efficient
-        //   version of collidAndStream.
-        blockwiseBulkCollideAndStream(domain);
+    dispatchCollideAndStream(CollideAndStreamPart::bulk, domain, domain);
+}
+
+/** In most simulations, the bulk of the domain is made of cells which point
+ *  to the background dynamics. If the header of its dynamics class provides
+ *  a specialization of BulkCollisionTraits3D, the collision of these cells
+ *  is dispatched statically.
+ */
+template<typename T, template<typename U> class Descriptor>
+void BlockLattice3D<T,Descriptor>::dispatchCollideAndStream (
+        typename CollideAndStreamPart::Part part, Box3D domain, Box3D interior )
+{
+    BulkCollisionTraits3D<T,Descriptor,typename Descriptor<T>::BaseDescriptor>::dispatch (
+            backgroundDynamics, CollideAndStreamPart(*this, part, domain, interior) );
+}
+
+template<typename T, template<typename U> class Descriptor>
+BlockLattice3D<T,Descriptor>::CollideAndStreamPart::CollideAndStreamPart (
+        BlockLattice3D<T,Descriptor>& lattice_, Part part_, Box3D domain_, Box3D interior_ )
+    : lattice(lattice_),
+      part(part_),
+      domain(domain_),
+      interior(interior_)
+{ }
+
+template<typename T, template<typename U> class Descriptor>
+template<class Collision>
+void BlockLattice3D<T,Descriptor>::CollideAndStreamPart::operator() (
+        Collision const& collision ) const
+{
+    switch(part) {
+        case whole:
+            lattice.collideAndStream(domain, collision);
+            break;
+        case shell:
+            lattice.collideAndStreamShell(domain, interior, collision);
+            break;
+        case bulk:
+            lattice.bulkCollideAndStream(domain, collision);
+            break;
+    }
+}
+
+template<typename T, template<typename U> class Descriptor>
+template<class Collision>
+void BlockLattice3D<T,Descriptor>::bulkCollideAndStream(Box3D domain, Collision const& collision) {
+    static const plint vicinity = Descriptor<T>::vicinity;
+    // The block is split among the shared-memory threads, unless it is already
+    //   executed by one of them. Every thread needs a slab of at least 2*vicinity
+    //   planes for the splitting to be valid, and a few more to be worth it.
+    const plint minSlabWidth = 4*vicinity;
+    const plint numThreads = global::smp().inParallelRegion() ?
+                                 1 : global::smp().getNumThreads();
+    if (numThreads>1 && domain.getNx()>=numThreads*minSlabWidth) {
+        threadedBulkCollideAndStream(domain, collision, numThreads);
+    }
+    else {
+        bulkCollideAndStream(domain, collision, this->getInternalStatistics());
+    }
+}
+
+template<typename T, template<typename U> class Descriptor>
+template<class Collision>
+void BlockLattice3D<T,Descriptor>::bulkCollideAndStream (
+        Box3D domain, Collision const& collision, BlockStatistics& statistics )
+{
+    // The cache-efficient version of collideAndStream works on all lattices.
+    //   The straightforward one is used when the domain fits in a single block.
+    const plint blockSize = cachePolicy().getBlockSize(sizeof(Cell<T,Descriptor>));
+    if ( domain.getNx()<=blockSize && domain.getNy()<=blockSize &&
+         domain.getNz()<=blockSize )
+    {
+        linearBulkCollideAndStream(domain, collision, statistics);
     }
     else {
-        // Otherwise, use the straightforward implementation.
-        //   Note that at some point, we should implement the cache-efficient
-        //   version for extended lattices as well.
-        linearBulkCollideAndStream(domain);
+        blockwiseBulkCollideAndStream(domain, collision, statistics);
+    }
+}
+
+/** The domain is cut into slabs along the x-axis, one per thread. The streaming
+ *  of a cell only touches the cells which precede it in memory, i.e. for the
+ *  first planes of a slab, the last planes of the previous slab. These are
+ *  therefore collided in a first phase. After a barrier, each thread executes
+ *  the fused collide-and-stream on the rest of its slab, and then streams the
+ *  already collided planes. The two threads which share a pair of neighboring
+ *  cells touch different populations of these cells, so there is no race.
+ */
+template<typename T, template<typename U> class Descriptor>
+template<class Collision>
+void BlockLattice3D<T,Descriptor>::threadedBulkCollideAndStream (
+        Box3D domain, Collision const& collision, plint numThreads )
+{
+    // Make sure domain is contained within current lattice
+    PLB_PRECONDITION( contained(domain, this->getBoundingBox()) );
+
+    static const plint vicinity = Descriptor<T>::vicinity;
+    // The threads gather their statistics separately, and they are combined at the end.
+    //   The buffer is kept from one call to the next, to avoid allocating it at
+    //   each time step.
+    threadStatistics.resize(numThreads);
+    for (plint iThread=0; iThread<numThreads; ++iThread) {
+        threadStatistics[iThread] = this->getInternalStatistics();
+    }
+#ifdef PLB_SMP_THREADS
+    #pragma omp parallel num_threads(numThreads)
+#endif
+    {
+        plint iThread = global::smp().getThreadId();
+        BlockStatistics& statistics = threadStatistics[iThread];
+        statistics.resetRunning();
+
+        Box3D slab(domain);
+        slab.x0 = domain.x0 + iThread*domain.getNx()/numThreads;
+        slab.x1 = domain.x0 + (iThread+1)*domain.getNx()/numThreads - 1;
+        Box3D lastPlanes(slab.x1-vicinity+1,slab.x1, slab.y0,slab.y1, slab.z0,slab.z1);
+
+        // First phase: collide the planes which are accessed by the next slab.
+        for (plint iX=lastPlanes.x0; iX<=lastPlanes.x1; ++iX) {
+            for (plint iY=lastPlanes.y0; iY<=lastPlanes.y1; ++iY) {
+                for (plint iZ=lastPlanes.z0; iZ<=lastPlanes.z1; ++iZ) {
+                    collision(grid[iX][iY][iZ], statistics);
+                    grid[iX][iY][iZ].revert();
+                }
+            }
+        }
+#ifdef PLB_SMP_THREADS
+        #pragma omp barrier
+#endif
+        // Second phase: collide and stream the remainder of the slab, then stream
+        //   the planes which have been collided in the first phase.
+        bulkCollideAndStream (
+                Box3D(slab.x0,lastPlanes.x0-1, slab.y0,slab.y1, slab.z0,slab.z1),
+                collision, statistics );
+        bulkStream(lastPlanes);
+    }
+    for (plint iThread=0; iThread<numThreads; ++iThread) {
+        this->getInternalStatistics().combine(threadStatistics[iThread]);
     }
 }
 
@@ -498,14 +747,17 @@ void BlockLattice3D<T,Descriptor>::bulkCollideAndStream(Box3D domain) {
  *  not only nearest-neighbor.
  */
 template<typename T, template<typename U> class Descriptor>
-void BlockLattice3D<T,Descriptor>::linearBulkCollideAndStream(Box3D domain) {
+template<class Collision>
+void BlockLattice3D<T,Descriptor>::linearBulkCollideAndStream (
+        Box3D domain, Collision const& collision, BlockStatistics& statistics )
+{
     // Make sure domain is contained within current lattice
     PLB_PRECONDITION( contained(domain, this->getBoundingBox()) );
 
     for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
         for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
             for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
-                grid[iX][iY][iZ].collide(this->getInternalStatistics());
+                collision(grid[iX][iY][iZ], statistics);
                 latticeTemplates<T,Descriptor>::swapAndStream3D(grid, iX, iY, iZ);
             }
         }
@@ -514,21 +766,26 @@ void BlockLattice3D<T,Descriptor>::linearBulkCollideAndStream(Box3D domain) {
 
 
 /** Sophisticated implementation which improves cache usage through block-wise
- *  loops. For now, this works only with nearest-neighbor lattices. On extended
- *  lattices, the naive version "linearBulkCollideAndStream" is used.
+ *  loops. The blocks are skewed, in proportion to the vicinity of the lattice,
+ *  so that the swap-operation of the streaming only accesses post-collision
+ *  cells. This works on all lattices, nearest-neighbor and extended.
  */
 template<typename T, template<typename U> class Descriptor>
-void BlockLattice3D<T,Descriptor>::blockwiseBulkCollideAndStream(Box3D domain) {
+template<class Collision>
+void BlockLattice3D<T,Descriptor>::blockwiseBulkCollideAndStream (
+        Box3D domain, Collision const& collision, BlockStatistics& statistics )
+{
     // Make sure domain is contained within current lattice
     PLB_PRECONDITION( contained(domain, this->getBoundingBox()) );
 
+    static const plint vicinity = Descriptor<T>::vicinity;
     // For cache efficiency, memory is traversed block-wise. The three outer loops enumerate
     //   the blocks, whereas the three inner loops enumerate the cells inside each block.
-    const plint blockSize = cachePolicy().getBlockSize();
+    const plint blockSize = cachePolicy().getBlockSize(sizeof(Cell<T,Descriptor>));
     // Outer loops.
     for (plint outerX=domain.x0; outerX<=domain.x1; outerX+=blockSize) {
-        for (plint outerY=domain.y0; outerY<=domain.y1+blockSize-1; outerY+=blockSize) {
-            for (plint outerZ=domain.z0; outerZ<=domain.z1+2*(blockSize-1); outerZ+=blockSize) {
+        for (plint outerY=domain.y0; outerY<=domain.y1+vicinity*(blockSize-1); outerY+=blockSize) {
+            for (plint outerZ=domain.z0; outerZ<=domain.z1+2*vicinity*(blockSize-1); outerZ+=blockSize) {
                 // Inner loops.
                 plint dx = 0;
                 for (plint innerX=outerX;
@@ -538,25 +795,22 @@ void BlockLattice3D<T,Descriptor>::blockwiseBulkCollideAndStream(Box3D domain) {
                     // Y-index is shifted in negative direction at each x-increment. to ensure
                     //   that only post-collision cells are accessed during the swap-operation
                     //   of the streaming.
-                    plint minY = outerY-dx;
+                    plint minY = outerY-vicinity*dx;
                     plint maxY = minY+blockSize-1;
-                    plint dy = 0;
                     for (plint innerY=std::max(minY,domain.y0);
                          innerY <= std::min(maxY, domain.y1);
-                         ++innerY, ++dy)
+                         ++innerY)
                     {
                         // Z-index is shifted in negative direction at each x-increment. and at each
                         //    y-increment, to ensure that only post-collision cells are accessed during
-                        //    the swap-operation of the streaming.
-                        plint minZ = outerZ-dx-dy;
-                        plint maxZ = minZ+blockSize-1;
-                        for (plint innerZ=std::max(minZ,domain.z0);
-                             innerZ <= std::min(maxZ, domain.z1);
-                             ++innerZ)
-                        {
+                        //    the swap-operation of the streaming. The y-offset is counted from the
+                        //    unclipped start of the block, which keeps the shift linear in x and y.
+                        plint dy = innerY-minY;
+                        plint minZ = std::max(outerZ-vicinity*(dx+dy), domain.z0);
+                        plint maxZ = std::min(outerZ-vicinity*(dx+dy)+blockSize-1, domain.z1);
+                        for (plint innerZ=minZ; innerZ <= maxZ; ++innerZ) {
                             // Collide the cell.
-                            grid[innerX][innerY][innerZ].collide (
-                                    this->getInternalStatistics() );
+                            collision(grid[innerX][innerY][innerZ], statistics);
                             // Swap the populations on the cell, and then with post-collision
                             //   neighboring cell, to perform the streaming step.
                             latticeTemplates<T,Descriptor>::swapAndStream3D (
@@ -707,17 +961,26 @@ void BlockLatticeDataTransfer3D<T,Descriptor>::send_static (
         Box3D domain, std::vector<char>& buffer ) const
 {
     PLB_PRECONDITION( constLattice );
-    plint cellSize = staticCellSize();
-    pluint numBytes = domain.nCells()*cellSize;
+    pluint numBytes = domain.nCells()*staticCellSize();
     // Avoid dereferencing uninitialized pointer.
     if (numBytes==0) return;
     buffer.resize(numBytes);
+    sendStatic(domain, &buffer[0]);
+}
+
+template<typename T, template<typename U> class Descriptor>
+void BlockLatticeDataTransfer3D<T,Descriptor>::sendStatic (
+        Box3D domain, char* buffer ) const
+{
+    PLB_PRECONDITION( constLattice );
+    PLB_PRECONDITION(contained(domain, constLattice->getBoundingBox()));
+    plint cellSize = staticCellSize();
 
     plint iData=0;
     for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
         for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
             for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
-                constLattice->get(iX,iY,iZ).serialize(&buffer[iData]);
+                constLattice->get(iX,iY,iZ).serialize(buffer+iData);
                 iData += cellSize;
             }
         }
@@ -725,39 +988,215 @@ void BlockLatticeDataTransfer3D<T,Descriptor>::send_static (
 }
 
 template<typename T, template<typename U> class Descriptor>
-void BlockLatticeDataTransfer3D<T,Descriptor>::send_dynamic (
-        Box3D domain, std::vector<char>& buffer ) const
+plint BlockLatticeDataTransfer3D<T,Descriptor>::incomingSize (
+        Box3D domain, IncomingPopulations3D const& incoming ) const
+{
+    plint numPop=0;
+    for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
+        for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
+            for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
+                for (plint iPop=0; iPop<Descriptor<T>::q; ++iPop) {
+                    if (incoming.isIncoming(iX-Descriptor<T>::c[iPop][0],
+                                            iY-Descriptor<T>::c[iPop][1],
+                                            iZ-Descriptor<T>::c[iPop][2]))
+                    {
+                        ++numPop;
+                    }
+                }
+            }
+        }
+    }
+    plint numScalars = Descriptor<T>::ExternalField::numScalars*domain.nCells();
+    return (numPop+numScalars)*(plint)sizeof(T);
+}
+
+template<typename T, template<typename U> class Descriptor>
+void BlockLatticeDataTransfer3D<T,Descriptor>::sendIncoming (
+        Box3D domain, IncomingPopulations3D const& incoming, char* buffer ) const
 {
     PLB_PRECONDITION( constLattice );
+    PLB_PRECONDITION(contained(domain, constLattice->getBoundingBox()));
+
+    plint iData=0;
+    for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
+        for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
+            for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
+                Cell<T,Descriptor> const& cell = constLattice->get(iX,iY,iZ);
+                for (plint iPop=0; iPop<Descriptor<T>::q; ++iPop) {
+                    if (incoming.isIncoming(iX-Descriptor<T>::c[iPop][0],
+                                            iY-Descriptor<T>::c[iPop][1],
+                                            iZ-Descriptor<T>::c[iPop][2]))
+                    {
+                        memcpy((void*)(buffer+iData), (const void*)(&cell[iPop]), sizeof(T));
+                        iData += sizeof(T);
+                    }
+                }
+                if (Descriptor<T>::ExternalField::numScalars>0) {
+                    plint numBytes = Descriptor<T>::ExternalField::numScalars*(plint)sizeof(T);
+                    memcpy((void*)(buffer+iData), (const void*)cell.getExternal(0), numBytes);
+                    iData += numBytes;
+                }
+            }
+        }
+    }
+}
+
+template<typename T, template<typename U> class Descriptor>
+void BlockLatticeDataTransfer3D<T,Descriptor>::receiveIncoming (
+        Box3D domain, IncomingPopulations3D const& incoming,
+        char const* buffer, Dot3D absoluteOffset )
+{
+    PLB_PRECONDITION( lattice );
+    PLB_PRECONDITION(contained(domain, lattice->getBoundingBox()));
+
+    plint iData=0;
     for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
         for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
             for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
-                // The serialize function automatically reallocates memory for buffer.
-                serialize(constLattice->get(iX,iY,iZ).getDynamics(), buffer);
+                Cell<T,Descriptor>& cell = lattice->get(iX,iY,iZ);
+                for (plint iPop=0; iPop<Descriptor<T>::q; ++iPop) {
+                    if (incoming.isIncoming(iX-Descriptor<T>::c[iPop][0],
+                                            iY-Descriptor<T>::c[iPop][1],
+                                            iZ-Descriptor<T>::c[iPop][2]))
+                    {
+                        memcpy((void*)(&cell[iPop]), (const void*)(buffer+iData), sizeof(T));
+                        iData += sizeof(T);
+                    }
+                }
+                if (Descriptor<T>::ExternalField::numScalars>0) {
+                    plint numBytes = Descriptor<T>::ExternalField::numScalars*(plint)sizeof(T);
+                    memcpy((void*)cell.getExternal(0), (const void*)(buffer+iData), numBytes);
+                    iData += numBytes;
+                }
             }
         }
     }
 }
 
+template<typename T, template<typename U> class Descriptor>
+void BlockLatticeDataTransfer3D<T,Descriptor>::send_dynamic (
+        Box3D domain, std::vector<char>& buffer ) const
+{
+    PLB_PRECONDITION( constLattice );
+    // Avoid dereferencing uninitialized pointer.
+    if (domain.nCells()==0) return;
+    sendDynamicsDictionary(domain, buffer);
+}
+
 template<typename T, template<typename U> class Descriptor>
 void BlockLatticeDataTransfer3D<T,Descriptor>::send_all (
         Box3D domain, std::vector<char>& buffer ) const
 {
     PLB_PRECONDITION( constLattice );
+    // Avoid dereferencing uninitialized pointer.
+    if (domain.nCells()==0) return;
+    // 1. Send dynamic info (automatic allocation of buffer memory).
+    sendDynamicsDictionary(domain, buffer);
+    // 2. Send static info of all cells in one block.
+    if (staticCellSize()>0) {
+        pluint pos = buffer.size();
+        buffer.resize(pos+domain.nCells()*staticCellSize());
+        sendStatic(domain, &buffer[pos]);
+    }
+}
+
+/** The dynamics content of a block is generally made of a few distinct
+ *  dynamics objects, repeated over millions of cells. Each distinct content is
+ *  therefore serialized once into a dictionary, and the cells only refer to
+ *  it through an id. The data has the following layout:
+ *    number of entries, entries (hierarchic serialization of a dynamics object),
+ *    number of runs, runs (number of consecutive cells, id of their entry).
+ *  All numbers are of type plint, and the cells are in the usual x-y-z order.
+ **/
+template<typename T, template<typename U> class Descriptor>
+void BlockLatticeDataTransfer3D<T,Descriptor>::sendDynamicsDictionary (
+        Box3D domain, std::vector<char>& buffer ) const
+{
+    PLB_PRECONDITION( constLattice );
+    pluint dictionaryPos = buffer.size();
+    buffer.resize(dictionaryPos+sizeof(plint));
+    std::map<std::vector<char>,plint> dictionary;
+    // Runs, stored as pairs (number of cells, id).
+    std::vector<plint> runs;
+    std::vector<char> dynamicsData;
+    Dynamics<T,Descriptor> const* previousDynamics = 0;
+    plint id = -1;
     for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
         for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
             for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
-                // 1. Send dynamic info (automaic allocation of buffer memory).
-                serialize(constLattice->get(iX,iY,iZ).getDynamics(), buffer);
-                pluint pos = buffer.size();
-                // 2. Send static info (needs manual allocation of buffer memory).
-                if (staticCellSize()>0) {
-                    buffer.resize(pos+staticCellSize());
-                    constLattice->get(iX,iY,iZ).serialize(&buffer[pos]);
+                Dynamics<T,Descriptor> const* dynamics =
+                    &constLattice->get(iX,iY,iZ).getDynamics();
+                // Consecutive cells which share the same object also share
+                //   its id, without being serialized again.
+                if (dynamics != previousDynamics) {
+                    dynamicsData.clear();
+                    serialize(*dynamics, dynamicsData);
+                    typename std::map<std::vector<char>,plint>::const_iterator it =
+                        dictionary.find(dynamicsData);
+                    if (it==dictionary.end()) {
+                        id = (plint)dictionary.size();
+                        dictionary.insert(std::make_pair(dynamicsData, id));
+                        buffer.insert(buffer.end(), dynamicsData.begin(), dynamicsData.end());
+                    }
+                    else {
+                        id = it->second;
+                    }
+                    previousDynamics = dynamics;
+                }
+                if (!runs.empty() && runs.back()==id) {
+                    ++runs[runs.size()-2];
+                }
+                else {
+                    runs.push_back(1);
+                    runs.push_back(id);
                 }
             }
         }
     }
+    plint numEntries = (plint)dictionary.size();
+    memcpy((void*)(&buffer[dictionaryPos]), (const void*)(&numEntries), sizeof(plint));
+
+    plint numRuns = (plint)runs.size()/2;
+    pluint runsPos = buffer.size();
+    buffer.resize(runsPos+(1+runs.size())*sizeof(plint));
+    memcpy((void*)(&buffer[runsPos]), (const void*)(&numRuns), sizeof(plint));
+    if (!runs.empty()) {
+        memcpy((void*)(&buffer[runsPos+sizeof(plint)]), (const void*)(&runs[0]), runs.size()*sizeof(plint));
+    }
+}
+
+template<typename T, template<typename U> class Descriptor>
+pluint BlockLatticeDataTransfer3D<T,Descriptor>::receiveDynamicsDictionary (
+        Box3D domain, std::vector<char> const& buffer,
+        std::vector<pluint>& entries, std::vector<plint>& cellIds ) const
+{
+    pluint pos = 0;
+    plint numEntries;
+    PLB_ASSERT( pos+sizeof(plint)<=buffer.size() );
+    memcpy((void*)(&numEntries), (const void*)(&buffer[pos]), sizeof(plint));
+    pos += sizeof(plint);
+    entries.resize(numEntries);
+    for (plint iEntry=0; iEntry<numEntries; ++iEntry) {
+        entries[iEntry] = pos;
+        pos = skipHierarchicData(buffer, pos);
+    }
+
+    plint numRuns;
+    PLB_ASSERT( pos+sizeof(plint)<=buffer.size() );
+    memcpy((void*)(&numRuns), (const void*)(&buffer[pos]), sizeof(plint));
+    pos += sizeof(plint);
+    cellIds.clear();
+    cellIds.reserve(domain.nCells());
+    for (plint iRun=0; iRun<numRuns; ++iRun) {
+        plint run[2];
+        PLB_ASSERT( pos+sizeof(run)<=buffer.size() );
+        memcpy((void*)run, (const void*)(&buffer[pos]), sizeof(run));
+        pos += sizeof(run);
+        PLB_ASSERT( run[1]>=0 && run[1]<numEntries );
+        cellIds.insert(cellIds.end(), run[0], run[1]);
+    }
+    PLB_ASSERT( (plint)cellIds.size()==domain.nCells() );
+    return pos;
 }
 
 template<typename T, template<typename U> class Descriptor>
@@ -775,6 +1214,20 @@ void BlockLatticeDataTransfer3D<T,Descriptor>::receive (
     }
 }
 
+template<typename T, template<typename U> class Descriptor>
+void BlockLatticeDataTransfer3D<T,Descriptor>::receiveCellwise (
+        Box3D domain, std::vector<char> const& buffer,
+        std::map<int,std::string> const& foreignIds )
+{
+    PLB_PRECONDITION( lattice );
+    PLB_PRECONDITION(contained(domain, lattice->getBoundingBox()));
+    std::map<int,int> idIndirect;
+    if (!foreignIds.empty()) {
+        meta::createIdIndirection<T,Descriptor>(foreignIds, idIndirect);
+    }
+    receive_cellwise(domain, buffer, idIndirect);
+}
+
 template<typename T, template<typename U> class Descriptor>
 void BlockLatticeDataTransfer3D<T,Descriptor>::receive (
         Box3D domain, std::vector<char> const& buffer, modif::ModifT kind )
@@ -803,13 +1256,22 @@ void BlockLatticeDataTransfer3D<T,Descriptor>::receive_static (
     PLB_PRECONDITION( (plint) buffer.size() == domain.nCells()*staticCellSize() );
     // Avoid dereferencing uninitialized pointer.
     if (buffer.empty()) return;
+    receiveStatic(domain, &buffer[0], Dot3D());
+}
+
+template<typename T, template<typename U> class Descriptor>
+void BlockLatticeDataTransfer3D<T,Descriptor>::receiveStatic (
+        Box3D domain, char const* buffer, Dot3D absoluteOffset )
+{
+    PLB_PRECONDITION( lattice );
+    PLB_PRECONDITION(contained(domain, lattice->getBoundingBox()));
     plint cellSize = staticCellSize();
 
     plint iData=0;
     for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
         for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
             for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
-                lattice->get(iX,iY,iZ).unSerialize(&buffer[iData]);
+                lattice->get(iX,iY,iZ).unSerialize(buffer+iData);
                 iData += cellSize;
             }
         }
@@ -821,15 +1283,19 @@ void BlockLatticeDataTransfer3D<T,Descriptor>::receive_dynamic (
         Box3D domain, std::vector<char> const& buffer )
 {
     PLB_PRECONDITION( lattice );
-    pluint serializerPos = 0;
+    // Avoid dereferencing uninitialized pointer.
+    if (buffer.empty()) return;
+    std::vector<pluint> entries;
+    std::vector<plint> cellIds;
+    receiveDynamicsDictionary(domain, buffer, entries, cellIds);
+    plint iCell = 0;
     for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
         for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
             for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
                 // No assert is included here, because incompatible types of
                 //   dynamics are detected by asserts inside HierarchicUnserializer.
-                serializerPos = 
-                    unserialize (
-                        lattice->get(iX,iY,iZ).getDynamics(), buffer, serializerPos );
+                unserialize (
+                    lattice->get(iX,iY,iZ).getDynamics(), buffer, entries[cellIds[iCell++]] );
             }
         }
     }
@@ -840,23 +1306,26 @@ void BlockLatticeDataTransfer3D<T,Descriptor>::receive_all (
         Box3D domain, std::vector<char> const& buffer )
 {
     PLB_PRECONDITION( lattice );
-    pluint posInBuffer = 0;
-    plint cellSize = staticCellSize();
+    // Avoid dereferencing uninitialized pointer.
+    if (buffer.empty()) return;
+    std::vector<pluint> entries;
+    std::vector<plint> cellIds;
+    pluint posInBuffer = receiveDynamicsDictionary(domain, buffer, entries, cellIds);
+    // 1. Unserialize dynamic data.
+    plint iCell = 0;
     for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
         for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
             for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
-                // 1. Unserialize dynamic data.
-                posInBuffer = 
-                    unserialize (
-                        lattice->get(iX,iY,iZ).getDynamics(), buffer, posInBuffer );
-                // 2. Unserialize static data.
-                if (staticCellSize()>0) {
-                    lattice->get(iX,iY,iZ).unSerialize(&buffer[posInBuffer]);
-                    posInBuffer += cellSize;
-                }
+                unserialize (
+                    lattice->get(iX,iY,iZ).getDynamics(), buffer, entries[cellIds[iCell++]] );
             }
         }
     }
+    // 2. Unserialize static data.
+    if (staticCellSize()>0) {
+        PLB_ASSERT( posInBuffer+domain.nCells()*staticCellSize()==buffer.size() );
+        receiveStatic(domain, &buffer[posInBuffer], Dot3D());
+    }
 }
 
 template<typename T, template<typename U> class Descriptor>
@@ -864,22 +1333,89 @@ void BlockLatticeDataTransfer3D<T,Descriptor>::receive_regenerate (
         Box3D domain, std::vector<char> const& buffer, std::map<int,int> const& idIndirect )
 {
     PLB_PRECONDITION( lattice );
+    // Avoid dereferencing uninitialized pointer.
+    if (buffer.empty()) return;
+    std::vector<pluint> entries;
+    std::vector<plint> cellIds;
+    pluint posInBuffer = receiveDynamicsDictionary(domain, buffer, entries, cellIds);
+
+    // 1. Generate one dynamics object per dictionary entry, and attribute
+    //    a copy of it to each cell. Entries which are equal to the background
+    //    dynamics of the lattice are replaced by the background dynamics
+    //    itself, as the sender has no means to tell that its cells pointed to
+    //    it. Otherwise, the static dispatch of the bulk collision would be lost
+    //    on a block after a migration or a restart from a checkpoint.
+    std::map<int,int> const* indirectPtr = idIndirect.empty() ? 0 : &idIndirect;
+    std::vector<Dynamics<T,Descriptor>*> prototypes(entries.size());
+    std::vector<bool> isBackground(entries.size());
+    std::vector<char> backgroundData, prototypeData;
+    serialize(lattice->getBackgroundDynamics(), backgroundData);
+    for (pluint iEntry=0; iEntry<entries.size(); ++iEntry) {
+        HierarchicUnserializer unserializer(buffer, entries[iEntry], indirectPtr);
+        prototypes[iEntry] = meta::dynamicsRegistration<T,Descriptor>().generate(unserializer);
+        prototypeData.clear();
+        serialize(*prototypes[iEntry], prototypeData);
+        isBackground[iEntry] = prototypeData==backgroundData;
+    }
+    plint iCell = 0;
+    for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
+        for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
+            for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
+                plint iEntry = cellIds[iCell++];
+                if (isBackground[iEntry]) {
+                    lattice->attributeDynamics(iX,iY,iZ, &lattice->getBackgroundDynamics());
+                }
+                else {
+                    lattice->attributeDynamics(iX,iY,iZ, prototypes[iEntry]->clone());
+                }
+            }
+        }
+    }
+    for (pluint iEntry=0; iEntry<prototypes.size(); ++iEntry) {
+        delete prototypes[iEntry];
+    }
+
+    // 2. Unserialize static data.
+    if (staticCellSize()>0) {
+        PLB_ASSERT( posInBuffer+domain.nCells()*staticCellSize()==buffer.size() );
+        receiveStatic(domain, &buffer[posInBuffer], Dot3D());
+    }
+}
+
+/** This is the decoder of format version 1 of the checkpoint files, which
+ *  stored one serialized dynamics object per cell. As in receive_regenerate(),
+ *  the cells whose dynamics is equal to the background dynamics point to it.
+ */
+template<typename T, template<typename U> class Descriptor>
+void BlockLatticeDataTransfer3D<T,Descriptor>::receive_cellwise (
+        Box3D domain, std::vector<char> const& buffer, std::map<int,int> const& idIndirect )
+{
+    PLB_PRECONDITION( lattice );
+    std::map<int,int> const* indirectPtr = idIndirect.empty() ? 0 : &idIndirect;
+    std::vector<char> backgroundData, dynamicsData;
+    serialize(lattice->getBackgroundDynamics(), backgroundData);
     pluint posInBuffer = 0;
     plint cellSize = staticCellSize();
     for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
         for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
             for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
                 // 1. Generate dynamics object, and unserialize dynamic data.
-                std::map<int,int> const* indirectPtr = idIndirect.empty() ? 0 : &idIndirect;
                 HierarchicUnserializer unserializer(buffer, posInBuffer, indirectPtr);
                 Dynamics<T,Descriptor>* newDynamics =
                     meta::dynamicsRegistration<T,Descriptor>().generate(unserializer);
                 posInBuffer = unserializer.getCurrentPos();
-                lattice->attributeDynamics(iX,iY,iZ, newDynamics);
+                dynamicsData.clear();
+                serialize(*newDynamics, dynamicsData);
+                if (dynamicsData==backgroundData) {
+                    delete newDynamics;
+                    lattice->attributeDynamics(iX,iY,iZ, &lattice->getBackgroundDynamics());
+                }
+                else {
+                    lattice->attributeDynamics(iX,iY,iZ, newDynamics);
+                }
 
                 // 2. Unserialize static data.
-                if (staticCellSize()>0) {
-                    PLB_ASSERT( !buffer.empty() );
+                if (cellSize>0) {
                     PLB_ASSERT( posInBuffer+cellSize<=buffer.size() );
                     lattice->get(iX,iY,iZ).unSerialize(&buffer[posInBuffer]);
                     posInBuffer += cellSize;
@@ -889,6 +1425,117 @@ void BlockLatticeDataTransfer3D<T,Descriptor>::receive_regenerate (
     }
 }
 
+template<typename T, template<typename U> class Descriptor>
+void BlockLatticeDataTransfer3D<T,Descriptor>::extract (
+        Box3D bufferDomain, std::vector<char> const& buffer, modif::ModifT kind,
+        Box3D region, std::vector<char>& regionBuffer ) const
+{
+    if (kind==modif::staticVariables) {
+        BlockDataTransfer3D::extract(bufferDomain, buffer, kind, region, regionBuffer);
+        return;
+    }
+    PLB_PRECONDITION( contained(region, bufferDomain) );
+    regionBuffer.clear();
+    if (buffer.empty()) return;
+    pluint staticPos = extractDynamicsDictionary(bufferDomain, buffer, region, regionBuffer);
+    // The static data follows the dynamics dictionary, except if only the
+    //   dynamic variables were sent.
+    plint cellStaticSize = kind==modif::dynamicVariables ? 0 : staticCellSize();
+    plint runSize = cellStaticSize*region.getNz();
+    pluint pos = regionBuffer.size();
+    regionBuffer.resize(pos+region.nCells()*cellStaticSize);
+    for (plint iX=region.x0; iX<=region.x1; ++iX) {
+        for (plint iY=region.y0; iY<=region.y1; ++iY) {
+            pluint start = staticPos + cellStaticSize * (
+                               (region.z0-bufferDomain.z0) + bufferDomain.getNz() *
+                               ( (iY-bufferDomain.y0) + bufferDomain.getNy()*(iX-bufferDomain.x0) ) );
+            std::copy(buffer.begin()+start, buffer.begin()+start+runSize, regionBuffer.begin()+pos);
+            pos += runSize;
+        }
+    }
+}
+
+template<typename T, template<typename U> class Descriptor>
+bool BlockLatticeDataTransfer3D<T,Descriptor>::sendsStaticDataLast(modif::ModifT kind) const
+{
+    return kind==modif::allVariables || kind==modif::dataStructure;
+}
+
+template<typename T, template<typename U> class Descriptor>
+void BlockLatticeDataTransfer3D<T,Descriptor>::extractFromHeader (
+        Box3D bufferDomain, std::vector<char> const& header, modif::ModifT kind,
+        Box3D region, std::vector<char> const& regionStaticData,
+        std::vector<char>& regionBuffer ) const
+{
+    PLB_PRECONDITION( sendsStaticDataLast(kind) );
+    PLB_PRECONDITION( contained(region, bufferDomain) );
+    PLB_PRECONDITION( (plint)regionStaticData.size()==region.nCells()*staticCellSize() );
+    regionBuffer.clear();
+    if (header.empty()) return;
+    extractDynamicsDictionary(bufferDomain, header, region, regionBuffer);
+    regionBuffer.insert(regionBuffer.end(), regionStaticData.begin(), regionStaticData.end());
+}
+
+/** The dictionary is kept as it is. The runs are decoded while walking through
+ *  the cells of bufferDomain, and re-encoded for the cells of the region only.
+ */
+template<typename T, template<typename U> class Descriptor>
+pluint BlockLatticeDataTransfer3D<T,Descriptor>::extractDynamicsDictionary (
+        Box3D bufferDomain, std::vector<char> const& buffer,
+        Box3D region, std::vector<char>& regionBuffer ) const
+{
+    pluint pos = 0;
+    plint numEntries;
+    PLB_ASSERT( pos+sizeof(plint)<=buffer.size() );
+    memcpy((void*)(&numEntries), (const void*)(&buffer[pos]), sizeof(plint));
+    pos += sizeof(plint);
+    for (plint iEntry=0; iEntry<numEntries; ++iEntry) {
+        pos = skipHierarchicData(buffer, pos);
+    }
+    regionBuffer.assign(buffer.begin(), buffer.begin()+pos);
+
+    plint numRuns;
+    PLB_ASSERT( pos+sizeof(plint)<=buffer.size() );
+    memcpy((void*)(&numRuns), (const void*)(&buffer[pos]), sizeof(plint));
+    pos += sizeof(plint);
+    std::vector<plint> runs;
+    plint iX=bufferDomain.x0, iY=bufferDomain.y0, iZ=bufferDomain.z0;
+    for (plint iRun=0; iRun<numRuns; ++iRun) {
+        plint run[2];
+        PLB_ASSERT( pos+sizeof(run)<=buffer.size() );
+        memcpy((void*)run, (const void*)(&buffer[pos]), sizeof(run));
+        pos += sizeof(run);
+        for (plint iCell=0; iCell<run[0]; ++iCell) {
+            if (contained(iX,iY,iZ, region)) {
+                if (!runs.empty() && runs.back()==run[1]) {
+                    ++runs[runs.size()-2];
+                }
+                else {
+                    runs.push_back(1);
+                    runs.push_back(run[1]);
+                }
+            }
+            if (++iZ>bufferDomain.z1) {
+                iZ = bufferDomain.z0;
+                if (++iY>bufferDomain.y1) {
+                    iY = bufferDomain.y0;
+                    ++iX;
+                }
+            }
+        }
+    }
+    PLB_ASSERT( iX==bufferDomain.x1+1 );
+
+    plint numRegionRuns = (plint)runs.size()/2;
+    pluint runsPos = regionBuffer.size();
+    regionBuffer.resize(runsPos+(1+runs.size())*sizeof(plint));
+    memcpy((void*)(&regionBuffer[runsPos]), (const void*)(&numRegionRuns), sizeof(plint));
+    if (!runs.empty()) {
+        memcpy((void*)(&regionBuffer[runsPos+sizeof(plint)]), (const void*)(&runs[0]), runs.size()*sizeof(plint));
+    }
+    return pos;
+}
+
 template<typename T, template<typename U> class Descriptor>
 void BlockLatticeDataTransfer3D<T,Descriptor>::attribute (
         Box3D toDomain, plint deltaX, plint deltaY, plint deltaZ,
@@ -983,19 +1630,26 @@ void BlockLatticeDataTransfer3D<T,Descriptor>::attribute_regenerate (
         BlockLattice3D<T,Descriptor> const& from )
 {
     PLB_PRECONDITION( lattice );
-    std::vector<char> serializedData;
+    std::vector<char> serializedData, backgroundData;
+    serialize(lattice->getBackgroundDynamics(), backgroundData);
     for (plint iX=toDomain.x0; iX<=toDomain.x1; ++iX) {
         for (plint iY=toDomain.y0; iY<=toDomain.y1; ++iY) {
             for (plint iZ=toDomain.z0; iZ<=toDomain.z1; ++iZ) {
-                // 1. Generate new dynamics and attribute dynamic content.
+                // 1. Generate new dynamics and attribute dynamic content. As in
+                //    receive_regenerate(), the background dynamics is reused.
                 serializedData.clear();
                 serialize (
                     from.get(iX+deltaX,iY+deltaY,iZ+deltaZ).getDynamics(),
                     serializedData );
-                HierarchicUnserializer unserializer(serializedData, 0);
-                Dynamics<T,Descriptor>* newDynamics =
-                    meta::dynamicsRegistration<T,Descriptor>().generate(unserializer);
-                lattice->attributeDynamics(iX,iY,iZ, newDynamics);
+                if (serializedData==backgroundData) {
+                    lattice->attributeDynamics(iX,iY,iZ, &lattice->getBackgroundDynamics());
+                }
+                else {
+                    HierarchicUnserializer unserializer(serializedData, 0);
+                    Dynamics<T,Descriptor>* newDynamics =
+                        meta::dynamicsRegistration<T,Descriptor>().generate(unserializer);
+                    lattice->attributeDynamics(iX,iY,iZ, newDynamics);
+                }
 
                 // 2. Attribute static content.
                 lattice->get(iX,iY,iZ).attributeValues (
@@ -1007,7 +1661,8 @@ void BlockLatticeDataTransfer3D<T,Descriptor>::attribute_regenerate (
 
 template<typename T, template<typename U> class Descriptor>
 CachePolicy3D& BlockLattice3D<T,Descriptor>::cachePolicy() {
-    static CachePolicy3D cachePolicySingleton(30);
+    // Block size 0: computed automatically from the cell size and the L2 cache.
+    static CachePolicy3D cachePolicySingleton(0);
     return cachePolicySingleton;
 }
 
@@ -61,6 +61,9 @@ public:
     {
         receive(domain, buffer, kind);
     }
+    /// Address of the data of domain, if it is contiguous in memory.
+    virtual char const* getStaticDataSpan(Box3D domain) const;
+    virtual char* getStaticDataSpan(Box3D domain);
     /// Attribute data between two blocks.
     virtual void attribute(Box3D toDomain, plint deltaX, plint deltaY, plint deltaZ,
                            AtomicBlock3D const& from, modif::ModifT kind);
@@ -140,6 +143,9 @@ public:
     {
         receive(domain, buffer, kind);
     }
+    /// Address of the data of domain, if it is contiguous in memory.
+    virtual char const* getStaticDataSpan(Box3D domain) const;
+    virtual char* getStaticDataSpan(Box3D domain);
     /// Attribute data between two blocks.
     virtual void attribute(Box3D toDomain, plint deltaX, plint deltaY, plint deltaZ,
                            AtomicBlock3D const& from, modif::ModifT kind);
@@ -221,6 +227,9 @@ public:
     {
         receive(domain, buffer, kind);
     }
+    /// Address of the data of domain, if it is contiguous in memory.
+    virtual char const* getStaticDataSpan(Box3D domain) const;
+    virtual char* getStaticDataSpan(Box3D domain);
     /// Attribute data between two blocks.
     virtual void attribute(Box3D toDomain, plint deltaX, plint deltaY, plint deltaZ,
                            AtomicBlock3D const& from, modif::ModifT kind);
@@ -214,6 +214,28 @@ void ScalarFieldDataTransfer3D<T>::receive (
     }
 }
 
+template<typename T>
+char const* ScalarFieldDataTransfer3D<T>::getStaticDataSpan(Box3D domain) const
+{
+    PLB_PRECONDITION( constField );
+    PLB_PRECONDITION( contained(domain, constField->getBoundingBox()) );
+    if (domain.nCells()==0 || !isContiguous(domain, constField->getBoundingBox())) {
+        return 0;
+    }
+    return (char const*)(&constField->get(domain.x0,domain.y0,domain.z0));
+}
+
+template<typename T>
+char* ScalarFieldDataTransfer3D<T>::getStaticDataSpan(Box3D domain)
+{
+    PLB_PRECONDITION( field );
+    PLB_PRECONDITION( contained(domain, field->getBoundingBox()) );
+    if (domain.nCells()==0 || !isContiguous(domain, field->getBoundingBox())) {
+        return 0;
+    }
+    return (char*)(&field->get(domain.x0,domain.y0,domain.z0));
+}
+
 template<typename T>
 void ScalarFieldDataTransfer3D<T>::attribute (
         Box3D toDomain, plint deltaX, plint deltaY, plint deltaZ,
@@ -430,6 +452,28 @@ void TensorFieldDataTransfer3D<T,nDim>::receive (
     }
 }
 
+template<typename T, int nDim>
+char const* TensorFieldDataTransfer3D<T,nDim>::getStaticDataSpan(Box3D domain) const
+{
+    PLB_PRECONDITION( constField );
+    PLB_PRECONDITION( contained(domain, constField->getBoundingBox()) );
+    if (domain.nCells()==0 || !isContiguous(domain, constField->getBoundingBox())) {
+        return 0;
+    }
+    return (char const*)(&constField->get(domain.x0,domain.y0,domain.z0)[0]);
+}
+
+template<typename T, int nDim>
+char* TensorFieldDataTransfer3D<T,nDim>::getStaticDataSpan(Box3D domain)
+{
+    PLB_PRECONDITION( field );
+    PLB_PRECONDITION( contained(domain, field->getBoundingBox()) );
+    if (domain.nCells()==0 || !isContiguous(domain, field->getBoundingBox())) {
+        return 0;
+    }
+    return (char*)(&field->get(domain.x0,domain.y0,domain.z0)[0]);
+}
+
 template<typename T, int nDim>
 void TensorFieldDataTransfer3D<T,nDim>::attribute (
         Box3D toDomain, plint deltaX, plint deltaY, plint deltaZ,
@@ -665,6 +709,28 @@ void NTensorFieldDataTransfer3D<T>::receive (
     }
 }
 
+template<typename T>
+char const* NTensorFieldDataTransfer3D<T>::getStaticDataSpan(Box3D domain) const
+{
+    PLB_PRECONDITION( constField );
+    PLB_PRECONDITION( contained(domain, constField->getBoundingBox()) );
+    if (domain.nCells()==0 || !isContiguous(domain, constField->getBoundingBox())) {
+        return 0;
+    }
+    return (char const*)constField->get(domain.x0,domain.y0,domain.z0);
+}
+
+template<typename T>
+char* NTensorFieldDataTransfer3D<T>::getStaticDataSpan(Box3D domain)
+{
+    PLB_PRECONDITION( field );
+    PLB_PRECONDITION( contained(domain, field->getBoundingBox()) );
+    if (domain.nCells()==0 || !isContiguous(domain, field->getBoundingBox())) {
+        return 0;
+    }
+    return (char*)field->get(domain.x0,domain.y0,domain.z0);
+}
+
 template<typename T>
 void NTensorFieldDataTransfer3D<T>::attribute (
         Box3D toDomain, plint deltaX, plint deltaY, plint deltaZ,
@@ -112,8 +112,8 @@ void ExternalRhoJcollideAndStream2D<T,Descriptor>::processGenericBlocks (
     Dot2D offset1 = computeRelativeDisplacement(lattice, rhoBarField);
     Dot2D offset2 = computeRelativeDisplacement(lattice, jField);
 
-    global::profiler().start("collStream");
-    global::profiler().increment("collStreamCells", extDomain.nCells());
+    global::profiler().start(global::prof::collStream);
+    global::profiler().increment(global::prof::collStreamCells, extDomain.nCells());
 
     // First, do the collision on cells within a boundary envelope of width
     // equal to the range of the lattice vectors (e.g. 1 for D2Q9)
@@ -145,7 +145,7 @@ void ExternalRhoJcollideAndStream2D<T,Descriptor>::processGenericBlocks (
     boundaryStream(lattice, extDomain, Box2D(extDomain.x0+vicinity,extDomain.x1-vicinity,
                                              extDomain.y1-vicinity+1,extDomain.y1));
 
-    global::profiler().stop("collStream");
+    global::profiler().stop(global::prof::collStream);
 }
 
 template<typename T, template<typename U> class Descriptor>
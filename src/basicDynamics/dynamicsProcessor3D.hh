@@ -123,8 +123,8 @@ void ExternalRhoJcollideAndStream3D<T,Descriptor>::processGenericBlocks (
     Dot3D offset1 = computeRelativeDisplacement(lattice, rhoBarField);
     Dot3D offset2 = computeRelativeDisplacement(lattice, jField);
 
-    global::profiler().start("collStream");
-    global::profiler().increment("collStreamCells", extDomain.nCells());
+    global::profiler().start(global::prof::collStream);
+    global::profiler().increment(global::prof::collStreamCells, extDomain.nCells());
 
     // First, do the collision on cells within a boundary envelope of width
     // equal to the range of the lattice vectors (e.g. 1 for D2Q9)
@@ -189,7 +189,7 @@ void ExternalRhoJcollideAndStream3D<T,Descriptor>::processGenericBlocks (
     boundaryStream(lattice, extDomain, Box3D(extDomain.x0+vicinity,extDomain.x1-vicinity,
                                              extDomain.y0+vicinity,extDomain.y1-vicinity,
                                              extDomain.z1-vicinity+1,extDomain.z1) );
-    global::profiler().stop("collStream");
+    global::profiler().stop(global::prof::collStream);
     global::timer("collideAndStream").stop();
 }
 
@@ -299,8 +299,8 @@ void PackedExternalRhoJcollideAndStream3D<T,Descriptor>::process (
 
     Dot3D offset = computeRelativeDisplacement(lattice, rhoBarJfield);
 
-    global::profiler().start("collStream");
-    global::profiler().increment("collStreamCells", extDomain.nCells());
+    global::profiler().start(global::prof::collStream);
+    global::profiler().increment(global::prof::collStreamCells, extDomain.nCells());
 
     // First, do the collision on cells within a boundary envelope of width
     // equal to the range of the lattice vectors (e.g. 1 for D2Q9)
@@ -365,7 +365,7 @@ void PackedExternalRhoJcollideAndStream3D<T,Descriptor>::process (
     boundaryStream(lattice, extDomain, Box3D(extDomain.x0+vicinity,extDomain.x1-vicinity,
                                              extDomain.y0+vicinity,extDomain.y1-vicinity,
                                              extDomain.z1-vicinity+1,extDomain.z1) );
-    global::profiler().stop("collStream");
+    global::profiler().stop(global::prof::collStream);
     global::timer("collideAndStream").stop();
 }
 
@@ -530,8 +530,8 @@ void WaveAbsorptionExternalRhoJcollideAndStream3D<T,Descriptor>::processGenericB
     Dot3D offset2 = computeRelativeDisplacement(lattice, jField);
     Dot3D offset3 = computeRelativeDisplacement(lattice, sigmaField);
 
-    global::profiler().start("collStream");
-    global::profiler().increment("collStreamCells", extDomain.nCells());
+    global::profiler().start(global::prof::collStream);
+    global::profiler().increment(global::prof::collStreamCells, extDomain.nCells());
 
     // First, do the collision on cells within a boundary envelope of width
     // equal to the range of the lattice vectors (e.g. 1 for D2Q9)
@@ -596,7 +596,7 @@ void WaveAbsorptionExternalRhoJcollideAndStream3D<T,Descriptor>::processGenericB
     boundaryStream(lattice, extDomain, Box3D(extDomain.x0+vicinity,extDomain.x1-vicinity,
                                              extDomain.y0+vicinity,extDomain.y1-vicinity,
                                              extDomain.z1-vicinity+1,extDomain.z1) );
-    global::profiler().stop("collStream");
+    global::profiler().stop(global::prof::collStream);
     global::timer("collideAndStream").stop();
 }
 
@@ -735,8 +735,8 @@ void OnLinkExternalRhoJcollideAndStream3D<T,Descriptor>::processGenericBlocks (
     Dot3D offset1 = computeRelativeDisplacement(lattice, rhoBarField);
     Dot3D offset2 = computeRelativeDisplacement(lattice, jField);
 
-    global::profiler().start("collStream");
-    global::profiler().increment("collStreamCells", extDomain.nCells());
+    global::profiler().start(global::prof::collStream);
+    global::profiler().increment(global::prof::collStreamCells, extDomain.nCells());
 
     // First, do the collision on cells within a boundary envelope of width
     // equal to the range of the lattice vectors (e.g. 1 for D2Q9)
@@ -801,7 +801,7 @@ void OnLinkExternalRhoJcollideAndStream3D<T,Descriptor>::processGenericBlocks (
     boundaryStream(lattice, extDomain, Box3D(extDomain.x0+vicinity,extDomain.x1-vicinity,
                                              extDomain.y0+vicinity,extDomain.y1-vicinity,
                                              extDomain.z1-vicinity+1,extDomain.z1) );
-    global::profiler().stop("collStream");
+    global::profiler().stop(global::prof::collStream);
     global::timer("collideAndStream").stop();
 }
 
@@ -39,8 +39,12 @@
 #include "latticeBoltzmann/d3q13Templates.h"
 #include "latticeBoltzmann/geometricOperationTemplates.h"
 #include "core/latticeStatistics.h"
+#include "atomicBlock/blockLattice3D.h"
+#include "latticeBoltzmann/nearestNeighborLattices3D.h"
+#include "latticeBoltzmann/extendedNeighborhoodLattices3D.h"
 #include <algorithm>
 #include <limits>
+#include <typeinfo>
 
 namespace plb {
 
@@ -2358,7 +2362,80 @@ void PrecondBGKdynamics<T,Descriptor>::unserialize(HierarchicUnserializer& unser
     invGamma = unserializer.readValue<T>();
 }
 
+/* *************** Static dispatch of the bulk collision ***************** */
+
+/// Static dispatch of the isothermal models in the collide-and-stream loops of
+///   BlockLattice3D.
+/** BGKdynamics is dispatched on all lattices. RegularizedBGKdynamics and
+ *  CompleteRegularizedBGKdynamics rely on collision templates (rlb_collision,
+ *  complete_regularized_bgk_ma2_collision) which are only specialized for
+ *  some lattices; they are dispatched if regularizedCollision is true. The
+ *  dynamic type is compared exactly, because derived classes may override
+ *  collide().
+ */
+template<typename T, template<typename U> class Descriptor, bool regularizedCollision>
+struct IsoThermalBulkCollisionTraits3D {
+    template<class Function>
+    static void dispatch(Dynamics<T,Descriptor>* backgroundDynamics, Function const& function) {
+        if (typeid(*backgroundDynamics)==typeid(BGKdynamics<T,Descriptor>)) {
+            function(HomogeneousBulkCollision3D<T,Descriptor,BGKdynamics<T,Descriptor> >(backgroundDynamics));
+        }
+        else {
+            function(GenericBulkCollision3D<T,Descriptor>());
+        }
+    }
+};
+
+template<typename T, template<typename U> class Descriptor>
+struct IsoThermalBulkCollisionTraits3D<T,Descriptor,true> {
+    template<class Function>
+    static void dispatch(Dynamics<T,Descriptor>* backgroundDynamics, Function const& function) {
+        std::type_info const& backgroundType = typeid(*backgroundDynamics);
+        if (backgroundType==typeid(BGKdynamics<T,Descriptor>)) {
+            function(HomogeneousBulkCollision3D<T,Descriptor,BGKdynamics<T,Descriptor> >(backgroundDynamics));
+        }
+        else if (backgroundType==typeid(RegularizedBGKdynamics<T,Descriptor>)) {
+            function(HomogeneousBulkCollision3D<T,Descriptor,RegularizedBGKdynamics<T,Descriptor> >(backgroundDynamics));
+        }
+        else if (backgroundType==typeid(CompleteRegularizedBGKdynamics<T,Descriptor>)) {
+            function(HomogeneousBulkCollision3D<T,Descriptor,CompleteRegularizedBGKdynamics<T,Descriptor> >(backgroundDynamics));
+        }
+        else {
+            function(GenericBulkCollision3D<T,Descriptor>());
+        }
+    }
+};
+
+template<typename T, template<typename U> class Descriptor>
+struct BulkCollisionTraits3D<T,Descriptor,descriptors::D3Q13DescriptorBase<T> >
+    : public IsoThermalBulkCollisionTraits3D<T,Descriptor,false>
+{ };
+
+template<typename T, template<typename U> class Descriptor>
+struct BulkCollisionTraits3D<T,Descriptor,descriptors::D3Q15DescriptorBase<T> >
+    : public IsoThermalBulkCollisionTraits3D<T,Descriptor,false>
+{ };
+
+template<typename T, template<typename U> class Descriptor>
+struct BulkCollisionTraits3D<T,Descriptor,descriptors::D3Q19DescriptorBase<T> >
+    : public IsoThermalBulkCollisionTraits3D<T,Descriptor,true>
+{ };
+
+template<typename T, template<typename U> class Descriptor>
+struct BulkCollisionTraits3D<T,Descriptor,descriptors::D3Q27DescriptorBase<T> >
+    : public IsoThermalBulkCollisionTraits3D<T,Descriptor,true>
+{ };
+
+template<typename T, template<typename U> class Descriptor>
+struct BulkCollisionTraits3D<T,Descriptor,descriptors::D3Q39DescriptorBase<T> >
+    : public IsoThermalBulkCollisionTraits3D<T,Descriptor,false>
+{ };
+
+template<typename T, template<typename U> class Descriptor>
+struct BulkCollisionTraits3D<T,Descriptor,descriptors::D3Q121DescriptorBase<T> >
+    : public IsoThermalBulkCollisionTraits3D<T,Descriptor,false>
+{ };
+
 }  // namespace plb
 
 #endif  // ISO_THERMAL_DYNAMICS_HH
-
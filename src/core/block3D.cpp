@@ -28,9 +28,57 @@
 #include "core/block3D.h"
 #include "core/plbDebug.h"
 #include <algorithm>
+#include <cmath>
+
+#ifdef PLB_USE_POSIX
+#include <unistd.h>
+#endif
 
 namespace plb {
 
+plint CachePolicy3D::getBlockSize(plint cellSize) const {
+    if (blockSize>0) {
+        return blockSize;
+    }
+    PLB_PRECONDITION( cellSize>0 );
+    // Half of the cache is reserved for the block; the other half holds
+    //   the neighboring cells which are touched by the streaming step.
+    plint numCells = getCacheSize()/2 / cellSize;
+    plint edge = (plint) std::pow((double)numCells, 1./3.);
+    return std::max(edge, (plint)4);
+}
+
+plint CachePolicy3D::detectedCacheSize = 0;
+
+/** The detected size is only written by plbInit(), so that the threads which
+ *  compute block sizes later on only read it. Without plbInit(), the size is
+ *  queried at each call.
+ */
+plint CachePolicy3D::getCacheSize() const {
+    if (cacheSize>0) {
+        return cacheSize;
+    }
+    if (detectedCacheSize>0) {
+        return detectedCacheSize;
+    }
+    return querySystemCacheSize();
+}
+
+void CachePolicy3D::detectCacheSize() {
+    detectedCacheSize = querySystemCacheSize();
+}
+
+plint CachePolicy3D::querySystemCacheSize() {
+#if defined PLB_USE_POSIX && defined _SC_LEVEL2_CACHE_SIZE
+    long l2Size = sysconf(_SC_LEVEL2_CACHE_SIZE);
+    if (l2Size>0) {
+        return (plint) l2Size;
+    }
+#endif
+    // Conservative default for the size of a per-core L2 cache.
+    return 256*1024;
+}
+
 void copySerializedBlock(Block3D const& from, Block3D& to, IndexOrdering::OrderingT ordering) {
     PLB_PRECONDITION( from.getBoundingBox().nCells() == to.getBoundingBox().nCells() );
     serializerToUnSerializer( from.getBlockSerializer(from.getBoundingBox(), ordering),
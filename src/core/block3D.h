@@ -49,18 +49,36 @@ void copySerializedBlock( Block3D const& from, Block3D& to,
 
 /// Some end-user implementations of the Block3D have a static cache-policy class,
 ///   which can be access to fine-tune the performance on a given platform.
+/** A block size of 0 means that the block size is chosen automatically, from
+ *  the size of the data attached to a cell and from the size of the L2 cache.
+ */
 class CachePolicy3D {
 public:
-    CachePolicy3D(plint blockSize_) : blockSize(blockSize_)
+    CachePolicy3D(plint blockSize_) : blockSize(blockSize_), cacheSize(0)
     { }
     void setBlockSize(plint blockSize_) {
         blockSize = blockSize_;
     }
+    /// Block size specified by the user, or 0 if it is automatic.
     plint getBlockSize() const {
         return blockSize;
     }
+    /// Block size to be used for cells of a given size in bytes.
+    plint getBlockSize(plint cellSize) const;
+    /// Override the automatically detected size (in bytes) of the cache.
+    void setCacheSize(plint cacheSize_) {
+        cacheSize = cacheSize_;
+    }
+    /// Size of the cache (in bytes) used to compute automatic block sizes.
+    plint getCacheSize() const;
+    /// Detect the size of the cache of the machine. This is done once by
+    ///   plbInit(), before any thread is started.
+    static void detectCacheSize();
 private:
+    static plint querySystemCacheSize();
     plint blockSize;
+    plint cacheSize;
+    static plint detectedCacheSize;
 };
 
 } // namespace plb
@@ -102,23 +102,65 @@ void BlockStatistics::evaluate() {
 
     // Second step: reset the running statistics, in order to be ready
     //   for next lattice iteration
-    for (pluint iVect=0; iVect<averageVect.size(); ++iVect) {
+    resetRunning();
+}
+
+void BlockStatistics::resetRunning() {
+    for (pluint iVect=0; iVect<tmpAv.size(); ++iVect) {
         tmpAv[iVect]     = 0.;
     }
-    for (pluint iVect=0; iVect<sumVect.size(); ++iVect) {
+    for (pluint iVect=0; iVect<tmpSum.size(); ++iVect) {
         tmpSum[iVect]    = 0.;
     }
-    for (pluint iVect=0; iVect<maxVect.size(); ++iVect) {
+    for (pluint iVect=0; iVect<tmpMax.size(); ++iVect) {
         // Use -max() instead of min(), because min<float> yields a positive value close to zero.
         tmpMax[iVect]    = -std::numeric_limits<double>::max();
     }
-    for (pluint iVect=0; iVect<intSumVect.size(); ++iVect) {
+    for (pluint iVect=0; iVect<tmpIntSum.size(); ++iVect) {
         tmpIntSum[iVect] = 0;
     }
 
     tmpNumCells = 0;
 }
 
+/** This is used to merge the statistics which have been gathered separately
+ *  by several threads on the same block.
+ */
+void BlockStatistics::combine(BlockStatistics const& rhs) {
+    PLB_PRECONDITION( tmpAv.size()     == rhs.tmpAv.size() );
+    PLB_PRECONDITION( tmpSum.size()    == rhs.tmpSum.size() );
+    PLB_PRECONDITION( tmpMax.size()    == rhs.tmpMax.size() );
+    PLB_PRECONDITION( tmpIntSum.size() == rhs.tmpIntSum.size() );
+
+    for (pluint iVect=0; iVect<tmpAv.size(); ++iVect) {
+        tmpAv[iVect]     += rhs.tmpAv[iVect];
+    }
+    for (pluint iVect=0; iVect<tmpSum.size(); ++iVect) {
+        tmpSum[iVect]    += rhs.tmpSum[iVect];
+    }
+    for (pluint iVect=0; iVect<tmpMax.size(); ++iVect) {
+        tmpMax[iVect]    = std::max(tmpMax[iVect], rhs.tmpMax[iVect]);
+    }
+    for (pluint iVect=0; iVect<tmpIntSum.size(); ++iVect) {
+        tmpIntSum[iVect] += rhs.tmpIntSum[iVect];
+    }
+
+    tmpNumCells += rhs.tmpNumCells;
+}
+
+void BlockStatistics::assignPublic(BlockStatistics const& rhs) {
+    PLB_PRECONDITION( averageVect.size() == rhs.averageVect.size() );
+    PLB_PRECONDITION( sumVect.size()     == rhs.sumVect.size() );
+    PLB_PRECONDITION( maxVect.size()     == rhs.maxVect.size() );
+    PLB_PRECONDITION( intSumVect.size()  == rhs.intSumVect.size() );
+
+    averageVect = rhs.averageVect;
+    sumVect     = rhs.sumVect;
+    maxVect     = rhs.maxVect;
+    intSumVect  = rhs.intSumVect;
+    numCells    = rhs.numCells;
+}
+
 void BlockStatistics::evaluate (
         std::vector<double> const& average, std::vector<double> const& sum,
         std::vector<double> const& max, std::vector<plint> const& intSum, pluint numCells_ )
@@ -85,6 +85,14 @@ public:
     /// Attribute a value to the public statistics, and reset running statistics to default.
     void evaluate(std::vector<double> const& average, std::vector<double> const& sum,
                   std::vector<double> const& max, std::vector<plint> const& intSum, pluint numCells_);
+    /// Reset the running statistics, without modifying the public ones.
+    void resetRunning();
+    /// Add the running statistics of rhs, which has the same subscriptions,
+    ///   to the current running statistics.
+    void combine(BlockStatistics const& rhs);
+    /// Copy the public statistics of rhs, which has the same subscriptions,
+    ///   without modifying the running ones.
+    void assignPublic(BlockStatistics const& rhs);
     /// Contribute the values of the current cell to the statistics of an "average observable"
     void gatherAverage(plint whichAverage, double value);
     /// Contribute the values of the current cell to the statistics of a "sum observable"
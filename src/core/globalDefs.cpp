@@ -34,7 +34,11 @@ IOpolicyClass::IOpolicyClass()
       endianSwitchOnBase64in(false),
       stlLowerBoundFlag(false),
       stlLowerBound(-1.),
-      parallelIOflag(true)
+      parallelIOflag(true),
+      collectiveIOflag(true),
+      numAggregatorsPerNode(1),
+      stripeCount(0),
+      stripeSize(0)
 { }
 
 void IOpolicyClass::setIndexOrderingForStreams(IndexOrdering::OrderingT streamOrdering_) {
@@ -85,6 +89,38 @@ bool IOpolicyClass::useParallelIO() const {
     return parallelIOflag;
 }
 
+void IOpolicyClass::activateCollectiveIO(bool activate) {
+    collectiveIOflag = activate;
+}
+
+bool IOpolicyClass::useCollectiveIO() const {
+    return collectiveIOflag;
+}
+
+void IOpolicyClass::setNumAggregatorsPerNode(plint numAggregatorsPerNode_) {
+    numAggregatorsPerNode = numAggregatorsPerNode_;
+}
+
+plint IOpolicyClass::getNumAggregatorsPerNode() const {
+    return numAggregatorsPerNode;
+}
+
+void IOpolicyClass::setStripeCount(plint stripeCount_) {
+    stripeCount = stripeCount_;
+}
+
+plint IOpolicyClass::getStripeCount() const {
+    return stripeCount;
+}
+
+void IOpolicyClass::setStripeSize(plint stripeSize_) {
+    stripeSize = stripeSize_;
+}
+
+plint IOpolicyClass::getStripeSize() const {
+    return stripeSize;
+}
+
 /** Directories are default initialized to working directory.
  */
 Directories::Directories()
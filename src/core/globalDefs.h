@@ -227,6 +227,26 @@ public:
 
     void activateParallelIO(bool activate);
     bool useParallelIO() const;
+
+    /// With parallel I/O, all processes access checkpoint files collectively,
+    ///   which lets the MPI library aggregate the requests (default: true).
+    void activateCollectiveIO(bool activate);
+    bool useCollectiveIO() const;
+
+    /// Number of aggregating processes per node for collective I/O. Zero
+    ///   leaves the choice to the MPI library (default: 1).
+    void setNumAggregatorsPerNode(plint numAggregatorsPerNode_);
+    plint getNumAggregatorsPerNode() const;
+
+    /// Number of storage targets over which newly created files are striped.
+    ///   Zero keeps the default of the file system.
+    void setStripeCount(plint stripeCount_);
+    plint getStripeCount() const;
+
+    /// Size, in bytes, of a stripe of newly created files. Zero keeps the
+    ///   default of the file system.
+    void setStripeSize(plint stripeSize_);
+    plint getStripeSize() const;
 private:
     IOpolicyClass();
 private:
@@ -236,6 +256,10 @@ private:
     bool stlLowerBoundFlag;
     double stlLowerBound;
     bool parallelIOflag;
+    bool collectiveIOflag;
+    plint numAggregatorsPerNode;
+    plint stripeCount;
+    plint stripeSize;
     friend IOpolicyClass& IOpolicy();
 };
     
@@ -149,6 +149,35 @@ private:
     std::map<int,int> const* idIndirect;
 };
 
+/// Position which follows the hierarchic data record that starts at pos.
+/** The record is skipped without being interpreted, which allows to find the
+ *  boundaries between the cells of a serialized block.
+ */
+inline pluint skipHierarchicData(std::vector<char> const& data, pluint pos) {
+    int numObjects, numValInObject, typeSize, numRepetitions;
+    PLB_PRECONDITION( pos+sizeof(int)<=data.size() );
+    memcpy((void*)(&numObjects), (void*)(&data[pos]), sizeof(int));
+    pos += sizeof(int);
+    for (int iObject=0; iObject<numObjects; ++iObject) {
+        // Skip the id, and read the number of values in the object.
+        PLB_PRECONDITION( pos+2*sizeof(int)<=data.size() );
+        pos += sizeof(int);
+        memcpy((void*)(&numValInObject), (void*)(&data[pos]), sizeof(int));
+        pos += sizeof(int);
+        while (numValInObject>0) {
+            PLB_PRECONDITION( pos+2*sizeof(int)<=data.size() );
+            memcpy((void*)(&typeSize), (void*)(&data[pos]), sizeof(int));
+            pos += sizeof(int);
+            memcpy((void*)(&numRepetitions), (void*)(&data[pos]), sizeof(int));
+            pos += sizeof(int);
+            pos += (pluint)typeSize*(pluint)numRepetitions;
+            numValInObject -= numRepetitions;
+        }
+    }
+    PLB_ASSERT( pos<=data.size() );
+    return pos;
+}
+
 class HierarchicSerializer {
 public:
     HierarchicSerializer(std::vector<char>& data_, int topMostObjectId)
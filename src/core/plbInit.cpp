@@ -28,6 +28,7 @@
 
 #include "core/plbInit.h"
 #include "core/plbInit.hh"
+#include "core/block3D.h"
 #include "core/plbProfiler.h"
 #include "core/plbRandom.h"
 #include "core/runTimeDiagnostics.h"
@@ -41,6 +42,7 @@ void plbInit(int *argc, char ***argv, bool verbous) {
     global::plbRandom<float>().seed(10);
     global::plbRandom<double>().seed(10);
     global::plbRandom<plint>().seed(10);
+    CachePolicy3D::detectCacheSize();
 }
 
 void plbInit() {
@@ -48,6 +50,7 @@ void plbInit() {
     global::plbRandom<float>().seed(10);
     global::plbRandom<double>().seed(10);
     global::plbRandom<plint>().seed(10);
+    CachePolicy3D::detectCacheSize();
 }
 
 namespace global {
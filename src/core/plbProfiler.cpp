@@ -25,6 +25,7 @@
 #include "core/plbProfiler.h"
 #include "parallelism/mpiManager.h"
 #include "core/runTimeDiagnostics.h"
+#include "core/plbDebug.h"
 #include "algorithm/statistics.h"
 #include "libraryInterfaces/TINYXML_xmlIO.hh"
 
@@ -32,27 +33,40 @@ namespace plb {
 
 namespace global {
 
-Profiler::Profiler() {
+namespace {
+
+/// Distance between the copies of the counters of two threads: a multiple
+///   of 64 bytes, the size of a cache line.
+const plint counterStride = ((prof::numCounters*(plint)sizeof(plint)+63)/64)*64 / (plint)sizeof(plint);
+
+}  // namespace
+
+Profiler::Profiler()
+    : counts(counterStride, 0),
+      numThreadCounters(0)
+{
     turnOff();
     automaticCycling();
     setReportFile("plbProfile");
 
-    validCounters.insert("collStreamCells");
-    validCounters.insert("iterations");
-    validCounters.insert("mpiSendChar");
-    validCounters.insert("mpiReceiveChar");
+    counterNames["collStreamCells"] = prof::collStreamCells;
+    counterNames["iterations"] = prof::iterations;
+    counterNames["mpiSendChar"] = prof::mpiSendChar;
+    counterNames["mpiReceiveChar"] = prof::mpiReceiveChar;
     
-    validTimers.insert("collStream");
-    validTimers.insert("cycle");
-    validTimers.insert("dataProcessor");
-    validTimers.insert("mpiCommunication");
-    validTimers.insert("io");
-    validTimers.insert("totalTime");
+    timerNames["collStream"] = prof::collStream;
+    timerNames["cycle"] = prof::cycle;
+    timerNames["dataProcessor"] = prof::dataProcessor;
+    timerNames["envelope-update"] = prof::envelopeUpdate;
+    timerNames["mpiCommunication"] = prof::mpiCommunication;
+    timerNames["io"] = prof::io;
+    timerNames["totalTime"] = prof::totalTime;
 }
 
 void Profiler::turnOn() {
+    allocateThreadCounters();
     profilingFlag = true;
-    start("totalTime");
+    start(prof::totalTime);
 }
 
 void Profiler::turnOff() {
@@ -68,22 +82,60 @@ void Profiler::manualCycling() {
 }
 
 void Profiler::cycle() {
-    increment("iterations");
+    allocateThreadCounters();
+    increment(prof::iterations);
 }
 
+/** The counters outside the parallel regions are at the beginning of the
+ *  array. They are followed by one copy for each thread of the parallel
+ *  regions. The array is only extended between parallel regions, when the
+ *  number of threads has increased.
+ */
+void Profiler::allocateThreadCounters() {
+    PLB_PRECONDITION( !smp().inParallelRegion() );
+    plint numThreads = smp().getNumThreads();
+    if (numThreads > numThreadCounters) {
+        counts.resize((1+numThreads)*counterStride, 0);
+        numThreadCounters = numThreads;
+    }
+}
+
+plint Profiler::getCounter(prof::CounterT counter) const {
+    plint count = 0;
+    for (plint iCopy=0; iCopy<=numThreadCounters; ++iCopy) {
+        count += counts[iCopy*counterStride+counter];
+    }
+    return count;
+}
+
+prof::TimerT Profiler::timerHandle(std::string const& timer) const {
+    std::map<std::string, prof::TimerT>::const_iterator it = timerNames.find(timer);
+    if (it==timerNames.end()) {
+        plbLogicError("Invalid timer for profiling: "+timer);
+    }
+    return it->second;
+}
+
+prof::CounterT Profiler::counterHandle(std::string const& counter) const {
+    std::map<std::string, prof::CounterT>::const_iterator it = counterNames.find(counter);
+    if (it==counterNames.end()) {
+        plbLogicError("Invalid counter for profiling: "+counter);
+    }
+    return it->second;
+}
 
 void Profiler::writeReport() {
-    plint collStreamCells = getCounter("collStreamCells");
-    plint iterations = getCounter("iterations");
-    //plint mpiSendChar = getCounter("mpiSendChar");
-    //plint mpiReceiveChar = getCounter("mpiReceiveChar");
-
-    double t_collStream = getTimer("collStream");
-    double t_cycle = getTimer("cycle");
-    //double t_dataProcessor = getTimer("dataProcessor");
-    double t_mpiCommunication = getTimer("mpiCommunication");
-    double t_io = getTimer("io");
-    //double t_totalTime = getTimer("totalTime");
+    plint collStreamCells = getCounter(prof::collStreamCells);
+    plint iterations = getCounter(prof::iterations);
+    //plint mpiSendChar = getCounter(prof::mpiSendChar);
+    //plint mpiReceiveChar = getCounter(prof::mpiReceiveChar);
+
+    double t_collStream = getTimer(prof::collStream);
+    double t_cycle = getTimer(prof::cycle);
+    //double t_dataProcessor = getTimer(prof::dataProcessor);
+    double t_mpiCommunication = getTimer(prof::mpiCommunication);
+    double t_io = getTimer(prof::io);
+    //double t_totalTime = getTimer(prof::totalTime);
 
     XMLwriter writer;
     XMLwriter& globalSection(writer["Global"]);
@@ -121,15 +173,20 @@ void Profiler::addMainProcValue(XMLwriter& writer, std::string name, plint value
 }
 
 
-void Profiler::verifyTimer(std::string const& timer) {
-    if (validTimers.find(timer)==validTimers.end()) {
-        plbLogicError("Invalid timer for profiling: "+timer);
+void Profiler::incrementConcurrently(prof::CounterT counter, plint value) {
+    plint iThread = smp().getThreadId();
+    if (iThread < numThreadCounters) {
+        counts[(1+iThread)*counterStride+counter] += value;
     }
-}
-
-void Profiler::verifyCounter(std::string const& counter) {
-    if (validCounters.find(counter)==validCounters.end()) {
-        plbLogicError("Invalid counter for profiling: "+counter);
+    else {
+        // The number of threads has increased since the counters were
+        //   allocated: the extra threads share the first copy.
+#ifdef PLB_SMP_THREADS
+        #pragma omp critical (plbProfilerCounters)
+#endif
+        {
+            counts[counter] += value;
+        }
     }
 }
 
@@ -29,13 +29,24 @@
 #include "core/plbTimer.h"
 #include "io/plbFiles.h"
 #include "libraryInterfaces/TINYXML_xmlIO.h"
+#include "parallelism/smpManager.h"
 #include <string>
-#include <set>
+#include <vector>
+#include <map>
 
 namespace plb {
 
 namespace global {
 
+/// Handles of the timers and counters of the profiler. They are resolved at
+///   compile time, and avoid any name lookup in the profiled code.
+namespace prof {
+    enum TimerT { collStream, cycle, dataProcessor, envelopeUpdate,
+                  mpiCommunication, io, totalTime, numTimers };
+    enum CounterT { collStreamCells, iterations, mpiSendChar, mpiReceiveChar,
+                    numCounters };
+}  // namespace prof
+
 /**
  * Counters:
  * =========
@@ -53,6 +64,15 @@ namespace global {
  * "mpiCommunication":               Total Time for MPI communication.
  * "io":                             Time spent for I/O operations.
  * "totalTime":                      Total time.
+*
+ * Inside a parallel region of the shared-memory threads, timers are only
+ * measured by the main thread, and counters are incremented by all threads.
+ * Each thread increments its own copy of the counters, and the copies are
+ * summed up when the counters are read.
+ *
+ * The timers and counters are identified by a handle (see namespace prof).
+ * The versions of the functions which take a name resolve it to the handle
+ * on each call, and are meant for code outside the inner loops.
 **/
 class Profiler {
 public:
@@ -67,43 +87,61 @@ public:
     bool doProfiling() const {
         return profilingFlag;
     }
-    void start(char const* timer) {
-        if (doProfiling()) {
-            verifyTimer(timer);
-            plbTimer(timer).start();
+    void start(prof::TimerT timer) {
+        if (doProfiling() && smp().isMainThread()) {
+            timers[timer].start();
         }
     }
-    void stop(char const* timer) {
-        if (doProfiling()) {
-            verifyTimer(timer);
-            plbTimer(timer).stop();
+    void stop(prof::TimerT timer) {
+        if (doProfiling() && smp().isMainThread()) {
+            timers[timer].stop();
         }
     }
-    void increment(char const* counter) {
+    void increment(prof::CounterT counter) {
+        increment(counter, 1);
+    }
+    void increment(prof::CounterT counter, plint value) {
         if (doProfiling()) {
-            verifyCounter(counter);
-            plbCounter(counter).increment();
+            if (smp().inParallelRegion()) {
+                incrementConcurrently(counter, value);
+            }
+            else {
+                counts[counter] += value;
+            }
         }
     }
+    plint getCounter(prof::CounterT counter) const;
+    double getTimer(prof::TimerT timer) const {
+        return timers[timer].getTime();
+    }
+    void start(char const* timer) {
+        start(timerHandle(timer));
+    }
+    void stop(char const* timer) {
+        stop(timerHandle(timer));
+    }
+    void increment(char const* counter) {
+        increment(counterHandle(counter), 1);
+    }
     void increment(char const* counter, plint value) {
-        if (doProfiling()) {
-            verifyCounter(counter);
-            plbCounter(counter).increment(value);
-        }
+        increment(counterHandle(counter), value);
     }
-    plint getCounter(char const* counter) {
-        verifyCounter(counter);
-        return plbCounter(counter).getCount();
+    plint getCounter(char const* counter) const {
+        return getCounter(counterHandle(counter));
     }
-    double getTimer(char const* timer) {
-        verifyTimer(timer);
-        return plbTimer(timer).getTime();
+    double getTimer(char const* timer) const {
+        return getTimer(timerHandle(timer));
     }
+    /// Resolve the name of a timer to its handle.
+    prof::TimerT timerHandle(std::string const& timer) const;
+    /// Resolve the name of a counter to its handle.
+    prof::CounterT counterHandle(std::string const& counter) const;
     void setReportFile(FileName const& reportFile_);
     void writeReport();
 private:
-    void verifyTimer(std::string const& timer);
-    void verifyCounter(std::string const& counter);
+    void incrementConcurrently(prof::CounterT counter, plint value);
+    /// Provide a copy of the counters to each thread of the parallel regions.
+    void allocateThreadCounters();
     void addStatisticalValue(XMLwriter& writer, std::string name, double value);
     void addMainProcValue(XMLwriter& writer, std::string name, plint value);
 
@@ -112,8 +150,13 @@ private:
     bool profilingFlag;
     bool manualCycleFlag;
     FileName reportFile;
-    std::set<std::string> validTimers;
-    std::set<std::string> validCounters;
+    PlbTimer timers[prof::numTimers];
+    /// Counters of all threads, in a flat array. The copies are padded to
+    ///   separate cache lines, to avoid false sharing.
+    std::vector<plint> counts;
+    plint numThreadCounters;
+    std::map<std::string, prof::TimerT> timerNames;
+    std::map<std::string, prof::CounterT> counterNames;
 friend Profiler& profiler();
 };
 
@@ -0,0 +1,269 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+ * Compression of binary data blocks -- implementation.
+ */
+
+#include "io/dataCompression.h"
+#include "core/runTimeDiagnostics.h"
+#include <algorithm>
+#include <cstring>
+
+#ifdef PLB_USE_ZLIB
+#include <zlib.h>
+#endif
+
+namespace plb {
+
+namespace {
+
+// Parameters of the LZ4 block format: matches are at least 4 bytes long,
+//   the last 5 bytes are always literals, and the last match starts at
+//   least 12 bytes before the end of the block.
+const plint lz4MinMatch = 4;
+const plint lz4LastLiterals = 5;
+const plint lz4MatchFindLimit = 12;
+const plint lz4MaxOffset = 65535;
+const int lz4HashLog = 16;
+
+inline unsigned int read32(char const* data) {
+    unsigned int value;
+    memcpy((void*)&value, (void const*)data, sizeof(value));
+    return value;
+}
+
+inline unsigned int lz4Hash(unsigned int sequence) {
+    return (sequence*2654435761U) >> (32-lz4HashLog);
+}
+
+/// Write a length which exceeds the 4 bits of the token.
+void writeLz4Length(plint length, std::vector<char>& compressed) {
+    for (; length>=255; length-=255) {
+        compressed.push_back((char)255);
+    }
+    compressed.push_back((char)length);
+}
+
+void writeLz4Sequence( char const* literals, plint numLiterals, plint offset, plint matchLength,
+                       std::vector<char>& compressed )
+{
+    plint tokenMatch = matchLength-lz4MinMatch;
+    unsigned char token = (unsigned char) ( (std::min(numLiterals,(plint)15)<<4) |
+                                            std::min(tokenMatch,(plint)15) );
+    compressed.push_back((char)token);
+    if (numLiterals>=15) {
+        writeLz4Length(numLiterals-15, compressed);
+    }
+    compressed.insert(compressed.end(), literals, literals+numLiterals);
+    compressed.push_back((char)(offset & 0xff));
+    compressed.push_back((char)(offset >> 8));
+    if (tokenMatch>=15) {
+        writeLz4Length(tokenMatch-15, compressed);
+    }
+}
+
+void writeLz4LastLiterals(char const* literals, plint numLiterals, std::vector<char>& compressed)
+{
+    unsigned char token = (unsigned char) (std::min(numLiterals,(plint)15)<<4);
+    compressed.push_back((char)token);
+    if (numLiterals>=15) {
+        writeLz4Length(numLiterals-15, compressed);
+    }
+    compressed.insert(compressed.end(), literals, literals+numLiterals);
+}
+
+}  // namespace
+
+void compressLZ4(char const* data, plint size, std::vector<char>& compressed)
+{
+    compressed.clear();
+    compressed.reserve(size + size/255 + 16);
+    plint anchor = 0;
+    if (size > lz4MatchFindLimit) {
+        std::vector<plint> table(1<<lz4HashLog, -1);
+        plint matchLimit = size-lz4LastLiterals;
+        plint pos = 0;
+        while (pos < size-lz4MatchFindLimit) {
+            unsigned int sequence = read32(data+pos);
+            unsigned int hash = lz4Hash(sequence);
+            plint candidate = table[hash];
+            table[hash] = pos;
+            if ( candidate<0 || pos-candidate>lz4MaxOffset ||
+                 read32(data+candidate)!=sequence )
+            {
+                ++pos;
+                continue;
+            }
+            plint length = lz4MinMatch;
+            while (pos+length<matchLimit && data[candidate+length]==data[pos+length]) {
+                ++length;
+            }
+            // Matches also extend backwards, over the pending literals.
+            while (pos>anchor && candidate>0 && data[pos-1]==data[candidate-1]) {
+                --pos;
+                --candidate;
+                ++length;
+            }
+            writeLz4Sequence(data+anchor, pos-anchor, pos-candidate, length, compressed);
+            pos += length;
+            anchor = pos;
+        }
+    }
+    writeLz4LastLiterals(data+anchor, size-anchor, compressed);
+}
+
+bool zlibIsAvailable() {
+#ifdef PLB_USE_ZLIB
+    return true;
+#else
+    return false;
+#endif
+}
+
+void compressZlib(char const* data, plint size, std::vector<char>& compressed)
+{
+#ifdef PLB_USE_ZLIB
+    uLongf compressedSize = compressBound((uLong)size);
+    compressed.resize(compressedSize);
+    int err = compress2( (Bytef*)&compressed[0], &compressedSize,
+                         (Bytef const*)data, (uLong)size, Z_BEST_SPEED );
+    if (err!=Z_OK) {
+        plbLogicError("zlib compression failed.");
+    }
+    compressed.resize(compressedSize);
+#else
+    plbLogicError("zlib compression requires compilation with PLB_USE_ZLIB.");
+#endif
+}
+
+/** With zlib, the segment is flushed with Z_SYNC_FLUSH, which ends it with an
+ *  empty stored block on a byte boundary.
+ */
+void deflateSegment(char const* data, plint size, std::vector<char>& compressed)
+{
+#ifdef PLB_USE_ZLIB
+    z_stream stream;
+    std::memset(&stream, 0, sizeof(stream));
+    // Negative window bits: raw deflate, without zlib header and checksum.
+    int err = deflateInit2(&stream, Z_BEST_SPEED, Z_DEFLATED, -15, 8, Z_DEFAULT_STRATEGY);
+    if (err!=Z_OK) {
+        plbLogicError("zlib compression failed.");
+    }
+    compressed.resize(deflateBound(&stream, (uLong)size)+16);
+    stream.next_in = (Bytef*)data;
+    stream.avail_in = (uInt)size;
+    stream.next_out = (Bytef*)&compressed[0];
+    stream.avail_out = (uInt)compressed.size();
+    err = deflate(&stream, Z_SYNC_FLUSH);
+    compressed.resize(compressed.size()-stream.avail_out);
+    deflateEnd(&stream);
+    if (err!=Z_OK || stream.avail_in!=0) {
+        plbLogicError("zlib compression failed.");
+    }
+#else
+    // Stored blocks: a header byte (not final, type 0), the length and its
+    //   one's complement, and at most 65535 bytes of data.
+    const plint maxStoredSize = 65535;
+    compressed.clear();
+    compressed.reserve(size + (size/maxStoredSize+1)*5);
+    for (plint pos=0; pos<size; pos+=maxStoredSize) {
+        plint blockSize = std::min(maxStoredSize, size-pos);
+        compressed.push_back(0);
+        compressed.push_back((char)(blockSize & 0xff));
+        compressed.push_back((char)(blockSize >> 8));
+        compressed.push_back((char)(~blockSize & 0xff));
+        compressed.push_back((char)((~blockSize >> 8) & 0xff));
+        compressed.insert(compressed.end(), data+pos, data+pos+blockSize);
+    }
+#endif
+}
+
+void closeDeflateStream(std::vector<char>& compressed)
+{
+    // Final stored block of length zero.
+    const char finalBlock[5] = { 1, 0, 0, (char)0xff, (char)0xff };
+    compressed.insert(compressed.end(), finalBlock, finalBlock+5);
+}
+
+namespace {
+
+const unsigned int adlerBase = 65521;
+
+}  // namespace
+
+unsigned int computeAdler32(char const* data, plint size)
+{
+    unsigned int a = 1, b = 0;
+    // 5552 is the largest number of bytes for which b cannot overflow
+    //   before the modulo is taken.
+    for (plint pos=0; pos<size; ) {
+        plint end = std::min(size, pos+5552);
+        for (; pos<end; ++pos) {
+            a += (unsigned char)data[pos];
+            b += a;
+        }
+        a %= adlerBase;
+        b %= adlerBase;
+    }
+    return (b << 16) | a;
+}
+
+/// Same algorithm as adler32_combine() in zlib.
+unsigned int combineAdler32(unsigned int adler1, unsigned int adler2, plint size2)
+{
+    unsigned int rem = (unsigned int)(size2 % adlerBase);
+    unsigned int sum1 = adler1 & 0xffff;
+    unsigned int sum2 = (unsigned int)(((unsigned long long)rem * sum1) % adlerBase);
+    sum1 += (adler2 & 0xffff) + adlerBase - 1;
+    sum2 += ((adler1 >> 16) & 0xffff) + ((adler2 >> 16) & 0xffff) + adlerBase - rem;
+    if (sum1 >= adlerBase) sum1 -= adlerBase;
+    if (sum1 >= adlerBase) sum1 -= adlerBase;
+    if (sum2 >= (adlerBase << 1)) sum2 -= (adlerBase << 1);
+    if (sum2 >= adlerBase) sum2 -= adlerBase;
+    return sum1 | (sum2 << 16);
+}
+
+unsigned int computeCrc32(char const* data, plint size, unsigned int crc)
+{
+    static unsigned int table[256];
+    static bool tableIsComputed = false;
+    if (!tableIsComputed) {
+        for (unsigned int n=0; n<256; ++n) {
+            unsigned int c = n;
+            for (int k=0; k<8; ++k) {
+                c = (c & 1) ? 0xedb88320U ^ (c >> 1) : c >> 1;
+            }
+            table[n] = c;
+        }
+        tableIsComputed = true;
+    }
+    crc = ~crc;
+    for (plint pos=0; pos<size; ++pos) {
+        crc = table[(crc ^ (unsigned char)data[pos]) & 0xff] ^ (crc >> 8);
+    }
+    return ~crc;
+}
+
+}  // namespace plb
@@ -0,0 +1,74 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+ * Compression of binary data blocks -- header file.
+ */
+
+#ifndef DATA_COMPRESSION_H
+#define DATA_COMPRESSION_H
+
+#include "core/globalDefs.h"
+#include <vector>
+
+namespace plb {
+
+/// Compress a buffer into the LZ4 block format (raw block, without frame).
+/** The compressor is a plain greedy one with a single hash table: it favors
+ *  speed over compression ratio, and needs no external library.
+ */
+void compressLZ4(char const* data, plint size, std::vector<char>& compressed);
+
+/// Tells whether the library was compiled with zlib support (PLB_USE_ZLIB).
+bool zlibIsAvailable();
+
+/// Compress a buffer into the zlib format, at the fastest compression level.
+/** An exception is thrown if the library was compiled without PLB_USE_ZLIB. **/
+void compressZlib(char const* data, plint size, std::vector<char>& compressed);
+
+/// Compress a buffer into a segment of a raw deflate stream.
+/** The segment ends on a byte boundary and contains no final block, so that
+ *  the segments of several buffers can be concatenated, and the stream closed
+ *  with closeDeflateStream(). Without PLB_USE_ZLIB, the data is stored in
+ *  uncompressed deflate blocks.
+ */
+void deflateSegment(char const* data, plint size, std::vector<char>& compressed);
+
+/// Append an empty final block, which closes a sequence of deflate segments.
+void closeDeflateStream(std::vector<char>& compressed);
+
+/// Adler-32 checksum of a buffer, as used in the zlib format.
+unsigned int computeAdler32(char const* data, plint size);
+
+/// Adler-32 checksum of the concatenation of two buffers, from their individual
+///   checksums and the size of the second one.
+unsigned int combineAdler32(unsigned int adler1, unsigned int adler2, plint size2);
+
+/// CRC-32 checksum of a buffer, as used in the PNG format. The checksum of a
+///   previous buffer can be provided, to compute the one of a concatenation.
+unsigned int computeCrc32(char const* data, plint size, unsigned int crc=0);
+
+}  // namespace plb
+
+#endif  // DATA_COMPRESSION_H
@@ -27,8 +27,10 @@
  */
 
 #include "io/base64.h"
+#include "io/dataCompression.h"
 #include "io/serializerIO.h"
 #include "io/serializerIO_3D.h"
+#include "io/rawVoxelIO_3D.h"
 #include "io/vtkDataOutput.h"
 #include "io/sparseVtkDataOutput.h"
 #include "io/vtkStructuredDataOutput.h"
@@ -41,4 +43,5 @@
 #include "io/multiBlockWriter3D.h"
 #include "io/utilIO_3D.h"
 #include "io/transientStatistics3D.h"
+#include "io/inSituOutput3D.h"
 
@@ -29,8 +29,10 @@
 #include "io/base64.hh"
 #include "io/serializerIO.hh"
 #include "io/serializerIO_3D.hh"
+#include "io/rawVoxelIO_3D.hh"
 #include "io/vtkDataOutput.hh"
 #include "io/vtkStructuredDataOutput.hh"
 #include "io/imageWriter.hh"
 #include "io/transientStatistics3D.hh"
+#include "io/inSituOutput3D.hh"
 
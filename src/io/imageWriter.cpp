@@ -0,0 +1,236 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+ * Parallel PNG output -- implementation.
+ */
+
+#include "io/imageWriter.h"
+#include "core/plbDebug.h"
+#include "io/dataCompression.h"
+#include "io/mpiParallelIO.h"
+#include "parallelism/mpiManager.h"
+#include <algorithm>
+#include <cstring>
+#include <deque>
+
+namespace plb {
+
+namespace {
+
+/// The image rows are distributed in contiguous bands, one per process.
+plint getBandBegin(plint band, plint numRows, plint numBands) {
+    return band*numRows/numBands;
+}
+
+/// Band which contains the given image row.
+plint getBand(plint row, plint numRows, plint numBands) {
+    return ((row+1)*numBands + numRows-1) / numRows - 1;
+}
+
+void appendBigEndian32(std::vector<char>& data, unsigned int value) {
+    data.push_back((char)((value >> 24) & 0xff));
+    data.push_back((char)((value >> 16) & 0xff));
+    data.push_back((char)((value >> 8) & 0xff));
+    data.push_back((char)(value & 0xff));
+}
+
+/// Append a PNG chunk: length, type, content and CRC of type and content.
+void appendPngChunk(std::vector<char>& data, char const* type, char const* content, plint size) {
+    appendBigEndian32(data, (unsigned int)size);
+    plint typePos = (plint) data.size();
+    data.insert(data.end(), type, type+4);
+    data.insert(data.end(), content, content+size);
+    appendBigEndian32(data, computeCrc32(&data[typePos], 4+size));
+}
+
+}  // namespace
+
+/** The tiles do not overlap, so that compositing them amounts to sending each
+ *  part of a tile to the process which owns the corresponding image rows. The
+ *  rows of the image (top row first, each starting with a filter byte) are
+ *  then compressed by each process into an independent deflate segment, which
+ *  is written as an IDAT chunk. The main process writes the PNG header, the
+ *  zlib header, and the end of the zlib stream, whose Adler-32 checksum is
+ *  combined from the checksums of all bands.
+ */
+void writeParallelPng( std::string const& fName, plint nx, plint ny,
+                       std::vector<Box2D> const& tiles, std::vector<int> const& owners,
+                       std::map<plint, std::vector<unsigned char> > const& localPixels )
+{
+    PLB_PRECONDITION( tiles.size() == owners.size() );
+    plint numBands = global::mpi().getSize();
+    plint myBand = global::mpi().getRank();
+    plint rowSize = 1+3*nx;
+    plint bandBegin = getBandBegin(myBand, ny, numBands);
+    plint bandEnd = getBandBegin(myBand+1, ny, numBands);
+    std::vector<char> band((bandEnd-bandBegin)*rowSize, 0);
+
+    // Send the rows of the local tiles to the processes which own them, and
+    //   copy the rows of the own band. The image row r is the line y=ny-1-r.
+#ifdef PLB_MPI_PARALLEL
+    // A deque, because the buffers must not move while they are being sent.
+    std::deque<std::vector<char> > sendBuffers;
+    std::vector<MPI_Request> requests;
+    std::vector<char> receiveBuffer;
+#endif
+    for (pluint iTile=0; iTile<tiles.size(); ++iTile) {
+        Box2D const& tile = tiles[iTile];
+        plint firstRow = ny-1-tile.y1;
+        plint lastRow = ny-1-tile.y0;
+        plint tileRowSize = 3*tile.getNx();
+        std::vector<unsigned char> const* pixels = 0;
+        if (owners[iTile]==global::mpi().getRank()) {
+            pixels = &localPixels.find(iTile)->second;
+        }
+        plint firstBand = getBand(firstRow, ny, numBands);
+        plint lastBand = getBand(lastRow, ny, numBands);
+        for (plint iBand=firstBand; iBand<=lastBand; ++iBand) {
+            plint row0 = std::max(firstRow, getBandBegin(iBand, ny, numBands));
+            plint row1 = std::min(lastRow, getBandBegin(iBand+1, ny, numBands)-1);
+            if (row1<row0) {
+                continue;
+            }
+            if (pixels && iBand==myBand) {
+                for (plint row=row0; row<=row1; ++row) {
+                    plint tileRow = ny-1-row-tile.y0;
+                    std::memcpy( &band[(row-bandBegin)*rowSize + 1 + 3*tile.x0],
+                                 &(*pixels)[tileRow*tileRowSize], tileRowSize );
+                }
+            }
+#ifdef PLB_MPI_PARALLEL
+            else if (pixels) {
+                sendBuffers.push_back(std::vector<char>((row1-row0+1)*tileRowSize));
+                std::vector<char>& buffer = sendBuffers.back();
+                for (plint row=row0; row<=row1; ++row) {
+                    plint tileRow = ny-1-row-tile.y0;
+                    std::memcpy( &buffer[(row-row0)*tileRowSize],
+                                 &(*pixels)[tileRow*tileRowSize], tileRowSize );
+                }
+                requests.push_back(MPI_Request());
+                global::mpi().iSend(&buffer[0], (int)buffer.size(), (int)iBand, &requests.back());
+            }
+#endif
+        }
+    }
+#ifdef PLB_MPI_PARALLEL
+    // Messages between two processes arrive in the order in which they are
+    //   sent, which is the order of the tiles.
+    for (pluint iTile=0; iTile<tiles.size(); ++iTile) {
+        if (owners[iTile]==global::mpi().getRank()) {
+            continue;
+        }
+        Box2D const& tile = tiles[iTile];
+        plint row0 = std::max(ny-1-tile.y1, bandBegin);
+        plint row1 = std::min(ny-1-tile.y0, bandEnd-1);
+        if (row1<row0) {
+            continue;
+        }
+        plint tileRowSize = 3*tile.getNx();
+        receiveBuffer.resize((row1-row0+1)*tileRowSize);
+        global::mpi().receive(&receiveBuffer[0], (int)receiveBuffer.size(), owners[iTile]);
+        for (plint row=row0; row<=row1; ++row) {
+            std::memcpy( &band[(row-bandBegin)*rowSize + 1 + 3*tile.x0],
+                         &receiveBuffer[(row-row0)*tileRowSize], tileRowSize );
+        }
+    }
+    for (pluint iRequest=0; iRequest<requests.size(); ++iRequest) {
+        MPI_Status status;
+        global::mpi().wait(&requests[iRequest], &status);
+    }
+#endif
+
+    std::vector<char> segment;
+    if (!band.empty()) {
+        deflateSegment(&band[0], (plint)band.size(), segment);
+    }
+    std::vector<long long> segmentSizes(numBands, 0), adlers(numBands, 0), bandSizes(numBands, 0);
+    segmentSizes[myBand] = (long long) segment.size();
+    adlers[myBand] = band.empty() ? 1 : computeAdler32(&band[0], (plint)band.size());
+    bandSizes[myBand] = (long long) band.size();
+#ifdef PLB_MPI_PARALLEL
+    global::mpi().allReduceVect(segmentSizes, MPI_SUM);
+    global::mpi().allReduceVect(adlers, MPI_SUM);
+    global::mpi().allReduceVect(bandSizes, MPI_SUM);
+#endif
+
+    // File layout: signature, IHDR chunk, IDAT chunk with the zlib header,
+    //   one IDAT chunk per non-empty band, closing IDAT chunk, IEND chunk.
+    std::vector<char> header, chunk, trailer;
+    const char signature[8] = { (char)0x89, 'P', 'N', 'G', '\r', '\n', 0x1a, '\n' };
+    header.insert(header.end(), signature, signature+8);
+    std::vector<char> ihdr;
+    appendBigEndian32(ihdr, (unsigned int)nx);
+    appendBigEndian32(ihdr, (unsigned int)ny);
+    const char ihdrFormat[5] = { 8, 2, 0, 0, 0 };  // 8-bit RGB, no interlacing.
+    ihdr.insert(ihdr.end(), ihdrFormat, ihdrFormat+5);
+    appendPngChunk(header, "IHDR", &ihdr[0], (plint)ihdr.size());
+    const char zlibHeader[2] = { 0x78, 0x01 };
+    appendPngChunk(header, "IDAT", zlibHeader, 2);
+
+    plint offset = (plint) header.size();
+    plint myOffset = 0;
+    for (plint iBand=0; iBand<numBands; ++iBand) {
+        if (iBand==myBand) {
+            myOffset = offset;
+        }
+        if (segmentSizes[iBand]>0) {
+            offset += 12+segmentSizes[iBand];
+        }
+    }
+    plint trailerOffset = offset;
+
+    std::vector<plint> offsets, sizes;
+    std::vector<char> data;
+    if (global::mpi().isMainProcessor()) {
+        offsets.push_back(0);
+        sizes.push_back((plint)header.size());
+        data.insert(data.end(), header.begin(), header.end());
+    }
+    if (!segment.empty()) {
+        appendPngChunk(chunk, "IDAT", &segment[0], (plint)segment.size());
+        offsets.push_back(myOffset);
+        sizes.push_back((plint)chunk.size());
+        data.insert(data.end(), chunk.begin(), chunk.end());
+    }
+    if (global::mpi().isMainProcessor()) {
+        unsigned int adler = 1;
+        for (plint iBand=0; iBand<numBands; ++iBand) {
+            adler = combineAdler32(adler, (unsigned int)adlers[iBand], bandSizes[iBand]);
+        }
+        std::vector<char> streamEnd;
+        closeDeflateStream(streamEnd);
+        appendBigEndian32(streamEnd, adler);
+        appendPngChunk(trailer, "IDAT", &streamEnd[0], (plint)streamEnd.size());
+        appendPngChunk(trailer, "IEND", 0, 0);
+        offsets.push_back(trailerOffset);
+        sizes.push_back((plint)trailer.size());
+        data.insert(data.end(), trailer.begin(), trailer.end());
+    }
+    parallelIO::RawDataWriter writer(fName, true);
+    writer.write(offsets, sizes, data);
+}
+
+}  // namespace plb
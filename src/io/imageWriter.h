@@ -33,6 +33,7 @@
 #include "io/colormaps.h"
 #include <sstream>
 #include <iomanip>
+#include <map>
 #include <vector>
 
 namespace plb {
@@ -113,7 +114,26 @@ public:
                         MultiScalarField3D<T>& field,
                         plint sizeX, plint sizeY) const;
 
+    /// Write a PNG image, without gathering the field on the main process.
+    /** The colors are computed by the processes which own the data. The
+     *  colored tiles are then redistributed into bands of image rows, one per
+     *  process, and each process encodes and writes its own band. The file is
+     *  written with a single collective call.
+     */
+    void writePng(std::string const& fName,
+                  MultiScalarField2D<T>& field,
+                  T minVal, T maxVal) const;
+    void writeScaledPng(std::string const& fName,
+                        MultiScalarField2D<T>& field) const;
+    /// Write a PNG image of a slice, which must be one cell thick.
+    void writePng(std::string const& fName,
+                  MultiScalarField3D<T>& field,
+                  T minVal, T maxVal) const;
+    void writeScaledPng(std::string const& fName,
+                        MultiScalarField3D<T>& field) const;
+
 private:
+    rgb getColor(T value, T minVal, T maxVal) const;
     void writePpmImplementation (
         std::string const& fName,
         ScalarField2D<T>& localField, T minVal, T maxVal) const;
@@ -128,6 +148,15 @@ private:
 
 ////////// Standalone functions ////////////////////////////////////////
 
+/// Write an RGB image, given as tiles distributed over the processes, into a
+///   PNG file. tiles are the domains of all tiles in the image (with y pointing
+///   upwards), and owners the processes which hold them. localPixels contains
+///   the RGB pixels of the local tiles, indexed as tiles, row by row with
+///   increasing y. Pixels which belong to no tile are black.
+void writeParallelPng( std::string const& fName, plint nx, plint ny,
+                       std::vector<Box2D> const& tiles, std::vector<int> const& owners,
+                       std::map<plint, std::vector<unsigned char> > const& localPixels );
+
 inline std::string createFileName(std::string name, plint number, plint width) {
     std::stringstream fNameStream;
     fNameStream << name << std::setfill('0') << std::setw(width) << number;
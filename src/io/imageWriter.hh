@@ -35,6 +35,7 @@
 #include "atomicBlock/dataField3D.h"
 #include "core/runTimeDiagnostics.h"
 #include "dataProcessors/dataAnalysisWrapper2D.h"
+#include "dataProcessors/dataAnalysisWrapper3D.h"
 #include <fstream>
 #include <cstdlib>
 #include <cmath>
@@ -124,11 +125,11 @@ void ImageWriter<T>::writePpm (
         MultiScalarField2D<T>& field,
         T minVal, T maxVal) const
 {
-    global::profiler().start("io");
+    global::profiler().start(global::prof::io);
     ScalarField2D<T> localField(field.getNx(), field.getNy());
     copySerializedBlock(field, localField);
     writePpmImplementation(fName, localField, minVal, maxVal);
-    global::profiler().stop("io");
+    global::profiler().stop(global::prof::io);
 }
 
 template<typename T>
@@ -317,6 +318,152 @@ void ImageWriter<T>::writeScaledPpm(std::string const& fName,
     writePpm(fName, field, T(), T());
 }
 
+template<typename T>
+void ImageWriter<T>::writePng (
+        std::string const& fName,
+        MultiScalarField2D<T>& field,
+        T minVal, T maxVal) const
+{
+    global::profiler().start(global::prof::io);
+    if (util::fpequal(minVal,maxVal)) {
+        minVal = computeMin(field);
+        maxVal = computeMax(field);
+    }
+    MultiBlockManagement2D const& management = field.getMultiBlockManagement();
+    std::map<plint,Box2D> const& bulks = management.getSparseBlockStructure().getBulks();
+    Box2D bbox = field.getBoundingBox();
+    std::vector<Box2D> tiles;
+    std::vector<int> owners;
+    std::map<plint, std::vector<unsigned char> > localPixels;
+    for (std::map<plint,Box2D>::const_iterator it = bulks.begin(); it != bulks.end(); ++it) {
+        Box2D domain;
+        if (!intersect(it->second, bbox, domain)) {
+            continue;
+        }
+        plint iTile = (plint) tiles.size();
+        tiles.push_back(domain.shift(-bbox.x0, -bbox.y0));
+        owners.push_back(management.getThreadAttribution().getMpiProcess(it->first));
+        if (management.getThreadAttribution().isLocal(it->first)) {
+            ScalarField2D<T> const& component = field.getComponent(it->first);
+            Dot2D location = component.getLocation();
+            std::vector<unsigned char>& pixels = localPixels[iTile];
+            pixels.resize(3*domain.nCells());
+            plint pos = 0;
+            for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
+                for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
+                    rgb color = getColor(component.get(iX-location.x, iY-location.y), minVal, maxVal);
+                    pixels[pos++] = (unsigned char) (color.r*255.);
+                    pixels[pos++] = (unsigned char) (color.g*255.);
+                    pixels[pos++] = (unsigned char) (color.b*255.);
+                }
+            }
+        }
+    }
+    writeParallelPng( global::directories().getImageOutDir() + fName+".png",
+                      bbox.getNx(), bbox.getNy(), tiles, owners, localPixels );
+    global::profiler().stop(global::prof::io);
+}
+
+template<typename T>
+void ImageWriter<T>::writeScaledPng(std::string const& fName,
+                                    MultiScalarField2D<T>& field) const
+{
+    writePng(fName, field, T(), T());
+}
+
+/** The image axes are the two axes of the slice which are more than one cell
+ *  wide, in the same order as in writePpm().
+ */
+template<typename T>
+void ImageWriter<T>::writePng (
+        std::string const& fName,
+        MultiScalarField3D<T>& field,
+        T minVal, T maxVal) const
+{
+    if (field.getMultiBlockManagement().isPartial()) {
+        plbLogicError("An image cannot be written from a partial multi-block management.");
+    }
+    Box3D bbox = field.getBoundingBox();
+    int axis0 = 0, axis1 = 1;
+    if (field.getNx()==1) {
+        axis0 = 1;
+        axis1 = 2;
+    }
+    else if (field.getNy()==1) {
+        axis1 = 2;
+    }
+    else if (field.getNz()!=1) {
+        return;
+    }
+    global::profiler().start(global::prof::io);
+    if (util::fpequal(minVal,maxVal)) {
+        minVal = computeMin(field);
+        maxVal = computeMax(field);
+    }
+    MultiBlockManagement3D const& management = field.getMultiBlockManagement();
+    std::map<plint,Box3D> const& bulks = management.getSparseBlockStructure().getBulks();
+    Array<plint,6> bboxArray = bbox.to_plbArray();
+    std::vector<Box2D> tiles;
+    std::vector<int> owners;
+    std::map<plint, std::vector<unsigned char> > localPixels;
+    for (std::map<plint,Box3D>::const_iterator it = bulks.begin(); it != bulks.end(); ++it) {
+        Box3D domain;
+        if (!intersect(it->second, bbox, domain)) {
+            continue;
+        }
+        Array<plint,6> domainArray = domain.to_plbArray();
+        plint iTile = (plint) tiles.size();
+        tiles.push_back(Box2D( domainArray[2*axis0]-bboxArray[2*axis0], domainArray[2*axis0+1]-bboxArray[2*axis0],
+                               domainArray[2*axis1]-bboxArray[2*axis1], domainArray[2*axis1+1]-bboxArray[2*axis1] ));
+        owners.push_back(management.getThreadAttribution().getMpiProcess(it->first));
+        if (management.getThreadAttribution().isLocal(it->first)) {
+            ScalarField3D<T> const& component = field.getComponent(it->first);
+            Dot3D location = component.getLocation();
+            std::vector<unsigned char>& pixels = localPixels[iTile];
+            pixels.resize(3*domain.nCells());
+            plint pos = 0;
+            // Loop in the order of the pixels: the second image axis is the slowest.
+            Array<plint,3> cell;
+            int axis2 = 3-axis0-axis1;
+            cell[axis2] = domainArray[2*axis2];
+            for (cell[axis1]=domainArray[2*axis1]; cell[axis1]<=domainArray[2*axis1+1]; ++cell[axis1]) {
+                for (cell[axis0]=domainArray[2*axis0]; cell[axis0]<=domainArray[2*axis0+1]; ++cell[axis0]) {
+                    rgb color = getColor( component.get(cell[0]-location.x, cell[1]-location.y,
+                                                        cell[2]-location.z), minVal, maxVal );
+                    pixels[pos++] = (unsigned char) (color.r*255.);
+                    pixels[pos++] = (unsigned char) (color.g*255.);
+                    pixels[pos++] = (unsigned char) (color.b*255.);
+                }
+            }
+        }
+    }
+    writeParallelPng( global::directories().getImageOutDir() + fName+".png",
+                      bboxArray[2*axis0+1]-bboxArray[2*axis0]+1,
+                      bboxArray[2*axis1+1]-bboxArray[2*axis1]+1, tiles, owners, localPixels );
+    global::profiler().stop(global::prof::io);
+}
+
+template<typename T>
+void ImageWriter<T>::writeScaledPng(std::string const& fName,
+                                    MultiScalarField3D<T>& field) const
+{
+    writePng(fName, field, T(), T());
+}
+
+template<typename T>
+rgb ImageWriter<T>::getColor(T value, T minVal, T maxVal) const
+{
+    double outputValue = 0.;
+    if (! (minVal==maxVal) ) {
+        outputValue = ( (double) (value-minVal) /
+                        (double) (maxVal-minVal) *
+                        (double) (numColors-1) / (double) numColors );
+    }
+    if (outputValue <   0.) outputValue = 0.;
+    if (outputValue >=  1.) outputValue = (double) (numColors-1) / (double) numColors;
+    return colorMap.get(outputValue);
+}
+
 template<typename T>
 void ImageWriter<T>::writePpmImplementation (
         std::string const& fName,
@@ -336,15 +483,7 @@ void ImageWriter<T>::writePpmImplementation (
 
         for (plint iY=localField.getNy()-1; iY>=0; --iY) {
             for (plint iX=0; iX<localField.getNx(); ++iX) {
-                double outputValue = 0.;
-                if (! (minVal==maxVal) ) {
-                    outputValue = ( (double) (localField.get(iX,iY)-minVal) /
-                                    (double) (maxVal-minVal) *
-                                    (double) (numColors-1) / (double) numColors );
-                }
-                if (outputValue <   0.) outputValue = 0.;
-                if (outputValue >=  1.) outputValue = (double) (numColors-1) / (double) numColors;
-                rgb color = colorMap.get(outputValue);
+                rgb color = getColor(localField.get(iX,iY), minVal, maxVal);
                 fout << (int) (color.r*(colorRange-1)) << " "
                      << (int) (color.g*(colorRange-1)) << " "
                      << (int) (color.b*(colorRange-1)) << "\n";
@@ -378,7 +517,7 @@ template<typename T>
 void ImageWriter<T>::imageMagickResize( std::string const& fName,
                                         plint sizeX, plint sizeY) const
 {
-    global::profiler().start("io");
+    global::profiler().start(global::prof::io);
 #ifdef PLB_USE_POSIX
     if (global::mpi().isMainProcessor()) {
         std::stringstream imStream;
@@ -398,7 +537,7 @@ void ImageWriter<T>::imageMagickResize( std::string const& fName,
         if (errorRm != 0) plbWarning("Error in removing temporary ppm file.");
     }
 #endif  // PLB_USE_POSIX
-    global::profiler().stop("io");
+    global::profiler().stop(global::prof::io);
 }
 
 }  // namespace plb
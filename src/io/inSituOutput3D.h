@@ -0,0 +1,128 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+ * In-situ output of slices and probes -- header file.
+ */
+
+#ifndef IN_SITU_OUTPUT_3D_H
+#define IN_SITU_OUTPUT_3D_H
+
+#include "core/globalDefs.h"
+#include "core/geometry3D.h"
+#include "multiBlock/multiBlockLattice3D.h"
+#include "io/plbFiles.h"
+
+#include <string>
+#include <vector>
+
+namespace plb {
+
+/// Output of slices and probes, computed in-situ on the processes which own them.
+/** Slices (any box of cells: planes, lines or sub-volumes) and sets of probes
+ *  are registered once. At each output, the requested field is computed from
+ *  the populations of the bulk cells, on the processes which own them, and all
+ *  sets are appended to the output file as one record, with a single collective
+ *  write. No multi-block is allocated, and no data is gathered on the main
+ *  process.
+ *
+ *  A record starts with the iteration, as an 8-byte integer, followed by the
+ *  sets in the order of registration. The cells of a slice are stored in
+ *  x-major order (z is the fastest index), the probes in the order in which
+ *  they were given, and the components of a vector are stored cell by cell.
+ *  The layout of the records is described in an XML file, written together
+ *  with the first record.
+ *
+ *  Probes can be located anywhere in the lattice. Their value is interpolated
+ *  trilinearly from the eight surrounding cells, which are read from the bulk
+ *  and from the envelope of the block which contains the first of them (with
+ *  z as the fastest index) that has a non-zero weight and belongs to the
+ *  domain. Probes without any such cell, in holes of a sparse domain, are
+ *  reported when they are registered, and are not written.
+ */
+template<typename T, template<typename U> class Descriptor>
+class InSituOutput3D {
+public:
+    /// The records are written into fName, which defaults to the output
+    ///   directory and to the extension "dat". The XML file has the same
+    ///   name, with extension "xml".
+    InSituOutput3D(MultiBlockLattice3D<T,Descriptor>& lattice_, FileName fName_);
+    // Field must be one of:
+    //
+    // "density", "velocity", "velocityX", "velocityY", "velocityZ", "velocityNorm"
+    //
+    // All sets must be registered before the first output.
+    void addSlice(std::string name, Box3D domain, std::string field);
+    void addProbes(std::string name, std::vector<Dot3D> const& cells, std::string field);
+    /// Probes at arbitrary positions, in lattice units. Near the boundary of
+    ///   the lattice and of a sparse domain, only the cells inside the domain
+    ///   contribute to the interpolation.
+    void addProbes(std::string name, std::vector<Array<T,3> > const& positions, std::string field);
+    /// Compute all sets, and append them to the output file. This function
+    ///   is collective.
+    void write(plint iteration);
+    /// Number of records written so far.
+    plint getNumRecords() const;
+    /// Size of a record in bytes.
+    plint getRecordSize() const;
+private:
+    /// Sequence of cells along z, which is stored contiguously in the file.
+    struct Run {
+        plint offset;   // Position in the record, in bytes.
+        plint set, blockId;
+        plint probe;    // Index of the probe in its set; -1 for slices.
+        plint iX, iY, z0, z1;
+        bool operator<(Run const& rhs) const { return offset < rhs.offset; }
+    };
+    void addSet(std::string name, std::string field, Box3D domain, std::vector<Array<T,3> > const& positions);
+    int fieldToId(std::string field) const;
+    plint getNumComponents(int field) const;
+    void computeRuns(std::vector<Run>& runs) const;
+    /// Lower corner of the cells which surround a probe.
+    Dot3D probeCorner(Array<T,3> const& position) const;
+    /// Find the cell which determines the block that computes a probe. Returns
+    ///   false if the probe has no interpolation cell inside the domain.
+    bool locateProbe(Array<T,3> const& position, Dot3D& ownerCell) const;
+    void computeValues(Cell<T,Descriptor>& cell, int field, T* values) const;
+    void interpolateValues( BlockLattice3D<T,Descriptor>& component, Array<T,3> const& position,
+                            int field, T* values ) const;
+    void fillValues(int field, T rho, Array<T,3> const& u, T* values) const;
+    void writeLayout() const;
+private:
+    enum { density, velocity, velocityX, velocityY, velocityZ, velocityNorm };
+    MultiBlockLattice3D<T,Descriptor>& lattice;
+    FileName fName;
+    std::vector<std::string> names;
+    std::vector<int> fields;
+    std::vector<Box3D> domains;                     // Domain of each slice; empty for probes.
+    std::vector<std::vector<Array<T,3> > > probes;  // Positions of each set of probes.
+    std::vector<plint> setOffsets;                  // Position of each set in the record.
+    plint recordSize;
+    plint numRecords;
+};
+
+}  // namespace plb
+
+#endif  // IN_SITU_OUTPUT_3D_H
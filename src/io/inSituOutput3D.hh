@@ -0,0 +1,443 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+ * In-situ output of slices and probes -- generic implementation.
+ */
+
+#ifndef IN_SITU_OUTPUT_3D_HH
+#define IN_SITU_OUTPUT_3D_HH
+
+#include "io/inSituOutput3D.h"
+#include "io/mpiParallelIO.h"
+#include "io/parallelIO.h"
+#include "core/plbDebug.h"
+#include "core/plbProfiler.h"
+#include "core/plbTypenames.h"
+#include "core/runTimeDiagnostics.h"
+#include "core/util.h"
+#include "libraryInterfaces/TINYXML_xmlIO.h"
+#include "multiBlock/multiBlockManagement3D.h"
+#include "atomicBlock/blockLattice3D.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace plb {
+
+template<typename T, template<typename U> class Descriptor>
+InSituOutput3D<T,Descriptor>::InSituOutput3D (
+        MultiBlockLattice3D<T,Descriptor>& lattice_, FileName fName_ )
+    : lattice(lattice_),
+      fName(fName_.defaultPath(global::directories().getOutputDir()).defaultExt("dat")),
+      recordSize(sizeof(long long)),
+      numRecords(0)
+{ }
+
+template<typename T, template<typename U> class Descriptor>
+void InSituOutput3D<T,Descriptor>::addSlice(std::string name, Box3D domain, std::string field)
+{
+    PLB_PRECONDITION( contained(domain, lattice.getBoundingBox()) );
+    addSet(name, field, domain, std::vector<Array<T,3> >());
+}
+
+template<typename T, template<typename U> class Descriptor>
+void InSituOutput3D<T,Descriptor>::addProbes (
+        std::string name, std::vector<Dot3D> const& cells, std::string field )
+{
+    std::vector<Array<T,3> > positions(cells.size());
+    for (pluint iProbe=0; iProbe<cells.size(); ++iProbe) {
+        PLB_ASSERT( contained(cells[iProbe], lattice.getBoundingBox()) );
+        positions[iProbe] = Array<T,3>((T)cells[iProbe].x, (T)cells[iProbe].y, (T)cells[iProbe].z);
+    }
+    addSet(name, field, Box3D(0,-1,0,-1,0,-1), positions);
+}
+
+template<typename T, template<typename U> class Descriptor>
+void InSituOutput3D<T,Descriptor>::addProbes (
+        std::string name, std::vector<Array<T,3> > const& positions, std::string field )
+{
+#ifdef PLB_DEBUG
+    Box3D bbox = lattice.getBoundingBox();
+    for (pluint iProbe=0; iProbe<positions.size(); ++iProbe) {
+        Array<T,3> const& position = positions[iProbe];
+        PLB_ASSERT( position[0]>=(T)bbox.x0 && position[0]<=(T)bbox.x1 &&
+                    position[1]>=(T)bbox.y0 && position[1]<=(T)bbox.y1 &&
+                    position[2]>=(T)bbox.z0 && position[2]<=(T)bbox.z1 );
+    }
+#endif
+    addSet(name, field, Box3D(0,-1,0,-1,0,-1), positions);
+}
+
+template<typename T, template<typename U> class Descriptor>
+void InSituOutput3D<T,Descriptor>::addSet (
+        std::string name, std::string field, Box3D domain, std::vector<Array<T,3> > const& positions )
+{
+    PLB_PRECONDITION( numRecords==0 );
+    int iField = fieldToId(field);
+    plint numCells = positions.empty() ? domain.nCells() : (plint)positions.size();
+    plint numMissing = 0;
+    Dot3D ownerCell;
+    for (pluint iProbe=0; iProbe<positions.size(); ++iProbe) {
+        if (!locateProbe(positions[iProbe], ownerCell)) {
+            ++numMissing;
+        }
+    }
+    if (numMissing>0) {
+        pcout << "Warning: in InSituOutput3D, " << numMissing << " probes of the set \""
+              << name << "\" lie outside the sparse domain, and are not written." << std::endl;
+    }
+    names.push_back(name);
+    fields.push_back(iField);
+    domains.push_back(domain);
+    probes.push_back(positions);
+    setOffsets.push_back(recordSize);
+    recordSize += numCells*getNumComponents(iField)*(plint)sizeof(T);
+}
+
+template<typename T, template<typename U> class Descriptor>
+plint InSituOutput3D<T,Descriptor>::getNumRecords() const {
+    return numRecords;
+}
+
+template<typename T, template<typename U> class Descriptor>
+plint InSituOutput3D<T,Descriptor>::getRecordSize() const {
+    return recordSize;
+}
+
+template<typename T, template<typename U> class Descriptor>
+int InSituOutput3D<T,Descriptor>::fieldToId(std::string field) const
+{
+    if (field == "density") {
+        return density;
+    } else if (field == "velocity") {
+        return velocity;
+    } else if (field == "velocityX") {
+        return velocityX;
+    } else if (field == "velocityY") {
+        return velocityY;
+    } else if (field == "velocityZ") {
+        return velocityZ;
+    } else if (field == "velocityNorm") {
+        return velocityNorm;
+    }
+    plbLogicError("In-situ output: unknown field \"" + field + "\".");
+    return -1;
+}
+
+template<typename T, template<typename U> class Descriptor>
+plint InSituOutput3D<T,Descriptor>::getNumComponents(int field) const {
+    return field==velocity ? 3 : 1;
+}
+
+template<typename T, template<typename U> class Descriptor>
+Dot3D InSituOutput3D<T,Descriptor>::probeCorner(Array<T,3> const& position) const {
+    return Dot3D( (plint)std::floor(position[0]),
+                  (plint)std::floor(position[1]),
+                  (plint)std::floor(position[2]) );
+}
+
+/** The interpolation cells are visited in the same order as in
+ *  interpolateValues(). The other cells are at a distance of at most one
+ *  cell from the selected one, and thus in the bulk or in the envelope of
+ *  the block which contains it.
+ */
+template<typename T, template<typename U> class Descriptor>
+bool InSituOutput3D<T,Descriptor>::locateProbe (
+        Array<T,3> const& position, Dot3D& ownerCell ) const
+{
+    SparseBlockStructure3D const& sparseBlock =
+        lattice.getMultiBlockManagement().getSparseBlockStructure();
+    Dot3D corner = probeCorner(position);
+    for (plint dx=0; dx<=1; ++dx) {
+        for (plint dy=0; dy<=1; ++dy) {
+            for (plint dz=0; dz<=1; ++dz) {
+                bool hasWeight = (dx==0 || position[0]!=(T)corner.x) &&
+                                 (dy==0 || position[1]!=(T)corner.y) &&
+                                 (dz==0 || position[2]!=(T)corner.z);
+                Dot3D cell(corner.x+dx, corner.y+dy, corner.z+dz);
+                if (hasWeight && sparseBlock.locate(cell.x, cell.y, cell.z)>=0) {
+                    ownerCell = cell;
+                    return true;
+                }
+            }
+        }
+    }
+    return false;
+}
+
+/** The runs are the z-lines of the slices which intersect the bulk of the
+ *  local blocks, and the probes whose owner cell (see locateProbe()) is located
+ *  in the bulk of the local blocks. They are recomputed at each output, so that
+ *  they follow changes of the data distribution of the lattice.
+ */
+template<typename T, template<typename U> class Descriptor>
+void InSituOutput3D<T,Descriptor>::computeRuns(std::vector<Run>& runs) const
+{
+    MultiBlockManagement3D const& management = lattice.getMultiBlockManagement();
+    std::vector<plint> const& localBlocks = management.getLocalInfo().getBlocks();
+    ThreadAttribution const& threadAttribution = management.getThreadAttribution();
+    SparseBlockStructure3D const& sparseBlock = management.getSparseBlockStructure();
+    Run run;
+    for (pluint iSet=0; iSet<names.size(); ++iSet) {
+        run.set = iSet;
+        run.probe = -1;
+        plint cellSize = getNumComponents(fields[iSet])*(plint)sizeof(T);
+        if (probes[iSet].empty()) {
+            Box3D const& slice = domains[iSet];
+            for (pluint iBlock=0; iBlock<localBlocks.size(); ++iBlock) {
+                Box3D domain;
+                if (!intersect(management.getBulk(localBlocks[iBlock]), slice, domain)) {
+                    continue;
+                }
+                run.blockId = localBlocks[iBlock];
+                run.z0 = domain.z0;
+                run.z1 = domain.z1;
+                for (run.iX=domain.x0; run.iX<=domain.x1; ++run.iX) {
+                    for (run.iY=domain.y0; run.iY<=domain.y1; ++run.iY) {
+                        plint iCell = ( (run.iX-slice.x0)*slice.getNy() + (run.iY-slice.y0) )
+                                          * slice.getNz() + (run.z0-slice.z0);
+                        run.offset = setOffsets[iSet] + iCell*cellSize;
+                        runs.push_back(run);
+                    }
+                }
+            }
+        }
+        else {
+            for (pluint iProbe=0; iProbe<probes[iSet].size(); ++iProbe) {
+                Dot3D ownerCell;
+                if (!locateProbe(probes[iSet][iProbe], ownerCell)) {
+                    continue;
+                }
+                run.blockId = sparseBlock.locate(ownerCell.x, ownerCell.y, ownerCell.z);
+                if (threadAttribution.isLocal(run.blockId)) {
+                    run.probe = (plint)iProbe;
+                    run.iX = ownerCell.x;
+                    run.iY = ownerCell.y;
+                    run.z0 = ownerCell.z;
+                    run.z1 = ownerCell.z;
+                    run.offset = setOffsets[iSet] + (plint)iProbe*cellSize;
+                    runs.push_back(run);
+                }
+            }
+        }
+    }
+    std::sort(runs.begin(), runs.end());
+}
+
+template<typename T, template<typename U> class Descriptor>
+void InSituOutput3D<T,Descriptor>::computeValues (
+        Cell<T,Descriptor>& cell, int field, T* values ) const
+{
+    T rho = T();
+    Array<T,3> u;
+    u.resetToZero();
+    if (field == density) {
+        rho = cell.computeDensity();
+    }
+    else {
+        cell.computeVelocity(u);
+    }
+    fillValues(field, rho, u, values);
+}
+
+/** The density or the velocity is interpolated, and the requested field is
+ *  computed from the result. Cells with a vanishing weight are not accessed,
+ *  so that a probe located on a cell yields the value of this cell. The
+ *  weights of the cells which belong to no block are redistributed on the
+ *  other ones.
+ */
+template<typename T, template<typename U> class Descriptor>
+void InSituOutput3D<T,Descriptor>::interpolateValues (
+        BlockLattice3D<T,Descriptor>& component, Array<T,3> const& position,
+        int field, T* values ) const
+{
+    SparseBlockStructure3D const& sparseBlock =
+        lattice.getMultiBlockManagement().getSparseBlockStructure();
+    Dot3D corner = probeCorner(position);
+    Dot3D location = component.getLocation();
+    Array<T,3> delta( position[0]-(T)corner.x,
+                      position[1]-(T)corner.y,
+                      position[2]-(T)corner.z );
+    T rho = T();
+    Array<T,3> u;
+    u.resetToZero();
+    T sumWeights = T();
+    for (plint dx=0; dx<=1; ++dx) {
+        for (plint dy=0; dy<=1; ++dy) {
+            for (plint dz=0; dz<=1; ++dz) {
+                T weight = (dx==0 ? (T)1-delta[0] : delta[0]) *
+                           (dy==0 ? (T)1-delta[1] : delta[1]) *
+                           (dz==0 ? (T)1-delta[2] : delta[2]);
+                plint iX = corner.x+dx;
+                plint iY = corner.y+dy;
+                plint iZ = corner.z+dz;
+                if (weight==T() || sparseBlock.locate(iX, iY, iZ)<0) {
+                    continue;
+                }
+                Cell<T,Descriptor>& cell = component.get(iX-location.x, iY-location.y, iZ-location.z);
+                if (field == density) {
+                    rho += weight*cell.computeDensity();
+                }
+                else {
+                    Array<T,3> uCell;
+                    cell.computeVelocity(uCell);
+                    for (plint iD=0; iD<3; ++iD) {
+                        u[iD] += weight*uCell[iD];
+                    }
+                }
+                sumWeights += weight;
+            }
+        }
+    }
+    if (sumWeights > T()) {
+        rho /= sumWeights;
+        for (plint iD=0; iD<3; ++iD) {
+            u[iD] /= sumWeights;
+        }
+    }
+    fillValues(field, rho, u, values);
+}
+
+template<typename T, template<typename U> class Descriptor>
+void InSituOutput3D<T,Descriptor>::fillValues (
+        int field, T rho, Array<T,3> const& u, T* values ) const
+{
+    switch (field) {
+        case density:
+            values[0] = rho;
+            break;
+        case velocity:
+            values[0] = u[0];
+            values[1] = u[1];
+            values[2] = u[2];
+            break;
+        case velocityX:
+        case velocityY:
+        case velocityZ:
+            values[0] = u[field-velocityX];
+            break;
+        default:
+            values[0] = std::sqrt(normSqr(u));
+    }
+}
+
+/** The values of all runs are assembled in one buffer, in the order of the
+ *  file, and written with one collective call. Adjacent runs are merged into
+ *  a single byte range.
+ */
+template<typename T, template<typename U> class Descriptor>
+void InSituOutput3D<T,Descriptor>::write(plint iteration)
+{
+    global::profiler().start(global::prof::io);
+    std::vector<Run> runs;
+    computeRuns(runs);
+
+    plint recordPos = numRecords*recordSize;
+    std::vector<plint> offsets, sizes;
+    std::vector<char> data;
+    if (global::mpi().isMainProcessor()) {
+        long long iterationValue = iteration;
+        data.resize(sizeof(long long));
+        std::memcpy(&data[0], &iterationValue, sizeof(long long));
+        offsets.push_back(recordPos);
+        sizes.push_back(sizeof(long long));
+    }
+    T values[3];
+    for (pluint iRun=0; iRun<runs.size(); ++iRun) {
+        Run const& run = runs[iRun];
+        int field = fields[run.set];
+        plint cellSize = getNumComponents(field)*(plint)sizeof(T);
+        plint runSize = (run.z1-run.z0+1)*cellSize;
+        if (!offsets.empty() && offsets.back()+sizes.back() == recordPos+run.offset) {
+            sizes.back() += runSize;
+        }
+        else {
+            offsets.push_back(recordPos+run.offset);
+            sizes.push_back(runSize);
+        }
+        BlockLattice3D<T,Descriptor>& component = lattice.getComponent(run.blockId);
+        Dot3D location = component.getLocation();
+        plint pos = (plint)data.size();
+        data.resize(pos+runSize);
+        if (run.probe >= 0) {
+            interpolateValues(component, probes[run.set][run.probe], field, values);
+            std::memcpy(&data[pos], values, cellSize);
+        }
+        else {
+            for (plint iZ=run.z0; iZ<=run.z1; ++iZ) {
+                computeValues( component.get(run.iX-location.x, run.iY-location.y, iZ-location.z),
+                               field, values );
+                std::memcpy(&data[pos], values, cellSize);
+                pos += cellSize;
+            }
+        }
+    }
+
+    if (numRecords==0) {
+        writeLayout();
+    }
+    parallelIO::RawDataWriter writer(fName, numRecords==0);
+    writer.write(offsets, sizes, data);
+    ++numRecords;
+    global::profiler().stop(global::prof::io);
+}
+
+template<typename T, template<typename U> class Descriptor>
+void InSituOutput3D<T,Descriptor>::writeLayout() const
+{
+    static const char* fieldNames[] = {
+        "density", "velocity", "velocityX", "velocityY", "velocityZ", "velocityNorm" };
+    XMLwriter xml;
+    XMLwriter& xmlOutput = xml["InSituOutput"];
+    xmlOutput["File"].setString(fName.get());
+    xmlOutput["Datatype"].setString(NativeType<T>::getName());
+    xmlOutput["RecordSize"].set(recordSize);
+    XMLwriter& xmlSets = xmlOutput["Set"];
+    for (pluint iSet=0; iSet<names.size(); ++iSet) {
+        xmlSets[iSet]["Name"].setString(names[iSet]);
+        xmlSets[iSet]["Field"].setString(fieldNames[fields[iSet]]);
+        xmlSets[iSet]["NumComponents"].set(getNumComponents(fields[iSet]));
+        xmlSets[iSet]["Offset"].set(setOffsets[iSet]);
+        if (probes[iSet].empty()) {
+            xmlSets[iSet]["Domain"].set<plint,6>(domains[iSet].to_plbArray());
+        }
+        else {
+            std::vector<T> positions;
+            for (pluint iProbe=0; iProbe<probes[iSet].size(); ++iProbe) {
+                positions.push_back(probes[iSet][iProbe][0]);
+                positions.push_back(probes[iSet][iProbe][1]);
+                positions.push_back(probes[iSet][iProbe][2]);
+            }
+            xmlSets[iSet]["Probes"].set(positions);
+        }
+    }
+    xml.print(FileName(fName).setExt("xml"));
+}
+
+}  // namespace plb
+
+#endif  // IN_SITU_OUTPUT_3D_HH
@@ -27,12 +27,148 @@
 #include "parallelism/mpiManager.h"
 #include "core/util.h"
 #include "io/plbFiles.h"
+#include "core/runTimeDiagnostics.h"
+#include <algorithm>
 #include <cstdio>
+#include <iostream>
 
 namespace plb {
 
 namespace parallelIO {
 
+#ifdef PLB_MPI_PARALLEL
+
+namespace {
+
+/// Largest amount of data handled by a single MPI I/O call.
+const plint maxIOchunkSize = 1000000000; // 1 GB.
+
+/// Hints for collective file access, as configured in the I/O policy: the
+///   requests are aggregated by a few processes per node, and new files are
+///   striped accordingly.
+MPI_Info createCollectiveIOhints() {
+    MPI_Info info;
+    MPI_Info_create(&info);
+    MPI_Info_set(info, const_cast<char*>("romio_cb_write"), const_cast<char*>("enable"));
+    MPI_Info_set(info, const_cast<char*>("romio_cb_read"), const_cast<char*>("enable"));
+    plint numAggregators = global::IOpolicy().getNumAggregatorsPerNode();
+    if (numAggregators>0) {
+        std::string configList = "*:"+util::val2str(numAggregators);
+        MPI_Info_set(info, const_cast<char*>("cb_config_list"), const_cast<char*>(configList.c_str()));
+    }
+    plint stripeCount = global::IOpolicy().getStripeCount();
+    if (stripeCount>0) {
+        std::string value = util::val2str(stripeCount);
+        MPI_Info_set(info, const_cast<char*>("striping_factor"), const_cast<char*>(value.c_str()));
+    }
+    plint stripeSize = global::IOpolicy().getStripeSize();
+    if (stripeSize>0) {
+        std::string value = util::val2str(stripeSize);
+        MPI_Info_set(info, const_cast<char*>("striping_unit"), const_cast<char*>(value.c_str()));
+    }
+    return info;
+}
+
+/// Distribute byte ranges of a file over chunks of at most 1 GB, each of which
+///   is handled by one MPI call; ranges which are larger than a chunk are split.
+///   chunkPos is the position of each chunk in the contiguous memory buffer.
+void splitIntoChunks( std::vector<plint> const& offsets, std::vector<plint> const& sizes,
+                      std::vector<std::vector<int> >& blockLengths,
+                      std::vector<std::vector<MPI_Aint> >& displacements,
+                      std::vector<plint>& chunkPos )
+{
+    plint chunkSize = maxIOchunkSize;
+    plint pos = 0;
+    for (pluint iRange=0; iRange<offsets.size(); ++iRange) {
+        plint rangePos = 0;
+        while (rangePos<sizes[iRange]) {
+            if (chunkSize==maxIOchunkSize) {
+                blockLengths.push_back(std::vector<int>());
+                displacements.push_back(std::vector<MPI_Aint>());
+                chunkPos.push_back(pos);
+                chunkSize = 0;
+            }
+            plint pieceSize = std::min(sizes[iRange]-rangePos, maxIOchunkSize-chunkSize);
+            blockLengths.back().push_back((int)pieceSize);
+            displacements.back().push_back((MPI_Aint)(offsets[iRange]+rangePos));
+            rangePos += pieceSize;
+            chunkSize += pieceSize;
+            pos += pieceSize;
+        }
+    }
+}
+
+}  // namespace
+
+#endif  // PLB_MPI_PARALLEL
+
+/// All processes open the file together, and write their blocks with collective
+///   calls. Each call handles at most one chunk of 1 GB per process, and processes
+///   which have run out of data take part with an empty request.
+void writeRawData_collective( FileName fName, std::vector<plint> const& myBlockIds,
+                              std::vector<plint> const& offset, std::vector<std::vector<char> >& data,
+                              bool appendMode )
+{
+#ifdef PLB_MPI_PARALLEL
+    MPI_Info info = createCollectiveIOhints();
+    MPI_File fh;
+    int amode = appendMode ? MPI_MODE_WRONLY : (MPI_MODE_CREATE | MPI_MODE_WRONLY);
+    int err = MPI_File_open( global::mpi().getGlobalCommunicator(),
+                             const_cast<char*>(fName.get().c_str()), amode, info, &fh );
+    MPI_Info_free(&info);
+    plbIOError(err!=MPI_SUCCESS, "Could not open file "+fName.get());
+
+    plint globalOffset = 0;
+    if (!appendMode) {
+        // Discard the content of a previous, possibly longer file.
+        MPI_File_set_size(fh, 0);
+    }
+    else {
+        if (global::mpi().isMainProcessor()) {
+            MPI_Offset fileSize;
+            MPI_File_get_size(fh, &fileSize);
+            globalOffset = (plint) fileSize;
+        }
+        global::mpi().bCast(&globalOffset, 1);
+    }
+
+    // Cut the blocks into pieces which can be handled by one MPI call.
+    std::vector<plint> pieceOffset, pieceBlock, piecePos, pieceSize;
+    for (plint iBlock=0; iBlock<(plint)myBlockIds.size(); ++iBlock) {
+        plint blockId = myBlockIds[iBlock];
+        plint nextOffset = blockId==0 ? 0 : offset[blockId-1];
+        PLB_ASSERT( offset[blockId]-nextOffset == (plint)data[iBlock].size() );
+        plint dataSize = (plint) data[iBlock].size();
+        for (plint pos=0; pos<dataSize; pos+=maxIOchunkSize) {
+            pieceOffset.push_back(globalOffset+nextOffset+pos);
+            pieceBlock.push_back(iBlock);
+            piecePos.push_back(pos);
+            pieceSize.push_back(std::min(maxIOchunkSize, dataSize-pos));
+        }
+    }
+    plint numRounds = (plint) pieceOffset.size();
+    global::mpi().reduceAndBcast(numRounds, MPI_MAX);
+
+    bool ioError = false;
+    char dummy = 0;
+    for (plint iRound=0; iRound<numRounds; ++iRound) {
+        MPI_Status status;
+        if (iRound<(plint)pieceOffset.size()) {
+            err = MPI_File_write_at_all( fh, pieceOffset[iRound],
+                                         &data[pieceBlock[iRound]][piecePos[iRound]],
+                                         (int)pieceSize[iRound], MPI_CHAR, &status );
+        }
+        else {
+            err = MPI_File_write_at_all(fh, 0, &dummy, 0, MPI_CHAR, &status);
+        }
+        ioError = ioError || err!=MPI_SUCCESS;
+    }
+    err = MPI_File_close(&fh);
+    ioError = ioError || err!=MPI_SUCCESS;
+    plbIOError(ioError, std::string("File access unsuccessful in file ")+fName.get());
+#endif
+}
+
 void writeRawData_mpi( FileName fName, std::vector<plint> const& myBlockIds,
                        std::vector<plint> const& offset, std::vector<std::vector<char> >& data,
                        bool appendMode )
@@ -177,7 +313,12 @@ void writeRawData( FileName fName, std::vector<plint> const& myBlockIds,
         fName.defaultExt("dat");
     }
     if (global::IOpolicy().useParallelIO() && global::mpi().getSize()>1) {
-        writeRawData_mpi(fName, myBlockIds, offset, data, appendMode );
+        if (global::IOpolicy().useCollectiveIO()) {
+            writeRawData_collective(fName, myBlockIds, offset, data, appendMode );
+        }
+        else {
+            writeRawData_mpi(fName, myBlockIds, offset, data, appendMode );
+        }
     }
     else {
         // Works in parallel too, but has no parallel efficiency.
@@ -285,6 +426,32 @@ void loadRawData_posix( FileName fName, std::vector<plint> const& myBlockIds,
     }
 }
 
+void loadRawData_collective( FileName fName, std::vector<plint> const& myBlockIds,
+                             std::vector<plint> const& offset, std::vector<std::vector<char> >& data )
+{
+    // The reader is used collectively: processes with less blocks take
+    //   part in the remaining calls with an empty request.
+    plint numBlocks = (plint) myBlockIds.size();
+#ifdef PLB_MPI_PARALLEL
+    global::mpi().reduceAndBcast(numBlocks, MPI_MAX);
+#endif
+    RawDataReader reader(fName);
+    std::vector<plint> noRanges;
+    std::vector<char> noData;
+    for (plint iBlock=0; iBlock<numBlocks; ++iBlock) {
+        if (iBlock<(plint)myBlockIds.size()) {
+            plint blockId = myBlockIds[iBlock];
+            plint nextOffset = blockId==0 ? 0 : offset[blockId-1];
+            std::vector<plint> offsets(1, nextOffset);
+            std::vector<plint> sizes(1, offset[blockId]-nextOffset);
+            reader.read(offsets, sizes, data[iBlock]);
+        }
+        else {
+            reader.read(noRanges, noRanges, noData);
+        }
+    }
+}
+
 void loadRawData( FileName fName, std::vector<plint> const& myBlockIds,
                   std::vector<plint> const& offset, std::vector<std::vector<char> >& data )
 {
@@ -292,7 +459,12 @@ void loadRawData( FileName fName, std::vector<plint> const& myBlockIds,
     fName.defaultPath(global::directories().getInputDir());
     fName.defaultExt("dat");
     if (global::IOpolicy().useParallelIO() && global::mpi().getSize()>1) {
-        loadRawData_mpi(fName, myBlockIds, offset, data);
+        if (global::IOpolicy().useCollectiveIO()) {
+            loadRawData_collective(fName, myBlockIds, offset, data);
+        }
+        else {
+            loadRawData_mpi(fName, myBlockIds, offset, data);
+        }
     }
     else {
         // Works in parallel too, but has no parallel efficiency.
@@ -300,6 +472,481 @@ void loadRawData( FileName fName, std::vector<plint> const& myBlockIds,
     }
 }
 
+
+/* *************** Class RawDataReader ************************************** */
+
+RawDataReader::RawDataReader(FileName fName_)
+    : fName(fName_),
+      collective( global::IOpolicy().useParallelIO() &&
+                  global::IOpolicy().useCollectiveIO() &&
+                  global::mpi().getSize()>1 ),
+      fp(0)
+{
+    bool errorFlag = false;
+    if (collective) {
+#ifdef PLB_MPI_PARALLEL
+        MPI_Info info = createCollectiveIOhints();
+        int err = MPI_File_open( global::mpi().getGlobalCommunicator(),
+                                 const_cast<char*>(fName.get().c_str()), MPI_MODE_RDONLY, info, &fh );
+        MPI_Info_free(&info);
+        errorFlag = err!=MPI_SUCCESS;
+#endif
+    }
+    else {
+        fp = fopen(fName.get().c_str(), "rb");
+        errorFlag = !fp;
+    }
+    plbIOError(errorFlag, "Could not open file "+fName.get());
+}
+
+RawDataReader::~RawDataReader()
+{
+    if (collective) {
+#ifdef PLB_MPI_PARALLEL
+        MPI_File_close(&fh);
+#endif
+    }
+    else if (fp) {
+        fclose(fp);
+    }
+}
+
+void RawDataReader::read( std::vector<plint> const& offsets, std::vector<plint> const& sizes,
+                          std::vector<char>& data )
+{
+    PLB_PRECONDITION( offsets.size()==sizes.size() );
+    plint totalSize = 0;
+    for (pluint iRange=0; iRange<sizes.size(); ++iRange) {
+        totalSize += sizes[iRange];
+    }
+    data.resize(totalSize);
+    if (collective) {
+        read_collective(offsets, sizes, data);
+    }
+    else {
+        read_posix(offsets, sizes, data);
+    }
+}
+
+/** The ranges are described by a file view, and read with a single collective
+ *  call per chunk of 1 GB. Processes which need less chunks take part in the
+ *  remaining calls with an empty request.
+ */
+void RawDataReader::read_collective( std::vector<plint> const& offsets, std::vector<plint> const& sizes,
+                                     std::vector<char>& data )
+{
+#ifdef PLB_MPI_PARALLEL
+    std::vector<std::vector<int> > blockLengths;
+    std::vector<std::vector<MPI_Aint> > displacements;
+    std::vector<plint> chunkPos;
+    splitIntoChunks(offsets, sizes, blockLengths, displacements, chunkPos);
+    plint numChunks = (plint) chunkPos.size();
+    global::mpi().reduceAndBcast(numChunks, MPI_MAX);
+
+    bool ioError = false;
+    char dummy = 0;
+    for (plint iChunk=0; iChunk<numChunks; ++iChunk) {
+        MPI_Status status;
+        int err = MPI_SUCCESS;
+        if (iChunk<(plint)chunkPos.size()) {
+            MPI_Datatype fileType;
+            MPI_Type_create_hindexed( (int)blockLengths[iChunk].size(), &blockLengths[iChunk][0],
+                                      &displacements[iChunk][0], MPI_BYTE, &fileType );
+            MPI_Type_commit(&fileType);
+            err = MPI_File_set_view( fh, 0, MPI_BYTE, fileType,
+                                     const_cast<char*>("native"), MPI_INFO_NULL );
+            int readSize = 0;
+            for (pluint iPiece=0; iPiece<blockLengths[iChunk].size(); ++iPiece) {
+                readSize += blockLengths[iChunk][iPiece];
+            }
+            if (err==MPI_SUCCESS) {
+                err = MPI_File_read_all(fh, &data[chunkPos[iChunk]], readSize, MPI_BYTE, &status);
+            }
+            MPI_Type_free(&fileType);
+        }
+        else {
+            err = MPI_File_set_view( fh, 0, MPI_BYTE, MPI_BYTE,
+                                     const_cast<char*>("native"), MPI_INFO_NULL );
+            if (err==MPI_SUCCESS) {
+                err = MPI_File_read_all(fh, &dummy, 0, MPI_BYTE, &status);
+            }
+        }
+        ioError = ioError || err!=MPI_SUCCESS;
+    }
+    plbIOError(ioError, std::string("File access unsuccessful in file ")+fName.get());
+#endif
+}
+
+void RawDataReader::read_posix( std::vector<plint> const& offsets, std::vector<plint> const& sizes,
+                                std::vector<char>& data )
+{
+    bool errorFlag = false;
+    plint pos = 0;
+    for (pluint iRange=0; iRange<offsets.size() && !errorFlag; ++iRange) {
+#if defined PLB_MAC_OS_X || defined PLB_BSD
+        int fSeekVal = fseek(fp, (long int)offsets[iRange], SEEK_SET);
+#else
+        int fSeekVal = fseeko64(fp, offsets[iRange], SEEK_SET);
+#endif
+        errorFlag = fSeekVal != 0;
+        if (!errorFlag && sizes[iRange]>0) {
+            plint numRead = (plint) fread(&data[pos], 1, sizes[iRange], fp);
+            errorFlag = numRead != sizes[iRange];
+        }
+        pos += sizes[iRange];
+    }
+    plbIOError(errorFlag, std::string("Unsuccessful reading from file ")+fName.get());
+}
+
+
+/* *************** Class RawDataWriter ************************************** */
+
+RawDataWriter::RawDataWriter(FileName fName_, bool truncate)
+    : fName(fName_),
+      collective( global::IOpolicy().useParallelIO() &&
+                  global::IOpolicy().useCollectiveIO() &&
+                  global::mpi().getSize()>1 )
+{
+    bool errorFlag = false;
+    if (collective) {
+#ifdef PLB_MPI_PARALLEL
+        MPI_Info info = createCollectiveIOhints();
+        int amode = truncate ? (MPI_MODE_CREATE | MPI_MODE_WRONLY) : MPI_MODE_WRONLY;
+        int err = MPI_File_open( global::mpi().getGlobalCommunicator(),
+                                 const_cast<char*>(fName.get().c_str()), amode, info, &fh );
+        MPI_Info_free(&info);
+        errorFlag = err!=MPI_SUCCESS;
+        if (!errorFlag && truncate) {
+            MPI_File_set_size(fh, 0);
+        }
+#endif
+        plbIOError(errorFlag, "Could not open file "+fName.get());
+    }
+    else {
+        // The file is created by the main process; the processes write into
+        //   it in turn.
+        if (global::mpi().isMainProcessor()) {
+            FILE* fp = fopen(fName.get().c_str(), truncate ? "wb" : "r+b");
+            errorFlag = !fp;
+            if (fp) {
+                fclose(fp);
+            }
+        }
+        plbMainProcIOError(errorFlag, "Could not open file "+fName.get());
+    }
+}
+
+RawDataWriter::~RawDataWriter()
+{
+    if (collective) {
+#ifdef PLB_MPI_PARALLEL
+        MPI_File_close(&fh);
+#endif
+    }
+}
+
+void RawDataWriter::write( std::vector<plint> const& offsets, std::vector<plint> const& sizes,
+                           std::vector<char> const& data )
+{
+    PLB_PRECONDITION( offsets.size()==sizes.size() );
+    if (collective) {
+        write_collective(offsets, sizes, data);
+    }
+    else {
+        write_posix(offsets, sizes, data);
+    }
+}
+
+/** The ranges are described by a file view, and written with a single
+ *  collective call per chunk of 1 GB, as in RawDataReader::read_collective().
+ */
+void RawDataWriter::write_collective( std::vector<plint> const& offsets, std::vector<plint> const& sizes,
+                                      std::vector<char> const& data )
+{
+#ifdef PLB_MPI_PARALLEL
+    std::vector<std::vector<int> > blockLengths;
+    std::vector<std::vector<MPI_Aint> > displacements;
+    std::vector<plint> chunkPos;
+    splitIntoChunks(offsets, sizes, blockLengths, displacements, chunkPos);
+    plint numChunks = (plint) chunkPos.size();
+    global::mpi().reduceAndBcast(numChunks, MPI_MAX);
+
+    bool ioError = false;
+    char dummy = 0;
+    for (plint iChunk=0; iChunk<numChunks; ++iChunk) {
+        MPI_Status status;
+        int err = MPI_SUCCESS;
+        if (iChunk<(plint)chunkPos.size()) {
+            MPI_Datatype fileType;
+            MPI_Type_create_hindexed( (int)blockLengths[iChunk].size(), &blockLengths[iChunk][0],
+                                      &displacements[iChunk][0], MPI_BYTE, &fileType );
+            MPI_Type_commit(&fileType);
+            err = MPI_File_set_view( fh, 0, MPI_BYTE, fileType,
+                                     const_cast<char*>("native"), MPI_INFO_NULL );
+            int writeSize = 0;
+            for (pluint iPiece=0; iPiece<blockLengths[iChunk].size(); ++iPiece) {
+                writeSize += blockLengths[iChunk][iPiece];
+            }
+            if (err==MPI_SUCCESS) {
+                err = MPI_File_write_all( fh, const_cast<char*>(&data[chunkPos[iChunk]]),
+                                          writeSize, MPI_BYTE, &status );
+            }
+            MPI_Type_free(&fileType);
+        }
+        else {
+            err = MPI_File_set_view( fh, 0, MPI_BYTE, MPI_BYTE,
+                                     const_cast<char*>("native"), MPI_INFO_NULL );
+            if (err==MPI_SUCCESS) {
+                err = MPI_File_write_all(fh, &dummy, 0, MPI_BYTE, &status);
+            }
+        }
+        ioError = ioError || err!=MPI_SUCCESS;
+    }
+    plbIOError(ioError, std::string("File access unsuccessful in file ")+fName.get());
+#endif
+}
+
+void RawDataWriter::write_posix( std::vector<plint> const& offsets, std::vector<plint> const& sizes,
+                                 std::vector<char> const& data )
+{
+    bool errorFlag = false;
+    for (plint iProcess=0; iProcess<global::mpi().getSize(); ++iProcess) {
+        if (global::mpi().getRank()==iProcess && !offsets.empty()) {
+            FILE* fp = fopen(fName.get().c_str(), "r+b");
+            errorFlag = !fp;
+            plint pos = 0;
+            for (pluint iRange=0; iRange<offsets.size() && !errorFlag; ++iRange) {
+#if defined PLB_MAC_OS_X || defined PLB_BSD
+                int fSeekVal = fseek(fp, (long int)offsets[iRange], SEEK_SET);
+#else
+                int fSeekVal = fseeko64(fp, offsets[iRange], SEEK_SET);
+#endif
+                errorFlag = fSeekVal != 0;
+                if (!errorFlag && sizes[iRange]>0) {
+                    plint numWritten = (plint) fwrite(&data[pos], 1, sizes[iRange], fp);
+                    errorFlag = numWritten != sizes[iRange];
+                }
+                pos += sizes[iRange];
+            }
+            if (fp) {
+                errorFlag = fclose(fp)!=0 || errorFlag;
+            }
+        }
+        global::mpi().barrier();
+    }
+    plbIOError(errorFlag, std::string("Unsuccessful writing into file ")+fName.get());
+}
+
+
+/* *************** Class AsyncRawDataWriter ********************************* */
+
+AsyncRawDataWriter::AsyncRawDataWriter()
+    : writing(false),
+      errorFlag(false)
+{ }
+
+/** The files started last are published here unless wait() was called. The
+ *  writer returned by asyncRawDataWriter() is destroyed at the end of the
+ *  program, on all processes, and before MPI is finalized, because the MPI
+ *  manager is created earlier. A destructor cannot raise an error, so errors
+ *  are reported on the error stream.
+ */
+AsyncRawDataWriter::~AsyncRawDataWriter()
+{
+    if (writing || !activeFiles.empty() || !activeDescriptions.empty()) {
+        try {
+            wait();
+        }
+        catch (PlbException const& exception) {
+            std::cerr << exception.what() << std::endl;
+        }
+    }
+}
+
+void AsyncRawDataWriter::recycleBuffers(std::vector<std::vector<char> >& data)
+{
+    if (!spareBuffers.empty()) {
+        data.swap(spareBuffers.back());
+        spareBuffers.pop_back();
+    }
+}
+
+void AsyncRawDataWriter::stage( FileName fName, std::vector<plint> const& myBlockIds,
+                                std::vector<plint> const& offset, std::vector<std::vector<char> >& data )
+{
+    PLB_ASSERT( myBlockIds.size() == data.size() );
+    fName.defaultPath(global::directories().getOutputDir());
+    fName.defaultExt("dat");
+    stagedFiles.push_back(FileData());
+    FileData& file = stagedFiles.back();
+    file.fName = fName.get();
+    file.myBlockIds = myBlockIds;
+    file.offset = offset;
+    file.data.swap(data);
+}
+
+void AsyncRawDataWriter::stageDescription(std::string fName, std::string const& content)
+{
+    stagedDescriptions.push_back(Description());
+    stagedDescriptions.back().fName = fName;
+    stagedDescriptions.back().content = content;
+}
+
+/** The files are created or truncated by the main process before the
+ *  background thread starts, so that all processes can then write their
+ *  blocks into the same file independently.
+ */
+void AsyncRawDataWriter::start()
+{
+    wait();
+    activeFiles.swap(stagedFiles);
+    activeDescriptions.swap(stagedDescriptions);
+    bool creationError = false;
+    std::string fileName;
+    if (global::mpi().isMainProcessor()) {
+        for (pluint iFile=0; iFile<activeFiles.size() && !creationError; ++iFile) {
+            fileName = temporaryName(activeFiles[iFile].fName);
+            FILE* fp = fopen(fileName.c_str(), "wb");
+            creationError = !fp;
+            if (fp) {
+                fclose(fp);
+            }
+        }
+    }
+    // Implies the synchronization which guarantees that the files exist.
+    plbIOError(creationError, std::string("Could not create file ")+fileName);
+    writing = true;
+#ifdef PLB_USE_POSIX
+    if (pthread_create(&thread, 0, writeInBackground, (void*)this) != 0) {
+        writeActiveFiles();
+        writing = false;
+    }
+#else
+    writeActiveFiles();
+    writing = false;
+#endif
+}
+
+void AsyncRawDataWriter::wait()
+{
+    join();
+    // Hand out the buffers of the written files for the next snapshots.
+    for (pluint iFile=0; iFile<activeFiles.size(); ++iFile) {
+        spareBuffers.push_back(std::vector<std::vector<char> >());
+        spareBuffers.back().swap(activeFiles[iFile].data);
+    }
+    std::vector<FileData> writtenFiles;
+    std::vector<Description> descriptions;
+    writtenFiles.swap(activeFiles);
+    descriptions.swap(activeDescriptions);
+    bool writeError = errorFlag;
+    std::string fileName = errorFileName;
+    errorFlag = false;
+    // Nothing is published unless all processes have written their data.
+    plbIOError(writeError, std::string("Unsuccessful writing into file ")+fileName);
+    publish(writtenFiles, descriptions);
+}
+
+/** The data files are renamed before the descriptions are written, so that a
+ *  description never refers to a file which is not yet in place.
+ */
+void AsyncRawDataWriter::publish( std::vector<FileData> const& files,
+                                  std::vector<Description> const& descriptions )
+{
+    bool publicationError = false;
+    std::string fileName;
+    if (global::mpi().isMainProcessor()) {
+        for (pluint iFile=0; iFile<files.size() && !publicationError; ++iFile) {
+            fileName = files[iFile].fName;
+            publicationError = std::rename(temporaryName(fileName).c_str(), fileName.c_str()) != 0;
+        }
+        for (pluint iDescr=0; iDescr<descriptions.size() && !publicationError; ++iDescr) {
+            Description const& description = descriptions[iDescr];
+            fileName = description.fName;
+            // The description replaces the previous version of the file in one step.
+            std::string tmpName = temporaryName(fileName);
+            FILE* fp = fopen(tmpName.c_str(), "wb");
+            publicationError = !fp;
+            if (fp) {
+                publicationError = fwrite ( description.content.data(), 1,
+                                            description.content.size(), fp )
+                                   != description.content.size();
+                publicationError = (fclose(fp) != 0) || publicationError;
+            }
+            if (!publicationError) {
+                publicationError = std::rename(tmpName.c_str(), fileName.c_str()) != 0;
+            }
+        }
+    }
+    plbMainProcIOError(publicationError, std::string("Could not publish file ")+fileName);
+}
+
+std::string AsyncRawDataWriter::temporaryName(std::string const& fName)
+{
+    return fName+".tmp";
+}
+
+bool AsyncRawDataWriter::isWriting() const {
+    return writing;
+}
+
+void AsyncRawDataWriter::join()
+{
+#ifdef PLB_USE_POSIX
+    if (writing) {
+        pthread_join(thread, 0);
+    }
+#endif
+    writing = false;
+}
+
+#ifdef PLB_USE_POSIX
+void* AsyncRawDataWriter::writeInBackground(void* writer)
+{
+    ((AsyncRawDataWriter*)writer)->writeActiveFiles();
+    return 0;
+}
+#endif
+
+/// Executed by the background thread: no MPI call, and no access to shared state.
+void AsyncRawDataWriter::writeActiveFiles()
+{
+    for (pluint iFile=0; iFile<activeFiles.size() && !errorFlag; ++iFile) {
+        FileData const& file = activeFiles[iFile];
+        if (file.myBlockIds.empty()) continue;
+        FILE* fp = fopen(temporaryName(file.fName).c_str(), "r+b");
+        errorFlag = !fp;
+        for (pluint iBlock=0; iBlock<file.myBlockIds.size() && !errorFlag; ++iBlock) {
+            plint blockId = file.myBlockIds[iBlock];
+            plint nextOffset = blockId==0 ? 0 : file.offset[blockId-1];
+            PLB_ASSERT( file.offset[blockId]-nextOffset == (plint)file.data[iBlock].size() );
+            if (file.data[iBlock].empty()) continue;
+#if defined PLB_MAC_OS_X || defined PLB_BSD
+            int fSeekVal = fseek(fp, (long int)nextOffset, SEEK_SET);
+#else
+            int fSeekVal = fseeko64(fp, nextOffset, SEEK_SET);
+#endif
+            errorFlag = fSeekVal != 0;
+            if (!errorFlag) {
+                plint numWritten = (plint)
+                    fwrite(&file.data[iBlock][0], 1, file.data[iBlock].size(), fp);
+                errorFlag = numWritten != (plint)file.data[iBlock].size();
+            }
+        }
+        if (fp) {
+            errorFlag = (fclose(fp) != 0) || errorFlag;
+        }
+        if (errorFlag) {
+            errorFileName = file.fName;
+        }
+    }
+}
+
+AsyncRawDataWriter& asyncRawDataWriter() {
+    static AsyncRawDataWriter instance;
+    return instance;
+}
+
 }  // namespace parallelIO
 
 }  // namespace plb
@@ -30,9 +30,15 @@
 
 #include "core/globalDefs.h"
 #include "io/plbFiles.h"
+#include "parallelism/mpiManager.h"
+#include <cstdio>
 #include <string>
 #include <vector>
 
+#ifdef PLB_USE_POSIX
+#include <pthread.h>
+#endif
+
 namespace plb {
 
 namespace parallelIO {
@@ -44,6 +50,139 @@ void writeRawData( FileName fName, std::vector<plint> const& myBlockIds,
 void loadRawData( FileName fName,  std::vector<plint> const& myBlockIds,
                   std::vector<plint> const& offset, std::vector<std::vector<char> >& data );
 
+/// Reads groups of byte ranges from a raw data file. With parallel, collective
+///   I/O, all processes must construct the reader, and call read() equally
+///   often (possibly with an empty group of ranges).
+class RawDataReader {
+public:
+    RawDataReader(FileName fName_);
+    ~RawDataReader();
+    /// Read the byte ranges [offsets[i], offsets[i]+sizes[i]) of the file, and
+    ///   store them one after the other into data. The ranges must be sorted
+    ///   by increasing offset, and must not overlap.
+    void read( std::vector<plint> const& offsets, std::vector<plint> const& sizes,
+               std::vector<char>& data );
+private:
+    RawDataReader(RawDataReader const& rhs);
+    RawDataReader& operator=(RawDataReader const& rhs);
+    void read_collective( std::vector<plint> const& offsets, std::vector<plint> const& sizes,
+                          std::vector<char>& data );
+    void read_posix( std::vector<plint> const& offsets, std::vector<plint> const& sizes,
+                     std::vector<char>& data );
+private:
+    FileName fName;
+    bool collective;
+#ifdef PLB_MPI_PARALLEL
+    MPI_File fh;
+#endif
+    FILE* fp;
+};
+
+/// Writes groups of byte ranges into a raw data file; the counterpart of
+///   RawDataReader. With parallel, collective I/O, all processes must
+///   construct the writer, and call write() equally often (possibly with an
+///   empty group of ranges). Otherwise, the processes write in turn.
+class RawDataWriter {
+public:
+    /// If truncate is false, the file must exist, and its content outside of
+    ///   the written ranges is preserved.
+    RawDataWriter(FileName fName_, bool truncate);
+    ~RawDataWriter();
+    /// Write data, one range after the other, into the byte ranges
+    ///   [offsets[i], offsets[i]+sizes[i]) of the file. The ranges must be
+    ///   sorted by increasing offset, and must not overlap.
+    void write( std::vector<plint> const& offsets, std::vector<plint> const& sizes,
+                std::vector<char> const& data );
+private:
+    RawDataWriter(RawDataWriter const& rhs);
+    RawDataWriter& operator=(RawDataWriter const& rhs);
+    void write_collective( std::vector<plint> const& offsets, std::vector<plint> const& sizes,
+                           std::vector<char> const& data );
+    void write_posix( std::vector<plint> const& offsets, std::vector<plint> const& sizes,
+                      std::vector<char> const& data );
+private:
+    FileName fName;
+    bool collective;
+#ifdef PLB_MPI_PARALLEL
+    MPI_File fh;
+#endif
+};
+
+/// Writes raw data files in the background, while the simulation goes on.
+/** The data of a file is first staged, through a swap of buffers, and the
+ *  staged files are then written by a background thread. Staging and
+ *  writing can overlap: new data can be staged while the previous files are
+ *  still being written. The buffers of written files are handed out again
+ *  for the next snapshot, to avoid reallocations. All methods are collective.
+ *  Without POSIX threads (PLB_USE_POSIX), the files are written by start().
+ *
+ *  The data files are written under a temporary name. Once all of them are
+ *  complete on all processes, they are renamed, and the staged descriptions
+ *  (e.g. XML files which refer to the data) are written. This publication
+ *  happens in wait(), which is also called by the next start(). A crash or
+ *  a failed write therefore never leaves a description which refers to
+ *  incomplete data. The files of the last snapshot are published at the
+ *  latest by the destructor, at the end of the program.
+ */
+class AsyncRawDataWriter {
+public:
+    AsyncRawDataWriter();
+    /// Waits for the files being written, and publishes them. This is
+    ///   collective, like wait().
+    ~AsyncRawDataWriter();
+    /// Provide a set of buffers to be filled with the data of the next file.
+    void recycleBuffers(std::vector<std::vector<char> >& data);
+    /// Stage the data of a file. The data is swapped into the writer.
+    void stage( FileName fName, std::vector<plint> const& myBlockIds,
+                std::vector<plint> const& offset, std::vector<std::vector<char> >& data );
+    /// Stage a text file which describes the staged data. It is written by
+    ///   the main process once the data files are complete.
+    void stageDescription(std::string fName, std::string const& content);
+    /// Wait for the previous files to be written, and start writing the
+    ///   staged files in the background.
+    void start();
+    /// Wait until all files are written, report errors, and publish the files.
+    void wait();
+    /// Tells whether files are being written in the background.
+    bool isWriting() const;
+private:
+    AsyncRawDataWriter(AsyncRawDataWriter const& rhs);
+    AsyncRawDataWriter& operator=(AsyncRawDataWriter const& rhs);
+    struct FileData {
+        std::string fName;
+        std::vector<plint> myBlockIds;
+        std::vector<plint> offset;
+        std::vector<std::vector<char> > data;
+    };
+    struct Description {
+        std::string fName;
+        std::string content;
+    };
+private:
+    void join();
+    void writeActiveFiles();
+    /// Rename the written data files, and write their descriptions.
+    static void publish( std::vector<FileData> const& files,
+                         std::vector<Description> const& descriptions );
+    static std::string temporaryName(std::string const& fName);
+#ifdef PLB_USE_POSIX
+    static void* writeInBackground(void* writer);
+#endif
+private:
+    std::vector<FileData> stagedFiles, activeFiles;
+    std::vector<Description> stagedDescriptions, activeDescriptions;
+    std::vector<std::vector<std::vector<char> > > spareBuffers;
+    bool writing;
+    bool errorFlag;
+    std::string errorFileName;
+#ifdef PLB_USE_POSIX
+    pthread_t thread;
+#endif
+};
+
+/// Writer used by the asynchronous checkpoints.
+AsyncRawDataWriter& asyncRawDataWriter();
+
 }  // namespace parallelIO
 
 }  // namespace plb
@@ -28,6 +28,7 @@
 
 #include "core/globalDefs.h"
 #include "io/multiBlockReader3D.h"
+#include "io/multiBlockWriter3D.h"
 #include "io/mpiParallelIO.h"
 #include "parallelism/mpiManager.h"
 #include "libraryInterfaces/TINYXML_xmlIO.h"
@@ -64,6 +65,26 @@ void dumpRestoreData( MultiBlock3D& multiBlock, bool dynamicContent,
     multiBlock.getBlockCommunicator().duplicateOverlaps(multiBlock, typeOfVariables);
 }
 
+namespace {
+
+/// Version of dumpRestoreData() for files in format version 1, in which the
+///   dynamics objects were stored cell by cell.
+void dumpRestoreCellwiseData( MultiBlock3D& multiBlock, std::vector<plint> const& myBlockIds,
+                              std::vector<std::vector<char> > const& data,
+                              std::map<int,std::string> const& foreignIds )
+{
+    for (pluint iBlock=0; iBlock<myBlockIds.size(); ++iBlock) {
+        plint blockId = myBlockIds[iBlock];
+        SmartBulk3D bulk(multiBlock.getMultiBlockManagement(), blockId);
+        Box3D localBulk(bulk.toLocal(bulk.getBulk()));
+        AtomicBlock3D& block = multiBlock.getComponent(blockId);
+        block.getDataTransfer().receiveCellwise(localBulk, data[iBlock], foreignIds);
+    }
+    multiBlock.getBlockCommunicator().duplicateOverlaps(multiBlock, modif::dataStructure);
+}
+
+}  // namespace
+
 void createDynamicsForeignIds3D(FileName fName, std::map<int,std::string>& foreignIds)
 {
     foreignIds.clear();
@@ -136,7 +157,8 @@ void readXmlSpec (
     FileName fName, Box3D& boundingBox, std::vector<plint>& offsets,
     plint& envelopeWidth, plint& gridLevel, plint& cellDim,
     std::string& dataType, std::string& descriptor, std::string& family,
-    std::vector<Box3D>& components, bool& dynamicContent, FileName& data_fName )
+    std::vector<Box3D>& components, bool& dynamicContent, plint& formatVersion,
+    FileName& data_fName )
 {
     fName.defaultPath(global::directories().getInputDir());
     fName.setExt("plb");
@@ -157,6 +179,12 @@ void readXmlSpec (
     }
     reader["Block3D"]["General"]["cellDim"].read(cellDim);
     reader["Block3D"]["General"]["dynamicContent"].read(dynamicContent);
+    try {
+        reader["Block3D"]["General"]["formatVersion"].read(formatVersion);
+    }
+    catch(PlbIOException const&) {
+        formatVersion = 1;
+    }
     reader["Block3D"]["Structure"]["BoundingBox"].read<plint,6>(boundingBox_array);
     boundingBox.from_plbArray(boundingBox_array);
     reader["Block3D"]["Structure"]["NumComponents"].read(numComponents);
@@ -176,6 +204,10 @@ void readXmlSpec (
     }
 
 
+    if (formatVersion > multiBlockFormatVersion3D()) {
+        plbIOError(std::string("The file ")+fName.get()+
+                   std::string(" was written in a newer, unknown format."));
+    }
     if( (plint)offsets.size() != numComponents ) {
         plbIOError(std::string("Number of offsets does not match number of components in XML file."));
     }
@@ -221,8 +253,9 @@ MultiBlock3D* load3D(FileName fName)
     std::vector<Box3D> components;
     bool dynamicContent;
     plint cellDim;
+    plint formatVersion;
     readXmlSpec( fName, boundingBox, offsets, envelopeWidth, gridLevel, cellDim, dataType,
-                 descriptor, family, components, dynamicContent, data_fName );
+                 descriptor, family, components, dynamicContent, formatVersion, data_fName );
 
     SparseBlockStructure3D blockStructure(boundingBox);
     for( plint iComponent=0; iComponent<(plint)components.size(); ++iComponent) {
@@ -254,18 +287,209 @@ MultiBlock3D* load3D(FileName fName)
     loadRawData( data_fName, myBlockIds, offsets, data);
     std::map<int,std::string> foreignIds;
     createDynamicsForeignIds3D(fName, foreignIds);
-    dumpRestoreData(*newBlock, dynamicContent, myBlockIds, data, foreignIds);
+    // The dynamics objects were stored cell by cell in format version 1.
+    //   Static content has the same layout in all versions.
+    if (dynamicContent && formatVersion < 2) {
+        dumpRestoreCellwiseData(*newBlock, myBlockIds, data, foreignIds);
+    }
+    else {
+        dumpRestoreData(*newBlock, dynamicContent, myBlockIds, data, foreignIds);
+    }
     readXmlProcessors(fName, *newBlock);
     return newBlock;
 }
 
+namespace {
+
+/// Append the byte ranges of the cells of region, inside a saved component
+///   with cells of fixed size, in the order in which they are sent.
+void appendFixedSizeRanges( Box3D component, plint componentStart, plint cellSize, Box3D region,
+                            std::vector<plint>& offsets, std::vector<plint>& sizes )
+{
+    for (plint iX=region.x0; iX<=region.x1; ++iX) {
+        for (plint iY=region.y0; iY<=region.y1; ++iY) {
+            offsets.push_back( componentStart + cellSize * (
+                                   (region.z0-component.z0) + component.getNz() *
+                                   ( (iY-component.y0) + component.getNy()*(iX-component.x0) ) ) );
+            sizes.push_back(cellSize*region.getNz());
+        }
+    }
+}
+
+}  // namespace
+
+/** The data is read straight from the file into the local components of
+ *  intoBlock, whatever the decomposition with which it was saved. If the cells
+ *  have a fixed size, each component reads exactly the byte ranges it
+ *  overlaps. Otherwise (dynamics objects), the header of each saved component
+ *  it overlaps is read, followed by the byte ranges of the static data of the
+ *  overlap, if the static data is stored last (see
+ *  BlockDataTransfer3D::sendsStaticDataLast()). The saved components are
+ *  otherwise read in full, and the cells are extracted from them. The older
+ *  path through a temporary multi-block is used if the saved content differs
+ *  from the requested one, if the domains have different shapes, or if the
+ *  dynamics objects are stored cell by cell (format version 1).
+ */
 void load(FileName fName, MultiBlock3D& intoBlock, bool dynamicContent )
 {
-    std::auto_ptr<MultiBlock3D> loadedBlock ( load3D(fName) );
+    Box3D boundingBox;
+    std::vector<plint> offsets;
+    plint envelopeWidth, gridLevel;
+    std::string dataType, descriptor, family;
+    FileName data_fName;
+    std::vector<Box3D> components;
+    bool savedDynamicContent;
+    plint cellDim;
+    plint formatVersion;
+    readXmlSpec( fName, boundingBox, offsets, envelopeWidth, gridLevel, cellDim, dataType,
+                 descriptor, family, components, savedDynamicContent, formatVersion, data_fName );
     modif::ModifT typeOfVariables = dynamicContent ?
             modif::dataStructure : modif::staticVariables;
-    copy_generic( *loadedBlock, loadedBlock->getBoundingBox(),
-                  intoBlock, intoBlock.getBoundingBox(), typeOfVariables );
+
+    Box3D intoBoundingBox(intoBlock.getBoundingBox());
+    if ( savedDynamicContent!=dynamicContent ||
+         (savedDynamicContent && formatVersion < 2) ||
+         boundingBox.getNx()!=intoBoundingBox.getNx() ||
+         boundingBox.getNy()!=intoBoundingBox.getNy() ||
+         boundingBox.getNz()!=intoBoundingBox.getNz() )
+    {
+        std::auto_ptr<MultiBlock3D> loadedBlock ( load3D(fName) );
+        copy_generic( *loadedBlock, loadedBlock->getBoundingBox(),
+                      intoBlock, intoBlock.getBoundingBox(), typeOfVariables );
+        return;
+    }
+    plint deltaX = intoBoundingBox.x0-boundingBox.x0;
+    plint deltaY = intoBoundingBox.y0-boundingBox.y0;
+    plint deltaZ = intoBoundingBox.z0-boundingBox.z0;
+
+    plint cellSize = intoBlock.sizeOfCell();
+    bool fixedCellSize = true;
+    for (plint iComp=0; iComp<(plint)components.size(); ++iComp) {
+        plint compSize = offsets[iComp] - (iComp==0 ? 0 : offsets[iComp-1]);
+        fixedCellSize = fixedCellSize && compSize==components[iComp].nCells()*cellSize;
+    }
+    if (!fixedCellSize && !dynamicContent) {
+        plbIOError(std::string("The data in file ")+data_fName.get()+
+                   std::string(" does not match the cell size of the block."));
+    }
+
+    std::map<int,std::string> foreignIds;
+    createDynamicsForeignIds3D(fName, foreignIds);
+    MultiBlockManagement3D const& management = intoBlock.getMultiBlockManagement();
+    std::vector<plint> const& myBlocks = intoBlock.getLocalInfo().getBlocks();
+    // Saved components which overlap with the local components, and number of
+    //   overlaps. They are only needed if the cells have a variable size.
+    std::vector<plint> neededComponents;
+    plint numOverlaps = 0;
+    if (!fixedCellSize) {
+        for (plint iComp=0; iComp<(plint)components.size(); ++iComp) {
+            plint numCompOverlaps = 0;
+            for (pluint iBlock=0; iBlock<myBlocks.size(); ++iBlock) {
+                SmartBulk3D bulk(management, myBlocks[iBlock]);
+                Box3D region;
+                if (intersect(bulk.getBulk().shift(-deltaX,-deltaY,-deltaZ), components[iComp], region)) {
+                    ++numCompOverlaps;
+                }
+            }
+            if (numCompOverlaps>0) {
+                neededComponents.push_back(iComp);
+                numOverlaps += numCompOverlaps;
+            }
+        }
+    }
+    // If the static data of the cells follows a header, the size of the header
+    //   of each saved component results from the size of the component.
+    bool staticDataLast = !fixedCellSize && !myBlocks.empty() &&
+        intoBlock.getComponent(myBlocks[0]).getDataTransfer().sendsStaticDataLast(typeOfVariables);
+    plint staticCellSize = staticDataLast ?
+        intoBlock.getComponent(myBlocks[0]).getDataTransfer().staticCellSize() : 0;
+    std::vector<plint> headerSizes(components.size());
+    for (plint iComp=0; iComp<(plint)components.size(); ++iComp) {
+        plint compSize = offsets[iComp] - (iComp==0 ? 0 : offsets[iComp-1]);
+        headerSizes[iComp] = compSize - components[iComp].nCells()*staticCellSize;
+        if (headerSizes[iComp]<0) {
+            plbIOError(std::string("The data in file ")+data_fName.get()+
+                       std::string(" does not match the cell size of the block."));
+        }
+    }
+    plint numReads = fixedCellSize ? (plint)myBlocks.size() :
+                     (plint)neededComponents.size() + (staticDataLast ? numOverlaps : 0);
+    // With collective I/O, all processes must take part in the same number of reads.
+    plint maxNumReads = numReads;
+#ifdef PLB_MPI_PARALLEL
+    global::mpi().reduceAndBcast(maxNumReads, MPI_MAX);
+#endif
+
+    RawDataReader reader(data_fName);
+    std::vector<char> data, staticData, regionData;
+    if (fixedCellSize) {
+        // One read per local component, for the ranges of all saved
+        //   components it overlaps, in increasing file order.
+        for (pluint iBlock=0; iBlock<myBlocks.size(); ++iBlock) {
+            plint blockId = myBlocks[iBlock];
+            SmartBulk3D bulk(management, blockId);
+            Box3D savedBulk(bulk.getBulk().shift(-deltaX,-deltaY,-deltaZ));
+            std::vector<Box3D> regions;
+            std::vector<plint> rangeOffsets, rangeSizes;
+            for (plint iComp=0; iComp<(plint)components.size(); ++iComp) {
+                Box3D region;
+                if (intersect(savedBulk, components[iComp], region)) {
+                    plint compStart = iComp==0 ? 0 : offsets[iComp-1];
+                    appendFixedSizeRanges( components[iComp], compStart, cellSize, region,
+                                           rangeOffsets, rangeSizes );
+                    regions.push_back(region);
+                }
+            }
+            reader.read(rangeOffsets, rangeSizes, data);
+            AtomicBlock3D& block = intoBlock.getComponent(blockId);
+            plint pos = 0;
+            for (pluint iRegion=0; iRegion<regions.size(); ++iRegion) {
+                plint regionSize = regions[iRegion].nCells()*cellSize;
+                regionData.assign(data.begin()+pos, data.begin()+pos+regionSize);
+                pos += regionSize;
+                Box3D localRegion(bulk.toLocal(regions[iRegion].shift(deltaX,deltaY,deltaZ)));
+                block.getDataTransfer().receive(localRegion, regionData, typeOfVariables, foreignIds);
+            }
+        }
+    }
+    else {
+        // The cell boundaries are only known after parsing the data: the
+        //   header of each saved component (or the full component) is read
+        //   once, and distributed to all local components which overlap with it.
+        for (pluint iNeeded=0; iNeeded<neededComponents.size(); ++iNeeded) {
+            plint iComp = neededComponents[iNeeded];
+            plint compStart = iComp==0 ? 0 : offsets[iComp-1];
+            reader.read( std::vector<plint>(1, compStart),
+                         std::vector<plint>(1, headerSizes[iComp]), data );
+            for (pluint iBlock=0; iBlock<myBlocks.size(); ++iBlock) {
+                plint blockId = myBlocks[iBlock];
+                SmartBulk3D bulk(management, blockId);
+                Box3D region;
+                if (intersect(bulk.getBulk().shift(-deltaX,-deltaY,-deltaZ), components[iComp], region)) {
+                    AtomicBlock3D& block = intoBlock.getComponent(blockId);
+                    if (staticDataLast) {
+                        std::vector<plint> rangeOffsets, rangeSizes;
+                        appendFixedSizeRanges( components[iComp], compStart+headerSizes[iComp],
+                                               staticCellSize, region, rangeOffsets, rangeSizes );
+                        reader.read(rangeOffsets, rangeSizes, staticData);
+                        block.getDataTransfer().extractFromHeader( components[iComp], data, typeOfVariables,
+                                                                   region, staticData, regionData );
+                    }
+                    else {
+                        block.getDataTransfer().extract( components[iComp], data, typeOfVariables,
+                                                         region, regionData );
+                    }
+                    Box3D localRegion(bulk.toLocal(region.shift(deltaX,deltaY,deltaZ)));
+                    block.getDataTransfer().receive(localRegion, regionData, typeOfVariables, foreignIds);
+                }
+            }
+        }
+    }
+    std::vector<plint> noRanges;
+    for (; numReads<maxNumReads; ++numReads) {
+        reader.read(noRanges, noRanges, data);
+    }
+    intoBlock.getBlockCommunicator().duplicateOverlaps(intoBlock, typeOfVariables);
 }
 
 
@@ -35,12 +35,14 @@
 #include "core/util.h"
 #include "core/plbProfiler.h"
 #include "core/plbTypenames.h"
+#include "core/runTimeDiagnostics.h"
 #include "core/multiBlockIdentifiers3D.h"
 #include "core/processorIdentifiers3D.h"
 #include "multiBlock/nonLocalTransfer3D.h"
 #include "multiBlock/multiBlockOperations3D.h"
 #include "io/plbFiles.h"
 #include <numeric>
+#include <sstream>
 #include <algorithm>
 #include <memory>
 
@@ -50,8 +52,20 @@ namespace parallelIO {
 
 /***** 1. Multi-Block Writer **************************************************/
 
+plint multiBlockFormatVersion3D() {
+    return 2;
+}
+
 void writeXmlSpec( MultiBlock3D& multiBlock, FileName fName,
                    std::vector<plint> const& offset, bool dynamicContent )
+{
+    XMLwriter xml;
+    createXmlSpec(multiBlock, fName, offset, dynamicContent, xml);
+    xml.print(FileName(fName).setExt("plb").defaultPath(global::directories().getOutputDir()));
+}
+
+void createXmlSpec( MultiBlock3D& multiBlock, FileName fName,
+                    std::vector<plint> const& offset, bool dynamicContent, XMLwriter& xml )
 {
     fName.setExt("plb");
     MultiBlockManagement3D const& management = multiBlock.getMultiBlockManagement();
@@ -61,7 +75,6 @@ void writeXmlSpec( MultiBlock3D& multiBlock, FileName fName,
     std::string blockName = multiBlock.getBlockName();
     PLB_ASSERT( !typeInfo.empty() );
 
-    XMLwriter xml;
     XMLwriter& xmlMultiBlock = xml["Block3D"];
     xmlMultiBlock["General"]["Family"].setString(blockName);
     xmlMultiBlock["General"]["Datatype"].setString(typeInfo[0]);
@@ -70,6 +83,7 @@ void writeXmlSpec( MultiBlock3D& multiBlock, FileName fName,
     }
     xmlMultiBlock["General"]["cellDim"].set(multiBlock.getCellDim());
     xmlMultiBlock["General"]["dynamicContent"].set(dynamicContent);
+    xmlMultiBlock["General"]["formatVersion"].set(multiBlockFormatVersion3D());
     xmlMultiBlock["General"]["globalId"].set(multiBlock.getId());
 
     Array<plint,6> boundingBox = multiBlock.getBoundingBox().to_plbArray();
@@ -133,7 +147,6 @@ void writeXmlSpec( MultiBlock3D& multiBlock, FileName fName,
             xmlProcessors[iProcessor]["Blocks"].set(processors[iProcessor].getMultiBlockIds());
         }
     }
-    xml.print(FileName(fName).defaultPath(global::directories().getOutputDir()));
 }
 
 void writeOneBlockXmlSpec( MultiBlock3D const& multiBlock, FileName fName, plint dataSize,
@@ -200,7 +213,7 @@ void transposeToBackward(plint sizeOfCell, Box3D const& domain, std::vector<char
 
 void save( MultiBlock3D& multiBlock, FileName fName, bool dynamicContent )
 {
-    global::profiler().start("io");
+    global::profiler().start(global::prof::io);
     std::vector<plint> offset;
     std::vector<plint> myBlockIds;
     std::vector<std::vector<char> > data;
@@ -209,12 +222,60 @@ void save( MultiBlock3D& multiBlock, FileName fName, bool dynamicContent )
 
     writeXmlSpec(multiBlock, fName, offset, dynamicContent);
     writeRawData(fName, myBlockIds, offset, data);
-    global::profiler().stop("io");
+    global::profiler().stop(global::prof::io);
+}
+
+void saveAsynchronously( MultiBlock3D& multiBlock, FileName fName, bool dynamicContent )
+{
+    saveAsynchronously( std::vector<MultiBlock3D*>(1, &multiBlock),
+                        std::vector<FileName>(1, fName), dynamicContent );
+}
+
+void saveAsynchronously( std::vector<MultiBlock3D*> multiBlocks, std::vector<FileName> fNames,
+                         bool dynamicContent )
+{
+    global::profiler().start(global::prof::io);
+    stageAsynchronousSave(multiBlocks, fNames, dynamicContent);
+    asyncRawDataWriter().start();
+    global::profiler().stop(global::prof::io);
+}
+
+void stageAsynchronousSave( std::vector<MultiBlock3D*> multiBlocks, std::vector<FileName> fNames,
+                            bool dynamicContent )
+{
+    PLB_PRECONDITION( multiBlocks.size()==fNames.size() );
+    AsyncRawDataWriter& writer = asyncRawDataWriter();
+    // The snapshot is taken while the previous files may still be written.
+    for (pluint iBlock=0; iBlock<multiBlocks.size(); ++iBlock) {
+        std::vector<plint> offset;
+        std::vector<plint> myBlockIds;
+        std::vector<std::vector<char> > data;
+        writer.recycleBuffers(data);
+
+        dumpData(*multiBlocks[iBlock], dynamicContent, offset, myBlockIds, data);
+
+        // The XML file is only written once the data is complete.
+        XMLwriter xml;
+        createXmlSpec(*multiBlocks[iBlock], fNames[iBlock], offset, dynamicContent, xml);
+        std::ostringstream xmlContent;
+        xml.toOutputStream(xmlContent);
+        writer.stageDescription (
+                FileName(fNames[iBlock]).setExt("plb").defaultPath(global::directories().getOutputDir()),
+                xmlContent.str() );
+        writer.stage(fNames[iBlock], myBlockIds, offset, data);
+    }
+}
+
+void waitForAsynchronousSave()
+{
+    global::profiler().start(global::prof::io);
+    asyncRawDataWriter().wait();
+    global::profiler().stop(global::prof::io);
 }
 
 void saveFull( MultiBlock3D& multiBlock, FileName fName, IndexOrdering::OrderingT ordering, bool appendMode )
 {
-    global::profiler().start("io");
+    global::profiler().start(global::prof::io);
     SparseBlockStructure3D blockStructure(multiBlock.getBoundingBox());
     Box3D bbox = multiBlock.getBoundingBox();
     if (ordering==IndexOrdering::forward) {
@@ -269,7 +330,7 @@ void saveFull( MultiBlock3D& multiBlock, FileName fName, IndexOrdering::Ordering
     }
     writeRawData(fName, myBlockIds, offset, data, appendMode);
     delete multiAdjacentBlock;
-    global::profiler().stop("io");
+    global::profiler().stop(global::prof::io);
 }
 
 void dumpData( MultiBlock3D& multiBlock, bool dynamicContent,
@@ -277,6 +338,9 @@ void dumpData( MultiBlock3D& multiBlock, bool dynamicContent,
                std::vector<std::vector<char> >& data )
 {
     MultiBlockManagement3D const& management = multiBlock.getMultiBlockManagement();
+    if (management.isPartial()) {
+        plbLogicError("A multi-block with a partial management cannot be saved.");
+    }
     std::map<plint,Box3D> const& bulks = management.getSparseBlockStructure().getBulks();
 
     plint numBlocks = (plint) bulks.size();
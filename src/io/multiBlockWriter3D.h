@@ -33,15 +33,47 @@
 #include "multiBlock/multiBlock3D.h"
 #include "core/serializer.h"
 #include "io/plbFiles.h"
+#include "libraryInterfaces/TINYXML_xmlIO.h"
 
 namespace plb {
 
 
 namespace parallelIO {
 
+/// Version of the file format written by save(), recorded in the .plb file.
+/** Version 2 encodes the dynamics objects of a block-lattice as a dictionary
+ *  per block. The files of version 1, which store them cell by cell, carry
+ *  no version number. Both versions can be read by load().
+ */
+plint multiBlockFormatVersion3D();
+
 void save( MultiBlock3D& multiBlock, FileName fName,
            bool dynamicContent = true );
 
+/// Save the multi-block like save(), but write the data in the background.
+/** The data is copied into a staging buffer, and the function returns while
+ *  the file is being written, so the simulation can continue. The multi-blocks
+ *  can be modified freely in the meantime. The files (.dat and .plb) only
+ *  appear after the next call to waitForAsynchronousSave() or to
+ *  saveAsynchronously(), once the data is completely written, or at the end
+ *  of the program at the latest.
+ */
+void saveAsynchronously( MultiBlock3D& multiBlock, FileName fName,
+                         bool dynamicContent = true );
+
+/// Save several multi-blocks in the background, into one file each.
+void saveAsynchronously( std::vector<MultiBlock3D*> multiBlocks, std::vector<FileName> fNames,
+                         bool dynamicContent = true );
+
+/// Stage the data of several multi-blocks for an asynchronous save, without
+///   starting to write it (see AsyncRawDataWriter).
+void stageAsynchronousSave( std::vector<MultiBlock3D*> multiBlocks, std::vector<FileName> fNames,
+                            bool dynamicContent = true );
+
+/// Wait until the data of the asynchronous saves is written to disk, and
+///   publish the files.
+void waitForAsynchronousSave();
+
 void saveFull( MultiBlock3D& multiBlock, FileName fName,
                IndexOrdering::OrderingT=IndexOrdering::forward, bool appendMode=false );
 
@@ -60,9 +92,17 @@ void dumpData( MultiBlock3D& multiBlock, bool dynamicContent,
                std::vector<plint>& offset, std::vector<plint>& myBlockIds,
                std::vector<std::vector<char> >& data );
 
+/// Reorder the data of a domain, with cells of sizeOfCell bytes, from
+///   z-fastest (forward) to x-fastest (backward) index ordering.
+void transposeToBackward(plint sizeOfCell, Box3D const& domain, std::vector<char>& data);
+
 void writeXmlSpec( MultiBlock3D& multiBlock, FileName fName,
                    std::vector<plint> const& offset, bool dynamicContent );
 
+/// Build the content of the .plb file written by writeXmlSpec().
+void createXmlSpec( MultiBlock3D& multiBlock, FileName fName,
+                    std::vector<plint> const& offset, bool dynamicContent, XMLwriter& xml );
+
 }  // namespace parallelIO
 
 }  // namespace plb
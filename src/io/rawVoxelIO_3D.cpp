@@ -0,0 +1,252 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+ * Raw voxel files, read through memory maps -- implementation.
+ */
+
+#include "io/rawVoxelIO_3D.h"
+#include "core/runTimeDiagnostics.h"
+#include "parallelism/mpiManager.h"
+#include <cstring>
+
+#ifdef PLB_USE_POSIX
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace plb {
+
+/* *************** Class RawVoxelFile3D ************************************* */
+
+/** The header consists of the magic word "PLBVOXEL", followed by the
+ *  8-byte integers version, x0, x1, y0, y1, z0, z1 and bytesPerVoxel,
+ *  and is padded with zeros to headerSize bytes.
+ */
+static const char rawVoxelMagic[8] = { 'P','L','B','V','O','X','E','L' };
+static const long long rawVoxelVersion = 1;
+
+const plint RawVoxelFile3D::headerSize;
+
+#ifndef PLB_USE_POSIX
+static bool seekFile(FILE* fp, plint offset)
+{
+#if defined PLB_MAC_OS_X || defined PLB_BSD
+    return fseek(fp, (long int)offset, SEEK_SET) == 0;
+#else
+    return fseeko64(fp, offset, SEEK_SET) == 0;
+#endif
+}
+#endif
+
+RawVoxelFile3D::RawVoxelFile3D(FileName fName_)
+    : fName(fName_),
+      bytesPerVoxel(0),
+#ifdef PLB_USE_POSIX
+      fd(-1)
+#else
+      fp(0)
+#endif
+{
+    // The header is read by the main process only, to avoid that thousands
+    //   of processes hit the file system at the same time.
+    long long info[8];
+    std::memset(info, 0, 8*sizeof(long long));
+    if (global::mpi().isMainProcessor()) {
+        char header[headerSize];
+        FILE* headerFp = fopen(fName.get().c_str(), "rb");
+        if (headerFp) {
+            if ( fread(header, 1, headerSize, headerFp) == (size_t)headerSize &&
+                 std::memcmp(header, rawVoxelMagic, 8) == 0 )
+            {
+                std::memcpy(info, header+8, 8*sizeof(long long));
+            }
+            fclose(headerFp);
+        }
+    }
+    global::mpi().bCast(info, 8);
+    plbIOError( info[0]!=rawVoxelVersion || (info[7]!=1 && info[7]!=2 && info[7]!=4 && info[7]!=8),
+                std::string("Could not read the header of raw voxel file ")+fName.get() );
+    boundingBox = Box3D(info[1], info[2], info[3], info[4], info[5], info[6]);
+    bytesPerVoxel = info[7];
+
+    bool errorFlag = false;
+#ifdef PLB_USE_POSIX
+    fd = open(fName.get().c_str(), O_RDONLY);
+    errorFlag = fd<0;
+#else
+    fp = fopen(fName.get().c_str(), "rb");
+    errorFlag = !fp;
+#endif
+    plbIOError(errorFlag, std::string("Could not open raw voxel file ")+fName.get());
+}
+
+RawVoxelFile3D::RawVoxelFile3D(FileName fName_, Box3D boundingBox_, plint bytesPerVoxel_)
+    : fName(fName_),
+      boundingBox(boundingBox_),
+      bytesPerVoxel(bytesPerVoxel_),
+#ifdef PLB_USE_POSIX
+      fd(-1)
+#else
+      fp(0)
+#endif
+{
+    PLB_PRECONDITION( bytesPerVoxel==1 || bytesPerVoxel==2 || bytesPerVoxel==4 || bytesPerVoxel==8 );
+    plint fileSize = headerSize + boundingBox.nCells()*bytesPerVoxel;
+    // The main process creates the file at its full size; the other processes
+    //   open it once this is done.
+    bool errorFlag = false;
+    if (global::mpi().isMainProcessor()) {
+        char header[headerSize];
+        std::memset(header, 0, headerSize);
+        long long info[8] = { rawVoxelVersion, boundingBox.x0, boundingBox.x1,
+                              boundingBox.y0, boundingBox.y1, boundingBox.z0, boundingBox.z1,
+                              bytesPerVoxel };
+        std::memcpy(header, rawVoxelMagic, 8);
+        std::memcpy(header+8, info, 8*sizeof(long long));
+#ifdef PLB_USE_POSIX
+        fd = open(fName.get().c_str(), O_RDWR|O_CREAT|O_TRUNC, 0644);
+        errorFlag = fd<0 ||
+                    pwrite(fd, header, headerSize, 0) != (ssize_t)headerSize ||
+                    ftruncate(fd, (off_t)fileSize) != 0;
+#else
+        fp = fopen(fName.get().c_str(), "w+b");
+        char zero = 0;
+        errorFlag = !fp ||
+                    fwrite(header, 1, headerSize, fp) != (size_t)headerSize ||
+                    !seekFile(fp, fileSize-1) ||
+                    fwrite(&zero, 1, 1, fp) != 1;
+#endif
+    }
+    plbMainProcIOError(errorFlag, std::string("Could not create raw voxel file ")+fName.get());
+    if (!global::mpi().isMainProcessor()) {
+#ifdef PLB_USE_POSIX
+        fd = open(fName.get().c_str(), O_WRONLY);
+        errorFlag = fd<0;
+#else
+        fp = fopen(fName.get().c_str(), "r+b");
+        errorFlag = !fp;
+#endif
+    }
+    plbIOError(errorFlag, std::string("Could not open raw voxel file ")+fName.get());
+}
+
+RawVoxelFile3D::~RawVoxelFile3D()
+{
+    closeFile();
+}
+
+void RawVoxelFile3D::closeFile()
+{
+#ifdef PLB_USE_POSIX
+    if (fd>=0) {
+        close(fd);
+        fd = -1;
+    }
+#else
+    if (fp) {
+        fclose(fp);
+        fp = 0;
+    }
+#endif
+}
+
+plint RawVoxelFile3D::getOffset(plint iX, plint iY, plint iZ) const
+{
+    return headerSize + ( ( (iX-boundingBox.x0)*boundingBox.getNy() + (iY-boundingBox.y0) )
+                          * boundingBox.getNz() + (iZ-boundingBox.z0) ) * bytesPerVoxel;
+}
+
+/** With POSIX support, the x-slabs which intersect the domain are mapped
+ *  into memory, and the z-lines of the domain are copied out of the map.
+ *  Only the pages which hold these lines are faulted in.
+ */
+bool RawVoxelFile3D::readVoxels(Box3D domain, std::vector<char>& data) const
+{
+    PLB_PRECONDITION( contained(domain, boundingBox) );
+    plint lineSize = domain.getNz()*bytesPerVoxel;
+    data.resize(domain.nCells()*bytesPerVoxel);
+#ifdef PLB_USE_POSIX
+    plint pageSize = (plint) sysconf(_SC_PAGESIZE);
+    plint begin = getOffset(domain.x0, domain.y0, domain.z0);
+    plint end = getOffset(domain.x1, domain.y1, domain.z1) + bytesPerVoxel;
+    plint mapBegin = begin - begin%pageSize;
+    void* map = mmap(0, (size_t)(end-mapBegin), PROT_READ, MAP_PRIVATE, fd, (off_t)mapBegin);
+    if (map==MAP_FAILED) {
+        return false;
+    }
+    char const* mapData = (char const*)map;
+    plint pos = 0;
+    for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
+        for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
+            std::memcpy(&data[pos], mapData+getOffset(iX,iY,domain.z0)-mapBegin, lineSize);
+            pos += lineSize;
+        }
+    }
+    munmap(map, (size_t)(end-mapBegin));
+    return true;
+#else
+    bool errorFlag = false;
+    plint pos = 0;
+    for (plint iX=domain.x0; iX<=domain.x1 && !errorFlag; ++iX) {
+        for (plint iY=domain.y0; iY<=domain.y1 && !errorFlag; ++iY) {
+            errorFlag = !seekFile(fp, getOffset(iX,iY,domain.z0)) ||
+                        fread(&data[pos], 1, lineSize, fp) != (size_t)lineSize;
+            pos += lineSize;
+        }
+    }
+    return !errorFlag;
+#endif
+}
+
+/** The z-lines are written one by one with positioned writes. Memory maps
+ *  are not used for writing, because the pages at the boundary between two
+ *  blocks would be written back by two processes.
+ */
+bool RawVoxelFile3D::writeVoxels(Box3D domain, std::vector<char> const& data)
+{
+    PLB_PRECONDITION( contained(domain, boundingBox) );
+    PLB_PRECONDITION( (plint)data.size() == domain.nCells()*bytesPerVoxel );
+    plint lineSize = domain.getNz()*bytesPerVoxel;
+    bool errorFlag = false;
+    plint pos = 0;
+    for (plint iX=domain.x0; iX<=domain.x1 && !errorFlag; ++iX) {
+        for (plint iY=domain.y0; iY<=domain.y1 && !errorFlag; ++iY) {
+#ifdef PLB_USE_POSIX
+            errorFlag = pwrite(fd, &data[pos], lineSize, (off_t)getOffset(iX,iY,domain.z0))
+                            != (ssize_t)lineSize;
+#else
+            errorFlag = !seekFile(fp, getOffset(iX,iY,domain.z0)) ||
+                        fwrite(&data[pos], 1, lineSize, fp) != (size_t)lineSize;
+#endif
+            pos += lineSize;
+        }
+    }
+    return !errorFlag;
+}
+
+}  // namespace plb
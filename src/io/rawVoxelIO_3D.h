@@ -0,0 +1,117 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+ * Raw voxel files, read through memory maps -- header file.
+ */
+
+#ifndef RAW_VOXEL_IO_3D_H
+#define RAW_VOXEL_IO_3D_H
+
+#include "core/globalDefs.h"
+#include "core/geometry3D.h"
+#include "io/plbFiles.h"
+#include "multiBlock/multiDataField3D.h"
+#include <cstdio>
+#include <vector>
+#include <memory>
+
+namespace plb {
+
+/// Raw voxel file: a fixed header, followed by the voxels of a box.
+/** The voxels are signed integers of 1, 2, 4 or 8 bytes, stored without
+ *  any encoding in x-major order (z is the fastest index). This is the
+ *  format of choice for large flag matrices, such as the ones produced by
+ *  the voxelizer: every process reads only the voxels of its own blocks,
+ *  through a memory map of the x-slabs which intersect them, so that no
+ *  data is funneled through the main process.
+ *
+ *  The header is read by the main process and broadcast. All processes
+ *  must construct the object, but the reads and writes of voxels are local.
+ *  Without POSIX support (PLB_USE_POSIX), the voxels are read line by line
+ *  with the standard C I/O.
+ */
+class RawVoxelFile3D {
+public:
+    /// Open an existing file for reading.
+    RawVoxelFile3D(FileName fName_);
+    /// Create a new file for the voxels of boundingBox, and open it for
+    ///   writing. The content of the voxels is undefined until they are
+    ///   written.
+    RawVoxelFile3D(FileName fName_, Box3D boundingBox_, plint bytesPerVoxel_);
+    ~RawVoxelFile3D();
+    Box3D getBoundingBox() const { return boundingBox; }
+    plint getBytesPerVoxel() const { return bytesPerVoxel; }
+    /// Read the voxels of all blocks of the multi-scalar-field, envelopes
+    ///   included, as far as they overlap with the file.
+    template<typename T>
+    void read(MultiScalarField3D<T>& field) const;
+    /// Write the bulk of all blocks of the multi-scalar-field, as far as it
+    ///   overlaps with the file. The values are rounded to integers.
+    template<typename T>
+    void write(MultiScalarField3D<T> const& field);
+    /// Read the raw voxels of a domain, in x-major order. Returns false
+    ///   on failure. This function is not collective.
+    bool readVoxels(Box3D domain, std::vector<char>& data) const;
+    /// Write the raw voxels of a domain, in x-major order. Returns false
+    ///   on failure. This function is not collective.
+    bool writeVoxels(Box3D domain, std::vector<char> const& data);
+private:
+    RawVoxelFile3D(RawVoxelFile3D const& rhs);
+    RawVoxelFile3D& operator=(RawVoxelFile3D const& rhs);
+    plint getOffset(plint iX, plint iY, plint iZ) const;
+    void closeFile();
+    template<typename T>
+    static T decodeVoxel(char const* voxel, plint bytesPerVoxel);
+    template<typename T>
+    static void encodeVoxel(T value, char* voxel, plint bytesPerVoxel);
+private:
+    FileName fName;
+    Box3D boundingBox;
+    plint bytesPerVoxel;
+#ifdef PLB_USE_POSIX
+    int fd;
+#else
+    FILE* fp;
+#endif
+public:
+    static const plint headerSize = 128;
+};
+
+/// Create a multi-scalar-field on the bounding-box of a raw voxel file, with
+///   the default data distribution, and read the voxels. Every process reads
+///   only the voxels of its own blocks.
+template<typename T>
+std::auto_ptr<MultiScalarField3D<T> > loadRawVoxelMatrix (
+        RawVoxelFile3D const& voxelFile, plint envelopeWidth=1 );
+
+/// Save a multi-scalar-field, typically a flag matrix, into a raw voxel file.
+template<typename T>
+void saveRawVoxelMatrix(MultiScalarField3D<T> const& field, FileName fName,
+                        plint bytesPerVoxel=1);
+
+}  // namespace plb
+
+#endif  // RAW_VOXEL_IO_3D_H
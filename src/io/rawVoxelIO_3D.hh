@@ -0,0 +1,186 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+ * Raw voxel files, read through memory maps -- generic implementation.
+ */
+
+#ifndef RAW_VOXEL_IO_3D_HH
+#define RAW_VOXEL_IO_3D_HH
+
+#include "io/rawVoxelIO_3D.h"
+#include "core/runTimeDiagnostics.h"
+#include "core/plbProfiler.h"
+#include "multiBlock/multiBlockManagement3D.h"
+#include "multiBlock/multiBlockGenerator3D.h"
+#include "atomicBlock/dataField3D.h"
+#include <cstring>
+
+namespace plb {
+
+template<typename T>
+T RawVoxelFile3D::decodeVoxel(char const* voxel, plint bytesPerVoxel)
+{
+    switch (bytesPerVoxel) {
+        case 1: {
+            signed char value;
+            std::memcpy(&value, voxel, 1);
+            return (T) value;
+        }
+        case 2: {
+            short value;
+            std::memcpy(&value, voxel, 2);
+            return (T) value;
+        }
+        case 4: {
+            int value;
+            std::memcpy(&value, voxel, 4);
+            return (T) value;
+        }
+        default: {
+            long long value;
+            std::memcpy(&value, voxel, 8);
+            return (T) value;
+        }
+    }
+}
+
+template<typename T>
+void RawVoxelFile3D::encodeVoxel(T value, char* voxel, plint bytesPerVoxel)
+{
+    // Round to the nearest integer; for integer types, (T)0.5 is zero.
+    long long intValue = value<T() ? (long long)(value-(T)0.5) : (long long)(value+(T)0.5);
+    switch (bytesPerVoxel) {
+        case 1: {
+            signed char rawValue = (signed char) intValue;
+            std::memcpy(voxel, &rawValue, 1);
+            break;
+        }
+        case 2: {
+            short rawValue = (short) intValue;
+            std::memcpy(voxel, &rawValue, 2);
+            break;
+        }
+        case 4: {
+            int rawValue = (int) intValue;
+            std::memcpy(voxel, &rawValue, 4);
+            break;
+        }
+        default: {
+            std::memcpy(voxel, &intValue, 8);
+        }
+    }
+}
+
+template<typename T>
+void RawVoxelFile3D::read(MultiScalarField3D<T>& field) const
+{
+    global::profiler().start(global::prof::io);
+    MultiBlockManagement3D const& management = field.getMultiBlockManagement();
+    std::vector<plint> const& localBlocks = management.getLocalInfo().getBlocks();
+    plint envelopeWidth = management.getEnvelopeWidth();
+    std::vector<char> data;
+    bool errorFlag = false;
+    for (pluint iBlock=0; iBlock<localBlocks.size() && !errorFlag; ++iBlock) {
+        plint blockId = localBlocks[iBlock];
+        Box3D domain;
+        if (!intersect(management.getBulk(blockId).enlarge(envelopeWidth), boundingBox, domain)) {
+            continue;
+        }
+        errorFlag = !readVoxels(domain, data);
+        if (errorFlag) {
+            break;
+        }
+        ScalarField3D<T>& component = field.getComponent(blockId);
+        Dot3D location = component.getLocation();
+        char const* voxel = &data[0];
+        for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
+            for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
+                for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
+                    component.get(iX-location.x, iY-location.y, iZ-location.z) =
+                        decodeVoxel<T>(voxel, bytesPerVoxel);
+                    voxel += bytesPerVoxel;
+                }
+            }
+        }
+    }
+    plbIOError(errorFlag, std::string("Could not read voxels from file ")+fName.get());
+    global::profiler().stop(global::prof::io);
+}
+
+template<typename T>
+void RawVoxelFile3D::write(MultiScalarField3D<T> const& field)
+{
+    global::profiler().start(global::prof::io);
+    MultiBlockManagement3D const& management = field.getMultiBlockManagement();
+    std::vector<plint> const& localBlocks = management.getLocalInfo().getBlocks();
+    std::vector<char> data;
+    bool errorFlag = false;
+    for (pluint iBlock=0; iBlock<localBlocks.size() && !errorFlag; ++iBlock) {
+        plint blockId = localBlocks[iBlock];
+        Box3D domain;
+        if (!intersect(management.getBulk(blockId), boundingBox, domain)) {
+            continue;
+        }
+        ScalarField3D<T> const& component = field.getComponent(blockId);
+        Dot3D location = component.getLocation();
+        data.resize(domain.nCells()*bytesPerVoxel);
+        char* voxel = &data[0];
+        for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
+            for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
+                for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
+                    encodeVoxel<T>(component.get(iX-location.x, iY-location.y, iZ-location.z),
+                                   voxel, bytesPerVoxel);
+                    voxel += bytesPerVoxel;
+                }
+            }
+        }
+        errorFlag = !writeVoxels(domain, data);
+    }
+    plbIOError(errorFlag, std::string("Could not write voxels to file ")+fName.get());
+    global::profiler().stop(global::prof::io);
+}
+
+template<typename T>
+std::auto_ptr<MultiScalarField3D<T> > loadRawVoxelMatrix (
+        RawVoxelFile3D const& voxelFile, plint envelopeWidth )
+{
+    std::auto_ptr<MultiScalarField3D<T> > field =
+        generateMultiScalarField<T>(voxelFile.getBoundingBox(), envelopeWidth);
+    voxelFile.read(*field);
+    return field;
+}
+
+template<typename T>
+void saveRawVoxelMatrix(MultiScalarField3D<T> const& field, FileName fName,
+                        plint bytesPerVoxel)
+{
+    RawVoxelFile3D voxelFile(fName, field.getBoundingBox(), bytesPerVoxel);
+    voxelFile.write(field);
+}
+
+}  // namespace plb
+
+#endif  // RAW_VOXEL_IO_3D_HH
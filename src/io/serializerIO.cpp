@@ -103,9 +103,9 @@ void Base64Writer::writeHeader(pluint dataSize) {
 
 void Base64Writer::writeData(char const* dataBuffer, pluint bufferSize)
 {
-    global::profiler().start("io");
+    global::profiler().start(global::prof::io);
     dataEncoder->encode(dataBuffer, bufferSize);
-    global::profiler().stop("io");
+    global::profiler().stop(global::prof::io);
 }
 
 
@@ -143,9 +143,9 @@ void RawBinaryWriter::writeHeader(pluint dataSize) {
 
 void RawBinaryWriter::writeData(char const* dataBuffer, pluint bufferSize)
 {
-    global::profiler().start("io");
+    global::profiler().start(global::prof::io);
     ostr->write(dataBuffer, (int)bufferSize);
-    global::profiler().stop("io");
+    global::profiler().stop(global::prof::io);
 }
 
 
@@ -217,9 +217,9 @@ void Base64Reader::readHeader(pluint dataSize) const {
 
 void Base64Reader::readData(char* dataBuffer, pluint bufferSize) const
 {
-    global::profiler().start("io");
+    global::profiler().start(global::prof::io);
     dataDecoder->decode(dataBuffer, bufferSize);
-    global::profiler().stop("io");
+    global::profiler().stop(global::prof::io);
 }
 
 
@@ -28,14 +28,56 @@
 #include "core/array.h"
 #include "core/globalDefs.h"
 #include "core/geometry3D.h"
+#include "atomicBlock/dataProcessingFunctional3D.h"
 #include "multiBlock/multiBlockLattice3D.h"
 #include "multiBlock/multiDataField3D.h"
 #include "io/plbFiles.h"
 
 #include <string>
+#include <vector>
 
 namespace plb {
 
+template<typename T, template<typename U> class Descriptor> class TransientStatistics3D;
+
+/* ***************** Transient Statistics Update ************************** */
+
+/// Update all the registered statistics of a TransientStatistics3D in a single
+///   pass over the lattice.
+/** The moments of each cell are computed once, and every registered statistic is
+ *  updated from them. The standard deviation is accumulated with Welford's
+ *  algorithm. The vorticity is computed from the velocity of the neighboring
+ *  cells, which is kept in a rolling buffer of three x-slices, so that the
+ *  lattice envelope must be up to date. Block 0 is the lattice, and the
+ *  following blocks are the statistics, in the order of registration.
+ */
+template<typename T, template<typename U> class Descriptor>
+class TransientStatisticsFunctional3D : public BoxProcessingFunctional3D {
+public:
+    /// Take the n-th sample of the statistics.
+    TransientStatisticsFunctional3D(TransientStatistics3D<T,Descriptor> const& statistics, plint n_);
+    /// Take a sample every period iterations, after n0 samples taken until the
+    ///   lattice time startTime.
+    TransientStatisticsFunctional3D(TransientStatistics3D<T,Descriptor> const& statistics,
+                                    plint n0_, plint startTime_, plint period_);
+    virtual void processGenericBlocks(Box3D domain, std::vector<AtomicBlock3D*> blocks);
+    virtual TransientStatisticsFunctional3D<T,Descriptor>* clone() const;
+    virtual void getTypeOfModification(std::vector<modif::ModifT>& modified) const;
+    virtual BlockDomain::DomainT appliesTo() const;
+private:
+    void registerStatistics(TransientStatistics3D<T,Descriptor> const& statistics);
+    void computeVelocitySlab(BlockLattice3D<T,Descriptor>& lattice, plint iX, Box3D const& velocityDomain);
+    Array<T,3> const& getVelocity(plint iX, plint iY, plint iZ, Box3D const& velocityDomain) const;
+    T derivative(plint iX, plint iY, plint iZ, int direction, int iD, Box3D const& velocityDomain) const;
+private:
+    std::vector<int> fields, operations;    // Field and operation of each statistics block.
+    bool needsVelocity, needsDensity, needsVorticity;
+    Box3D enlargedDomain;                   // Domain of the velocity used for the vorticity.
+    plint n0, startTime, period;
+    plint lastSampleTime;
+    std::vector<Array<T,3> > velocitySlabs; // Velocity in the slices iX-1, iX and iX+1.
+};
+
 /* ***************** Transient Statistics Manager ************************* */
 
 template<typename T, template<typename U> class Descriptor>
@@ -58,7 +100,21 @@ public:
     // "min", "max", "ave" (for mean value), "rms", "dev" (for standard deviation).
     bool registerFieldOperation(std::string field, std::string operation);
     void initialize();
+    // Take one sample of all the registered statistics, right after an iteration.
     void update();
+    // Take a sample of all the registered statistics every "period" iterations, through
+    // an internal data processor of the lattice, at the given processor level. A level
+    // of at least 1 is needed for the vorticity, whose computation reads the envelope of
+    // the lattice. After this call, update() must not be called any more.
+    //
+    // The processor modifies no block, so that it does not prevent the overlapped or
+    // stream-only communication of the lattice (see MultiBlock3D::overlapsCommunication()).
+    // It is then executed after the envelope update, at any level.
+    void integrateUpdate(plint period, plint level);
+    // Same as above, at level 1 if a vorticity is registered, and at level 0 otherwise.
+    void integrateUpdate(plint period = 1);
+    // Number of samples taken so far.
+    plint getNumSamples() const;
     MultiScalarField3D<T>& get(std::string field, std::string operation) const;
     // "rho" is the actual fluid density in physical units (or the scaling factor for an advection-diffusion equation).
     // "pressureOffset" is the ambient pressure in physical units.
@@ -77,7 +133,7 @@ private:
     std::string idToOperation(int iOperation) const;
     T getScalingFactor(int iField, T dx, T dt, T rho) const;
     T getOffset(int iField, T dx, T dt, T rho, T pressureOffset, T rhoLB) const;
-    MultiScalarField3D<T>* computeField(int iField) const;
+    std::vector<MultiBlock3D*> getUpdateArguments();
     std::string getFileName(std::string path, int iField, int iOperation, std::string domainName,
             plint iteration, plint namePadding) const;
 private:
@@ -94,6 +150,11 @@ private:
     int fieldIsRegistered[numFields];                           // Array of all registered fields.
     int fieldOperationIsRegistered[numFields][numOperations];   // Table of all registered fields and operations.
     MultiScalarField3D<T>* blocks[numFields][numOperations];    // All scalar fields to operate on.
+    int isIntegrated;                                           // Are the updates executed by the lattice.
+    plint startTime;                                            // Lattice time at which the updates were integrated.
+    plint period;                                               // Number of iterations between integrated updates.
+
+    friend class TransientStatisticsFunctional3D<T,Descriptor>;
 };
 
 }  // namespace plb
@@ -29,24 +29,267 @@
 #include "core/globalDefs.h"
 #include "core/geometry3D.h"
 #include "atomicBlock/dataProcessingFunctional3D.h"
+#include "atomicBlock/blockLattice3D.h"
 #include "dataProcessors/dataAnalysisFunctional3D.h"
 #include "dataProcessors/dataAnalysisWrapper3D.h"
 #include "multiBlock/multiBlock3D.h"
 #include "multiBlock/multiBlockLattice3D.h"
 #include "multiBlock/multiDataField3D.h"
 #include "multiBlock/multiDataProcessorWrapper3D.h"
+#include "multiBlock/multiBlockGenerator3D.h"
 #include "io/imageWriter.h"
 #include "io/plbFiles.h"
 #include "io/vtkDataOutput.h"
 #include "io/transientStatistics3D.h"
 
 #include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <string>
 #include <vector>
 
 namespace plb {
 
+/* ***************** Transient Statistics Update ************************** */
+
+template<typename T, template<typename U> class Descriptor>
+TransientStatisticsFunctional3D<T,Descriptor>::TransientStatisticsFunctional3D(
+        TransientStatistics3D<T,Descriptor> const& statistics, plint n_)
+    : n0(n_ - 1),
+      startTime(0),
+      period(0),
+      lastSampleTime(-1)
+{
+    registerStatistics(statistics);
+}
+
+template<typename T, template<typename U> class Descriptor>
+TransientStatisticsFunctional3D<T,Descriptor>::TransientStatisticsFunctional3D(
+        TransientStatistics3D<T,Descriptor> const& statistics, plint n0_, plint startTime_, plint period_)
+    : n0(n0_),
+      startTime(startTime_),
+      period(period_),
+      lastSampleTime(-1)
+{
+    PLB_ASSERT(period >= 1);
+    registerStatistics(statistics);
+}
+
+template<typename T, template<typename U> class Descriptor>
+void TransientStatisticsFunctional3D<T,Descriptor>::registerStatistics(
+        TransientStatistics3D<T,Descriptor> const& statistics)
+{
+    typedef TransientStatistics3D<T,Descriptor> S;
+    needsVelocity = false;
+    needsDensity = false;
+    needsVorticity = false;
+    for (int iField = 0; iField < S::numFields; iField++) {
+        for (int iOperation = 0; iOperation < S::numOperations; iOperation++) {
+            if (statistics.fieldOperationIsRegistered[iField][iOperation]) {
+                fields.push_back(iField);
+                operations.push_back(iOperation);
+            }
+        }
+        if (statistics.fieldIsRegistered[iField]) {
+            if (iField == S::density || iField == S::pressure) {
+                needsDensity = true;
+            } else if (iField == S::vorticityX || iField == S::vorticityY || iField == S::vorticityZ ||
+                    iField == S::vorticityNorm) {
+                needsVorticity = true;
+            } else {
+                needsVelocity = true;
+            }
+        }
+    }
+    enlargedDomain = statistics.enlargedDomain;
+}
+
+template<typename T, template<typename U> class Descriptor>
+void TransientStatisticsFunctional3D<T,Descriptor>::computeVelocitySlab(
+        BlockLattice3D<T,Descriptor>& lattice, plint iX, Box3D const& velocityDomain)
+{
+    plint ny = velocityDomain.getNy();
+    plint nz = velocityDomain.getNz();
+    Array<T,3>* slab = &velocitySlabs[((iX - velocityDomain.x0) % 3) * ny * nz];
+    for (plint iY = velocityDomain.y0; iY <= velocityDomain.y1; iY++) {
+        for (plint iZ = velocityDomain.z0; iZ <= velocityDomain.z1; iZ++) {
+            lattice.get(iX, iY, iZ).computeVelocity(*slab);
+            ++slab;
+        }
+    }
+}
+
+template<typename T, template<typename U> class Descriptor>
+Array<T,3> const& TransientStatisticsFunctional3D<T,Descriptor>::getVelocity(
+        plint iX, plint iY, plint iZ, Box3D const& velocityDomain) const
+{
+    plint ny = velocityDomain.getNy();
+    plint nz = velocityDomain.getNz();
+    return velocitySlabs[(((iX - velocityDomain.x0) % 3) * ny + iY - velocityDomain.y0) * nz + iZ - velocityDomain.z0];
+}
+
+// Centered differences, except on the boundary of the velocity domain, where one-sided
+//   first-order differences are used, as in computeVorticity.
+template<typename T, template<typename U> class Descriptor>
+T TransientStatisticsFunctional3D<T,Descriptor>::derivative(
+        plint iX, plint iY, plint iZ, int direction, int iD, Box3D const& velocityDomain) const
+{
+    Array<plint,3> pos(iX, iY, iZ);
+    plint lower = direction == 0 ? velocityDomain.x0 : (direction == 1 ? velocityDomain.y0 : velocityDomain.z0);
+    plint upper = direction == 0 ? velocityDomain.x1 : (direction == 1 ? velocityDomain.y1 : velocityDomain.z1);
+    plint iMinus = pos[direction] > lower ? pos[direction] - 1 : pos[direction];
+    plint iPlus = pos[direction] < upper ? pos[direction] + 1 : pos[direction];
+    if (iPlus == iMinus) {
+        return T();
+    }
+    Array<plint,3> posMinus(pos), posPlus(pos);
+    posMinus[direction] = iMinus;
+    posPlus[direction] = iPlus;
+    return (getVelocity(posPlus[0], posPlus[1], posPlus[2], velocityDomain)[iD] -
+            getVelocity(posMinus[0], posMinus[1], posMinus[2], velocityDomain)[iD]) / (T) (iPlus - iMinus);
+}
+
+template<typename T, template<typename U> class Descriptor>
+void TransientStatisticsFunctional3D<T,Descriptor>::processGenericBlocks(
+        Box3D domain, std::vector<AtomicBlock3D*> blocks)
+{
+    typedef TransientStatistics3D<T,Descriptor> S;
+    PLB_ASSERT(blocks.size() == fields.size() + 1);
+    BlockLattice3D<T,Descriptor>& lattice = dynamic_cast<BlockLattice3D<T,Descriptor>&>(*blocks[0]);
+
+    plint n = n0 + 1;
+    if (period > 0) {
+        // The internal processors may be executed more than once per iteration.
+        plint time = lattice.getTimeCounter().getTime();
+        plint numIterations = time - startTime + 1;
+        if (numIterations % period != 0 || time == lastSampleTime) {
+            return;
+        }
+        lastSampleTime = time;
+        n = n0 + numIterations / period;
+    }
+    T nMinusOne = (T) n - (T) 1;
+    T oneOverN = (T) 1 / (T) n;
+
+    plint numStatistics = (plint) fields.size();
+    std::vector<ScalarField3D<T>*> statistics(numStatistics);
+    std::vector<Dot3D> offsets(numStatistics);
+    for (plint iStat = 0; iStat < numStatistics; iStat++) {
+        statistics[iStat] = dynamic_cast<ScalarField3D<T>*>(blocks[iStat + 1]);
+        PLB_ASSERT(statistics[iStat]);
+        offsets[iStat] = computeRelativeDisplacement(lattice, *statistics[iStat]);
+    }
+
+    // The velocity of the cells neighboring the domain is needed for the vorticity.
+    Box3D velocityDomain(domain);
+    if (needsVorticity) {
+        Dot3D location = lattice.getLocation();
+#ifdef PLB_DEBUG
+        bool intersectsWithEnlargedDomain =
+#endif
+            intersect(domain.enlarge(1), enlargedDomain.shift(-location.x, -location.y, -location.z), velocityDomain);
+        PLB_ASSERT(intersectsWithEnlargedDomain);
+        velocitySlabs.resize(3 * velocityDomain.getNy() * velocityDomain.getNz());
+        for (plint iX = velocityDomain.x0; iX <= std::min(domain.x0, velocityDomain.x1); iX++) {
+            computeVelocitySlab(lattice, iX, velocityDomain);
+        }
+    }
+
+    T values[S::numFields];
+    T previousAverage[S::numFields];
+    Array<T,3> u, omega;
+    for (plint iX = domain.x0; iX <= domain.x1; iX++) {
+        if (needsVorticity && iX + 1 <= velocityDomain.x1) {
+            computeVelocitySlab(lattice, iX + 1, velocityDomain);
+        }
+        for (plint iY = domain.y0; iY <= domain.y1; iY++) {
+            for (plint iZ = domain.z0; iZ <= domain.z1; iZ++) {
+                Cell<T,Descriptor>& cell = lattice.get(iX, iY, iZ);
+                if (needsVorticity) {
+                    u = getVelocity(iX, iY, iZ, velocityDomain);
+                    omega[0] = derivative(iX, iY, iZ, 1, 2, velocityDomain) - derivative(iX, iY, iZ, 2, 1, velocityDomain);
+                    omega[1] = derivative(iX, iY, iZ, 2, 0, velocityDomain) - derivative(iX, iY, iZ, 0, 2, velocityDomain);
+                    omega[2] = derivative(iX, iY, iZ, 0, 1, velocityDomain) - derivative(iX, iY, iZ, 1, 0, velocityDomain);
+                    values[S::vorticityX] = omega[0];
+                    values[S::vorticityY] = omega[1];
+                    values[S::vorticityZ] = omega[2];
+                    values[S::vorticityNorm] = std::sqrt(VectorTemplateImpl<T,3>::normSqr(omega));
+                } else if (needsVelocity) {
+                    cell.computeVelocity(u);
+                }
+                if (needsVelocity) {
+                    values[S::velocityX] = u[0];
+                    values[S::velocityY] = u[1];
+                    values[S::velocityZ] = u[2];
+                    values[S::velocityNorm] = std::sqrt(VectorTemplateImpl<T,3>::normSqr(u));
+                }
+                if (needsDensity) {
+                    values[S::density] = cell.computeDensity();
+                    values[S::pressure] = values[S::density];
+                }
+
+                for (plint iStat = 0; iStat < numStatistics; iStat++) {
+                    Dot3D const& ofs = offsets[iStat];
+                    T& statistic = statistics[iStat]->get(iX + ofs.x, iY + ofs.y, iZ + ofs.z);
+                    T value = values[fields[iStat]];
+                    if (n == 1) {
+                        statistic = operations[iStat] == S::rms ? std::fabs(value) :
+                                   (operations[iStat] == S::dev ? T() : value);
+                        continue;
+                    }
+                    switch (operations[iStat]) {
+                    case S::min:
+                        statistic = std::min(statistic, value);
+                        break;
+                    case S::max:
+                        statistic = std::max(statistic, value);
+                        break;
+                    case S::ave:
+                        previousAverage[fields[iStat]] = statistic;
+                        statistic = oneOverN * (nMinusOne * statistic + value);
+                        break;
+                    case S::rms:
+                        statistic = std::sqrt(oneOverN * (nMinusOne * statistic * statistic + value * value));
+                        break;
+                    case S::dev: {
+                        // The average of the same field precedes the deviation, and is already updated.
+                        T oldAverage = previousAverage[fields[iStat]];
+                        T newAverage = oneOverN * (nMinusOne * oldAverage + value);
+                        T variance = oneOverN * (nMinusOne * statistic * statistic +
+                                (value - oldAverage) * (value - newAverage));
+                        statistic = std::sqrt(variance);
+                        break;
+                    }
+                    default:
+                        break;
+                    }
+                }
+            }
+        }
+    }
+}
+
+template<typename T, template<typename U> class Descriptor>
+TransientStatisticsFunctional3D<T,Descriptor>* TransientStatisticsFunctional3D<T,Descriptor>::clone() const
+{
+    return new TransientStatisticsFunctional3D<T,Descriptor>(*this);
+}
+
+template<typename T, template<typename U> class Descriptor>
+void TransientStatisticsFunctional3D<T,Descriptor>::getTypeOfModification(
+        std::vector<modif::ModifT>& modified) const
+{
+    // The envelopes of the statistics are not needed during the updates, and are
+    //   only duplicated when the statistics are accessed.
+    std::fill(modified.begin(), modified.end(), modif::nothing);
+}
+
+template<typename T, template<typename U> class Descriptor>
+BlockDomain::DomainT TransientStatisticsFunctional3D<T,Descriptor>::appliesTo() const
+{
+    return BlockDomain::bulk;
+}
+
 /* ***************** Transient Statistics Manager ************************* */
 
 template<typename T, template<typename U> class Descriptor>
@@ -64,6 +307,9 @@ TransientStatistics3D<T,Descriptor>::TransientStatistics3D(MultiBlockLattice3D<T
     (void) memset(fieldIsRegistered, 0, sizeof fieldIsRegistered);
     (void) memset(fieldOperationIsRegistered, 0, sizeof fieldOperationIsRegistered);
     (void) memset(blocks, 0, sizeof blocks);
+    isIntegrated = 0;
+    startTime = 0;
+    period = 1;
 }
 
 template<typename T, template<typename U> class Descriptor>
@@ -71,8 +317,11 @@ TransientStatistics3D<T,Descriptor>::TransientStatistics3D(TransientStatistics3D
     : lattice(rhs.lattice),
       domain(rhs.domain),
       enlargedDomain(rhs.enlargedDomain),
-      n(rhs.n),
-      isInitialized(rhs.isInitialized)
+      n(rhs.getNumSamples()),
+      isInitialized(rhs.isInitialized),
+      isIntegrated(0),  // The integrated updates keep acting on the statistics of rhs only.
+      startTime(0),
+      period(1)
 {
     for (int iField = 0; iField < numFields; iField++) {
         fieldIsRegistered[iField] = rhs.fieldIsRegistered[iField];
@@ -102,6 +351,9 @@ void TransientStatistics3D<T,Descriptor>::swap(TransientStatistics3D<T,Descripto
     std::swap(enlargedDomain, rhs.enlargedDomain);
     std::swap(n, rhs.n);
     std::swap(isInitialized, rhs.isInitialized);
+    std::swap(isIntegrated, rhs.isIntegrated);
+    std::swap(startTime, rhs.startTime);
+    std::swap(period, rhs.period);
 
     for (int iField = 0; iField < numFields; iField++) {
         std::swap(fieldIsRegistered[iField], rhs.fieldIsRegistered[iField]);
@@ -183,81 +435,67 @@ void TransientStatistics3D<T,Descriptor>::initialize()
     }
 
     for (int iField = 0; iField < numFields; iField++) {
-        if (fieldIsRegistered[iField]) {    // There is at least one operation for this field.
-            MultiScalarField3D<T>* field = computeField(iField);
-            for (int iOperation = 0; iOperation < numOperations; iOperation++) {
-                if (fieldOperationIsRegistered[iField][iOperation]) {
-                    MultiScalarField3D<T>* fieldToRegister = 0;
-                    if (iOperation == rms) {
-                        fieldToRegister = computeAbsoluteValue(*field).release();
-                    } else if (iOperation == dev) {
-                        fieldToRegister = field->clone();
-                        setToConstant(*fieldToRegister, fieldToRegister->getBoundingBox(), (T) 0);
-                    } else {
-                        fieldToRegister = field->clone();
-                    }
-
-                    blocks[iField][iOperation] = fieldToRegister;
-                }
+        for (int iOperation = 0; iOperation < numOperations; iOperation++) {
+            if (fieldOperationIsRegistered[iField][iOperation]) {
+                blocks[iField][iOperation] = generateMultiScalarField<T>(lattice, domain).release();
             }
-            delete field;
         }
     }
 
     n = 1;
     isInitialized = 1;
+    std::vector<MultiBlock3D*> args(getUpdateArguments());
+    applyProcessingFunctional(new TransientStatisticsFunctional3D<T,Descriptor>(*this, n), domain, args);
 }
 
 template<typename T, template<typename U> class Descriptor>
 void TransientStatistics3D<T,Descriptor>::update()
 {
+    PLB_PRECONDITION(!isIntegrated);
     if (!isInitialized) {
         initialize();
         return;
     }
 
     n++;
+    std::vector<MultiBlock3D*> args(getUpdateArguments());
+    applyProcessingFunctional(new TransientStatisticsFunctional3D<T,Descriptor>(*this, n), domain, args);
+}
 
-    for (int iField = 0; iField < numFields; iField++) {
-        if (fieldIsRegistered[iField]) {    // There is at least one operation for this field.
-            MultiScalarField3D<T>* field = computeField(iField);
-            for (int iOperation = 0; iOperation < numOperations; iOperation++) {
-                if (fieldOperationIsRegistered[iField][iOperation]) {
-                    std::vector<MultiBlock3D*> args;
-                    args.push_back(field);
-                    if (iOperation == dev) {
-                        args.push_back(blocks[iField][ave]); // ave must be less than dev, so that the average is already updated.
-                    }
-                    args.push_back(blocks[iField][iOperation]);
+template<typename T, template<typename U> class Descriptor>
+void TransientStatistics3D<T,Descriptor>::integrateUpdate(plint period_)
+{
+    bool needsVorticity = fieldIsRegistered[vorticityX] || fieldIsRegistered[vorticityY] ||
+                          fieldIsRegistered[vorticityZ] || fieldIsRegistered[vorticityNorm];
+    integrateUpdate(period_, needsVorticity ? 1 : 0);
+}
 
-                    BoxProcessingFunctional3D* functional = 0;
-                    switch (iOperation) {
-                    case min:
-                        functional = new UpdateMinScalarTransientStatistics3D<T>();
-                        break;
-                    case max:
-                        functional = new UpdateMaxScalarTransientStatistics3D<T>();
-                        break;
-                    case ave:
-                        functional = new UpdateAveScalarTransientStatistics3D<T>(n);
-                        break;
-                    case rms:
-                        functional = new UpdateRmsScalarTransientStatistics3D<T>(n);
-                        break;
-                    case dev:
-                        functional = new UpdateDevScalarTransientStatistics3D<T>(n);
-                        break;
-                    default:
-                        functional = 0;
-                        break;
-                    }
+template<typename T, template<typename U> class Descriptor>
+void TransientStatistics3D<T,Descriptor>::integrateUpdate(plint period_, plint level)
+{
+    PLB_PRECONDITION(!isIntegrated);
+    PLB_PRECONDITION(period_ >= 1);
+    PLB_PRECONDITION(level >= 1 || !(fieldIsRegistered[vorticityX] || fieldIsRegistered[vorticityY] ||
+                fieldIsRegistered[vorticityZ] || fieldIsRegistered[vorticityNorm]));
+    if (!isInitialized) {
+        initialize();
+    }
 
-                    applyProcessingFunctional(functional, field->getBoundingBox(), args);
-                }
-            }
-            delete field;
-        }
+    period = period_;
+    startTime = lattice.getTimeCounter().getTime();
+    isIntegrated = 1;
+    std::vector<MultiBlock3D*> args(getUpdateArguments());
+    integrateProcessingFunctional(new TransientStatisticsFunctional3D<T,Descriptor>(*this, n, startTime, period),
+            domain, args, level);
+}
+
+template<typename T, template<typename U> class Descriptor>
+plint TransientStatistics3D<T,Descriptor>::getNumSamples() const
+{
+    if (isIntegrated) {
+        return n + (lattice.getTimeCounter().getTime() - startTime) / period;
     }
+    return n;
 }
 
 template<typename T, template<typename U> class Descriptor>
@@ -268,6 +506,8 @@ MultiScalarField3D<T>& TransientStatistics3D<T,Descriptor>::get(std::string fiel
     int iOperation = operationToId(operation);
     PLB_ASSERT(iOperation >= 0);
 
+    // The update does not maintain the envelopes of the statistics.
+    blocks[iField][iOperation]->duplicateOverlaps(modif::staticVariables);
     return *blocks[iField][iOperation];
 }
 
@@ -321,13 +561,14 @@ void TransientStatistics3D<T,Descriptor>::saveState(
     XMLwriter& entry = restart["continue"]["transientStatistics"];
     entry["name"].setString(FileName(fname_base).defaultPath(global::directories().getOutputDir()));
     entry["iteration"].set(iteration);
-    entry["n"].set(n);
+    entry["n"].set(getNumSamples());
     restart.print(xmlFileName);
 }
 
 template<typename T, template<typename U> class Descriptor>
 void TransientStatistics3D<T,Descriptor>::loadState(plint& iteration, FileName xmlFileName)
 {
+    PLB_PRECONDITION(!isIntegrated);
     XMLreader restart(xmlFileName.get());
     std::string fname_base;
     restart["continue"]["transientStatistics"]["name"].read(fname_base);
@@ -495,47 +736,19 @@ T TransientStatistics3D<T,Descriptor>::getOffset(int iField, T dx, T dt, T rho,
 }
 
 template<typename T, template<typename U> class Descriptor>
-MultiScalarField3D<T>* TransientStatistics3D<T,Descriptor>::computeField(int iField) const
+std::vector<MultiBlock3D*> TransientStatistics3D<T,Descriptor>::getUpdateArguments()
 {
-    PLB_ASSERT(iField >= 0);
-
-    MultiScalarField3D<T>* field = 0;
-
-    switch (iField) {
-    case velocityX:
-        field = computeVelocityComponent(lattice, domain, 0).release();
-        break;
-    case velocityY:
-        field = computeVelocityComponent(lattice, domain, 1).release();
-        break;
-    case velocityZ:
-        field = computeVelocityComponent(lattice, domain, 2).release();
-        break;
-    case velocityNorm:
-        field = computeVelocityNorm(lattice, domain).release();
-        break;
-    case density:
-    case pressure:
-        field = computeDensity(lattice, domain).release();
-        break;
-    case vorticityX:
-        field = extractComponent(*computeVorticity(*computeVelocity(lattice, enlargedDomain)), domain, 0).release();
-        break;
-    case vorticityY:
-        field = extractComponent(*computeVorticity(*computeVelocity(lattice, enlargedDomain)), domain, 1).release();
-        break;
-    case vorticityZ:
-        field = extractComponent(*computeVorticity(*computeVelocity(lattice, enlargedDomain)), domain, 2).release();
-        break;
-    case vorticityNorm:
-        field = computeNorm(*computeVorticity(*computeVelocity(lattice, enlargedDomain)), domain).release();
-        break;
-    default:
-        field = 0;
-        break;
+    // The order of the statistics must be the one of TransientStatisticsFunctional3D::registerStatistics.
+    std::vector<MultiBlock3D*> args;
+    args.push_back(&lattice);
+    for (int iField = 0; iField < numFields; iField++) {
+        for (int iOperation = 0; iOperation < numOperations; iOperation++) {
+            if (fieldOperationIsRegistered[iField][iOperation]) {
+                args.push_back(blocks[iField][iOperation]);
+            }
+        }
     }
-
-    return field;
+    return args;
 }
 
 template<typename T, template<typename U> class Descriptor>
@@ -36,9 +36,12 @@
 #include "io/plbFiles.h"
 #include "parallelism/mpiManager.h"
 #include "io/utilIO_3D.h"
+#include "io/mpiParallelIO.h"
+#include "core/plbProfiler.h"
 
 #include <vector>
 #include <cstdio>
+#include <sstream>
 
 namespace plb {
 
@@ -58,6 +61,29 @@ void saveState(std::vector<MultiBlock3D*> blocks, plint iteration, bool saveDyna
     restart.print(xmlFileName);
 }
 
+void saveStateAsynchronously(std::vector<MultiBlock3D*> blocks, plint iteration, bool saveDynamicContent,
+        FileName xmlFileName, FileName baseFileName, plint fileNamePadding)
+{
+    std::string fname_base = createFileName(baseFileName.get(), iteration, fileNamePadding);
+    std::vector<FileName> fnames;
+    for (pluint i = 0; i < blocks.size(); i++) {
+        fnames.push_back(FileName(fname_base+"_"+util::val2str(i)));
+    }
+    global::profiler().start(global::prof::io);
+    parallelIO::stageAsynchronousSave(blocks, fnames, saveDynamicContent);
+    // The restart file is published together with the data, once it is complete.
+    XMLwriter restart;
+    XMLwriter& entry = restart["continue"];
+    entry["name"].setString(FileName(fname_base).defaultPath(global::directories().getOutputDir()));
+    entry["num_blocks"].set(blocks.size());
+    entry["iteration"].set(iteration);
+    std::ostringstream restartContent;
+    restart.toOutputStream(restartContent);
+    parallelIO::asyncRawDataWriter().stageDescription(xmlFileName.get(), restartContent.str());
+    parallelIO::asyncRawDataWriter().start();
+    global::profiler().stop(global::prof::io);
+}
+
 void loadState(std::vector<MultiBlock3D*> blocks, plint& iteration, bool saveDynamicContent,
         FileName xmlFileName)
 {
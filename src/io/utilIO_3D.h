@@ -41,6 +41,15 @@ namespace plb {
 void saveState(std::vector<MultiBlock3D*> blocks, plint iteration, bool saveDynamicContent,
         FileName xmlFileName, FileName baseFileName, plint fileNamePadding = 8);
 
+/* Save the current state of the simulation like saveState, but write the data
+ * in the background while the simulation continues. The checkpoint, including
+ * the restart file xmlFileName, only appears once its data is complete, at the
+ * next call to parallelIO::waitForAsynchronousSave() or to this function. The
+ * last checkpoint requires a call to parallelIO::waitForAsynchronousSave()
+ * before the end of the program. */
+void saveStateAsynchronously(std::vector<MultiBlock3D*> blocks, plint iteration, bool saveDynamicContent,
+        FileName xmlFileName, FileName baseFileName, plint fileNamePadding = 8);
+
 /* Load the state of the simulation from checkpoint files for restarting. */
 void loadState(std::vector<MultiBlock3D*> blocks, plint& iteration, bool saveDynamicContent,
         FileName xmlFileName);
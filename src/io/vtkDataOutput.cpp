@@ -32,6 +32,12 @@
 #include "io/multiBlockWriter3D.h"
 #include "io/base64.h"
 #include "io/base64.hh"
+#include "io/dataCompression.h"
+#include "core/runTimeDiagnostics.h"
+#include "core/util.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <fstream>
 
 namespace plb {
@@ -242,6 +248,424 @@ void ParallelVtkDataWriter3D::appendFillerSpace(plint fillerSpace) {
 }
 
 
+////////// class PartitionedVtkDataWriter3D ////////////////////////////////////////
+
+// Encoding and file attributes common to all partitioned VTK writers.
+static void encodeVtkAppendedData( std::vector<char> const& data, VtkCompression::CompressionT compression,
+                                   std::vector<char>& encoded );
+static void writeVtkFileAttributes(std::ostream& ostr, VtkCompression::CompressionT compression);
+
+PartitionedVtkDataWriter3D::PartitionedVtkDataWriter3D (
+        std::string const& fileName_, VtkCompression::CompressionT compression_ )
+    : fileName(fileName_),
+      compression(compression_),
+      piecesDefined(false),
+      dataFile(0),
+      dataSize(0)
+{
+    if (compression==VtkCompression::zlib && !zlibIsAvailable()) {
+        plbLogicError("Palabos was compiled without zlib support (PLB_USE_ZLIB): "
+                      "the zlib compression of VTK files is not available.");
+    }
+}
+
+PartitionedVtkDataWriter3D::~PartitionedVtkDataWriter3D() {
+    // Without a call to writeFiles(), the temporary file is discarded.
+    if (dataFile) {
+        closeDataFile();
+        std::remove(dataFileName.c_str());
+    }
+}
+
+void PartitionedVtkDataWriter3D::setPieces( Box3D wholeExtent_, std::map<plint,Box3D> const& pieces_,
+                                            std::map<plint,int> const& pieceProcesses_,
+                                            std::vector<plint> const& localPieces_ )
+{
+    PLB_PRECONDITION( !piecesDefined );
+    wholeExtent = wholeExtent_;
+    pieces = pieces_;
+    pieceProcesses = pieceProcesses_;
+    localPieces = localPieces_;
+    fieldOffsets.resize(localPieces.size());
+    piecesDefined = true;
+    if (!localPieces.empty()) {
+        dataFileName = getLocalFileName(global::mpi().getRank())+".tmp";
+        dataFile = new std::ofstream(dataFileName.c_str(), std::ios_base::out|std::ios_base::binary);
+        if (!(*dataFile)) {
+            std::cerr << "could not open file " <<  dataFileName << "\n";
+        }
+    }
+}
+
+Box3D PartitionedVtkDataWriter3D::getPiece(plint pieceId) const {
+    std::map<plint,Box3D>::const_iterator it = pieces.find(pieceId);
+    PLB_ASSERT( it != pieces.end() );
+    return it->second;
+}
+
+void PartitionedVtkDataWriter3D::appendData(plint iLocalPiece, std::vector<char> const& data) {
+    PLB_PRECONDITION( iLocalPiece < (plint)localPieces.size() );
+    PLB_PRECONDITION( !fieldNames.empty() );
+    PLB_PRECONDITION( (plint)fieldOffsets[iLocalPiece].size() == (plint)fieldNames.size()-1 );
+    PLB_PRECONDITION( dataFile );
+    fieldOffsets[iLocalPiece].push_back(dataSize);
+    std::vector<char> encoded;
+    encodeVtkAppendedData(data, compression, encoded);
+    if (!encoded.empty()) {
+        dataFile->write(&encoded[0], (std::streamsize)encoded.size());
+    }
+    dataSize += (plint)encoded.size();
+}
+
+void PartitionedVtkDataWriter3D::closeDataFile() {
+    delete dataFile;
+    dataFile = 0;
+}
+
+// Uncompressed data is preceded by its size in bytes. Compressed data is cut
+//   into blocks of equal size, except possibly the last one; they are preceded
+//   by the number of blocks, the uncompressed size of a block and of the last
+//   block (0 if it is complete), and the compressed size of each block. All
+//   header values are UInt64, as declared in the header_type attribute.
+static void encodeVtkAppendedData( std::vector<char> const& data, VtkCompression::CompressionT compression,
+                                   std::vector<char>& encoded )
+{
+    std::vector<pluint> header;
+    std::vector<char> body;
+    pluint numBytes = (pluint)data.size();
+    if (compression==VtkCompression::none) {
+        header.push_back(numBytes);
+    }
+    else {
+        static const pluint blockSize = 32768;
+        pluint numBlocks = (numBytes+blockSize-1)/blockSize;
+        header.push_back(numBlocks);
+        header.push_back(blockSize);
+        header.push_back(numBytes%blockSize);
+        std::vector<char> compressedBlock;
+        for (pluint iBlock=0; iBlock<numBlocks; ++iBlock) {
+            pluint blockStart = iBlock*blockSize;
+            plint blockBytes = (plint)std::min(blockSize, numBytes-blockStart);
+            if (compression==VtkCompression::lz4) {
+                compressLZ4(&data[blockStart], blockBytes, compressedBlock);
+            }
+            else {
+                compressZlib(&data[blockStart], blockBytes, compressedBlock);
+            }
+            header.push_back((pluint)compressedBlock.size());
+            body.insert(body.end(), compressedBlock.begin(), compressedBlock.end());
+        }
+    }
+    pluint headerSize = header.size()*sizeof(pluint);
+    encoded.resize(headerSize + (compression==VtkCompression::none ? numBytes : body.size()));
+    if (!header.empty()) {
+        memcpy(&encoded[0], &header[0], headerSize);
+    }
+    std::vector<char> const& payload = compression==VtkCompression::none ? data : body;
+    if (!payload.empty()) {
+        memcpy(&encoded[headerSize], &payload[0], payload.size());
+    }
+}
+
+std::string PartitionedVtkDataWriter3D::getLocalFileName(int process) const {
+    return fileName+"_"+util::val2str(process)+".vti";
+}
+
+static void writeVtkFileAttributes(std::ostream& ostr, VtkCompression::CompressionT compression) {
+    ostr << "version=\"1.0\"";
+#ifdef PLB_BIG_ENDIAN
+    ostr << " byte_order=\"BigEndian\"";
+#else
+    ostr << " byte_order=\"LittleEndian\"";
+#endif
+    ostr << " header_type=\"UInt64\"";
+    if (compression==VtkCompression::lz4) {
+        ostr << " compressor=\"vtkLZ4DataCompressor\"";
+    }
+    else if (compression==VtkCompression::zlib) {
+        ostr << " compressor=\"vtkZLibDataCompressor\"";
+    }
+}
+
+void PartitionedVtkDataWriter3D::writeFiles(Array<double,3> origin, double deltaX) {
+    if (!piecesDefined) {
+        return;
+    }
+    if (!localPieces.empty()) {
+        writeLocalFile(origin, deltaX);
+    }
+    if (global::mpi().isMainProcessor()) {
+        writeMainFile(origin, deltaX);
+    }
+}
+
+// The .vti file of a process holds one Piece element per local atomic-block,
+//   all of which refer to the same appended data. Its whole extent is the
+//   bounding box of the local pieces.
+void PartitionedVtkDataWriter3D::writeLocalFile(Array<double,3> origin, double deltaX)
+{
+    closeDataFile();
+    std::string localName = getLocalFileName(global::mpi().getRank());
+    std::ofstream ostr(localName.c_str(), std::ios_base::out|std::ios_base::binary);
+    if (!ostr) {
+        std::cerr << "could not open file " <<  localName << "\n";
+        std::remove(dataFileName.c_str());
+        return;
+    }
+    Box3D localExtent = getPiece(localPieces[0]);
+    for (pluint iPiece=1; iPiece<localPieces.size(); ++iPiece) {
+        localExtent = bound(localExtent, getPiece(localPieces[iPiece]));
+    }
+    ostr << "<?xml version=\"1.0\"?>\n";
+    ostr << "<VTKFile type=\"ImageData\" ";
+    writeVtkFileAttributes(ostr, compression);
+    ostr << ">\n";
+    ostr << "<ImageData WholeExtent=\""
+         << localExtent.x0 << " " << localExtent.x1 << " "
+         << localExtent.y0 << " " << localExtent.y1 << " "
+         << localExtent.z0 << " " << localExtent.z1 << "\" "
+         << "Origin=\""
+         << origin[0] << " " << origin[1] << " " << origin[2] << "\" "
+         << "Spacing=\""
+         << deltaX << " " << deltaX << " " << deltaX << "\">\n";
+    for (pluint iPiece=0; iPiece<localPieces.size(); ++iPiece) {
+        Box3D piece = getPiece(localPieces[iPiece]);
+        ostr << "<Piece Extent=\""
+             << piece.x0 << " " << piece.x1 << " "
+             << piece.y0 << " " << piece.y1 << " "
+             << piece.z0 << " " << piece.z1 << "\">\n";
+        ostr << "<PointData>\n";
+        for (pluint iField=0; iField<fieldNames.size(); ++iField) {
+            ostr << "<DataArray type=\"" << fieldTypes[iField]
+                 << "\" Name=\"" << fieldNames[iField];
+            if (fieldDims[iField]>1) {
+                ostr << "\" NumberOfComponents=\"" << fieldDims[iField];
+            }
+            ostr << "\" format=\"appended\" offset=\"" << fieldOffsets[iPiece][iField] << "\" />\n";
+        }
+        ostr << "</PointData>\n";
+        ostr << "</Piece>\n";
+    }
+    ostr << "</ImageData>\n";
+    ostr << "<AppendedData encoding=\"raw\">\n_";
+    if (dataSize>0) {
+        std::ifstream dataIn(dataFileName.c_str(), std::ios_base::in|std::ios_base::binary);
+        ostr << dataIn.rdbuf();
+    }
+    std::remove(dataFileName.c_str());
+    ostr << "\n</AppendedData>\n";
+    ostr << "</VTKFile>\n";
+}
+
+void PartitionedVtkDataWriter3D::writeMainFile(Array<double,3> origin, double deltaX) const
+{
+    std::string mainName = fileName+".pvti";
+    std::ofstream ostr(mainName.c_str());
+    if (!ostr) {
+        std::cerr << "could not open file " <<  mainName << "\n";
+        return;
+    }
+    // The pieces are referred to relative to the .pvti file.
+    std::string::size_type slashPos = fileName.find_last_of('/');
+    std::string baseName = slashPos==std::string::npos ? fileName : fileName.substr(slashPos+1);
+
+    ostr << "<?xml version=\"1.0\"?>\n";
+    ostr << "<VTKFile type=\"PImageData\" ";
+    writeVtkFileAttributes(ostr, compression);
+    ostr << ">\n";
+    ostr << "<PImageData WholeExtent=\""
+         << wholeExtent.x0 << " " << wholeExtent.x1 << " "
+         << wholeExtent.y0 << " " << wholeExtent.y1 << " "
+         << wholeExtent.z0 << " " << wholeExtent.z1 << "\" "
+         << "GhostLevel=\"0\" "
+         << "Origin=\""
+         << origin[0] << " " << origin[1] << " " << origin[2] << "\" "
+         << "Spacing=\""
+         << deltaX << " " << deltaX << " " << deltaX << "\">\n";
+    ostr << "<PPointData>\n";
+    for (pluint iField=0; iField<fieldNames.size(); ++iField) {
+        ostr << "<PDataArray type=\"" << fieldTypes[iField]
+             << "\" Name=\"" << fieldNames[iField];
+        if (fieldDims[iField]>1) {
+            ostr << "\" NumberOfComponents=\"" << fieldDims[iField];
+        }
+        ostr << "\" />\n";
+    }
+    ostr << "</PPointData>\n";
+    std::map<plint,Box3D>::const_iterator it = pieces.begin();
+    for (; it != pieces.end(); ++it) {
+        Box3D const& piece = it->second;
+        ostr << "<Piece Extent=\""
+             << piece.x0 << " " << piece.x1 << " "
+             << piece.y0 << " " << piece.y1 << " "
+             << piece.z0 << " " << piece.z1 << "\" "
+             << "Source=\"" << baseName+"_"+util::val2str(pieceProcesses.find(it->first)->second)+".vti"
+             << "\" />\n";
+    }
+    ostr << "</PImageData>\n";
+    ostr << "</VTKFile>\n";
+}
+
+
+
+////////// class PartitionedVtkPolyDataWriter3D ////////////////////////////////////
+
+PartitionedVtkPolyDataWriter3D::PartitionedVtkPolyDataWriter3D (
+        std::string const& fileName_, VtkCompression::CompressionT compression_ )
+    : fileName(fileName_),
+      compression(compression_),
+      numPoints(0),
+      numTriangles(0),
+      pointsArray(-1),
+      cellsArray(-1)
+{
+    if (compression==VtkCompression::zlib && !zlibIsAvailable()) {
+        plbLogicError("Palabos was compiled without zlib support (PLB_USE_ZLIB): "
+                      "the zlib compression of VTK files is not available.");
+    }
+}
+
+void PartitionedVtkPolyDataWriter3D::appendArray(std::vector<char> const& data) {
+    arrayOffsets.push_back((plint)pieceData.size());
+    std::vector<char> encoded;
+    encodeVtkAppendedData(data, compression, encoded);
+    pieceData.insert(pieceData.end(), encoded.begin(), encoded.end());
+}
+
+void PartitionedVtkPolyDataWriter3D::setTriangles(std::vector<plint> const& triangles) {
+    PLB_PRECONDITION( cellsArray==-1 );
+    PLB_PRECONDITION( triangles.size()%3==0 );
+    numTriangles = (plint)triangles.size()/3;
+    appendCells(triangles, 3);
+}
+
+void PartitionedVtkPolyDataWriter3D::appendCells (
+        std::vector<plint> const& connectivity, plint pointsPerCell )
+{
+    cellsArray = (plint)arrayOffsets.size();
+    std::vector<char> data(connectivity.size()*sizeof(plint));
+    if (!data.empty()) {
+        memcpy(&data[0], &connectivity[0], data.size());
+    }
+    appendArray(data);
+    std::vector<plint> offsets(connectivity.size()/pointsPerCell);
+    for (pluint iCell=0; iCell<offsets.size(); ++iCell) {
+        offsets[iCell] = pointsPerCell*(plint)(iCell+1);
+    }
+    data.resize(offsets.size()*sizeof(plint));
+    if (!data.empty()) {
+        memcpy(&data[0], &offsets[0], data.size());
+    }
+    appendArray(data);
+}
+
+void PartitionedVtkPolyDataWriter3D::writeFiles() {
+    PLB_PRECONDITION( pointsArray>=0 );
+    if (cellsArray==-1) {
+        std::vector<plint> vertices(numPoints);
+        for (plint iPoint=0; iPoint<numPoints; ++iPoint) {
+            vertices[iPoint] = iPoint;
+        }
+        appendCells(vertices, 1);
+    }
+    writePiece();
+    if (global::mpi().isMainProcessor()) {
+        writeMainFile();
+    }
+}
+
+void PartitionedVtkPolyDataWriter3D::writeDataArray (
+        std::ostream& ostr, std::string const& type, std::string const& name,
+        plint nDim, plint iArray ) const
+{
+    ostr << "<DataArray type=\"" << type << "\"";
+    if (!name.empty()) {
+        ostr << " Name=\"" << name << "\"";
+    }
+    if (nDim>1) {
+        ostr << " NumberOfComponents=\"" << nDim << "\"";
+    }
+    ostr << " format=\"appended\" offset=\"" << arrayOffsets[iArray] << "\" />\n";
+}
+
+void PartitionedVtkPolyDataWriter3D::writePiece() const
+{
+    std::string pieceName = fileName+"_"+util::val2str(global::mpi().getRank())+".vtp";
+    std::ofstream ostr(pieceName.c_str(), std::ios_base::out|std::ios_base::binary);
+    if (!ostr) {
+        std::cerr << "could not open file " <<  pieceName << "\n";
+        return;
+    }
+    std::string cellType = numTriangles>0 ? "Polys" : "Verts";
+    ostr << "<?xml version=\"1.0\"?>\n";
+    ostr << "<VTKFile type=\"PolyData\" ";
+    writeVtkFileAttributes(ostr, compression);
+    ostr << ">\n";
+    ostr << "<PolyData>\n";
+    ostr << "<Piece NumberOfPoints=\"" << numPoints << "\""
+         << " NumberOfVerts=\"" << (numTriangles>0 ? 0 : numPoints) << "\""
+         << " NumberOfLines=\"0\" NumberOfStrips=\"0\""
+         << " NumberOfPolys=\"" << numTriangles << "\">\n";
+    ostr << "<PointData>\n";
+    for (pluint iField=0; iField<fieldNames.size(); ++iField) {
+        writeDataArray(ostr, fieldTypes[iField], fieldNames[iField], fieldDims[iField], fieldArrays[iField]);
+    }
+    ostr << "</PointData>\n";
+    ostr << "<Points>\n";
+    writeDataArray(ostr, pointType, "", 3, pointsArray);
+    ostr << "</Points>\n";
+    ostr << "<" << cellType << ">\n";
+    writeDataArray(ostr, VtkTypeNames<plint>::getName(), "connectivity", 1, cellsArray);
+    writeDataArray(ostr, VtkTypeNames<plint>::getName(), "offsets", 1, cellsArray+1);
+    ostr << "</" << cellType << ">\n";
+    ostr << "</Piece>\n";
+    ostr << "</PolyData>\n";
+    ostr << "<AppendedData encoding=\"raw\">\n_";
+    if (!pieceData.empty()) {
+        ostr.write(&pieceData[0], (std::streamsize)pieceData.size());
+    }
+    ostr << "\n</AppendedData>\n";
+    ostr << "</VTKFile>\n";
+}
+
+void PartitionedVtkPolyDataWriter3D::writeMainFile() const
+{
+    std::string mainName = fileName+".pvtp";
+    std::ofstream ostr(mainName.c_str());
+    if (!ostr) {
+        std::cerr << "could not open file " <<  mainName << "\n";
+        return;
+    }
+    // The pieces are referred to relative to the .pvtp file.
+    std::string::size_type slashPos = fileName.find_last_of('/');
+    std::string baseName = slashPos==std::string::npos ? fileName : fileName.substr(slashPos+1);
+
+    ostr << "<?xml version=\"1.0\"?>\n";
+    ostr << "<VTKFile type=\"PPolyData\" ";
+    writeVtkFileAttributes(ostr, compression);
+    ostr << ">\n";
+    ostr << "<PPolyData GhostLevel=\"0\">\n";
+    ostr << "<PPointData>\n";
+    for (pluint iField=0; iField<fieldNames.size(); ++iField) {
+        ostr << "<PDataArray type=\"" << fieldTypes[iField]
+             << "\" Name=\"" << fieldNames[iField];
+        if (fieldDims[iField]>1) {
+            ostr << "\" NumberOfComponents=\"" << fieldDims[iField];
+        }
+        ostr << "\" />\n";
+    }
+    ostr << "</PPointData>\n";
+    ostr << "<PPoints>\n";
+    ostr << "<PDataArray type=\"" << pointType << "\" NumberOfComponents=\"3\" />\n";
+    ostr << "</PPoints>\n";
+    for (plint iProc=0; iProc<global::mpi().getSize(); ++iProc) {
+        ostr << "<Piece Source=\"" << baseName+"_"+util::val2str(iProc)+".vtp" << "\" />\n";
+    }
+    ostr << "</PPolyData>\n";
+    ostr << "</VTKFile>\n";
+}
+
+
 
 
 template<>
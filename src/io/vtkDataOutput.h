@@ -31,6 +31,7 @@
 #include <fstream>
 #include <sstream>
 #include <vector>
+#include <map>
 
 #include "core/serializer.h"
 #include "atomicBlock/dataField2D.h"
@@ -41,6 +42,11 @@
 
 namespace plb {
 
+namespace VtkCompression {
+    /// Compression of the appended data blocks. zlib requires PLB_USE_ZLIB.
+    enum CompressionT {none, lz4, zlib};
+}
+
 class VtkDataWriter3D {
 public:
     VtkDataWriter3D(std::string const& fileName_, bool pointData_=true, bool mainProcOnly_=true);
@@ -85,6 +91,107 @@ private:
     std::ofstream *ostr;
 };
 
+/// Writes an image as one .vti file per process, which holds the pieces of
+///   the local atomic-blocks, and a .pvti file which assembles them.
+/** Each process writes the pieces of its own atomic-blocks, as raw appended
+ *  data, possibly compressed by blocks; no data is gathered on the main
+ *  process. The encoded data is appended to a temporary file as soon as it
+ *  is provided, and copied behind the XML header of the .vti file by
+ *  writeFiles(), so that at most one field is held in memory.
+ */
+class PartitionedVtkDataWriter3D {
+public:
+    PartitionedVtkDataWriter3D( std::string const& fileName_,
+                                VtkCompression::CompressionT compression_ );
+    ~PartitionedVtkDataWriter3D();
+    /// Define the pieces of the image, in global coordinates, the process
+    ///   which writes each of them, and the local ones among them.
+    void setPieces( Box3D wholeExtent_, std::map<plint,Box3D> const& pieces_,
+                    std::map<plint,int> const& pieceProcesses_,
+                    std::vector<plint> const& localPieces_ );
+    bool hasPieces() const { return piecesDefined; }
+    Box3D getWholeExtent() const { return wholeExtent; }
+    Box3D getPiece(plint pieceId) const;
+    std::vector<plint> const& getLocalPieces() const { return localPieces; }
+    template<typename T>
+    void declareDataField(std::string const& name, plint nDim);
+    /// Append the data of the last declared field for a local piece, with x
+    ///   as the fastest index.
+    void appendData(plint iLocalPiece, std::vector<char> const& data);
+    /// Write the .vti files of the local pieces and, on the main process,
+    ///   the .pvti file.
+    void writeFiles(Array<double,3> origin, double deltaX);
+private:
+    PartitionedVtkDataWriter3D(PartitionedVtkDataWriter3D const& rhs);
+    PartitionedVtkDataWriter3D& operator=(PartitionedVtkDataWriter3D const& rhs);
+    void writeLocalFile(Array<double,3> origin, double deltaX);
+    void writeMainFile(Array<double,3> origin, double deltaX) const;
+    void closeDataFile();
+    std::string getLocalFileName(int process) const;
+private:
+    std::string fileName;
+    VtkCompression::CompressionT compression;
+    bool piecesDefined;
+    Box3D wholeExtent;
+    std::map<plint,Box3D> pieces;
+    std::map<plint,int> pieceProcesses;
+    std::vector<plint> localPieces;
+    std::vector<std::string> fieldNames, fieldTypes;
+    std::vector<plint> fieldDims;
+    /// Offset of each field of the local pieces in the appended data.
+    std::vector<std::vector<plint> > fieldOffsets;
+    /// Temporary file which holds the appended data of the local pieces.
+    std::string dataFileName;
+    std::ofstream* dataFile;
+    plint dataSize;
+};
+
+/// Writes points, and optionally triangles between them, as one .vtp file
+///   per process and a .pvtp file which assembles them.
+/** Each process provides the points of its own piece, which are written
+ *  as raw appended data, possibly compressed by blocks; no data is gathered
+ *  on the main process. The data is kept in memory until writeFiles() is called.
+ */
+class PartitionedVtkPolyDataWriter3D {
+public:
+    PartitionedVtkPolyDataWriter3D( std::string const& fileName_,
+                                    VtkCompression::CompressionT compression_ );
+    /// Coordinates of the points of the local piece, three per point.
+    template<typename T>
+    void setPoints(std::vector<T> const& coordinates);
+    /// Triangles of the local piece, as three point indices per triangle.
+    ///   Without triangles, every point is written as a vertex cell.
+    void setTriangles(std::vector<plint> const& triangles);
+    /// Append a field defined on the points of the local piece, with nDim
+    ///   components per point.
+    template<typename T>
+    void appendPointData(std::string const& name, plint nDim, std::vector<T> const& data);
+    /// Write the .vtp file of the local piece and, on the main process,
+    ///   the .pvtp file. All processes must call this function.
+    void writeFiles();
+private:
+    void appendArray(std::vector<char> const& data);
+    void appendCells(std::vector<plint> const& connectivity, plint pointsPerCell);
+    void writePiece() const;
+    void writeMainFile() const;
+    void writeDataArray( std::ostream& ostr, std::string const& type, std::string const& name,
+                         plint nDim, plint iArray ) const;
+private:
+    std::string fileName;
+    VtkCompression::CompressionT compression;
+    plint numPoints, numTriangles;
+    std::string pointType;
+    std::vector<std::string> fieldNames, fieldTypes;
+    std::vector<plint> fieldDims;
+    /// Encoded arrays of the local piece, and offset of each one in it.
+    std::vector<char> pieceData;
+    std::vector<plint> arrayOffsets;
+    /// Position in arrayOffsets of the points, of the cell connectivity (followed
+    ///   by the cell offsets), and of the point data fields; -1 if not yet given.
+    plint pointsArray, cellsArray;
+    std::vector<plint> fieldArrays;
+};
+
 template<typename T>
 class VtkImageOutput2D {
 public:
@@ -189,6 +296,43 @@ private:
     plint numEntries, sizeOfEntry, sizeOfFooter, nextDataOffset, iEntry;
 };
 
+/// Parallel output of images into a .pvti file and one .vti file per
+///   process, with one piece per local atomic-block.
+/** The pieces overlap by one point, so that the image has no gaps. The data
+ *  is stored in the type TConv, for example float to halve the output size
+ *  of a simulation in double precision. Each call to writeData() encodes
+ *  its field and hands it to the file system right away; the XML headers
+ *  are written at destruction. The multi-block management must not be
+ *  partial, because the .pvti file lists all pieces.
+ */
+template<typename T>
+class PartitionedVtkImageOutput3D {
+public:
+    PartitionedVtkImageOutput3D( std::string fName, double deltaX_=1.,
+                                 VtkCompression::CompressionT compression=VtkCompression::none );
+    PartitionedVtkImageOutput3D( std::string fName, double deltaX_, Array<double,3> offset_,
+                                 VtkCompression::CompressionT compression=VtkCompression::none );
+    ~PartitionedVtkImageOutput3D();
+    /// Write a multi-block whose cells hold nDim values of type TConv.
+    template<typename TConv>
+    void writeData(MultiBlock3D& block, plint nDim, std::string const& name);
+    template<typename TConv>
+    void writeData(MultiScalarField3D<T>& scalarField,
+                   std::string scalarFieldName, TConv scalingFactor=(TConv)1, TConv additiveOffset=(TConv)0);
+    template<plint n, typename TConv>
+    void writeData(MultiTensorField3D<T,n>& tensorField,
+                   std::string tensorFieldName, TConv scalingFactor=(TConv)1);
+    template<typename TConv>
+    void writeData(MultiNTensorField3D<T>& nTensorField, std::string nTensorFieldName);
+private:
+    PartitionedVtkImageOutput3D(PartitionedVtkImageOutput3D<T> const& rhs);
+    PartitionedVtkImageOutput3D<T>& operator=(PartitionedVtkImageOutput3D<T> const& rhs);
+private:
+    PartitionedVtkDataWriter3D vtkOut;
+    double deltaX;
+    Array<double,3> offset;
+};
+
 } // namespace plb
 
 #endif  // VTK_DATA_OUTPUT_H
@@ -35,12 +35,17 @@
 #include "dataProcessors/ntensorAnalysisWrapper3D.h"
 #include "io/vtkDataOutput.h"
 #include "io/serializerIO.h"
+#include "io/multiBlockWriter3D.h"
+#include "multiBlock/multiBlockManagement3D.h"
+#include "core/plbProfiler.h"
 
 #include <iostream>
 #include <iomanip>
 #include <fstream>
 #include <sstream>
 #include <typeinfo>
+#include <algorithm>
+#include <cstring>
 
 namespace plb {
 
@@ -533,6 +538,166 @@ void ParallelVtkImageOutput3D<T>::writeData( MultiNTensorField3D<T>& nTensorFiel
     delete transformedField;
 }
 
+////////// class PartitionedVtkDataWriter3D ////////////////////////////////////////
+
+template<typename T>
+void PartitionedVtkDataWriter3D::declareDataField(std::string const& name, plint nDim)
+{
+    fieldNames.push_back(name);
+    fieldTypes.push_back(VtkTypeNames<T>::getName());
+    fieldDims.push_back(nDim);
+}
+
+////////// class PartitionedVtkPolyDataWriter3D ////////////////////////////////////
+
+template<typename T>
+void PartitionedVtkPolyDataWriter3D::setPoints(std::vector<T> const& coordinates)
+{
+    PLB_PRECONDITION( pointsArray==-1 );
+    PLB_PRECONDITION( coordinates.size()%3==0 );
+    numPoints = (plint)coordinates.size()/3;
+    pointType = VtkTypeNames<T>::getName();
+    pointsArray = (plint)arrayOffsets.size();
+    std::vector<char> data(coordinates.size()*sizeof(T));
+    if (!data.empty()) {
+        memcpy(&data[0], &coordinates[0], data.size());
+    }
+    appendArray(data);
+}
+
+template<typename T>
+void PartitionedVtkPolyDataWriter3D::appendPointData (
+        std::string const& name, plint nDim, std::vector<T> const& data )
+{
+    PLB_PRECONDITION( pointsArray>=0 );
+    PLB_PRECONDITION( (plint)data.size()==numPoints*nDim );
+    fieldNames.push_back(name);
+    fieldTypes.push_back(VtkTypeNames<T>::getName());
+    fieldDims.push_back(nDim);
+    fieldArrays.push_back((plint)arrayOffsets.size());
+    std::vector<char> rawData(data.size()*sizeof(T));
+    if (!rawData.empty()) {
+        memcpy(&rawData[0], &data[0], rawData.size());
+    }
+    appendArray(rawData);
+}
+
+////////// class PartitionedVtkImageOutput3D ////////////////////////////////////
+
+template<typename T>
+PartitionedVtkImageOutput3D<T>::PartitionedVtkImageOutput3D (
+        std::string fName, double deltaX_, VtkCompression::CompressionT compression )
+    : vtkOut( global::directories().getVtkOutDir() + fName, compression ),
+      deltaX(deltaX_),
+      offset(T(),T(),T())
+{ }
+
+template<typename T>
+PartitionedVtkImageOutput3D<T>::PartitionedVtkImageOutput3D (
+        std::string fName, double deltaX_, Array<double,3> offset_,
+        VtkCompression::CompressionT compression )
+    : vtkOut( global::directories().getVtkOutDir() + fName, compression ),
+      deltaX(deltaX_),
+      offset(offset_)
+{ }
+
+template<typename T>
+PartitionedVtkImageOutput3D<T>::~PartitionedVtkImageOutput3D() {
+    global::profiler().start(global::prof::io);
+    vtkOut.writeFiles(offset, deltaX);
+    global::profiler().stop(global::prof::io);
+}
+
+template<typename T>
+template<typename TConv>
+void PartitionedVtkImageOutput3D<T>::writeData( MultiBlock3D& block, plint nDim, std::string const& name )
+{
+    MultiBlockManagement3D const& management = block.getMultiBlockManagement();
+    if (management.isPartial()) {
+        plbLogicError("A partitioned VTK image cannot be written from a partial multi-block management.");
+    }
+    global::profiler().start(global::prof::io);
+    Box3D boundingBox = block.getBoundingBox();
+
+    // Each piece is the bulk of an atomic-block, extended by one point in
+    //   the upper directions, taken from the envelope, so that adjacent
+    //   pieces share their boundary points and leave no gap in the image.
+    std::map<plint,Box3D> pieces(management.getSparseBlockStructure().getBulks());
+    if (management.getEnvelopeWidth() >= 1) {
+        std::map<plint,Box3D>::iterator it = pieces.begin();
+        for (; it != pieces.end(); ++it) {
+            Box3D& piece = it->second;
+            piece.x1 = std::min(piece.x1+1, boundingBox.x1);
+            piece.y1 = std::min(piece.y1+1, boundingBox.y1);
+            piece.z1 = std::min(piece.z1+1, boundingBox.z1);
+        }
+    }
+    std::vector<plint> const& localBlocks = management.getLocalInfo().getBlocks();
+    if (vtkOut.hasPieces()) {
+        PLB_PRECONDITION( vtkOut.getWholeExtent() == boundingBox );
+        PLB_PRECONDITION( vtkOut.getLocalPieces() == localBlocks );
+    }
+    else {
+        std::map<plint,int> pieceProcesses;
+        std::map<plint,Box3D>::const_iterator it = pieces.begin();
+        for (; it != pieces.end(); ++it) {
+            pieceProcesses[it->first] = management.getThreadAttribution().getMpiProcess(it->first);
+        }
+        vtkOut.setPieces(boundingBox, pieces, pieceProcesses, localBlocks);
+    }
+
+    block.duplicateOverlaps(modif::staticVariables);
+    vtkOut.declareDataField<TConv>(name, nDim);
+    std::vector<char> data;
+    for (pluint iBlock=0; iBlock<localBlocks.size(); ++iBlock) {
+        plint blockId = localBlocks[iBlock];
+        SmartBulk3D bulk(management, blockId);
+        Box3D localPiece(bulk.toLocal(pieces[blockId]));
+        block.getComponent(blockId).getDataTransfer().send(localPiece, data, modif::staticVariables);
+        parallelIO::transposeToBackward(nDim*(plint)sizeof(TConv), localPiece, data);
+        vtkOut.appendData((plint)iBlock, data);
+    }
+    global::profiler().stop(global::prof::io);
+}
+
+template<typename T>
+template<typename TConv>
+void PartitionedVtkImageOutput3D<T>::writeData( MultiScalarField3D<T>& scalarField,
+                                                std::string scalarFieldName, TConv scalingFactor,
+                                                TConv additiveOffset )
+{
+    std::auto_ptr<MultiScalarField3D<TConv> > transformedField = copyConvert<T,TConv>(scalarField);
+    if (!util::isOne(scalingFactor)) {
+        multiplyInPlace(*transformedField, scalingFactor);
+    }
+    if (!util::isZero(additiveOffset)) {
+        addInPlace(*transformedField, additiveOffset);
+    }
+    writeData<TConv>(*transformedField, 1, scalarFieldName);
+}
+
+template<typename T>
+template<plint n, typename TConv>
+void PartitionedVtkImageOutput3D<T>::writeData( MultiTensorField3D<T,n>& tensorField,
+                                                std::string tensorFieldName, TConv scalingFactor )
+{
+    std::auto_ptr<MultiTensorField3D<TConv,n> > transformedField = copyConvert<T,TConv,n>(tensorField);
+    if (!util::isOne(scalingFactor)) {
+        multiplyInPlace(*transformedField, scalingFactor);
+    }
+    writeData<TConv>(*transformedField, n, tensorFieldName);
+}
+
+template<typename T>
+template<typename TConv>
+void PartitionedVtkImageOutput3D<T>::writeData( MultiNTensorField3D<T>& nTensorField,
+                                                std::string nTensorFieldName )
+{
+    MultiNTensorField3D<TConv>* transformedField = copyConvert<T,TConv>(nTensorField, nTensorField.getBoundingBox());
+    writeData<TConv>(*transformedField, transformedField->getNdim(), nTensorFieldName);
+    delete transformedField;
+}
+
 }  // namespace plb
 
 #endif  // VTK_DATA_OUTPUT_HH
@@ -45,6 +45,34 @@ struct BlockCommunicator3D {
      *  is being transmitted.
      **/
     virtual void duplicateOverlaps(MultiBlock3D& multiBlock, modif::ModifT whichData) const =0;
+    /// Split version of duplicateOverlaps(): initiate the communication.
+    /** The data in the envelopes of the multi-block must not be accessed
+     *  before completeDuplicateOverlaps() is called. Between the two calls,
+     *  the cells of the bulk which are sent to the envelopes of other
+     *  blocks must not be modified. By default, nothing is done here, and
+     *  everything happens in completeDuplicateOverlaps().
+     **/
+    virtual void startDuplicateOverlaps(MultiBlock3D& multiBlock, modif::ModifT whichData) const { }
+    /// Split version of duplicateOverlaps(): conclude the communication.
+    virtual void completeDuplicateOverlaps(MultiBlock3D& multiBlock, modif::ModifT whichData) const {
+        duplicateOverlaps(multiBlock, whichData);
+    }
+    /// Update the envelopes of a block-lattice right after a full collide-and-stream step.
+    /** Only the populations which the envelopes could not stream themselves are
+     *  transmitted (see IncomingPopulations3D). This requires the envelopes to
+     *  be up to date before the step, and that nothing but the collide-and-
+     *  stream step modified the cells since. By default, the full static data
+     *  is transmitted.
+     **/
+    virtual void duplicateStreamedOverlaps(MultiBlock3D& multiBlock) const {
+        duplicateOverlaps(multiBlock, modif::staticVariables);
+    }
+    /// Split version of duplicateStreamedOverlaps(), see startDuplicateOverlaps().
+    virtual void startDuplicateStreamedOverlaps(MultiBlock3D& multiBlock) const { }
+    /// Split version of duplicateStreamedOverlaps(), see completeDuplicateOverlaps().
+    virtual void completeDuplicateStreamedOverlaps(MultiBlock3D& multiBlock) const {
+        duplicateStreamedOverlaps(multiBlock);
+    }
     /// Transmit data between two multi-blocks, according to a user-defined pattern.
     /** The variable whichData specifies which type of content (static/dynamic/full dynamics object)
      *  is being transmitted.
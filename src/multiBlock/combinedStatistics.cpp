@@ -26,12 +26,21 @@
  * The CombinedStatistics class -- implementation.
  */
 #include "multiBlock/combinedStatistics.h"
+#include "core/plbDebug.h"
 #include <cmath>
 #include <numeric>
 #include <limits>
 
 namespace plb {
 
+CombinedStatistics::CombinedStatistics()
+    : combining(false)
+{ }
+
+CombinedStatistics::CombinedStatistics(CombinedStatistics const& rhs)
+    : combining(false)
+{ }
+
 CombinedStatistics::~CombinedStatistics()
 { }
 
@@ -138,6 +147,59 @@ void CombinedStatistics::combine (
         averageObservables, sumObservables, maxObservables, intSumObservables, 0 );
 }
 
+void CombinedStatistics::startCombining (
+            std::vector<BlockStatistics const*>& individualStatistics,
+            BlockStatistics& result ) const
+{
+    PLB_PRECONDITION( !combining );
+
+    // Local averages
+    averageObservables.resize(result.getAverageVect().size());
+    sumWeights.resize(result.getAverageVect().size());
+    computeLocalAverage(individualStatistics, averageObservables, sumWeights);
+
+    // Local sums
+    sumObservables.resize(result.getSumVect().size());
+    computeLocalSum(individualStatistics, sumObservables);
+
+    // Local maxima
+    maxObservables.resize(result.getMaxVect().size());
+    computeLocalMax(individualStatistics, maxObservables);
+
+    // Local integer sums
+    intSumObservables.resize(result.getIntSumVect().size());
+    computeLocalIntSum(individualStatistics, intSumObservables);
+
+    // Initiate global, cross-core statistics
+    this->startReduction (
+            averageObservables, sumWeights,
+            sumObservables,
+            maxObservables,
+            intSumObservables );
+    combining = true;
+}
+
+void CombinedStatistics::completeCombining(BlockStatistics& result) const
+{
+    PLB_PRECONDITION( combining );
+    combining = false;
+
+    // Compute global, cross-core statistics
+    this->completeReduction (
+            averageObservables, sumWeights,
+            sumObservables,
+            maxObservables,
+            intSumObservables );
+
+    // Update public statistics in resulting block
+    result.evaluate (
+        averageObservables, sumObservables, maxObservables, intSumObservables, 0 );
+}
+
+bool CombinedStatistics::isCombining() const {
+    return combining;
+}
+
 
 SerialCombinedStatistics* SerialCombinedStatistics::clone() const {
     return new SerialCombinedStatistics(*this);
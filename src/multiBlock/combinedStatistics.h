@@ -36,11 +36,25 @@ namespace plb {
 
 class CombinedStatistics {
 public:
+    CombinedStatistics();
+    /// A pending reduction is not copied.
+    CombinedStatistics(CombinedStatistics const& rhs);
     virtual ~CombinedStatistics();
     virtual CombinedStatistics* clone() const =0;
     void combine (
             std::vector<BlockStatistics const*>& individualStatistics,
             BlockStatistics& result ) const;
+    /// Split version of combine(): compute the local statistics, and initiate
+    ///   their cross-core reduction. The individual statistics can be modified
+    ///   as soon as this function returns. Calls to combine() remain possible
+    ///   while the reduction is in progress.
+    void startCombining (
+            std::vector<BlockStatistics const*>& individualStatistics,
+            BlockStatistics& result ) const;
+    /// Split version of combine(): conclude the reduction, and store the result.
+    void completeCombining(BlockStatistics& result) const;
+    /// Tells if a reduction has been started and not yet completed.
+    bool isCombining() const;
 protected:
     virtual void reduceStatistics (
             std::vector<double>& averageObservables,
@@ -48,6 +62,27 @@ protected:
             std::vector<double>& sumObservables,
             std::vector<double>& maxObservables,
             std::vector<plint>& intSumObservables ) const =0;
+    /// Initiate a non-blocking reduction of the observables. By default,
+    ///   nothing is done here, and everything happens in completeReduction().
+    virtual void startReduction (
+            std::vector<double>& averageObservables,
+            std::vector<double>& sumWeights,
+            std::vector<double>& sumObservables,
+            std::vector<double>& maxObservables,
+            std::vector<plint>& intSumObservables ) const
+    { }
+    /// Conclude the reduction initiated by startReduction(). The arguments are
+    ///   the same objects as in the call to startReduction().
+    virtual void completeReduction (
+            std::vector<double>& averageObservables,
+            std::vector<double>& sumWeights,
+            std::vector<double>& sumObservables,
+            std::vector<double>& maxObservables,
+            std::vector<plint>& intSumObservables ) const
+    {
+        reduceStatistics(averageObservables, sumWeights, sumObservables,
+                         maxObservables, intSumObservables);
+    }
 private:
     void computeLocalAverage (
             std::vector<BlockStatistics const*> const& individualStatistics,
@@ -62,6 +97,11 @@ private:
     void computeLocalIntSum (
             std::vector<BlockStatistics const*> const& individualStatistics,
             std::vector<plint>& intSumObservables ) const;
+private:
+    /// Observables of the reduction in progress.
+    mutable std::vector<double> averageObservables, sumWeights, sumObservables, maxObservables;
+    mutable std::vector<plint> intSumObservables;
+    mutable bool combining;
 };
 
 class SerialCombinedStatistics : public CombinedStatistics {
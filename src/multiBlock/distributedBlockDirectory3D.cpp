@@ -0,0 +1,447 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+ * Distributed directory of the blocks of a multi-block -- implementation.
+ */
+
+#include "multiBlock/distributedBlockDirectory3D.h"
+#include "multiBlock/staticRepartitions3D.h"
+#include "parallelism/mpiManager.h"
+#include "core/util.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace plb {
+
+namespace {
+
+typedef DistributedBlockDirectory3D::BlockRecord BlockRecord;
+
+void packValue(std::vector<char>& buffer, plint value) {
+    pluint pos = buffer.size();
+    buffer.resize(pos+sizeof(plint));
+    std::memcpy(&buffer[pos], &value, sizeof(plint));
+}
+
+plint unpackValue(std::vector<char> const& buffer, pluint& pos) {
+    plint value;
+    std::memcpy(&value, &buffer[pos], sizeof(plint));
+    pos += sizeof(plint);
+    return value;
+}
+
+void packBox(std::vector<char>& buffer, Box3D const& box) {
+    packValue(buffer, box.x0); packValue(buffer, box.x1);
+    packValue(buffer, box.y0); packValue(buffer, box.y1);
+    packValue(buffer, box.z0); packValue(buffer, box.z1);
+}
+
+Box3D unpackBox(std::vector<char> const& buffer, pluint& pos) {
+    Box3D box;
+    box.x0 = unpackValue(buffer, pos); box.x1 = unpackValue(buffer, pos);
+    box.y0 = unpackValue(buffer, pos); box.y1 = unpackValue(buffer, pos);
+    box.z0 = unpackValue(buffer, pos); box.z1 = unpackValue(buffer, pos);
+    return box;
+}
+
+void packRecord(std::vector<char>& buffer, BlockRecord const& record) {
+    packValue(buffer, record.id);
+    packBox(buffer, record.bulk);
+    packBox(buffer, record.uniqueBulk);
+    packValue(buffer, record.process);
+}
+
+BlockRecord unpackRecord(std::vector<char> const& buffer, pluint& pos) {
+    BlockRecord record;
+    record.id = unpackValue(buffer, pos);
+    record.bulk = unpackBox(buffer, pos);
+    record.uniqueBulk = unpackBox(buffer, pos);
+    record.process = (int)unpackValue(buffer, pos);
+    return record;
+}
+
+struct BlockRecordIdLess {
+    bool operator()(BlockRecord const& a, BlockRecord const& b) const {
+        return a.id < b.id;
+    }
+};
+
+struct BlockRecordIdEqual {
+    bool operator()(BlockRecord const& a, BlockRecord const& b) const {
+        return a.id == b.id;
+    }
+};
+
+/// Sort the records by id, and remove the duplicates.
+void sortAndRemoveDuplicates(std::vector<BlockRecord>& records) {
+    std::sort(records.begin(), records.end(), BlockRecordIdLess());
+    records.erase( std::unique(records.begin(), records.end(), BlockRecordIdEqual()),
+                   records.end() );
+}
+
+}  // namespace
+
+DistributedBlockDirectory3D::DistributedBlockDirectory3D (
+        Box3D boundingBox_, std::vector<plint> const& ids,
+        std::vector<Box3D> const& bulks, std::vector<Box3D> const& uniqueBulks )
+    : boundingBox(boundingBox_),
+      directoryIndex(boundingBox_)
+{
+    PLB_PRECONDITION( ids.size()==bulks.size() && ids.size()==uniqueBulks.size() );
+    std::vector<BlockRecord> blocks(ids.size());
+    for (pluint iBlock=0; iBlock<ids.size(); ++iBlock) {
+        blocks[iBlock].id = ids[iBlock];
+        blocks[iBlock].bulk = bulks[iBlock];
+        blocks[iBlock].uniqueBulk = uniqueBulks[iBlock];
+        blocks[iBlock].process = global::mpi().getRank();
+    }
+    initialize(blocks);
+}
+
+DistributedBlockDirectory3D::DistributedBlockDirectory3D (
+        SparseBlockStructure3D const& sparseBlock, ThreadAttribution const& attribution )
+    : boundingBox(sparseBlock.getBoundingBox()),
+      directoryIndex(sparseBlock.getBoundingBox())
+{
+    std::vector<plint> ids = sparseBlock.getLocalBlocks(attribution);
+    std::vector<BlockRecord> blocks(ids.size());
+    for (pluint iBlock=0; iBlock<ids.size(); ++iBlock) {
+        blocks[iBlock].id = ids[iBlock];
+        sparseBlock.getBulk(ids[iBlock], blocks[iBlock].bulk);
+        sparseBlock.getUniqueBulk(ids[iBlock], blocks[iBlock].uniqueBulk);
+        blocks[iBlock].process = global::mpi().getRank();
+    }
+    initialize(blocks);
+}
+
+void DistributedBlockDirectory3D::initialize(std::vector<BlockRecord> const& localBlocks_)
+{
+    localBlocks = localBlocks_;
+    std::sort(localBlocks.begin(), localBlocks.end(), BlockRecordIdLess());
+    numBlocks = (plint)localBlocks.size();
+#ifdef PLB_MPI_PARALLEL
+    global::mpi().reduceAndBcast(numBlocks, MPI_SUM);
+#endif
+
+    // The directory grid has about four cells per process, with approximately
+    //   cubic cells.
+    int numProcs = global::mpi().getSize();
+    double cellSize = std::pow( (double)boundingBox.nCells() / (4.*(double)numProcs), 1./3. );
+    gridNx = std::max((plint)1, (plint)(0.5+(double)boundingBox.getNx()/cellSize));
+    gridNy = std::max((plint)1, (plint)(0.5+(double)boundingBox.getNy()/cellSize));
+    gridNz = std::max((plint)1, (plint)(0.5+(double)boundingBox.getNz()/cellSize));
+    gridLx = (boundingBox.getNx()+gridNx-1) / gridNx;
+    gridLy = (boundingBox.getNy()+gridNy-1) / gridNy;
+    gridLz = (boundingBox.getNz()+gridNz-1) / gridNz;
+
+    // Register each block with the processes responsible for the cells it intersects.
+    std::vector<std::vector<char> > sendBuffers(numProcs), recvBuffers;
+    std::vector<int> processes;
+    for (pluint iBlock=0; iBlock<localBlocks.size(); ++iBlock) {
+        findDirectoryProcesses(localBlocks[iBlock].bulk, processes);
+        for (pluint iProc=0; iProc<processes.size(); ++iProc) {
+            packRecord(sendBuffers[processes[iProc]], localBlocks[iBlock]);
+        }
+    }
+    global::mpi().allToAllV(sendBuffers, recvBuffers);
+    for (int iProc=0; iProc<numProcs; ++iProc) {
+        pluint pos = 0;
+        while (pos < recvBuffers[iProc].size()) {
+            BlockRecord record = unpackRecord(recvBuffers[iProc], pos);
+            directoryPositions[record.id] = directoryBlocks.size();
+            directoryBlocks.push_back(record);
+            directoryIndex.addBlock(record.bulk, record.uniqueBulk, record.id);
+        }
+    }
+}
+
+Box3D DistributedBlockDirectory3D::getBoundingBox() const {
+    return boundingBox;
+}
+
+plint DistributedBlockDirectory3D::getNumBlocks() const {
+    return numBlocks;
+}
+
+std::vector<DistributedBlockDirectory3D::BlockRecord> const&
+    DistributedBlockDirectory3D::getLocalBlocks() const
+{
+    return localBlocks;
+}
+
+void DistributedBlockDirectory3D::findDirectoryProcesses (
+        Box3D const& domain, std::vector<int>& processes ) const
+{
+    processes.clear();
+    Box3D inside;
+    if (!plb::intersect(domain, boundingBox, inside)) {
+        return;
+    }
+    int numProcs = global::mpi().getSize();
+    Box3D gridBox( (inside.x0-boundingBox.x0)/gridLx, (inside.x1-boundingBox.x0)/gridLx,
+                   (inside.y0-boundingBox.y0)/gridLy, (inside.y1-boundingBox.y0)/gridLy,
+                   (inside.z0-boundingBox.z0)/gridLz, (inside.z1-boundingBox.z0)/gridLz );
+    for (plint gridX=gridBox.x0; gridX<=gridBox.x1; ++gridX) {
+        for (plint gridY=gridBox.y0; gridY<=gridBox.y1; ++gridY) {
+            for (plint gridZ=gridBox.z0; gridZ<=gridBox.z1; ++gridZ) {
+                plint cell = (gridX*gridNy + gridY)*gridNz + gridZ;
+                processes.push_back((int)(cell % numProcs));
+            }
+        }
+    }
+    std::sort(processes.begin(), processes.end());
+    processes.erase(std::unique(processes.begin(), processes.end()), processes.end());
+}
+
+void DistributedBlockDirectory3D::intersect (
+        std::vector<Box3D> const& domains,
+        std::vector<std::vector<BlockRecord> >& blocks ) const
+{
+    int numProcs = global::mpi().getSize();
+    std::vector<std::vector<char> > queries(numProcs), receivedQueries;
+    std::vector<int> processes;
+    for (pluint iDomain=0; iDomain<domains.size(); ++iDomain) {
+        findDirectoryProcesses(domains[iDomain], processes);
+        for (pluint iProc=0; iProc<processes.size(); ++iProc) {
+            packValue(queries[processes[iProc]], (plint)iDomain);
+            packBox(queries[processes[iProc]], domains[iDomain]);
+        }
+    }
+    global::mpi().allToAllV(queries, receivedQueries);
+
+    std::vector<std::vector<char> > answers(numProcs), receivedAnswers;
+    std::vector<plint> ids;
+    std::vector<Box3D> intersections;
+    for (int iProc=0; iProc<numProcs; ++iProc) {
+        pluint pos = 0;
+        while (pos < receivedQueries[iProc].size()) {
+            plint iDomain = unpackValue(receivedQueries[iProc], pos);
+            Box3D domain = unpackBox(receivedQueries[iProc], pos);
+            ids.clear();
+            intersections.clear();
+            directoryIndex.intersect(domain, ids, intersections);
+            packValue(answers[iProc], iDomain);
+            packValue(answers[iProc], (plint)ids.size());
+            for (pluint iBlock=0; iBlock<ids.size(); ++iBlock) {
+                packRecord( answers[iProc],
+                            directoryBlocks[directoryPositions.find(ids[iBlock])->second] );
+            }
+        }
+    }
+    global::mpi().allToAllV(answers, receivedAnswers);
+
+    blocks.assign(domains.size(), std::vector<BlockRecord>());
+    for (int iProc=0; iProc<numProcs; ++iProc) {
+        pluint pos = 0;
+        while (pos < receivedAnswers[iProc].size()) {
+            plint iDomain = unpackValue(receivedAnswers[iProc], pos);
+            plint numFound = unpackValue(receivedAnswers[iProc], pos);
+            for (plint iBlock=0; iBlock<numFound; ++iBlock) {
+                blocks[iDomain].push_back(unpackRecord(receivedAnswers[iProc], pos));
+            }
+        }
+    }
+    // A block which spans several directory cells can be found by several processes.
+    for (pluint iDomain=0; iDomain<blocks.size(); ++iDomain) {
+        sortAndRemoveDuplicates(blocks[iDomain]);
+    }
+}
+
+void DistributedBlockDirectory3D::locate (
+        std::vector<Dot3D> const& points,
+        std::vector<plint>& ids, std::vector<int>& processes ) const
+{
+    std::vector<Box3D> domains(points.size());
+    for (pluint iPoint=0; iPoint<points.size(); ++iPoint) {
+        domains[iPoint] = Box3D( points[iPoint].x, points[iPoint].x,
+                                 points[iPoint].y, points[iPoint].y,
+                                 points[iPoint].z, points[iPoint].z );
+    }
+    std::vector<std::vector<BlockRecord> > blocks;
+    intersect(domains, blocks);
+    ids.assign(points.size(), -1);
+    processes.assign(points.size(), -1);
+    for (pluint iPoint=0; iPoint<points.size(); ++iPoint) {
+        if (!blocks[iPoint].empty()) {
+            ids[iPoint] = blocks[iPoint][0].id;
+            processes[iPoint] = blocks[iPoint][0].process;
+        }
+    }
+}
+
+MultiBlockManagement3D DistributedBlockDirectory3D::createLocalManagement (
+        plint envelopeWidth, plint refinementLevel ) const
+{
+    // Neighbors are searched around each local block, and around its periodic
+    //   images which touch the bounding box, as in LocalMultiBlockInfo3D.
+    std::vector<Box3D> domains;
+    for (pluint iBlock=0; iBlock<localBlocks.size(); ++iBlock) {
+        for (plint dx=-1; dx<=+1; ++dx) {
+            for (plint dy=-1; dy<=+1; ++dy) {
+                for (plint dz=-1; dz<=+1; ++dz) {
+                    Box3D domain = localBlocks[iBlock].bulk.shift (
+                            dx*boundingBox.getNx(), dy*boundingBox.getNy(),
+                            dz*boundingBox.getNz() ).enlarge(envelopeWidth);
+                    if (plb::doesIntersect(domain, boundingBox)) {
+                        domains.push_back(domain);
+                    }
+                }
+            }
+        }
+    }
+    std::vector<std::vector<BlockRecord> > neighbors;
+    intersect(domains, neighbors);
+
+    std::vector<BlockRecord> blocks(localBlocks);
+    for (pluint iDomain=0; iDomain<neighbors.size(); ++iDomain) {
+        blocks.insert(blocks.end(), neighbors[iDomain].begin(), neighbors[iDomain].end());
+    }
+    sortAndRemoveDuplicates(blocks);
+    return createManagement(blocks, envelopeWidth, refinementLevel, true);
+}
+
+MultiBlockManagement3D DistributedBlockDirectory3D::createGlobalManagement (
+        plint envelopeWidth, plint refinementLevel ) const
+{
+    std::vector<char> localData;
+    for (pluint iBlock=0; iBlock<localBlocks.size(); ++iBlock) {
+        packRecord(localData, localBlocks[iBlock]);
+    }
+    std::vector<std::vector<char> > sendBuffers(global::mpi().getSize(), localData), recvBuffers;
+    global::mpi().allToAllV(sendBuffers, recvBuffers);
+    std::vector<BlockRecord> blocks;
+    blocks.reserve(numBlocks);
+    for (pluint iProc=0; iProc<recvBuffers.size(); ++iProc) {
+        pluint pos = 0;
+        while (pos < recvBuffers[iProc].size()) {
+            blocks.push_back(unpackRecord(recvBuffers[iProc], pos));
+        }
+    }
+    sortAndRemoveDuplicates(blocks);
+    return createManagement(blocks, envelopeWidth, refinementLevel, false);
+}
+
+DistributedBlockDirectory3D DistributedBlockDirectory3D::reparallelize (
+        plint blockLx, plint blockLy, plint blockLz ) const
+{
+    std::vector<std::pair<plint,plint> > rangesX, rangesY, rangesZ;
+    util::linearBlockRepartition(boundingBox.x0, boundingBox.x1, blockLx, rangesX);
+    util::linearBlockRepartition(boundingBox.y0, boundingBox.y1, blockLy, rangesY);
+    util::linearBlockRepartition(boundingBox.z0, boundingBox.z1, blockLz, rangesZ);
+
+    // Each process covers a range of regular blocks, in the order in which
+    //   they are visited by the replicated version.
+    int numProcs = global::mpi().getSize();
+    int rank = global::mpi().getRank();
+    plint numRegular = (plint)(rangesX.size()*rangesY.size()*rangesZ.size());
+    plint firstRegular = numRegular*rank/numProcs;
+    plint lastRegular = numRegular*(rank+1)/numProcs;
+    std::vector<Box3D> regularBlocks;
+    for (plint iRegular=firstRegular; iRegular<lastRegular; ++iRegular) {
+        plint blockZ = iRegular % (plint)rangesZ.size();
+        plint blockY = (iRegular / (plint)rangesZ.size()) % (plint)rangesY.size();
+        plint blockX = iRegular / ((plint)rangesZ.size()*(plint)rangesY.size());
+        regularBlocks.push_back( Box3D( rangesX[blockX].first, rangesX[blockX].second,
+                                        rangesY[blockY].first, rangesY[blockY].second,
+                                        rangesZ[blockZ].first, rangesZ[blockZ].second ) );
+    }
+    std::vector<std::vector<BlockRecord> > oldBlocks;
+    intersect(regularBlocks, oldBlocks);
+    std::vector<Box3D> newBlocks, intersections;
+    for (pluint iRegular=0; iRegular<regularBlocks.size(); ++iRegular) {
+        intersections.clear();
+        for (pluint iBlock=0; iBlock<oldBlocks[iRegular].size(); ++iBlock) {
+            Box3D intersection;
+            plb::intersect(regularBlocks[iRegular], oldBlocks[iRegular][iBlock].bulk, intersection);
+            intersections.push_back(intersection);
+        }
+        coverRegularBlock(regularBlocks[iRegular], intersections, newBlocks);
+    }
+
+    // The ids are numbered consecutively over the processes, and the blocks
+    //   are sent to their new owner.
+    std::vector<plint> numNewBlocks(numProcs, 0);
+    numNewBlocks[rank] = (plint)newBlocks.size();
+#ifdef PLB_MPI_PARALLEL
+    global::mpi().allReduceVect(numNewBlocks, MPI_SUM);
+#endif
+    plint firstId = 0, numIds = 0;
+    for (int iProc=0; iProc<numProcs; ++iProc) {
+        if (iProc<rank) {
+            firstId += numNewBlocks[iProc];
+        }
+        numIds += numNewBlocks[iProc];
+    }
+    std::vector<std::vector<char> > sendBuffers(numProcs), recvBuffers;
+    for (pluint iNew=0; iNew<newBlocks.size(); ++iNew) {
+        BlockRecord record;
+        record.id = firstId+(plint)iNew;
+        record.bulk = newBlocks[iNew];
+        record.uniqueBulk = newBlocks[iNew];
+        // Same partition as reparallelize(MultiBlockManagement3D const&, ...):
+        //   the first numIds%numProcs processes have one block more.
+        plint numLarge = numIds%numProcs;
+        plint smallSize = numIds/numProcs;
+        record.process = record.id < numLarge*(smallSize+1) ?
+                             (int)(record.id/(smallSize+1)) :
+                             (int)(numLarge + (record.id-numLarge*(smallSize+1))/smallSize);
+        packRecord(sendBuffers[record.process], record);
+    }
+    global::mpi().allToAllV(sendBuffers, recvBuffers);
+    std::vector<plint> ids;
+    std::vector<Box3D> bulks, uniqueBulks;
+    for (int iProc=0; iProc<numProcs; ++iProc) {
+        pluint pos = 0;
+        while (pos < recvBuffers[iProc].size()) {
+            BlockRecord record = unpackRecord(recvBuffers[iProc], pos);
+            ids.push_back(record.id);
+            bulks.push_back(record.bulk);
+            uniqueBulks.push_back(record.uniqueBulk);
+        }
+    }
+    return DistributedBlockDirectory3D(boundingBox, ids, bulks, uniqueBulks);
+}
+
+MultiBlockManagement3D DistributedBlockDirectory3D::createManagement (
+        std::vector<BlockRecord> const& blocks,
+        plint envelopeWidth, plint refinementLevel, bool partial ) const
+{
+    SparseBlockStructure3D sparseBlock(boundingBox);
+    // The blocks are added in the order of their ids, so that the local blocks
+    //   are attributed to the same threads as in a replicated attribution.
+    ExplicitThreadAttribution* attribution = new ExplicitThreadAttribution;
+    for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
+        sparseBlock.addBlock(blocks[iBlock].bulk, blocks[iBlock].uniqueBulk, blocks[iBlock].id);
+        attribution->addBlock(blocks[iBlock].id, blocks[iBlock].process);
+    }
+    // A partial management keeps a copy of the directory, through which it
+    //   resolves the queries about remote blocks.
+    return MultiBlockManagement3D( sparseBlock, attribution, envelopeWidth, refinementLevel, partial,
+                                   partial ? new DistributedBlockDirectory3D(*this) : 0 );
+}
+
+}  // namespace plb
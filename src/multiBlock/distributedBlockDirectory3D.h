@@ -0,0 +1,133 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+/** \file
+ * Distributed directory of the blocks of a multi-block -- header file.
+ */
+
+#ifndef DISTRIBUTED_BLOCK_DIRECTORY_3D_H
+#define DISTRIBUTED_BLOCK_DIRECTORY_3D_H
+
+#include "core/globalDefs.h"
+#include "core/geometry3D.h"
+#include "multiBlock/sparseBlockStructure3D.h"
+#include "multiBlock/threadAttribution.h"
+#include "multiBlock/multiBlockManagement3D.h"
+#include <map>
+#include <vector>
+
+namespace plb {
+
+/// Directory of the blocks of a multi-block, distributed over the MPI processes.
+/** Instead of replicating the full block structure on every process, each process
+ *  keeps the blocks it owns, and is responsible for the directory entries of a part
+ *  of the domain: the bounding box is divided into a regular grid of about four
+ *  cells per process, and each cell is handled by one process. Global queries,
+ *  which are rare, are resolved collectively by sending them to the processes
+ *  responsible for the corresponding cells. The memory used on each process
+ *  therefore grows with the number of local blocks, and with the number of blocks
+ *  divided by the number of processes, instead of the total number of blocks.
+ *
+ *  The main use is createLocalManagement(), which builds a multi-block management
+ *  that contains only the local blocks and their neighbors. All methods, including
+ *  the constructors, must be called collectively.
+ **/
+class DistributedBlockDirectory3D {
+public:
+    /// Description of one block in the directory.
+    struct BlockRecord {
+        plint id;
+        Box3D bulk, uniqueBulk;
+        int process;
+    };
+public:
+    /// Each process hands over the blocks it owns. The block ids must be unique
+    ///   over all processes.
+    DistributedBlockDirectory3D( Box3D boundingBox_, std::vector<plint> const& ids,
+                                 std::vector<Box3D> const& bulks,
+                                 std::vector<Box3D> const& uniqueBulks );
+    /// Each process hands over the blocks which are local in the attribution.
+    DistributedBlockDirectory3D( SparseBlockStructure3D const& sparseBlock,
+                                 ThreadAttribution const& attribution );
+    Box3D getBoundingBox() const;
+    /// Total number of blocks, over all processes.
+    plint getNumBlocks() const;
+    /// Blocks owned by the current process.
+    std::vector<BlockRecord> const& getLocalBlocks() const;
+    /// For each domain, find all blocks which intersect it, ordered by their id.
+    void intersect( std::vector<Box3D> const& domains,
+                    std::vector<std::vector<BlockRecord> >& blocks ) const;
+    /// For each point, find the block which contains it and the process which
+    ///   owns this block. The id and the process are -1 for points outside all blocks.
+    void locate( std::vector<Dot3D> const& points,
+                 std::vector<plint>& ids, std::vector<int>& processes ) const;
+    /// Management which knows the local blocks, and all blocks which are within
+    ///   envelopeWidth of a local block, including through periodic boundaries.
+    /** It yields the same local blocks, overlaps and communication as the
+     *  replicated management. Operations which need to know all blocks, such
+     *  as copies between multi-blocks of different distributions, file output
+     *  of the full multi-block, or redistributions, must be executed on a
+     *  management obtained from createGlobalManagement(). The management is
+     *  marked as partial, and these operations raise an error on it.
+     **/
+    MultiBlockManagement3D createLocalManagement (
+            plint envelopeWidth, plint refinementLevel=0 ) const;
+    /// Replicated management with all blocks, obtained by gathering the directory
+    ///   on all processes.
+    MultiBlockManagement3D createGlobalManagement (
+            plint envelopeWidth, plint refinementLevel=0 ) const;
+    /// Directory of the blocks obtained by covering the blocks of this directory
+    ///   with regular blocks of about blockLx*blockLy*blockLz cells.
+    /** The blocks and their ids are the same as with reparallelize() on the
+     *  replicated block-structure, and the blocks are handed out to the
+     *  processes in ranges of consecutive ids, as in reparallelize() on a
+     *  replicated management. Each process computes the blocks of a range of
+     *  regular blocks, and the full block-structure is never gathered.
+     **/
+    DistributedBlockDirectory3D reparallelize(plint blockLx, plint blockLy, plint blockLz) const;
+private:
+    void initialize(std::vector<BlockRecord> const& localBlocks_);
+    /// Processes responsible for the directory cells which intersect a domain.
+    void findDirectoryProcesses(Box3D const& domain, std::vector<int>& processes) const;
+    /// Build a management from a set of blocks, sorted by id.
+    MultiBlockManagement3D createManagement (
+            std::vector<BlockRecord> const& blocks,
+            plint envelopeWidth, plint refinementLevel, bool partial ) const;
+private:
+    Box3D boundingBox;
+    plint numBlocks;
+    plint gridNx, gridNy, gridNz;
+    plint gridLx, gridLy, gridLz;
+    std::vector<BlockRecord> localBlocks;
+    /// Blocks which intersect the directory cells of the current process, and
+    ///   spatial index of these blocks.
+    std::vector<BlockRecord> directoryBlocks;
+    std::map<plint,pluint> directoryPositions;
+    SparseBlockStructure3D directoryIndex;
+};
+
+}  // namespace plb
+
+#endif  // DISTRIBUTED_BLOCK_DIRECTORY_3D_H
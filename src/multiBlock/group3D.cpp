@@ -27,6 +27,7 @@
  */
 #include "multiBlock/group3D.h"
 #include "multiBlock/multiBlockGenerator3D.h"
+#include <algorithm>
 
 namespace plb {
 
@@ -191,6 +192,72 @@ void Group3D::replace(plint id, MultiBlock3D* block) {
     }
 }
 
+void Group3D::toggleBlockCostMeasurement(bool measurementOn) {
+    for (pluint i=0; i<blocks.size(); ++i) {
+        blocks[i]->toggleBlockCostMeasurement(measurementOn);
+    }
+}
+
+std::map<plint,double> Group3D::getBlockCosts() const {
+    std::map<plint,double> costs;
+    for (pluint i=0; i<blocks.size(); ++i) {
+        std::map<plint,double> blockCosts = blocks[i]->getBlockCosts();
+        std::map<plint,double>::const_iterator it = blockCosts.begin();
+        for (; it != blockCosts.end(); ++it) {
+            costs[it->first] += it->second;
+        }
+    }
+    return costs;
+}
+
+void Group3D::resetBlockCosts() {
+    for (pluint i=0; i<blocks.size(); ++i) {
+        blocks[i]->resetBlockCosts();
+    }
+}
+
+void Group3D::rebalance(MultiBlockRedistribute3D const& redistribution) {
+    PLB_ASSERT(!blocks.empty());
+    MultiBlockManagement3D newManagement =
+        redistribution.redistribute(getMultiBlockManagement());
+    // Blocks can only be moved as a whole; if the redistribution also changes
+    //   the block decomposition, the multi-blocks are re-created.
+    if (newManagement.getSparseBlockStructure().equals(
+                getMultiBlockManagement().getSparseBlockStructure()) )
+    {
+        migrateBlocks(blocks, newManagement.getThreadAttribution());
+    }
+    else {
+        replaceManagement(newManagement);
+    }
+}
+
+bool Group3D::rebalance(double imbalanceTolerance) {
+    PLB_ASSERT(!blocks.empty());
+    std::map<plint,double> costs = getBlockCosts();
+    resetBlockCosts();
+
+    ThreadAttribution const& attribution =
+        getMultiBlockManagement().getThreadAttribution();
+    std::vector<double> processCosts(global::mpi().getSize());
+    double totalCost = 0.;
+    std::map<plint,double>::const_iterator it = costs.begin();
+    for (; it != costs.end(); ++it) {
+        processCosts[attribution.getMpiProcess(it->first)] += it->second;
+        totalCost += it->second;
+    }
+    if (totalCost <= 0.) {
+        return false;
+    }
+    double maxCost = *std::max_element(processCosts.begin(), processCosts.end());
+    double averageCost = totalCost / (double)processCosts.size();
+    if (maxCost <= averageCost*(1.+imbalanceTolerance)) {
+        return false;
+    }
+    rebalance(CostWeightedRedistribute3D(costs, imbalanceTolerance));
+    return true;
+}
+
 void Group3D::replace(std::string name, MultiBlock3D* block) {
     std::map<std::string, plint>::const_iterator it = ids.find(name);
     if (it==ids.end()) {
@@ -33,6 +33,7 @@
 #include "multiBlock/multiDataField3D.h"
 #include "particles/multiParticleField3D.h"
 #include "multiBlock/multiContainerBlock3D.h"
+#include "multiBlock/redistribution3D.h"
 #include <vector>
 #include <string>
 #include <map>
@@ -67,6 +68,22 @@ public:
     /// Replace the block with name "name", and re-assign the multi-block management
     /// of all other blocks accordingly.
     void replace(std::string name, MultiBlock3D* block);
+    /// Measure the time spent in each atomic-block of all multi-blocks of the group.
+    void toggleBlockCostMeasurement(bool measurementOn);
+    /// Time measured in each atomic-block since the last reset, summed over
+    /// all multi-blocks of the group. Must be called collectively.
+    std::map<plint,double> getBlockCosts() const;
+    /// Start a new measurement window in all multi-blocks of the group.
+    void resetBlockCosts();
+    /// Move the atomic-blocks of all multi-blocks, in place, to the processes
+    /// chosen by the redistribution. Only the blocks which change process are
+    /// transmitted (see migrateBlocks()).
+    void rebalance(MultiBlockRedistribute3D const& redistribution);
+    /// If the measured cost of the most loaded process exceeds the average by more
+    /// than imbalanceTolerance, move the atomic-blocks according to the measured
+    /// costs (see CostWeightedRedistribute3D). A new measurement window is started
+    /// in any case. Returns true if blocks were moved.
+    bool rebalance(double imbalanceTolerance=0.05);
 
     template<typename T>
     plint generateScalar(std::string name="", plint envelopeWidth=1, plint gridLevel=0);
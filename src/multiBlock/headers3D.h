@@ -37,6 +37,8 @@
 #include "multiBlock/serialMultiDataField3D.h"
 #include "multiBlock/serialBlockCommunicator3D.h"
 #include "multiBlock/staticRepartitions3D.h"
+#include "multiBlock/redistribution3D.h"
+#include "multiBlock/distributedBlockDirectory3D.h"
 #include "multiBlock/defaultMultiBlockPolicy3D.h"
 #include "multiBlock/multiDataProcessorWrapper3D.h"
 #include "multiBlock/reductiveMultiDataProcessorWrapper3D.h"
@@ -29,6 +29,7 @@
 #include "core/globalDefs.h"
 #include "multiBlock/localMultiBlockInfo3D.h"
 #include "multiBlock/multiBlockManagement3D.h"
+#include "parallelism/smpManager.h"
 #include <algorithm>
 
 namespace plb {
@@ -49,8 +50,7 @@ LocalMultiBlockInfo3D::LocalMultiBlockInfo3D (
     : envelopeWidth(envelopeWidth_)
 {
     computeMyBlocks(sparseBlock,attribution);
-    computeAllNormalOverlaps(sparseBlock);
-    computeAllPeriodicOverlaps(sparseBlock);
+    computeAllOverlaps(sparseBlock);
     // This is important: the overlaps must be sorted so they
     //   appear in the same order on different processors, to
     //   guarantee a match in the communication pattern.
@@ -96,17 +96,51 @@ void LocalMultiBlockInfo3D::computeMyBlocks(SparseBlockStructure3D const& sparse
     myBlocks = sparseBlock.getLocalBlocks(attribution);
 }
 
-void LocalMultiBlockInfo3D::computeAllNormalOverlaps (
+void LocalMultiBlockInfo3D::computeAllOverlaps (
         SparseBlockStructure3D const& sparseBlock )
 {
-    for (pluint iBlock=0; iBlock<myBlocks.size(); ++iBlock) {
-        plint blockId = myBlocks[iBlock];
-        computeNormalOverlaps(sparseBlock, blockId);
+    // The overlaps of each block are computed independently, and concatenated
+    //   in the order of the blocks, whatever the number of threads.
+    plint numBlocks = (plint)myBlocks.size();
+    std::vector<std::vector<Overlap3D> > blockNormalOverlaps(numBlocks);
+    std::vector<std::vector<PeriodicOverlap3D> > blockPeriodicOverlaps(numBlocks);
+    std::vector<std::vector<PeriodicOverlap3D> > blockRemoteOverlaps(numBlocks);
+    const plint numThreads =
+        std::max((plint)1, std::min((plint)global::smp().getNumThreads(), numBlocks));
+#ifdef PLB_SMP_THREADS
+    #pragma omp parallel num_threads(numThreads) if(numThreads>1)
+#endif
+    {
+        plint threadId = global::smp().getThreadId();
+        for (plint iBlock=threadId; iBlock<numBlocks; iBlock+=numThreads) {
+            plint blockId = myBlocks[iBlock];
+            computeNormalOverlaps(sparseBlock, blockId, blockNormalOverlaps[iBlock]);
+            Box3D bulk;
+            sparseBlock.getBulk(blockId, bulk);
+            // Speed optimization: execute the test for periodicity
+            //   only for bulk-domains which touch the bounding box.
+            if (!contained (
+                        bulk.enlarge(1), sparseBlock.getBoundingBox() ) )
+            {
+                computePeriodicOverlaps( sparseBlock, blockId, blockPeriodicOverlaps[iBlock],
+                                         blockRemoteOverlaps[iBlock] );
+            }
+        }
+    }
+    for (plint iBlock=0; iBlock<numBlocks; ++iBlock) {
+        normalOverlaps.insert( normalOverlaps.end(), blockNormalOverlaps[iBlock].begin(),
+                               blockNormalOverlaps[iBlock].end() );
+        periodicOverlaps.insert( periodicOverlaps.end(), blockPeriodicOverlaps[iBlock].begin(),
+                                 blockPeriodicOverlaps[iBlock].end() );
+        periodicOverlapWithRemoteData.insert( periodicOverlapWithRemoteData.end(),
+                                              blockRemoteOverlaps[iBlock].begin(),
+                                              blockRemoteOverlaps[iBlock].end() );
     }
 }
 
 void LocalMultiBlockInfo3D::computeNormalOverlaps (
-        SparseBlockStructure3D const& sparseBlock, plint blockId )
+        SparseBlockStructure3D const& sparseBlock, plint blockId,
+        std::vector<Overlap3D>& overlaps ) const
 {
     Box3D intersection;
     SmartBulk3D bulk(sparseBlock, envelopeWidth, blockId);
@@ -121,35 +155,20 @@ void LocalMultiBlockInfo3D::computeNormalOverlaps (
         if (intersect( neighborBulk.getBulk(),
                        bulk.computeNonPeriodicEnvelope(), intersection) )
         {
-            normalOverlaps.push_back(Overlap3D(neighborId, blockId, intersection));
+            overlaps.push_back(Overlap3D(neighborId, blockId, intersection));
         }
         if (intersect( bulk.getBulk(),
                        neighborBulk.computeNonPeriodicEnvelope(), intersection) )
         {
-            normalOverlaps.push_back(Overlap3D(blockId, neighborId, intersection));
-        }
-    }
-}
-
-void LocalMultiBlockInfo3D::computeAllPeriodicOverlaps (
-        SparseBlockStructure3D const& sparseBlock )
-{
-    for (pluint iBlock=0; iBlock<myBlocks.size(); ++iBlock) {
-        plint blockId = myBlocks[iBlock];
-        Box3D bulk;
-        sparseBlock.getBulk(blockId, bulk);
-        // Speed optimization: execute the test for periodicity
-        //   only for bulk-domains which touch the bounding box.
-        if (!contained (
-                    bulk.enlarge(1), sparseBlock.getBoundingBox() ) )
-        {
-            computePeriodicOverlaps(sparseBlock, blockId);
+            overlaps.push_back(Overlap3D(blockId, neighborId, intersection));
         }
     }
 }
 
 void LocalMultiBlockInfo3D::computePeriodicOverlaps (
-        SparseBlockStructure3D const& sparseBlock, plint blockId )
+        SparseBlockStructure3D const& sparseBlock, plint blockId,
+        std::vector<PeriodicOverlap3D>& overlaps,
+        std::vector<PeriodicOverlap3D>& overlapsWithRemoteData ) const
 {
     Box3D intersection; // Temporary variable.
     std::vector<plint> neighbors; // Temporary variable.
@@ -184,8 +203,8 @@ void LocalMultiBlockInfo3D::computePeriodicOverlaps (
                                 PeriodicOverlap3D overlap (
                                     Overlap3D(neighborId, blockId, intersection, shiftX, shiftY, shiftZ),
                                     dx, dy, dz );
-                                periodicOverlaps.push_back(overlap);
-                                periodicOverlapWithRemoteData.push_back(overlap);
+                                overlaps.push_back(overlap);
+                                overlapsWithRemoteData.push_back(overlap);
                             }
                             // Does the bulk of the shifted new block overlap with the envelope of a previous
                             //   block? If yes, add an overlap, in which the new block has the "original position",
@@ -196,7 +215,7 @@ void LocalMultiBlockInfo3D::computePeriodicOverlaps (
                                 intersect(shiftedBulk, neighborBulk.computeEnvelope(), intersection))
                             {
                                 intersection = intersection.shift(-shiftX,-shiftY, -shiftZ);
-                                periodicOverlaps.push_back (
+                                overlaps.push_back (
                                         PeriodicOverlap3D (
                                             Overlap3D(blockId, neighborId, intersection, -shiftX, -shiftY, -shiftZ),
                                             -dx, -dy, -dz ) );
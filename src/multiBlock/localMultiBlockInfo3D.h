@@ -129,14 +129,16 @@ private:
     /// Determine all blocks which are associated to the current MPI thread.
     void computeMyBlocks(SparseBlockStructure3D const& sparseBlock,
                          ThreadAttribution const& attribution);
-    /// Compute normal overlaps for all local blocks.
-    void computeAllNormalOverlaps(SparseBlockStructure3D const& sparseBlock);
+    /// Compute normal and periodic overlaps for all local blocks. The blocks
+    ///   are distributed over the shared-memory threads.
+    void computeAllOverlaps(SparseBlockStructure3D const& sparseBlock);
     /// Compute normal overlaps for one local block.
-    void computeNormalOverlaps(SparseBlockStructure3D const& sparseBlock, plint blockId);
-    /// Compute periodic overlaps for all local blocks.
-    void computeAllPeriodicOverlaps(SparseBlockStructure3D const& sparseBlock);
+    void computeNormalOverlaps( SparseBlockStructure3D const& sparseBlock, plint blockId,
+                                std::vector<Overlap3D>& overlaps ) const;
     /// Compute periodic overlaps for one local block.
-    void computePeriodicOverlaps(SparseBlockStructure3D const& sparseBlock, plint blockId);
+    void computePeriodicOverlaps( SparseBlockStructure3D const& sparseBlock, plint blockId,
+                                  std::vector<PeriodicOverlap3D>& overlaps,
+                                  std::vector<PeriodicOverlap3D>& overlapsWithRemoteData ) const;
 private:
     plint                          envelopeWidth;
     std::vector<plint>             myBlocks;
@@ -462,18 +462,18 @@ void MultiBlock2D::setRefinementLevel(plint newLevel)
 }
 
 void MultiBlock2D::executeInternalProcessors() {
-    global::profiler().start("dataProcessor");
+    global::profiler().start(global::prof::dataProcessor);
     // Execute all automatic internal processors.
     for (plint iLevel=0; iLevel<=maxProcessorLevel; ++iLevel) {
         executeInternalProcessors(iLevel);
     }
     // Duplicate boundaries at least once in case there is no automatic processor.
     if (maxProcessorLevel==-1) {
-        global::profiler().start("envelope-update");
+        global::profiler().start(global::prof::envelopeUpdate);
         this->duplicateOverlaps(internalModifT);
-        global::profiler().stop("envelope-update");
+        global::profiler().stop(global::prof::envelopeUpdate);
     }
-    global::profiler().stop("dataProcessor");
+    global::profiler().stop(global::prof::dataProcessor);
 }
 
 void MultiBlock2D::executeInternalProcessors(plint level, bool communicate) {
@@ -28,6 +28,9 @@
 #include "multiBlock/multiBlock3D.h"
 #include "core/plbDebug.h"
 #include "core/plbProfiler.h"
+#include "core/plbTimer.h"
+#include "core/runTimeDiagnostics.h"
+#include "parallelism/smpManager.h"
 #include "atomicBlock/atomicBlock3D.h"
 #include "multiBlock/multiBlockOperations3D.h"
 #include "multiBlock/multiBlockSerializer3D.h"
@@ -35,6 +38,7 @@
 #include "atomicBlock/atomicBlock3D.h"
 #include <cmath>
 #include <algorithm>
+#include <limits>
 
 namespace plb {
 
@@ -45,43 +49,51 @@ MultiStatSubscriber3D::MultiStatSubscriber3D(MultiBlock3D& multiBlock_)
 { }
 
 plint MultiStatSubscriber3D::subscribeAverage() {
+    // Conclude any pending reduction before the subscriptions are modified.
+    BlockStatistics& statistics = multiBlock.getInternalStatistics();
     std::vector<plint> const& blocks
         = multiBlock.getLocalInfo().getBlocks();
     for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
         plint blockId = blocks[iBlock];
         multiBlock.getComponent(blockId).internalStatSubscription().subscribeAverage();
     }
-    return multiBlock.getInternalStatistics().subscribeAverage();
+    return statistics.subscribeAverage();
 }
 
 plint MultiStatSubscriber3D::subscribeSum() {
+    // Conclude any pending reduction before the subscriptions are modified.
+    BlockStatistics& statistics = multiBlock.getInternalStatistics();
     std::vector<plint> const& blocks
         = multiBlock.getLocalInfo().getBlocks();
     for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
         plint blockId = blocks[iBlock];
         multiBlock.getComponent(blockId).internalStatSubscription().subscribeSum();
     }
-    return multiBlock.getInternalStatistics().subscribeSum();
+    return statistics.subscribeSum();
 }
 
 plint MultiStatSubscriber3D::subscribeMax() {
+    // Conclude any pending reduction before the subscriptions are modified.
+    BlockStatistics& statistics = multiBlock.getInternalStatistics();
     std::vector<plint> const& blocks
         = multiBlock.getLocalInfo().getBlocks();
     for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
         plint blockId = blocks[iBlock];
         multiBlock.getComponent(blockId).internalStatSubscription().subscribeMax();
     }
-    return multiBlock.getInternalStatistics().subscribeMax();
+    return statistics.subscribeMax();
 }
 
 plint MultiStatSubscriber3D::subscribeIntSum() {
+    // Conclude any pending reduction before the subscriptions are modified.
+    BlockStatistics& statistics = multiBlock.getInternalStatistics();
     std::vector<plint> const& blocks
         = multiBlock.getLocalInfo().getBlocks();
     for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
         plint blockId = blocks[iBlock];
         multiBlock.getComponent(blockId).internalStatSubscription().subscribeIntSum();
     }
-    return multiBlock.getInternalStatistics().subscribeIntSum();
+    return statistics.subscribeIntSum();
 }
 
 
@@ -246,13 +258,19 @@ MultiBlock3D::MultiBlock3D( MultiBlockManagement3D const& multiBlockManagement_,
                             CombinedStatistics* combinedStatistics_ )
     : multiBlockManagement(multiBlockManagement_),
       maxProcessorLevel(-1),
+      automaticProcessorsModify(false),
       blockCommunicator(blockCommunicator_),
       internalStatistics(),
       combinedStatistics(combinedStatistics_),
       statSubscriber(*this),
       statisticsOn(true),
+      statisticsPeriod(1),
+      statisticsCycle(0),
+      overlappedCommunicationOn(false),
+      streamOnlyCommunicationOn(false),
       periodicitySwitch(*this),
-      internalModifT(modif::staticVariables)
+      internalModifT(modif::staticVariables),
+      blockCostMeasurementOn(false)
 { 
     id = multiBlockRegistration3D().announce(*this);
 }
@@ -261,13 +279,19 @@ MultiBlock3D::MultiBlock3D(plint nx, plint ny, plint nz, plint envelopeWidth)
     : multiBlockManagement(defaultMultiBlockPolicy3D().getMultiBlockManagement (
                                Box3D(0,nx-1,0,ny-1,0,nz-1), envelopeWidth) ),
       maxProcessorLevel(-1),
+      automaticProcessorsModify(false),
       blockCommunicator(defaultMultiBlockPolicy3D().getBlockCommunicator()),
       internalStatistics(),
       combinedStatistics(defaultMultiBlockPolicy3D().getCombinedStatistics()),
       statSubscriber(*this),
       statisticsOn(true),
+      statisticsPeriod(1),
+      statisticsCycle(0),
+      overlappedCommunicationOn(false),
+      streamOnlyCommunicationOn(false),
       periodicitySwitch(*this),
-      internalModifT(modif::staticVariables)
+      internalModifT(modif::staticVariables),
+      blockCostMeasurementOn(false)
 {
     id = multiBlockRegistration3D().announce(*this);
 }
@@ -277,14 +301,21 @@ MultiBlock3D::MultiBlock3D(MultiBlock3D const& rhs)
       multiBlocksChangedByManualProcessors(rhs.multiBlocksChangedByManualProcessors),
       multiBlocksChangedByAutomaticProcessors(rhs.multiBlocksChangedByAutomaticProcessors),
       maxProcessorLevel(rhs.maxProcessorLevel),
+      automaticProcessorsModify(rhs.automaticProcessorsModify),
       storedProcessors(rhs.storedProcessors),
       blockCommunicator(rhs.blockCommunicator->clone()),
-      internalStatistics(rhs.internalStatistics),
+      internalStatistics(rhs.getInternalStatistics()),
       combinedStatistics(rhs.combinedStatistics -> clone()),
       statSubscriber(*this),
       statisticsOn(rhs.statisticsOn),
+      statisticsPeriod(rhs.statisticsPeriod),
+      statisticsCycle(rhs.statisticsCycle),
+      overlappedCommunicationOn(rhs.overlappedCommunicationOn),
+      streamOnlyCommunicationOn(rhs.streamOnlyCommunicationOn),
       periodicitySwitch(*this, rhs.periodicitySwitch),
-      internalModifT(rhs.internalModifT)
+      internalModifT(rhs.internalModifT),
+      blockCostMeasurementOn(rhs.blockCostMeasurementOn),
+      blockCosts(rhs.blockCosts)
 {
     id = multiBlockRegistration3D().announce(*this);
 }
@@ -292,14 +323,20 @@ MultiBlock3D::MultiBlock3D(MultiBlock3D const& rhs)
 MultiBlock3D::MultiBlock3D(MultiBlock3D const& rhs, Box3D subDomain, bool crop)
     : multiBlockManagement( intersect(rhs.getMultiBlockManagement(), subDomain, crop) ),
       maxProcessorLevel(-1),
+      automaticProcessorsModify(false),
       storedProcessors(rhs.storedProcessors),
       blockCommunicator(rhs.blockCommunicator->clone()),
       internalStatistics(),
       combinedStatistics(rhs.combinedStatistics->clone()),
       statSubscriber(*this),
       statisticsOn(true),
+      statisticsPeriod(1),
+      statisticsCycle(0),
+      overlappedCommunicationOn(false),
+      streamOnlyCommunicationOn(false),
       periodicitySwitch(*this),
-      internalModifT(rhs.internalModifT)
+      internalModifT(rhs.internalModifT),
+      blockCostMeasurementOn(false)
 {
     id = multiBlockRegistration3D().announce(*this);
 }
@@ -309,13 +346,20 @@ void MultiBlock3D::swap(MultiBlock3D& rhs) {
     multiBlocksChangedByManualProcessors.swap(rhs.multiBlocksChangedByManualProcessors);
     multiBlocksChangedByAutomaticProcessors.swap(rhs.multiBlocksChangedByAutomaticProcessors);
     std::swap(maxProcessorLevel, rhs.maxProcessorLevel);
+    std::swap(automaticProcessorsModify, rhs.automaticProcessorsModify);
     storedProcessors.swap(rhs.storedProcessors);
     std::swap(blockCommunicator, rhs.blockCommunicator);
     std::swap(internalStatistics, rhs.internalStatistics);
     std::swap(combinedStatistics, rhs.combinedStatistics);
     std::swap(statisticsOn, rhs.statisticsOn);
+    std::swap(statisticsPeriod, rhs.statisticsPeriod);
+    std::swap(statisticsCycle, rhs.statisticsCycle);
+    std::swap(overlappedCommunicationOn, rhs.overlappedCommunicationOn);
+    std::swap(streamOnlyCommunicationOn, rhs.streamOnlyCommunicationOn);
     std::swap(periodicitySwitch, rhs.periodicitySwitch);
     std::swap(internalModifT, rhs.internalModifT);
+    std::swap(blockCostMeasurementOn, rhs.blockCostMeasurementOn);
+    blockCosts.swap(rhs.blockCosts);
 }
 
 MultiBlock3D::~MultiBlock3D() {
@@ -365,6 +409,7 @@ SparseBlockStructure3D const& MultiBlock3D::getSparseBlockStructure() const {
 }
 
 BlockStatistics& MultiBlock3D::getInternalStatistics() {
+    completeStatistics();
     return internalStatistics;
 }
 
@@ -388,6 +433,26 @@ void MultiBlock3D::duplicateOverlaps(modif::ModifT whichData) {
     this->getBlockCommunicator().duplicateOverlaps(*this, whichData);
 }
 
+void MultiBlock3D::startDuplicateOverlaps(modif::ModifT whichData) {
+    this->getBlockCommunicator().startDuplicateOverlaps(*this, whichData);
+}
+
+void MultiBlock3D::completeDuplicateOverlaps(modif::ModifT whichData) {
+    this->getBlockCommunicator().completeDuplicateOverlaps(*this, whichData);
+}
+
+void MultiBlock3D::duplicateStreamedOverlaps() {
+    this->getBlockCommunicator().duplicateStreamedOverlaps(*this);
+}
+
+void MultiBlock3D::startDuplicateStreamedOverlaps() {
+    this->getBlockCommunicator().startDuplicateStreamedOverlaps(*this);
+}
+
+void MultiBlock3D::completeDuplicateStreamedOverlaps() {
+    this->getBlockCommunicator().completeDuplicateStreamedOverlaps(*this);
+}
+
 void MultiBlock3D::signalPeriodicity() {
     getBlockCommunicator().signalPeriodicity();
 }
@@ -418,15 +483,28 @@ void MultiBlock3D::getDynamicsDict(Box3D domain, std::map<std::string,int>& dict
 }
 
 void MultiBlock3D::evaluateStatistics() {
+    completeStatistics();
     std::vector<plint> const& blocks = getLocalInfo().getBlocks();
     for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
         plint blockId = blocks[iBlock];
         getComponent(blockId).evaluateStatistics();
     }
-    if (isInternalStatisticsOn()) reduceStatistics();
+    if (isInternalStatisticsOn()) {
+        if (statisticsCycle % statisticsPeriod == 0) {
+            startReduceStatistics();
+        }
+        else {
+            // Keep the result of the last reduction in each individual statistics.
+            for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
+                plint blockId = blocks[iBlock];
+                getComponent(blockId).getInternalStatistics().assignPublic(internalStatistics);
+            }
+        }
+        ++statisticsCycle;
+    }
 }
 
-void MultiBlock3D::reduceStatistics() {
+void MultiBlock3D::startReduceStatistics() {
     std::vector<plint> const& blocks = getLocalInfo().getBlocks();
     std::vector<BlockStatistics const*> individualStatistics;
     // Prepare a vector containing the BlockStatistics of all components
@@ -435,13 +513,20 @@ void MultiBlock3D::reduceStatistics() {
         individualStatistics.push_back(&getComponent(blockId).getInternalStatistics());
     }
 
-    // Execute reduction operation on all individual statistics and store result into
-    //   statistics of current MultiBlock.
-    combinedStatistics -> combine(individualStatistics, this->getInternalStatistics());
-    // Copy result to each individual statistics
+    // Initiate the reduction operation on all individual statistics. The result is
+    //   stored into the statistics of the current MultiBlock by completeStatistics().
+    combinedStatistics -> startCombining(individualStatistics, internalStatistics);
+}
+
+void MultiBlock3D::completeStatistics() {
+    if (!combinedStatistics->isCombining()) return;
+    combinedStatistics -> completeCombining(internalStatistics);
+    // Copy result to each individual statistics. Their running statistics may
+    //   already have been updated in the meantime, and are left untouched.
+    std::vector<plint> const& blocks = getLocalInfo().getBlocks();
     for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
         plint blockId = blocks[iBlock];
-        (getComponent(blockId).getInternalStatistics()) = (this->getInternalStatistics());
+        getComponent(blockId).getInternalStatistics().assignPublic(internalStatistics);
     }
 }
 
@@ -453,6 +538,56 @@ bool MultiBlock3D::isInternalStatisticsOn() const {
     return statisticsOn;
 }
 
+void MultiBlock3D::setInternalStatisticsPeriod(plint statisticsPeriod_) {
+    PLB_PRECONDITION( statisticsPeriod_ > 0 );
+    statisticsPeriod = statisticsPeriod_;
+    statisticsCycle = 0;
+}
+
+plint MultiBlock3D::getInternalStatisticsPeriod() const {
+    return statisticsPeriod;
+}
+
+void MultiBlock3D::toggleOverlappedCommunication(bool overlappedCommunicationOn_) {
+    overlappedCommunicationOn = overlappedCommunicationOn_;
+}
+
+bool MultiBlock3D::isOverlappedCommunicationOn() const {
+    return overlappedCommunicationOn;
+}
+
+/** The envelope update can only be started before the end of the collision-
+ *  streaming step if no automatic data processor needs to be executed between
+ *  the two. Processors which modify no block can be executed after the
+ *  envelope update (see executeReadOnlyInternalProcessors()).
+ */
+bool MultiBlock3D::overlapsCommunication() const {
+    return overlappedCommunicationOn && !automaticProcessorsModify;
+}
+
+void MultiBlock3D::toggleStreamOnlyCommunication(bool streamOnlyCommunicationOn_) {
+    streamOnlyCommunicationOn = streamOnlyCommunicationOn_;
+}
+
+bool MultiBlock3D::isStreamOnlyCommunicationOn() const {
+    return streamOnlyCommunicationOn;
+}
+
+/** The incoming populations are sufficient to update the envelopes as long
+ *  as the cells are modified by nothing else than the collision, i.e. the
+ *  automatic data processors modify no block, and the dynamics objects only
+ *  modify the populations.
+ *
+ *  The envelope cells are then collided locally. They stay equal to the
+ *  cells they duplicate because the block-lattices collide every cell with
+ *  the same code, in the bulk as well as in the envelope (see
+ *  HomogeneousBulkCollision3D).
+ */
+bool MultiBlock3D::communicatesStreamOnly() const {
+    return streamOnlyCommunicationOn && !automaticProcessorsModify &&
+           internalModifT==modif::staticVariables;
+}
+
 PeriodicitySwitch3D const& MultiBlock3D::periodicity() const {
     return periodicitySwitch;
 }
@@ -485,30 +620,220 @@ void MultiBlock3D::setDataTransfer(BlockDataTransfer3D* newDataTransfer) {
     delete newDataTransfer;
 }
 
+void MultiBlock3D::toggleBlockCostMeasurement(bool blockCostMeasurementOn_) {
+    blockCostMeasurementOn = blockCostMeasurementOn_;
+    resetBlockCosts();
+}
+
+bool MultiBlock3D::isBlockCostMeasurementOn() const {
+    return blockCostMeasurementOn;
+}
+
+void MultiBlock3D::resetBlockCosts() {
+    // All local blocks have an entry, so that the threads which execute
+    //   different blocks never modify the structure of the map.
+    blockCosts.clear();
+    std::vector<plint> const& blocks = getLocalInfo().getBlocks();
+    for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
+        blockCosts[blocks[iBlock]] = 0.;
+    }
+}
+
+std::map<plint,double> MultiBlock3D::getBlockCosts() const {
+    if (multiBlockManagement.isPartial()) {
+        plbLogicError("The block costs cannot be gathered on a partial multi-block management.");
+    }
+    std::map<plint,Box3D> const& bulks = getSparseBlockStructure().getBulks();
+    std::vector<double> costs(bulks.size(), 0.);
+    std::map<plint,Box3D>::const_iterator it = bulks.begin();
+    for (pluint pos=0; it != bulks.end(); ++it, ++pos) {
+        std::map<plint,double>::const_iterator costIt = blockCosts.find(it->first);
+        if (costIt != blockCosts.end()) {
+            costs[pos] = costIt->second;
+        }
+    }
+#ifdef PLB_MPI_PARALLEL
+    global::mpi().allReduceVect(costs, MPI_SUM);
+#endif
+    std::map<plint,double> result;
+    it = bulks.begin();
+    for (pluint pos=0; it != bulks.end(); ++it, ++pos) {
+        result[it->first] = costs[pos];
+    }
+    return result;
+}
+
+void MultiBlock3D::addBlockCost(plint blockId, double cost) {
+    std::map<plint,double>::iterator it = blockCosts.find(blockId);
+    PLB_ASSERT( it != blockCosts.end() );
+    it->second += cost;
+}
+
+void MultiBlock3D::migrateComponents (
+        ThreadAttribution const& newAttribution, std::vector<plint>& arrivedBlocks )
+{
+    // A pending reduction of the statistics still refers to the current blocks.
+    completeStatistics();
+    ThreadAttribution const& attribution = multiBlockManagement.getThreadAttribution();
+    int myProcess = global::mpi().getRank();
+    std::map<plint,Box3D> const& bulks = getSparseBlockStructure().getBulks();
+
+    std::vector<plint> departingBlocks;
+    std::vector<int> departingTo, arrivingFrom;
+    arrivedBlocks.clear();
+    std::map<plint,Box3D>::const_iterator it = bulks.begin();
+    for (; it != bulks.end(); ++it) {
+        plint blockId = it->first;
+        int fromProcess = attribution.getMpiProcess(blockId);
+        int toProcess = newAttribution.getMpiProcess(blockId);
+        if (fromProcess != toProcess) {
+            if (fromProcess == myProcess) {
+                departingBlocks.push_back(blockId);
+                departingTo.push_back(toProcess);
+            }
+            if (toProcess == myProcess) {
+                arrivedBlocks.push_back(blockId);
+                arrivingFrom.push_back(fromProcess);
+            }
+        }
+    }
+
+    // Blocks are sent and received in the order of their ids. Between two processes,
+    //   MPI messages do not overtake each other, so that each message matches its block.
+    std::vector<std::vector<char> > sendBuffers(departingBlocks.size());
+    std::vector<long long> sendSizes(departingBlocks.size());
+#ifdef PLB_MPI_PARALLEL
+    std::vector<MPI_Request> requests(2*departingBlocks.size(), MPI_REQUEST_NULL);
+#endif
+    for (pluint iBlock=0; iBlock<departingBlocks.size(); ++iBlock) {
+        plint blockId = departingBlocks[iBlock];
+        sendComponent(blockId, sendBuffers[iBlock]);
+        releaseComponent(blockId);
+        blockCosts.erase(blockId);
+        sendSizes[iBlock] = (long long)sendBuffers[iBlock].size();
+        PLB_ASSERT( sendSizes[iBlock] <= (long long)std::numeric_limits<int>::max() );
+#ifdef PLB_MPI_PARALLEL
+        global::mpi().iSend(&sendSizes[iBlock], 1, departingTo[iBlock], &requests[2*iBlock]);
+        if (sendSizes[iBlock] > 0) {
+            global::mpi().iSend( &sendBuffers[iBlock][0], (int)sendSizes[iBlock],
+                                 departingTo[iBlock], &requests[2*iBlock+1] );
+        }
+#endif
+    }
+
+    multiBlockManagement.changeThreadAttribution(newAttribution.clone());
+
+    for (pluint iBlock=0; iBlock<arrivedBlocks.size(); ++iBlock) {
+        plint blockId = arrivedBlocks[iBlock];
+        allocateComponent(blockId);
+        // The new block has the statistics subscriptions of the multi-block.
+        BlockStatistics& statistics = getComponent(blockId).getInternalStatistics();
+        statistics = internalStatistics;
+        statistics.resetRunning();
+        std::vector<char> buffer;
+#ifdef PLB_MPI_PARALLEL
+        long long bufferSize = 0;
+        global::mpi().receive(&bufferSize, 1, arrivingFrom[iBlock]);
+        buffer.resize(bufferSize);
+        if (bufferSize > 0) {
+            global::mpi().receive(&buffer[0], (int)bufferSize, arrivingFrom[iBlock]);
+        }
+#endif
+        receiveComponent(blockId, buffer);
+        blockCosts[blockId] = 0.;
+    }
+
+#ifdef PLB_MPI_PARALLEL
+    for (pluint iRequest=0; iRequest<requests.size(); ++iRequest) {
+        if (requests[iRequest] != MPI_REQUEST_NULL) {
+            MPI_Status status;
+            global::mpi().wait(&requests[iRequest], &status);
+        }
+    }
+#endif
+    // The communication patterns depend on the attribution of the blocks.
+    signalPeriodicity();
+}
+
+void MultiBlock3D::allocateComponent(plint blockId) {
+    plbLogicError( "The atomic-blocks of a multi-block of type " + getBlockName() +
+                   " cannot be migrated to another process." );
+}
+
+void MultiBlock3D::releaseComponent(plint blockId) {
+    plbLogicError( "The atomic-blocks of a multi-block of type " + getBlockName() +
+                   " cannot be migrated to another process." );
+}
+
+void MultiBlock3D::sendComponent(plint blockId, std::vector<char>& buffer) const {
+    AtomicBlock3D const& component = getComponent(blockId);
+    component.getDataTransfer().send(component.getBoundingBox(), buffer, modif::dataStructure);
+}
+
+void MultiBlock3D::receiveComponent(plint blockId, std::vector<char> const& buffer) {
+    AtomicBlock3D& component = getComponent(blockId);
+    component.getDataTransfer().receive(component.getBoundingBox(), buffer, modif::dataStructure);
+}
+
 
 void MultiBlock3D::executeInternalProcessors() {
-    global::profiler().start("dataProcessor");
+    global::profiler().start(global::prof::dataProcessor);
     // Execute all automatic internal processors.
     for (plint iLevel=0; iLevel<=maxProcessorLevel; ++iLevel) {
         executeInternalProcessors(iLevel);
     }
     // Duplicate boundaries at least once in case there is no automatic processor.
     if (maxProcessorLevel==-1) {
-        global::profiler().start("envelope-update");
+        global::profiler().start(global::prof::envelopeUpdate);
         this->duplicateOverlaps(internalModifT);
-        global::profiler().stop("envelope-update");
+        global::profiler().stop(global::prof::envelopeUpdate);
     }
-    global::profiler().stop("dataProcessor");
+    global::profiler().stop(global::prof::dataProcessor);
+}
+
+/** The processors read the bulk and the envelopes, which are up to date, and
+ *  as they modify no block, no envelope needs to be updated afterwards.
+ */
+void MultiBlock3D::executeReadOnlyInternalProcessors() {
+    PLB_PRECONDITION( !automaticProcessorsModify );
+    global::profiler().start(global::prof::dataProcessor);
+    for (plint iLevel=0; iLevel<=maxProcessorLevel; ++iLevel) {
+        executeInternalProcessors(iLevel, false);
+    }
+    global::profiler().stop(global::prof::dataProcessor);
 }
 
 void MultiBlock3D::executeInternalProcessors(plint level, bool communicate) {
+    // Processors may read the statistics of the atomic-blocks.
+    completeStatistics();
     if (level < 0) {
       global::timer("execute_dp").start();
     }
     std::vector<plint> const& blocks = getLocalInfo().getBlocks();
-    for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
-        plint blockId = blocks[iBlock];
-        getComponent(blockId).executeInternalProcessors(level);
+    const plint numThreads = global::smp().threadedProcessors() ?
+                                 global::smp().getNumThreads() : 1;
+    // The data processors of different blocks are independent, and are
+    //   executed concurrently by the threads to which the blocks are attributed.
+    if (numThreads>1 && blocks.size()>1) {
+        ThreadAttribution const& threadAttribution = multiBlockManagement.getThreadAttribution();
+#ifdef PLB_SMP_THREADS
+        #pragma omp parallel num_threads(numThreads)
+#endif
+        {
+            plint threadId = global::smp().getThreadId();
+            for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
+                plint blockId = blocks[iBlock];
+                if (threadAttribution.getLocalThreadId(blockId)%numThreads == threadId) {
+                    executeComponentProcessors(blockId, level);
+                }
+            }
+        }
+    }
+    else {
+        for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
+            plint blockId = blocks[iBlock];
+            executeComponentProcessors(blockId, level);
+        }
     }
     if (level < 0) {
         global::timer("execute_dp").stop();
@@ -522,6 +847,18 @@ void MultiBlock3D::executeInternalProcessors(plint level, bool communicate) {
     }
 }
 
+void MultiBlock3D::executeComponentProcessors(plint blockId, plint level) {
+    if (blockCostMeasurementOn) {
+        global::PlbTimer timer;
+        timer.start();
+        getComponent(blockId).executeInternalProcessors(level);
+        addBlockCost(blockId, timer.stop());
+    }
+    else {
+        getComponent(blockId).executeInternalProcessors(level);
+    }
+}
+
 void MultiBlock3D::subscribeProcessor (
         plint level,
         std::vector<MultiBlock3D*> modifiedBlocks,
@@ -529,6 +866,13 @@ void MultiBlock3D::subscribeProcessor (
         bool includesEnvelope )
 {
     maxProcessorLevel = std::max(level, maxProcessorLevel);
+    if (level>=0) {
+        for (pluint iBlock=0; iBlock<typeOfModification.size(); ++iBlock) {
+            if (typeOfModification[iBlock]!=modif::nothing) {
+                automaticProcessorsModify = true;
+            }
+        }
+    }
 
     if (level>=0) {
         addModifiedBlocks(level,
@@ -41,6 +41,7 @@
 #include <utility>
 #include <string>
 #include <vector>
+#include <map>
 
 namespace plb {
 
@@ -141,6 +142,10 @@ public:
     void executeInternalProcessors();
     /// Execute all internal dataProcessors at a given level.
     void executeInternalProcessors(plint level, bool communicate=true);
+    /// Execute all internal dataProcessors at positive or zero level, after a
+    ///   collision-streaming step which has already updated the envelopes.
+    ///   This is only possible if the processors modify no block.
+    void executeReadOnlyInternalProcessors();
     /// After adding an internal processor to the atomic-blocks, subscribe it
     /// in the multi-block to guarantee it will be executed.
     void subscribeProcessor(plint level,
@@ -157,16 +162,50 @@ public:
     SparseBlockStructure3D const& getSparseBlockStructure() const;
     /// Get a handle to internal statistics. Don't use this to subscribe new
     /// statistics. Use the method internalStatSubscription() instead.
+    ///   This completes the pending global reduction (see completeStatistics()),
+    ///   and must therefore be called by all processes.
     BlockStatistics& getInternalStatistics();
-    /// Get a constant handle to internal statistics.
+    /// Get a constant handle to internal statistics. This does not communicate:
+    ///   if a global reduction is pending, the statistics of the previous
+    ///   completed reduction are returned. Call completeStatistics() first to
+    ///   get the most recent ones.
     BlockStatistics const& getInternalStatistics() const;
     /// Get object to subscribe new internal statistics.
     StatSubscriber& internalStatSubscription();
     /// Copy running statistics to public statistics, and reset running stats.
+    ///   The global reduction is only initiated here, and completed by
+    ///   completeStatistics(), by the non-constant getInternalStatistics(), or
+    ///   before the next internal processors are run.
     void evaluateStatistics();
+    /// Complete the global reduction of the statistics initiated by
+    ///   evaluateStatistics(), if any. This is a collective operation.
+    void completeStatistics();
     CombinedStatistics const& getCombinedStatistics() const;
     void toggleInternalStatistics(bool statisticsOn_);
     bool isInternalStatisticsOn() const;
+    /// Reduce the statistics across the processes only every statisticsPeriod_
+    ///   evaluations. In-between, the public statistics keep the value of the
+    ///   last reduction. The default period is 1.
+    void setInternalStatisticsPeriod(plint statisticsPeriod_);
+    plint getInternalStatisticsPeriod() const;
+    /// Overlap the envelope update with the collision-streaming step. This
+    ///   is only effective on blocks whose automatic data processors modify
+    ///   no block, such as the integrated statistics; these processors are
+    ///   then executed after the envelope update.
+    void toggleOverlappedCommunication(bool overlappedCommunicationOn_);
+    bool isOverlappedCommunicationOn() const;
+    /// Tells whether the envelope update is currently overlapped with the
+    ///   collision-streaming step.
+    bool overlapsCommunication() const;
+    /// After a collide-and-stream step, only transmit the populations which the
+    ///   envelopes cannot stream themselves. This is only effective on blocks
+    ///   whose automatic data processors modify no block, and whose dynamics
+    ///   objects only modify static data.
+    void toggleStreamOnlyCommunication(bool streamOnlyCommunicationOn_);
+    bool isStreamOnlyCommunicationOn() const;
+    /// Tells whether the envelope update after the current collision-streaming
+    ///   step is restricted to the incoming populations.
+    bool communicatesStreamOnly() const;
     PeriodicitySwitch3D const& periodicity() const;
     PeriodicitySwitch3D& periodicity();
     /// Returns: which kind of data is modified by level-0 processors and by
@@ -178,6 +217,26 @@ public:
     void setRefinementLevel(plint newLevel);
     /// Assign a data transfer policy to all atomic-blocks.
     void setDataTransfer(BlockDataTransfer3D* newDataTransfer);
+    /// Measure the time spent in each local atomic-block by the collision-streaming
+    ///   step and by the internal data processors.
+    void toggleBlockCostMeasurement(bool blockCostMeasurementOn_);
+    bool isBlockCostMeasurementOn() const;
+    /// Discard the times measured so far, and start a new measurement window.
+    void resetBlockCosts();
+    /// Time measured in each atomic-block since the last reset. The result is
+    ///   the same on all processes: this method must be called collectively.
+    std::map<plint,double> getBlockCosts() const;
+    /// Attribute the atomic-blocks to the processes of newAttribution, keeping
+    ///   the sparse block-structure, and move the blocks which change process.
+    /** The data structure of each moving block, envelope included, is sent to
+     *  its new process, which allocates the block and receives it. The other
+     *  blocks are left untouched. The internal data processors of the blocks
+     *  which arrive on this process, returned in arrivedBlocks, are not
+     *  restored: use migrateBlocks() to move multi-blocks which are coupled
+     *  through data processors. This method must be called collectively.
+     **/
+    void migrateComponents( ThreadAttribution const& newAttribution,
+                            std::vector<plint>& arrivedBlocks );
 public:
     virtual AtomicBlock3D& getComponent(plint blockId) =0;
     virtual AtomicBlock3D const& getComponent(plint blockId) const =0;
@@ -192,13 +251,39 @@ private:
     void duplicateOverlapsInModifiedMultiBlocks(plint level);
     void duplicateOverlapsInModifiedMultiBlocks(std::vector<BlockAndModif>& multiBlocks);
     void duplicateOverlapsAtLevelZero(std::vector<BlockAndModif>& multiBlocks);
-    void reduceStatistics();
+    void startReduceStatistics();
+    /// Execute the internal processors of an atomic-block, and measure their
+    ///   cost if required.
+    void executeComponentProcessors(plint blockId, plint level);
+protected:
+    /// Add time spent in the local atomic-block blockId to its measured cost.
+    void addBlockCost(plint blockId, double cost);
+    /// Allocate the atomic-block blockId, which is local in the current management.
+    /** Multi-blocks which support the migration of atomic-blocks override this
+     *  method, as well as releaseComponent(). By default, an error is raised.
+     **/
+    virtual void allocateComponent(plint blockId);
+    /// Deallocate the local atomic-block blockId.
+    virtual void releaseComponent(plint blockId);
+    /// Serialize an atomic-block which moves to another process. By default,
+    ///   its full data structure is sent through its data transfer policy.
+    virtual void sendComponent(plint blockId, std::vector<char>& buffer) const;
+    /// Unserialize an atomic-block which arrives from another process.
+    virtual void receiveComponent(plint blockId, std::vector<char> const& buffer);
 public:
     BlockCommunicator3D const& getBlockCommunicator() const;
     virtual void copyReceive (
                 MultiBlock3D const& fromBlock, Box3D const& fromDomain,
                 Box3D const& toDomain, modif::ModifT whichData=modif::dataStructure ) =0;
     void duplicateOverlaps(modif::ModifT whichData);
+    /// Initiate the envelope update (see BlockCommunicator3D).
+    void startDuplicateOverlaps(modif::ModifT whichData);
+    /// Conclude the envelope update initiated by startDuplicateOverlaps().
+    void completeDuplicateOverlaps(modif::ModifT whichData);
+    /// Envelope update right after a collide-and-stream step (see BlockCommunicator3D).
+    void duplicateStreamedOverlaps();
+    void startDuplicateStreamedOverlaps();
+    void completeDuplicateStreamedOverlaps();
     void signalPeriodicity();
     virtual DataSerializer* getBlockSerializer (
             Box3D const& domain, IndexOrdering::OrderingT ordering ) const;
@@ -222,14 +307,21 @@ private:
     /// an update of their envelope.
     std::vector<std::vector<BlockAndModif> > multiBlocksChangedByAutomaticProcessors;
     plint maxProcessorLevel;
+    /// Whether an automatic processor modifies a block, or only reads data.
+    bool automaticProcessorsModify;
     std::vector<ProcessorStorage3D> storedProcessors;
     BlockCommunicator3D* blockCommunicator;
     BlockStatistics internalStatistics;
     CombinedStatistics* combinedStatistics;
     MultiStatSubscriber3D statSubscriber;
     bool statisticsOn;
+    plint statisticsPeriod, statisticsCycle;
+    bool overlappedCommunicationOn;
+    bool streamOnlyCommunicationOn;
     PeriodicitySwitch3D periodicitySwitch;
     modif::ModifT internalModifT;
+    bool blockCostMeasurementOn;
+    std::map<plint,double> blockCosts;
     id_t id;
 };
 
@@ -322,12 +322,12 @@ void MultiBlockLattice2D<T,Descriptor>::collideAndStream(Box2D domain) {
 
 template<typename T, template<typename U> class Descriptor>
 void MultiBlockLattice2D<T,Descriptor>::collideAndStream() {
-    global::profiler().start("cycle");
+    global::profiler().start(global::prof::cycle);
     collideAndStreamImplementation();
     this->executeInternalProcessors();
     this->evaluateStatistics();
     this->incrementTime();
-    global::profiler().stop("cycle");
+    global::profiler().stop(global::prof::cycle);
     if (global::profiler().cyclingIsAutomatic()) {
         global::profiler().cycle();
     }
@@ -335,12 +335,12 @@ void MultiBlockLattice2D<T,Descriptor>::collideAndStream() {
 
 template<typename T, template<typename U> class Descriptor>
 void MultiBlockLattice2D<T,Descriptor>::externalCollideAndStream() {
-    global::profiler().start("cycle");
+    global::profiler().start(global::prof::cycle);
     collideAndStreamImplementation();
     if (global::profiler().cyclingIsAutomatic()) {
         global::profiler().cycle();
     }
-    global::profiler().stop("cycle");
+    global::profiler().stop(global::prof::cycle);
 }
 
 template<typename T, template<typename U> class Descriptor>
@@ -128,11 +128,34 @@ public:
     static std::string blockName();
     static std::string basicType();
     static std::string descriptorType();
+protected:
+    virtual void allocateComponent(plint blockId);
+    virtual void releaseComponent(plint blockId);
 private:
     void collideAndStreamImplementation();
+    /// Collide and stream, and overlap the update of the envelopes with
+    ///   the computations.
+    void overlappedCollideAndStreamImplementation();
+    /// Apply a method to all local blocks, on the shared-memory threads.
+    void executeOnLocalBlocks(void (MultiBlockLattice3D<T,Descriptor>::*blockMethod)(plint));
+    /// Apply a method to a local block, and measure its cost if required.
+    void executeOnBlock(void (MultiBlockLattice3D<T,Descriptor>::*blockMethod)(plint), plint blockId);
+    /// Domain of a local block on which collideAndStream is applied.
+    Box3D computeCollideAndStreamDomain(plint blockId) const;
+    /// Part of the collide-and-stream domain which does not influence
+    ///   the envelopes of other blocks at the current iteration.
+    Box3D computeInterior(Box3D domain) const;
+    /// Collide and stream one of the local blocks, including its envelope.
+    void collideAndStreamBlock(plint blockId);
+    /// First part of collideAndStreamBlock(), for overlapped communication.
+    void collideAndStreamBlockShell(plint blockId);
+    /// Second part of collideAndStreamBlock(), for overlapped communication.
+    void collideAndStreamBlockInterior(plint blockId);
     void streamImplementation();
     void allocateAndInitialize();
+    void allocateBlockLattice(plint blockId);
     void eliminateStatisticsInEnvelope();
+    void eliminateStatisticsInEnvelope(BlockLattice3D<T,Descriptor>& block);
     Box3D extendPeriodic(Box3D const& box, plint envelopeWidth) const;
 private:
     Dynamics<T,Descriptor>* backgroundDynamics;
@@ -145,6 +168,19 @@ public:
 template<typename T, template<typename U> class Descriptor>
 MultiBlockLattice3D<T,Descriptor>& findMultiBlockLattice3D(id_t id);
 
+/// The stored statistics of the last collision-streaming step. These functions
+///   complete the pending global reduction, and are therefore collective.
+template<typename T, template<typename U> class Descriptor>
+double getStoredAverageDensity(MultiBlockLattice3D<T,Descriptor>& blockLattice);
+
+template<typename T, template<typename U> class Descriptor>
+double getStoredAverageEnergy(MultiBlockLattice3D<T,Descriptor>& blockLattice);
+
+template<typename T, template<typename U> class Descriptor>
+double getStoredMaxVelocity(MultiBlockLattice3D<T,Descriptor>& blockLattice);
+
+/// Same as above, without communication: if a global reduction is pending,
+///   the statistics of the previous completed reduction are returned.
 template<typename T, template<typename U> class Descriptor>
 double getStoredAverageDensity(MultiBlockLattice3D<T,Descriptor> const& blockLattice);
 
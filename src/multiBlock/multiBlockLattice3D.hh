@@ -37,7 +37,9 @@
 #include "core/plbTypenames.h"
 #include "core/multiBlockIdentifiers3D.h"
 #include "core/plbProfiler.h"
+#include "core/plbTimer.h"
 #include "core/dynamicsIdentifiers.h"
+#include "parallelism/smpManager.h"
 #include "dataProcessors/metaStuffWrapper3D.h"
 #include "coProcessors/coProcessor3D.h"
 #include <algorithm>
@@ -333,12 +335,29 @@ void MultiBlockLattice3D<T,Descriptor>::collideAndStream(Box3D domain) {
 
 template<typename T, template<typename U> class Descriptor>
 void MultiBlockLattice3D<T,Descriptor>::collideAndStream() {
-    global::profiler().start("cycle");
-    collideAndStreamImplementation();
-    this->executeInternalProcessors();
+    global::profiler().start(global::prof::cycle);
+    if ( this->overlapsCommunication() &&
+         !this->getMultiBlockManagement().getThreadAttribution().hasCoProcessors() )
+    {
+        overlappedCollideAndStreamImplementation();
+        this->executeReadOnlyInternalProcessors();
+    }
+    else if ( this->communicatesStreamOnly() &&
+              !this->getMultiBlockManagement().getThreadAttribution().hasCoProcessors() )
+    {
+        collideAndStreamImplementation();
+        global::profiler().start(global::prof::envelopeUpdate);
+        this->duplicateStreamedOverlaps();
+        global::profiler().stop(global::prof::envelopeUpdate);
+        this->executeReadOnlyInternalProcessors();
+    }
+    else {
+        collideAndStreamImplementation();
+        this->executeInternalProcessors();
+    }
     this->evaluateStatistics();
     this->incrementTime();
-    global::profiler().stop("cycle");
+    global::profiler().stop(global::prof::cycle);
     if (global::profiler().cyclingIsAutomatic()) {
         global::profiler().cycle();
     }
@@ -346,12 +365,12 @@ void MultiBlockLattice3D<T,Descriptor>::collideAndStream() {
 
 template<typename T, template<typename U> class Descriptor>
 void MultiBlockLattice3D<T,Descriptor>::externalCollideAndStream() {
-    global::profiler().start("cycle");
+    global::profiler().start(global::prof::cycle);
     collideAndStreamImplementation();
     if (global::profiler().cyclingIsAutomatic()) {
         global::profiler().cycle();
     }
-    global::profiler().stop("cycle");
+    global::profiler().stop(global::prof::cycle);
 }
 
 template<typename T, template<typename U> class Descriptor>
@@ -367,27 +386,125 @@ void MultiBlockLattice3D<T,Descriptor>::collideAndStreamImplementation() {
                  global::defaultCoProcessor3D<T>().collideAndStream(handle);
             }
             else {
-                SmartBulk3D bulk(this->getMultiBlockManagement(), blockId);
-                // CollideAndStream must be applied to full domain,
-                //   including currently active envelopes.
-                Box3D domain = extendPeriodic(bulk.computeNonPeriodicEnvelope(),
-                                              this->getMultiBlockManagement().getEnvelopeWidth());
-                it->second -> collideAndStream( bulk.toLocal(domain) );
+                collideAndStreamBlock(blockId);
             }
         }
     }
     else  {
-        for ( typename BlockMap::iterator it = blockLattices.begin();
-              it != blockLattices.end(); ++it)
+        executeOnLocalBlocks(&MultiBlockLattice3D<T,Descriptor>::collideAndStreamBlock);
+    }
+}
+
+/** The cells of each block which are sent to the envelopes of other blocks,
+ *  and their neighbors, are collided and streamed first. The envelope update
+ *  is initiated, and the rest of the blocks is collided and streamed while
+ *  the messages are on their way.
+ */
+template<typename T, template<typename U> class Descriptor>
+void MultiBlockLattice3D<T,Descriptor>::overlappedCollideAndStreamImplementation() {
+    bool streamOnly = this->communicatesStreamOnly();
+    executeOnLocalBlocks(&MultiBlockLattice3D<T,Descriptor>::collideAndStreamBlockShell);
+    global::profiler().start(global::prof::envelopeUpdate);
+    if (streamOnly) {
+        this->startDuplicateStreamedOverlaps();
+    }
+    else {
+        this->startDuplicateOverlaps(this->getInternalTypeOfModification());
+    }
+    global::profiler().stop(global::prof::envelopeUpdate);
+    executeOnLocalBlocks(&MultiBlockLattice3D<T,Descriptor>::collideAndStreamBlockInterior);
+    global::profiler().start(global::prof::envelopeUpdate);
+    if (streamOnly) {
+        this->completeDuplicateStreamedOverlaps();
+    }
+    else {
+        this->completeDuplicateOverlaps(this->getInternalTypeOfModification());
+    }
+    global::profiler().stop(global::prof::envelopeUpdate);
+}
+
+template<typename T, template<typename U> class Descriptor>
+void MultiBlockLattice3D<T,Descriptor>::executeOnLocalBlocks (
+        void (MultiBlockLattice3D<T,Descriptor>::*blockMethod)(plint) )
+{
+    ThreadAttribution const& threadAttribution=this->getMultiBlockManagement().getThreadAttribution();
+    std::vector<plint> const& blocks = this->getLocalInfo().getBlocks();
+    const plint numThreads = global::smp().getNumThreads();
+    // If there are at least as many local blocks as threads, each thread
+    //   executes the blocks which are attributed to it. Otherwise, the
+    //   blocks are executed one after the other, and the bulk of each
+    //   block is split among the threads (see BlockLattice3D).
+    if (numThreads>1 && (plint)blocks.size()>=numThreads) {
+#ifdef PLB_SMP_THREADS
+        #pragma omp parallel num_threads(numThreads)
+#endif
         {
-            SmartBulk3D bulk(this->getMultiBlockManagement(), it->first);
-            // CollideAndStream must be applied to full domain,
-            //   including currently active envelopes.
-            Box3D domain = extendPeriodic(bulk.computeNonPeriodicEnvelope(),
-                                          this->getMultiBlockManagement().getEnvelopeWidth());
-            it->second -> collideAndStream( bulk.toLocal(domain) );
+            plint threadId = global::smp().getThreadId();
+            for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
+                if (threadAttribution.getLocalThreadId(blocks[iBlock])%numThreads == threadId) {
+                    executeOnBlock(blockMethod, blocks[iBlock]);
+                }
+            }
         }
     }
+    else {
+        for (pluint iBlock=0; iBlock<blocks.size(); ++iBlock) {
+            executeOnBlock(blockMethod, blocks[iBlock]);
+        }
+    }
+}
+
+template<typename T, template<typename U> class Descriptor>
+void MultiBlockLattice3D<T,Descriptor>::executeOnBlock (
+        void (MultiBlockLattice3D<T,Descriptor>::*blockMethod)(plint), plint blockId )
+{
+    if (this->isBlockCostMeasurementOn()) {
+        global::PlbTimer timer;
+        timer.start();
+        (this->*blockMethod)(blockId);
+        this->addBlockCost(blockId, timer.stop());
+    }
+    else {
+        (this->*blockMethod)(blockId);
+    }
+}
+
+template<typename T, template<typename U> class Descriptor>
+Box3D MultiBlockLattice3D<T,Descriptor>::computeCollideAndStreamDomain(plint blockId) const {
+    SmartBulk3D bulk(this->getMultiBlockManagement(), blockId);
+    // CollideAndStream must be applied to full domain,
+    //   including currently active envelopes.
+    Box3D domain = extendPeriodic(bulk.computeNonPeriodicEnvelope(),
+                                  this->getMultiBlockManagement().getEnvelopeWidth());
+    return bulk.toLocal(domain);
+}
+
+template<typename T, template<typename U> class Descriptor>
+void MultiBlockLattice3D<T,Descriptor>::collideAndStreamBlock(plint blockId) {
+    getComponent(blockId).collideAndStream(computeCollideAndStreamDomain(blockId));
+}
+
+/** The cells which are sent to other blocks are at a distance smaller than
+ *  two envelope widths from the boundary of the collide-and-stream domain,
+ *  and their neighbors at a distance smaller than two envelope widths plus
+ *  the vicinity. All of them belong to the shell.
+ */
+template<typename T, template<typename U> class Descriptor>
+Box3D MultiBlockLattice3D<T,Descriptor>::computeInterior(Box3D domain) const {
+    plint envelopeWidth = this->getMultiBlockManagement().getEnvelopeWidth();
+    return domain.enlarge(-(2*envelopeWidth+Descriptor<T>::vicinity));
+}
+
+template<typename T, template<typename U> class Descriptor>
+void MultiBlockLattice3D<T,Descriptor>::collideAndStreamBlockShell(plint blockId) {
+    Box3D domain = computeCollideAndStreamDomain(blockId);
+    getComponent(blockId).collideAndStreamShell(domain, computeInterior(domain));
+}
+
+template<typename T, template<typename U> class Descriptor>
+void MultiBlockLattice3D<T,Descriptor>::collideAndStreamBlockInterior(plint blockId) {
+    Box3D domain = computeCollideAndStreamDomain(blockId);
+    getComponent(blockId).collideAndStreamInterior(domain, computeInterior(domain));
 }
 
 template<typename T, template<typename U> class Descriptor>
@@ -419,39 +536,68 @@ void MultiBlockLattice3D<T,Descriptor>::allocateAndInitialize()
     this->getInternalStatistics().subscribeMax();     // Subscribe max uSqr
 
     for (pluint iBlock=0; iBlock<this->getLocalInfo().getBlocks().size(); ++iBlock) {
-        plint blockId = this->getLocalInfo().getBlocks()[iBlock];
-        SmartBulk3D bulk(this->getMultiBlockManagement(), blockId);
-        Box3D envelope = bulk.computeEnvelope();
-        BlockLattice3D<T,Descriptor>* newLattice
-            = new BlockLattice3D<T,Descriptor> (
-                    envelope.getNx(), envelope.getNy(), envelope.getNz(),
-                    backgroundDynamics->clone() );
-        newLattice -> setLocation(Dot3D(envelope.x0, envelope.y0, envelope.z0));
-        blockLattices[blockId] = newLattice;
+        allocateBlockLattice(this->getLocalInfo().getBlocks()[iBlock]);
     }
 }
 
+template<typename T, template<typename U> class Descriptor>
+void MultiBlockLattice3D<T,Descriptor>::allocateBlockLattice(plint blockId)
+{
+    SmartBulk3D bulk(this->getMultiBlockManagement(), blockId);
+    Box3D envelope = bulk.computeEnvelope();
+    BlockLattice3D<T,Descriptor>* newLattice
+        = new BlockLattice3D<T,Descriptor> (
+                envelope.getNx(), envelope.getNy(), envelope.getNz(),
+                backgroundDynamics->clone() );
+    newLattice -> setLocation(Dot3D(envelope.x0, envelope.y0, envelope.z0));
+    blockLattices[blockId] = newLattice;
+}
+
+template<typename T, template<typename U> class Descriptor>
+void MultiBlockLattice3D<T,Descriptor>::allocateComponent(plint blockId)
+{
+    allocateBlockLattice(blockId);
+    BlockLattice3D<T,Descriptor>& block = *blockLattices[blockId];
+    eliminateStatisticsInEnvelope(block);
+    block.getTimeCounter().resetTime(this->getTimeCounter().getTime());
+}
+
+template<typename T, template<typename U> class Descriptor>
+void MultiBlockLattice3D<T,Descriptor>::releaseComponent(plint blockId)
+{
+    typename BlockMap::iterator it = blockLattices.find(blockId);
+    PLB_ASSERT( it != blockLattices.end() );
+    delete it->second;
+    blockLattices.erase(it);
+}
+
 template<typename T, template<typename U> class Descriptor>
 void MultiBlockLattice3D<T,Descriptor>::eliminateStatisticsInEnvelope()
 {
     for ( typename BlockMap::iterator it = blockLattices.begin();
           it != blockLattices.end(); ++it )
     {
-        plint envelopeWidth = this->getMultiBlockManagement().getEnvelopeWidth();
-        BlockLattice3D<T,Descriptor>& block = *it->second;
-        plint maxX = block.getNx()-1;
-        plint maxY = block.getNy()-1;
-        plint maxZ = block.getNz()-1;
-        
-        block.specifyStatisticsStatus(Box3D(0, maxX, 0, maxY, 0, envelopeWidth-1), false);
-        block.specifyStatisticsStatus(Box3D(0, maxX, 0, maxY, maxZ-envelopeWidth+1, maxZ), false);
-        block.specifyStatisticsStatus(Box3D(0, maxX, 0, envelopeWidth-1, 0, maxZ), false);
-        block.specifyStatisticsStatus(Box3D(0, maxX, maxY-envelopeWidth+1, maxY, 0, maxZ), false);
-        block.specifyStatisticsStatus(Box3D(0, envelopeWidth-1, 0, maxY, 0, maxZ), false);
-        block.specifyStatisticsStatus(Box3D(maxX-envelopeWidth+1, maxX,  0, maxY, 0, maxZ), false);
+        eliminateStatisticsInEnvelope(*it->second);
     }
 }
 
+template<typename T, template<typename U> class Descriptor>
+void MultiBlockLattice3D<T,Descriptor>::eliminateStatisticsInEnvelope (
+        BlockLattice3D<T,Descriptor>& block )
+{
+    plint envelopeWidth = this->getMultiBlockManagement().getEnvelopeWidth();
+    plint maxX = block.getNx()-1;
+    plint maxY = block.getNy()-1;
+    plint maxZ = block.getNz()-1;
+
+    block.specifyStatisticsStatus(Box3D(0, maxX, 0, maxY, 0, envelopeWidth-1), false);
+    block.specifyStatisticsStatus(Box3D(0, maxX, 0, maxY, maxZ-envelopeWidth+1, maxZ), false);
+    block.specifyStatisticsStatus(Box3D(0, maxX, 0, envelopeWidth-1, 0, maxZ), false);
+    block.specifyStatisticsStatus(Box3D(0, maxX, maxY-envelopeWidth+1, maxY, 0, maxZ), false);
+    block.specifyStatisticsStatus(Box3D(0, envelopeWidth-1, 0, maxY, 0, maxZ), false);
+    block.specifyStatisticsStatus(Box3D(maxX-envelopeWidth+1, maxX,  0, maxY, 0, maxZ), false);
+}
+
 template<typename T, template<typename U> class Descriptor>
 std::map<plint,BlockLattice3D<T,Descriptor>*>&
     MultiBlockLattice3D<T,Descriptor>::getBlockLattices()
@@ -559,6 +705,24 @@ MultiBlockLattice3D<T,Descriptor>& findMultiBlockLattice3D(id_t id) {
     return (MultiBlockLattice3D<T,Descriptor>&)(*multiBlock);
 }
 
+template<typename T, template<typename U> class Descriptor>
+double getStoredAverageDensity(MultiBlockLattice3D<T,Descriptor>& blockLattice) {
+    blockLattice.completeStatistics();
+    return getStoredAverageDensity((MultiBlockLattice3D<T,Descriptor> const&)blockLattice);
+}
+
+template<typename T, template<typename U> class Descriptor>
+double getStoredAverageEnergy(MultiBlockLattice3D<T,Descriptor>& blockLattice) {
+    blockLattice.completeStatistics();
+    return getStoredAverageEnergy((MultiBlockLattice3D<T,Descriptor> const&)blockLattice);
+}
+
+template<typename T, template<typename U> class Descriptor>
+double getStoredMaxVelocity(MultiBlockLattice3D<T,Descriptor>& blockLattice) {
+    blockLattice.completeStatistics();
+    return getStoredMaxVelocity((MultiBlockLattice3D<T,Descriptor> const&)blockLattice);
+}
+
 template<typename T, template<typename U> class Descriptor>
 double getStoredAverageDensity(MultiBlockLattice3D<T,Descriptor> const& blockLattice) {
     return Descriptor<T>::fullRho (
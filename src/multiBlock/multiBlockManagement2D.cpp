@@ -255,9 +255,10 @@ MultiBlockManagement2D extend( MultiBlockManagement2D const& management,
         extend( management.getSparseBlockStructure(), addedBulk, addedBulk, newIds );
     std::vector<plint> mpiProcesses(newIds.size()), localThreads(newIds.size());
     for (pluint iNew=0; iNew<newIds.size(); ++iNew) {
-        // Default-attribute the newly created blocks to the main process.
+        // Default-attribute the newly created blocks to the main process,
+        //   and let it choose their local thread.
         mpiProcesses[iNew] = global::mpi().bossId();
-        localThreads[iNew] = 0;
+        localThreads[iNew] = -1;
     }
     return MultiBlockManagement2D (
             resultStructure,
@@ -27,9 +27,13 @@
  */
 
 #include "multiBlock/multiBlockManagement3D.h"
+#include "multiBlock/distributedBlockDirectory3D.h"
 #include "multiBlock/staticRepartitions3D.h"
 #include "multiBlock/defaultMultiBlockPolicy3D.h"
 #include "core/plbDebug.h"
+#include "core/runTimeDiagnostics.h"
+#include "core/util.h"
+#include "parallelism/mpiManager.h"
 #include <algorithm>
 
 namespace plb {
@@ -37,20 +41,27 @@ namespace plb {
 MultiBlockManagement3D::MultiBlockManagement3D (
         SparseBlockStructure3D const& sparseBlock_,
         ThreadAttribution* threadAttribution_,
-        plint envelopeWidth_, plint refinementLevel_ )
+        plint envelopeWidth_, plint refinementLevel_, bool partial_,
+        DistributedBlockDirectory3D* directory_ )
     : envelopeWidth(envelopeWidth_),
       sparseBlock(sparseBlock_),
       threadAttribution(threadAttribution_),
       localInfo(sparseBlock, getThreadAttribution(), envelopeWidth),
-      refinementLevel(refinementLevel_)
-{ }
+      refinementLevel(refinementLevel_),
+      partial(partial_),
+      directory(directory_)
+{
+    PLB_PRECONDITION( partial || !directory );
+}
 
 MultiBlockManagement3D::MultiBlockManagement3D(MultiBlockManagement3D const& rhs)
     : envelopeWidth(rhs.envelopeWidth),
       sparseBlock(rhs.sparseBlock),
       threadAttribution(rhs.threadAttribution->clone()),
       localInfo(rhs.localInfo),
-      refinementLevel(rhs.refinementLevel)
+      refinementLevel(rhs.refinementLevel),
+      partial(rhs.partial),
+      directory(rhs.directory ? new DistributedBlockDirectory3D(*rhs.directory) : 0)
 { }
 
 MultiBlockManagement3D& MultiBlockManagement3D::operator=(MultiBlockManagement3D const& rhs) {
@@ -65,10 +76,13 @@ void MultiBlockManagement3D::swap(MultiBlockManagement3D& rhs) {
     std::swap(threadAttribution, rhs.threadAttribution);
     localInfo.swap(rhs.localInfo);
     std::swap(refinementLevel, rhs.refinementLevel);
+    std::swap(partial, rhs.partial);
+    std::swap(directory, rhs.directory);
 }
 
 MultiBlockManagement3D::~MultiBlockManagement3D() {
     delete threadAttribution;
+    delete directory;
 }
 
 plint MultiBlockManagement3D::getEnvelopeWidth() const {
@@ -182,6 +196,23 @@ bool MultiBlockManagement3D::findAllLocalRepresentations (
             foundZ.push_back(bulk.toLocalZ(iZ-overlap.getShiftZ()));
         }
     }
+    // A partial management does not know the remote blocks, and the processes
+    //   find out together whether one of them holds the cell in a bulk.
+    bool isInBulk = hasBulkCell;
+    if (partial) {
+#ifdef PLB_MPI_PARALLEL
+        int numHolders = hasBulkCell ? 1 : 0;
+        global::mpi().reduceAndBcast(numHolders, MPI_SUM);
+        isInBulk = numHolders>0;
+#endif
+    }
+    else {
+        isInBulk = sparseBlock.locate(iX,iY,iZ) >= 0;
+    }
+    if (!isInBulk) {
+        plbLogicError( "The cell (" + util::val2str(iX) + "," + util::val2str(iY) + "," +
+                       util::val2str(iZ) + ") is not in the bulk of any block of the multi-block." );
+    }
     return hasBulkCell;
 }
 
@@ -198,6 +229,12 @@ void MultiBlockManagement3D::changeEnvelopeWidth(plint newEnvelopeWidth) {
     localInfo = LocalMultiBlockInfo3D(sparseBlock, getThreadAttribution(), envelopeWidth);
 }
 
+void MultiBlockManagement3D::changeThreadAttribution(ThreadAttribution* newAttribution) {
+    delete threadAttribution;
+    threadAttribution = newAttribution;
+    localInfo = LocalMultiBlockInfo3D(sparseBlock, getThreadAttribution(), envelopeWidth);
+}
+
 bool MultiBlockManagement3D::equivalentTo(MultiBlockManagement3D const& rhs) const {
     std::map<plint,Box3D> const& bulks = sparseBlock.getBulks();
     std::map<plint,Box3D>::const_iterator it = bulks.begin();
@@ -216,13 +253,43 @@ bool MultiBlockManagement3D::equivalentTo(MultiBlockManagement3D const& rhs) con
            refinementLevel == rhs.refinementLevel;
 }
 
+bool MultiBlockManagement3D::isPartial() const {
+    return partial;
+}
+
+DistributedBlockDirectory3D const* MultiBlockManagement3D::getDirectory() const {
+    return directory;
+}
+
+void MultiBlockManagement3D::locate (
+        std::vector<Dot3D> const& points,
+        std::vector<plint>& ids, std::vector<int>& processes ) const
+{
+    if (partial) {
+        if (!directory) {
+            plbLogicError("Remote blocks can only be located on a partial multi-block management "
+                          "which has a distributed directory.");
+        }
+        directory->locate(points, ids, processes);
+    }
+    else {
+        ids.resize(points.size());
+        processes.resize(points.size());
+        for (pluint iPoint=0; iPoint<points.size(); ++iPoint) {
+            ids[iPoint] = sparseBlock.locate(points[iPoint].x, points[iPoint].y, points[iPoint].z);
+            processes[iPoint] = ids[iPoint]<0 ? -1 : threadAttribution->getMpiProcess(ids[iPoint]);
+        }
+    }
+}
+
 MultiBlockManagement3D scale(MultiBlockManagement3D const& originalManagement, plint relativeLevel)
 {
     return MultiBlockManagement3D (
             scale(originalManagement.getSparseBlockStructure(), relativeLevel),
             originalManagement.getThreadAttribution().clone(),
             originalManagement.getEnvelopeWidth(),
-            originalManagement.getRefinementLevel()+relativeLevel );
+            originalManagement.getRefinementLevel()+relativeLevel,
+            originalManagement.isPartial() );
 }
 
 MultiBlockManagement3D intersect (
@@ -233,7 +300,8 @@ MultiBlockManagement3D intersect (
             intersect(originalManagement.getSparseBlockStructure(), subDomain, crop),
             originalManagement.getThreadAttribution().clone(),
             originalManagement.getEnvelopeWidth(),
-            originalManagement.getRefinementLevel() );
+            originalManagement.getRefinementLevel(),
+            originalManagement.isPartial() );
 }
 
 MultiBlockManagement3D intersect (
@@ -245,7 +313,8 @@ MultiBlockManagement3D intersect (
                       subDomain, newBoundingBox),
             originalManagement.getThreadAttribution().clone(),
             originalManagement.getEnvelopeWidth(),
-            originalManagement.getRefinementLevel() );
+            originalManagement.getRefinementLevel(),
+            originalManagement.isPartial() );
 }
 
 MultiBlockManagement3D intersect( MultiBlockManagement3D const& management1,
@@ -256,7 +325,8 @@ MultiBlockManagement3D intersect( MultiBlockManagement3D const& management1,
                       management2.getSparseBlockStructure(), crop),
             management1.getThreadAttribution().clone(),
             management1.getEnvelopeWidth(),
-            management1.getRefinementLevel() );
+            management1.getRefinementLevel(),
+            management1.isPartial() || management2.isPartial() );
 }
 
 
@@ -268,9 +338,10 @@ MultiBlockManagement3D extend( MultiBlockManagement3D const& management,
         extend( management.getSparseBlockStructure(), addedBulk, addedBulk, newIds );
     std::vector<plint> mpiProcesses(newIds.size()), localThreads(newIds.size());
     for (pluint iNew=0; iNew<newIds.size(); ++iNew) {
-        // Default-attribute the newly created blocks to the main process.
+        // Default-attribute the newly created blocks to the main process,
+        //   and let it choose their local thread.
         mpiProcesses[iNew] = global::mpi().bossId();
-        localThreads[iNew] = 0;
+        localThreads[iNew] = -1;
     }
     return MultiBlockManagement3D (
             resultStructure,
@@ -372,6 +443,14 @@ MultiBlockManagement3D align( std::vector<Box3D> const& originalDomain,
 MultiBlockManagement3D reparallelize(MultiBlockManagement3D const& management,
                                      plint blockLx, plint blockLy, plint blockLz)
 {
+    if (management.isPartial()) {
+        if (!management.getDirectory()) {
+            plbLogicError("A partial multi-block management without distributed directory "
+                          "cannot be reparallelized.");
+        }
+        return management.getDirectory()->reparallelize(blockLx, blockLy, blockLz).
+                   createLocalManagement(management.getEnvelopeWidth(), management.getRefinementLevel());
+    }
     SparseBlockStructure3D resultStructure =
         reparallelize(management.getSparseBlockStructure(), blockLx, blockLy, blockLz);
     plint numBlocks = resultStructure.nextIncrementalId();
@@ -40,12 +40,17 @@
 
 namespace plb {
 
+class DistributedBlockDirectory3D;
+
 class MultiBlockManagement3D {
 public:
+    /// The management takes ownership of threadAttribution_ and directory_.
     MultiBlockManagement3D( SparseBlockStructure3D const& sparseBlock_,
                             ThreadAttribution* threadAttribution_,
                             plint envelopeWidth_,
-                            plint refinementLevel_ =0 );
+                            plint refinementLevel_ =0,
+                            bool partial_ =false,
+                            DistributedBlockDirectory3D* directory_ =0 );
     MultiBlockManagement3D(MultiBlockManagement3D const& rhs);
     MultiBlockManagement3D& operator=(MultiBlockManagement3D const& rhs);
     void swap(MultiBlockManagement3D& rhs);
@@ -62,21 +67,51 @@ public:
     bool findInLocalBulk (
             plint iX, plint iY, plint iZ, plint& foundId,
             plint& localX, plint& localY, plint& localZ ) const;
+    /// Find the representations of a cell in the local blocks, including the
+    ///   envelopes, and tell whether one of them is in a bulk.
+    /** This is used by the distributed accessors of the multi-blocks, in which
+     *  the process holding the cell in a bulk broadcasts its value. A cell which
+     *  is in no bulk raises an error instead of blocking the other processes. On
+     *  a partial management, this is decided through a reduction, and the
+     *  function must be called collectively.
+     **/
     bool findAllLocalRepresentations (
             plint iX, plint iY, plint iZ, std::vector<plint>& foundId,
             std::vector<plint>& foundX, std::vector<plint>& foundY,
             std::vector<plint>& foundZ ) const;
+    /// For each point, find the block whose bulk contains it and the process
+    ///   which owns this block, or -1 for points outside all blocks.
+    /** On a partial management, the remote blocks are found through the
+     *  distributed directory, and the function must be called collectively.
+     **/
+    void locate( std::vector<Dot3D> const& points,
+                 std::vector<plint>& ids, std::vector<int>& processes ) const;
     plint getRefinementLevel() const;
     void setRefinementLevel(plint newLevel);
     void changeEnvelopeWidth(plint newEnvelopeWidth);
+    /// Replace the thread attribution, keeping the sparse block-structure. The
+    ///   management takes ownership of newAttribution.
+    void changeThreadAttribution(ThreadAttribution* newAttribution);
     // Same multi-block-management, except for envelope-width
     bool equivalentTo(MultiBlockManagement3D const& rhs) const;
+    /// Tells whether the sparse block-structure only holds a part of the
+    ///   blocks, namely the local blocks and their neighbors (see
+    ///   DistributedBlockDirectory3D::createLocalManagement()). Operations
+    ///   which need all blocks raise an error on a partial management.
+    bool isPartial() const;
+    /// Distributed directory of a partial management obtained from
+    ///   DistributedBlockDirectory3D::createLocalManagement(), or 0. The
+    ///   partial managements derived from it by scale() or intersect() have
+    ///   no directory.
+    DistributedBlockDirectory3D const* getDirectory() const;
 private:
     plint                  envelopeWidth;
     SparseBlockStructure3D sparseBlock;
     ThreadAttribution*     threadAttribution;
     LocalMultiBlockInfo3D  localInfo;
     plint                  refinementLevel;
+    bool                   partial;
+    DistributedBlockDirectory3D* directory;
 };
 
 MultiBlockManagement3D scale(MultiBlockManagement3D const& originalManagement, plint relativeLevel);
@@ -131,7 +166,9 @@ MultiBlockManagement3D align( std::vector<Box3D> const& originalDomain,
 
 /// Re-create a block-management by covering the sparse structure with regular blocks.
 /** The parameters blockLx, blockLy, and blockLz indicate the approximate size of the
- *  blocks.
+ *  blocks. A partial management is reparallelized through its distributed
+ *  directory, and the result is again a partial management; the function must
+ *  then be called collectively.
  **/
 MultiBlockManagement3D reparallelize(MultiBlockManagement3D const& management,
                                      plint blockLx, plint blockLy, plint blockLz);
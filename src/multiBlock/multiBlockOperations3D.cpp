@@ -29,6 +29,7 @@
 #include "multiBlock/multiBlockOperations3D.h"
 #include "multiBlock/multiBlockOperations3D.hh"
 #include "core/plbDebug.h"
+#include <set>
 
 namespace plb {
 
@@ -149,6 +150,34 @@ void addInternalProcessor( DataProcessorGenerator3D const& generator, MultiBlock
     actor.storeProcessor(generator, multiBlockArgs, level);
 }
 
+void reintegrateInternalProcessors(MultiBlock3D& actor, std::vector<plint> const& blockIds)
+{
+    std::set<plint> reallocatedBlocks(blockIds.begin(), blockIds.end());
+    std::vector<MultiBlock3D::ProcessorStorage3D> const& processors = actor.getStoredProcessors();
+    for (pluint iProcessor=0; iProcessor<processors.size(); ++iProcessor) {
+        std::vector<MultiBlock3D*> multiBlockArgs = processors[iProcessor].getMultiBlocks();
+        MultiProcessing3D<DataProcessorGenerator3D const, DataProcessorGenerator3D >
+            multiProcessing(processors[iProcessor].getGenerator(), multiBlockArgs);
+        std::vector<DataProcessorGenerator3D*> const& retainedGenerators = multiProcessing.getRetainedGenerators();
+        std::vector<std::vector<plint> > const& atomicBlockNumbers = multiProcessing.getAtomicBlockNumbers();
+
+        for (pluint iGenerator=0; iGenerator<retainedGenerators.size(); ++iGenerator) {
+            PLB_ASSERT(!atomicBlockNumbers[iGenerator].empty());
+            if (reallocatedBlocks.find(atomicBlockNumbers[iGenerator][0]) == reallocatedBlocks.end()) {
+                continue;
+            }
+            std::vector<AtomicBlock3D*> extractedAtomicBlocks(multiBlockArgs.size());
+            for (pluint iBlock=0; iBlock<extractedAtomicBlocks.size(); ++iBlock) {
+                extractedAtomicBlocks[iBlock] =
+                    &multiBlockArgs[iBlock]->getComponent(atomicBlockNumbers[iGenerator][iBlock]);
+            }
+            AtomicBlock3D& atomicActor = actor.getComponent(atomicBlockNumbers[iGenerator][0]);
+            plb::addInternalProcessor( *retainedGenerators[iGenerator], atomicActor,
+                                       extractedAtomicBlocks, processors[iProcessor].getLevel() );
+        }
+    }
+}
+
 void addInternalProcessor( DataProcessorGenerator3D const& generator,
                            std::vector<MultiBlock3D*> multiBlocks, plint level )
 {
@@ -72,6 +72,15 @@ void addInternalProcessor( DataProcessorGenerator3D const& generator,
                            MultiBlock3D& object1, MultiBlock3D& object2,
                            plint level=0 );
 
+/// Re-create, on the atomic-blocks blockIds of the actor, the internal processors
+///   which were added to the actor through addInternalProcessor().
+/** This is used when atomic-blocks have been re-allocated, for example after
+ *  they migrated to another process (see migrateBlocks()). The other atomic-blocks
+ *  keep their processors, and the processors are not subscribed again in the
+ *  multi-block.
+ **/
+void reintegrateInternalProcessors(MultiBlock3D& actor, std::vector<plint> const& blockIds);
+
 
 
 template<class OriginalGenerator, class MutableGenerator>
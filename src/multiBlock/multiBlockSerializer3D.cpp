@@ -29,6 +29,7 @@
 #include "multiBlock/multiBlockSerializer3D.h"
 #include "atomicBlock/atomicBlock3D.h"
 #include "core/plbDebug.h"
+#include "core/runTimeDiagnostics.h"
 
 namespace plb {
 
@@ -41,8 +42,13 @@ MultiBlockSerializer3D::MultiBlockSerializer3D (
       ordering(ordering_),
       domain(multiBlock.getBoundingBox()),
       iX(domain.x0), iY(domain.y0), iZ(domain.z0),
-      buffer(1) // this avoids buffer of size 0 which one cannot point to
-{ }
+      buffer(1), // this avoids buffer of size 0 which one cannot point to
+      chunk(&buffer[0])
+{
+    if (multiBlock.getMultiBlockManagement().isPartial()) {
+        plbLogicError("A partial multi-block management cannot be serialized.");
+    }
+}
 
 MultiBlockSerializer3D::MultiBlockSerializer3D (
         MultiBlock3D const& multiBlock_,
@@ -51,8 +57,13 @@ MultiBlockSerializer3D::MultiBlockSerializer3D (
     : multiBlock(multiBlock_), ordering(ordering_),
       domain(domain_),
       iX(domain.x0), iY(domain.y0), iZ(domain.z0),
-      buffer(1) // this avoids buffer of size 0 which one cannot point to
-{ }
+      buffer(1), // this avoids buffer of size 0 which one cannot point to
+      chunk(&buffer[0])
+{
+    if (multiBlock.getMultiBlockManagement().isPartial()) {
+        plbLogicError("A partial multi-block management cannot be serialized.");
+    }
+}
 
 MultiBlockSerializer3D* MultiBlockSerializer3D::clone() const {
     return new MultiBlockSerializer3D(*this);
@@ -90,6 +101,7 @@ const char* MultiBlockSerializer3D::getNextDataBuffer(pluint& bufferSize) const
             }
             else {
                 bufferSize = 0;
+                chunk = &buffer[0];
             }
         }
         iZ += nextChunkSize;
@@ -131,7 +143,7 @@ const char* MultiBlockSerializer3D::getNextDataBuffer(pluint& bufferSize) const
         }
     }
     if (global::mpi().isMainProcessor()) {
-        return &buffer[0];
+        return chunk;
     }
     else {
         return 0;
@@ -173,6 +185,7 @@ void MultiBlockSerializer3D::computeBufferAlongX ( plint nextBlockId,
         nextBlock.getDataTransfer().send (
                 Box3D(localX,localX+nextChunkSize-1, localY, localY, localZ, localZ),
                 buffer, modif::staticVariables );
+        chunk = &buffer[0];
     }
     communicateBuffer(bufferSize, nextBlockId, blockIsLocal);
 }
@@ -194,6 +207,7 @@ void MultiBlockSerializer3D::computeBufferAlongY (
         nextBlock.getDataTransfer().send (
                 Box3D(localX,localX, localY, localY+nextChunkSize-1, localZ, localZ),
                 buffer, modif::staticVariables );
+        chunk = &buffer[0];
     }
     communicateBuffer(bufferSize, nextBlockId, blockIsLocal);
 }
@@ -205,16 +219,22 @@ void MultiBlockSerializer3D::computeBufferAlongZ (
     bool blockIsLocal = isLocal(nextBlockId);
     if (blockIsLocal) {
         SmartBulk3D bulk(multiBlock.getMultiBlockManagement(), nextBlockId);
-        // Avoid pointing to a buffer of size 0, as this leads to undefined behavior.
-        PLB_ASSERT(bufferSize>0);
-        buffer.resize(bufferSize);
         plint localX = bulk.toLocalX(iX);
         plint localY = bulk.toLocalY(iY);
         plint localZ = bulk.toLocalZ(iZ);
-        AtomicBlock3D const& nextBlock = multiBlock.getComponent(nextBlockId);
-        nextBlock.getDataTransfer().send (
-                Box3D(localX,localX, localY,localY, localZ, localZ+nextChunkSize-1),
-                buffer, modif::staticVariables );
+        Box3D localChunk(localX,localX, localY,localY, localZ, localZ+nextChunkSize-1);
+        BlockDataTransfer3D const& transfer =
+            multiBlock.getComponent(nextBlockId).getDataTransfer();
+        // If the block stores the z-line contiguously, it is sent or handed
+        //   over to the sink in place, without intermediate copy.
+        chunk = transfer.getStaticDataSpan(localChunk);
+        if (!chunk) {
+            // Avoid pointing to a buffer of size 0, as this leads to undefined behavior.
+            PLB_ASSERT(bufferSize>0);
+            buffer.resize(bufferSize);
+            transfer.send(localChunk, buffer, modif::staticVariables);
+            chunk = &buffer[0];
+        }
     }
     communicateBuffer(bufferSize, nextBlockId, blockIsLocal);
 }
@@ -231,7 +251,7 @@ void MultiBlockSerializer3D::communicateBuffer (
     plint dummyMessage;
     if (isAllocated && !global::mpi().isMainProcessor()) {
         global::mpi().receive(&dummyMessage, 1, 0);
-        global::mpi().rSend(&buffer[0], bufferSize, 0);
+        global::mpi().rSend(const_cast<char*>(chunk), bufferSize, 0);
     }
     if (!isAllocated && global::mpi().isMainProcessor()) {
         int fromProc = multiBlock.getMultiBlockManagement().
@@ -244,6 +264,7 @@ void MultiBlockSerializer3D::communicateBuffer (
         global::mpi().iRecv(&buffer[0], bufferSize, fromProc, &request);
         global::mpi().send(&dummyMessage, 1, fromProc);
         global::mpi().wait(&request, &status);
+        chunk = &buffer[0];
     }
 #endif  // PLB_MPI_PARALLEL
 }
@@ -257,6 +278,7 @@ void MultiBlockSerializer3D::fillBufferWithZeros(plint nextChunkSize) const {
         for (plint iBuffer=0; iBuffer<bufferSize; ++iBuffer) {
             buffer[iBuffer] = 0;
         }
+        chunk = &buffer[0];
     }
 }
 
@@ -271,7 +293,11 @@ MultiBlockUnSerializer3D::MultiBlockUnSerializer3D (
       domain(multiBlock.getBoundingBox()),
       iX(domain.x0), iY(domain.y0), iZ(domain.z0),
       buffer(1) // this avoids buffer of size 0 which one cannot point to
-{ }
+{
+    if (multiBlock.getMultiBlockManagement().isPartial()) {
+        plbLogicError("A partial multi-block management cannot be serialized.");
+    }
+}
 
 MultiBlockUnSerializer3D::MultiBlockUnSerializer3D (
         MultiBlock3D& multiBlock_,
@@ -282,7 +308,11 @@ MultiBlockUnSerializer3D::MultiBlockUnSerializer3D (
       domain(domain_),
       iX(domain.x0), iY(domain.y0), iZ(domain.z0),
       buffer(1) // this avoids buffer of size 0 which one cannot point to
-{ }
+{
+    if (multiBlock.getMultiBlockManagement().isPartial()) {
+        plbLogicError("A partial multi-block management cannot be serialized.");
+    }
+}
 
 MultiBlockUnSerializer3D* MultiBlockUnSerializer3D::clone() const {
     return new MultiBlockUnSerializer3D(*this);
@@ -60,6 +60,8 @@ private:
     Box3D domain;
     mutable plint iX, iY, iZ;
     mutable std::vector<char> buffer;
+    /// Data of the current chunk: either the buffer, or a span read in place from a local block.
+    mutable char const* chunk;
 };
 
 class MultiBlockUnSerializer3D : public DataUnSerializer {
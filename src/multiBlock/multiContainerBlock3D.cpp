@@ -31,6 +31,9 @@
 #include "multiBlock/multiContainerBlock3D.h"
 #include "multiBlock/defaultMultiBlockPolicy3D.h"
 #include "core/blockIdentifiers.h"
+#include "core/runTimeDiagnostics.h"
+#include <algorithm>
+#include <cstring>
 
 namespace plb {
 
@@ -40,13 +43,15 @@ MultiContainerBlock3D::MultiContainerBlock3D (
 
     : MultiBlock3D(multiBlockManagement_,
                    defaultMultiBlockPolicy3D().getBlockCommunicator(),
-                   combinedStatistics_)
+                   combinedStatistics_),
+      dataPrototype(0)
 {
     allocateBlocks();
 }
 
 MultiContainerBlock3D::~MultiContainerBlock3D() {
     deAllocateBlocks();
+    delete dataPrototype;
 }
 
 MultiContainerBlock3D::MultiContainerBlock3D(plint nx_, plint ny_, plint nz_)
@@ -54,13 +59,15 @@ MultiContainerBlock3D::MultiContainerBlock3D(plint nx_, plint ny_, plint nz_)
             // Default envelope-width to 0
             defaultMultiBlockPolicy3D().getMultiBlockManagement(nx_,ny_,nz_, 0),
             defaultMultiBlockPolicy3D().getBlockCommunicator(),
-            defaultMultiBlockPolicy3D().getCombinedStatistics() )
+            defaultMultiBlockPolicy3D().getCombinedStatistics() ),
+      dataPrototype(0)
 {
     allocateBlocks();
 }
 
 MultiContainerBlock3D::MultiContainerBlock3D(MultiBlock3D const& rhs)
-    : MultiBlock3D(rhs)
+    : MultiBlock3D(rhs),
+      dataPrototype(0)
 {
     allocateBlocks();
 }
@@ -69,13 +76,15 @@ MultiContainerBlock3D::MultiContainerBlock3D(MultiBlock3D const& rhs, Box3D subD
     : MultiBlock3D (
             intersect(rhs.getMultiBlockManagement(), subDomain, crop),
             rhs.getBlockCommunicator().clone(),
-            rhs.getCombinedStatistics().clone() )
+            rhs.getCombinedStatistics().clone() ),
+      dataPrototype(0)
 {
     allocateBlocks();
 }
 
 MultiContainerBlock3D::MultiContainerBlock3D(MultiContainerBlock3D const& rhs)
-    : MultiBlock3D(rhs)
+    : MultiBlock3D(rhs),
+      dataPrototype(rhs.dataPrototype ? rhs.dataPrototype->clone() : 0)
 {
     allocateBlocks(rhs);
 }
@@ -104,6 +113,7 @@ MultiContainerBlock3D* MultiContainerBlock3D::clone (
 
 void MultiContainerBlock3D::swap(MultiContainerBlock3D& rhs) {
     blocks.swap(rhs.blocks);
+    std::swap(dataPrototype, rhs.dataPrototype);
     MultiBlock3D::swap(rhs);
 }
 
@@ -184,6 +194,61 @@ std::vector<std::string> MultiContainerBlock3D::getTypeInfo() const {
     return std::vector<std::string>();
 }
 
+void MultiContainerBlock3D::setDataPrototype(ContainerBlockData* dataPrototype_) {
+    delete dataPrototype;
+    dataPrototype = dataPrototype_;
+}
+
+void MultiContainerBlock3D::allocateComponent(plint blockId) {
+    SmartBulk3D bulk(this->getMultiBlockManagement(), blockId);
+    Box3D envelope = bulk.computeEnvelope();
+    AtomicContainerBlock3D* newBlock =
+        new AtomicContainerBlock3D (
+                envelope.getNx(), envelope.getNy(), envelope.getNz() );
+    newBlock -> setLocation(Dot3D(envelope.x0, envelope.y0, envelope.z0));
+    blocks[blockId] = newBlock;
+}
+
+void MultiContainerBlock3D::releaseComponent(plint blockId) {
+    BlockMap::iterator it = blocks.find(blockId);
+    PLB_ASSERT( it != blocks.end() );
+    delete it->second;
+    blocks.erase(it);
+}
+
+/** The buffer holds a flag which tells if the block has data, followed by
+ *  the unique ID and the serialized state of the data.
+ **/
+void MultiContainerBlock3D::sendComponent(plint blockId, std::vector<char>& buffer) const {
+    ContainerBlockData const* data = getComponent(blockId).getData();
+    std::vector<char> state;
+    if (data) {
+        data->serialize(state);
+    }
+    buffer.resize(1+sizeof(plint)+state.size());
+    buffer[0] = data ? 1 : 0;
+    plint uniqueID = data ? data->getUniqueID() : 0;
+    memcpy(&buffer[1], &uniqueID, sizeof(plint));
+    std::copy(state.begin(), state.end(), buffer.begin()+1+sizeof(plint));
+}
+
+void MultiContainerBlock3D::receiveComponent(plint blockId, std::vector<char> const& buffer) {
+    PLB_ASSERT( buffer.size() >= 1+sizeof(plint) );
+    if (!buffer[0]) {
+        return;
+    }
+    if (!dataPrototype) {
+        plbLogicError( "The data of a container block can only be migrated to another process "
+                       "if the container has a data prototype (see createContainerBlock)." );
+    }
+    ContainerBlockData* data = dataPrototype->clone();
+    plint uniqueID;
+    memcpy(&uniqueID, &buffer[1], sizeof(plint));
+    data->setUniqueID(uniqueID);
+    data->unserialize(std::vector<char>(buffer.begin()+1+sizeof(plint), buffer.end()));
+    getComponent(blockId).setData(data);
+}
+
 
 MultiContainerBlock3D* createContainerBlock(MultiBlock3D& templ, ContainerBlockData* data)
 {
@@ -206,7 +271,7 @@ MultiContainerBlock3D* createContainerBlock(MultiBlock3D& templ, ContainerBlockD
         }
     }
 
-    delete data;
+    dataContainer->setDataPrototype(data);
     return dataContainer;
 }
 
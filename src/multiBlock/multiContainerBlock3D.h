@@ -63,12 +63,21 @@ public:
                 Box3D const& toDomain, modif::ModifT whichData=modif::dataStructure );
     std::string getBlockName() const;
     std::vector<std::string> getTypeInfo() const;
+    /// Data from which the data of the atomic-blocks which migrate to this
+    ///   process is cloned. The multi-block takes ownership of the prototype.
+    void setDataPrototype(ContainerBlockData* dataPrototype_);
+protected:
+    virtual void allocateComponent(plint blockId);
+    virtual void releaseComponent(plint blockId);
+    virtual void sendComponent(plint blockId, std::vector<char>& buffer) const;
+    virtual void receiveComponent(plint blockId, std::vector<char> const& buffer);
 private:
     void allocateBlocks();
     void allocateBlocks(MultiContainerBlock3D const& rhs);
     void deAllocateBlocks();
 private:
     BlockMap blocks;
+    ContainerBlockData* dataPrototype;
 };
 
 MultiContainerBlock3D* createContainerBlock(MultiBlock3D& templ, ContainerBlockData* data);
@@ -100,6 +100,9 @@ public:
     static std::string basicType();
 public:
     MultiNTensorField3D<T>& nTensorView();
+protected:
+    virtual void allocateComponent(plint blockId);
+    virtual void releaseComponent(plint blockId);
 private:
     void allocateFields(T iniVal=T());
     void deAllocateFields();
@@ -179,6 +182,9 @@ public:
     static std::string basicType();
 public:
     MultiNTensorField3D<T>& nTensorView();
+protected:
+    virtual void allocateComponent(plint blockId);
+    virtual void releaseComponent(plint blockId);
 private:
     void allocateFields();
     void allocateFields(Array<T,nDim> const& iniVal);
@@ -263,6 +269,9 @@ public:
     MultiScalarField3D<T>& scalarView();
     template<int nDim>
     MultiTensorField3D<T,nDim>& tensorView();
+protected:
+    virtual void allocateComponent(plint blockId);
+    virtual void releaseComponent(plint blockId);
 private:
     void allocateFields();
     void allocateFields(T const* iniVal);
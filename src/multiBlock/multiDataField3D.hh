@@ -210,6 +210,31 @@ void MultiScalarField3D<T>::deAllocateFields()
     }
 }
 
+template<typename T>
+void MultiScalarField3D<T>::allocateComponent(plint blockId)
+{
+    // A view shares the memory of the atomic-blocks: it is re-created on demand.
+    delete nTensorViewBlock;
+    nTensorViewBlock = 0;
+    SmartBulk3D bulk(this->getMultiBlockManagement(), blockId);
+    Box3D envelope = bulk.computeEnvelope();
+    ScalarField3D<T>* newField =
+        new ScalarField3D<T>(envelope.getNx(), envelope.getNy(), envelope.getNz());
+    newField -> setLocation(Dot3D(envelope.x0, envelope.y0, envelope.z0));
+    fields[blockId] = newField;
+}
+
+template<typename T>
+void MultiScalarField3D<T>::releaseComponent(plint blockId)
+{
+    delete nTensorViewBlock;
+    nTensorViewBlock = 0;
+    typename BlockMap::iterator it = fields.find(blockId);
+    PLB_ASSERT( it != fields.end() );
+    delete it->second;
+    fields.erase(it);
+}
+
 template<typename T>
 inline T& MultiScalarField3D<T>::get(plint iX, plint iY, plint iZ) {
     PLB_PRECONDITION(iX>=0 && iX<this->getNx());
@@ -505,6 +530,31 @@ void MultiTensorField3D<T,nDim>::deAllocateFields()
     }
 }
 
+template<typename T, int nDim>
+void MultiTensorField3D<T,nDim>::allocateComponent(plint blockId)
+{
+    // A view shares the memory of the atomic-blocks: it is re-created on demand.
+    delete nTensorViewBlock;
+    nTensorViewBlock = 0;
+    SmartBulk3D bulk(this->getMultiBlockManagement(), blockId);
+    Box3D envelope = bulk.computeEnvelope();
+    TensorField3D<T,nDim>* newField =
+        new TensorField3D<T,nDim>(envelope.getNx(), envelope.getNy(), envelope.getNz());
+    newField -> setLocation(Dot3D(envelope.x0, envelope.y0, envelope.z0));
+    fields[blockId] = newField;
+}
+
+template<typename T, int nDim>
+void MultiTensorField3D<T,nDim>::releaseComponent(plint blockId)
+{
+    delete nTensorViewBlock;
+    nTensorViewBlock = 0;
+    typename BlockMap::iterator it = fields.find(blockId);
+    PLB_ASSERT( it != fields.end() );
+    delete it->second;
+    fields.erase(it);
+}
+
 template<typename T, int nDim>
 inline Array<T,nDim>& 
 MultiTensorField3D<T,nDim>::get(plint iX, plint iY, plint iZ) {
@@ -833,6 +883,32 @@ void MultiNTensorField3D<T>::deAllocateFields()
     }
 }
 
+template<typename T>
+void MultiNTensorField3D<T>::allocateComponent(plint blockId)
+{
+    // A view shares the memory of the atomic-blocks: it is re-created on demand.
+    delete scalarOrTensorView;
+    scalarOrTensorView = 0;
+    SmartBulk3D bulk(this->getMultiBlockManagement(), blockId);
+    Box3D envelope = bulk.computeEnvelope();
+    NTensorField3D<T>* newField =
+        new NTensorField3D<T> (
+                envelope.getNx(), envelope.getNy(), envelope.getNz(), this->getNdim() );
+    newField -> setLocation(Dot3D(envelope.x0, envelope.y0, envelope.z0));
+    fields[blockId] = newField;
+}
+
+template<typename T>
+void MultiNTensorField3D<T>::releaseComponent(plint blockId)
+{
+    delete scalarOrTensorView;
+    scalarOrTensorView = 0;
+    typename BlockMap::iterator it = fields.find(blockId);
+    PLB_ASSERT( it != fields.end() );
+    delete it->second;
+    fields.erase(it);
+}
+
 template<typename T>
 inline T*
 MultiNTensorField3D<T>::get(plint iX, plint iY, plint iZ) {
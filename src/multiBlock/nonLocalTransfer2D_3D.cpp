@@ -255,7 +255,7 @@ void communicate (
         MultiBlock2D const& originMultiBlock,
         MultiBlock3D& destinationMultiBlock, modif::ModifT whichData )
 {
-    global::profiler().start("mpiCommunication");
+    global::profiler().start(global::prof::mpiCommunication);
     bool staticMessage = whichData == modif::staticVariables;
     // 1. Non-blocking receives.
     communication.recvComm.startBeingReceptive(staticMessage);
@@ -292,7 +292,7 @@ void communicate (
 
     // 5. Finalize the sends.
     communication.sendComm.finalize(staticMessage);
-    global::profiler().stop("mpiCommunication");
+    global::profiler().stop(global::prof::mpiCommunication);
 }
 
 void communicate (
@@ -333,7 +333,7 @@ void communicate (
         MultiBlock3D const& originMultiBlock,
         MultiBlock2D& destinationMultiBlock, modif::ModifT whichData )
 {
-    global::profiler().start("mpiCommunication");
+    global::profiler().start(global::prof::mpiCommunication);
     bool staticMessage = whichData == modif::staticVariables;
     // 1. Non-blocking receives.
     communication.recvComm.startBeingReceptive(staticMessage);
@@ -370,7 +370,7 @@ void communicate (
 
     // 5. Finalize the sends.
     communication.sendComm.finalize(staticMessage);
-    global::profiler().stop("mpiCommunication");
+    global::profiler().stop(global::prof::mpiCommunication);
 }
 
 void communicate (
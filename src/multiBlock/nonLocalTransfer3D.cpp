@@ -28,6 +28,7 @@
 
 #include "core/globalDefs.h"
 #include "multiBlock/nonLocalTransfer3D.h"
+#include "core/runTimeDiagnostics.h"
 
 namespace plb {
 
@@ -89,6 +90,12 @@ void copy_generic (
         MultiBlock3D const& from, Box3D const& fromDomain,
         MultiBlock3D& to, Box3D const& toDomain, modif::ModifT typeOfModif )
 {
+    if ( from.getMultiBlockManagement().isPartial() ||
+         to.getMultiBlockManagement().isPartial() )
+    {
+        plbLogicError("Data cannot be copied between different distributions "
+                      "of a partial multi-block management.");
+    }
     Box3D fromDomain_(fromDomain);
     Box3D toDomain_(toDomain);
     adjustEqualSize(fromDomain_, toDomain_);
@@ -104,6 +111,12 @@ void copyNonLocal_generic (
         MultiBlock3D const& from, MultiBlock3D& to,
         Box3D const& domain, modif::ModifT typeOfModif )
 {
+    if ( from.getMultiBlockManagement().isPartial() ||
+         to.getMultiBlockManagement().isPartial() )
+    {
+        plbLogicError("Data cannot be copied between different distributions "
+                      "of a partial multi-block management.");
+    }
     std::vector<Overlap3D> dataTransfer = copyAllDataTransfer (
                 from.getMultiBlockManagement().getSparseBlockStructure(),
                 to.getMultiBlockManagement().getSparseBlockStructure() );
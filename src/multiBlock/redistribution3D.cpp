@@ -28,7 +28,13 @@
 
 #include "core/globalDefs.h"
 #include "multiBlock/redistribution3D.h"
+#include "multiBlock/multiBlock3D.h"
+#include "multiBlock/multiBlockOperations3D.h"
+#include "core/runTimeDiagnostics.h"
 #include <cstdlib>
+#include <cmath>
+#include <algorithm>
+#include <set>
 
 namespace plb {
 
@@ -39,6 +45,9 @@ RandomRedistribute3D::RandomRedistribute3D(pluint rseed_)
 MultiBlockManagement3D RandomRedistribute3D::redistribute (
         MultiBlockManagement3D const& original ) const
 {
+    if (original.isPartial()) {
+        plbLogicError("A partial multi-block management cannot be redistributed.");
+    }
     ThreadAttribution const& originalAttribution = original.getThreadAttribution();
     SparseBlockStructure3D const& originalSparseBlock = original.getSparseBlockStructure();
 
@@ -69,5 +78,353 @@ MultiBlockManagement3D RandomRedistribute3D::redistribute (
             original.getEnvelopeWidth(), original.getRefinementLevel() );
 }
 
-}  // namespace plb
+namespace {
+
+struct CostBlock {
+    plint id;
+    Box3D bulk;
+    double cost;
+    plint proc;
+};
+
+/// Order blocks by the position of their center along a given axis.
+class CostBlockCenterLess {
+public:
+    CostBlockCenterLess(plint axis_) : axis(axis_) { }
+    bool operator()(CostBlock const& a, CostBlock const& b) const {
+        plint centerA = twiceCenter(a.bulk), centerB = twiceCenter(b.bulk);
+        if (centerA != centerB) {
+            return centerA < centerB;
+        }
+        return a.id < b.id;
+    }
+private:
+    plint twiceCenter(Box3D const& box) const {
+        switch(axis) {
+            case 0:  return box.x0+box.x1;
+            case 1:  return box.y0+box.y1;
+            default: return box.z0+box.z1;
+        }
+    }
+private:
+    plint axis;
+};
 
+struct CostBlockIdLess {
+    bool operator()(CostBlock const& a, CostBlock const& b) const {
+        return a.id < b.id;
+    }
+};
+
+/// Split the blocks [begin,end) over the processes [firstProc, firstProc+numProcs)
+///   by weighted recursive coordinate bisection.
+void bisectByCost( std::vector<CostBlock>& blocks, plint begin, plint end,
+                   plint firstProc, plint numProcs )
+{
+    plint numBlocks = end-begin;
+    if (numBlocks==0) {
+        return;
+    }
+    if (numProcs==1) {
+        for (plint i=begin; i<end; ++i) {
+            blocks[i].proc = firstProc;
+        }
+        return;
+    }
+
+    Box3D boundingBox(blocks[begin].bulk);
+    double totalCost = 0.;
+    for (plint i=begin; i<end; ++i) {
+        boundingBox = bound(boundingBox, blocks[i].bulk);
+        totalCost += blocks[i].cost;
+    }
+    plint axis = 0;
+    if (boundingBox.getNy() > boundingBox.getNx()) axis = 1;
+    if (boundingBox.getNz() > std::max(boundingBox.getNx(), boundingBox.getNy())) axis = 2;
+    std::sort(blocks.begin()+begin, blocks.begin()+end, CostBlockCenterLess(axis));
+
+    plint leftProcs = numProcs/2;
+    double leftTarget = totalCost*(double)leftProcs/(double)numProcs;
+    // As long as there are enough blocks, each process gets at least one.
+    plint minSplit = 0, maxSplit = numBlocks;
+    if (numBlocks >= numProcs) {
+        minSplit = leftProcs;
+        maxSplit = numBlocks-(numProcs-leftProcs);
+    }
+    double leftCost = 0.;
+    for (plint i=0; i<minSplit; ++i) {
+        leftCost += blocks[begin+i].cost;
+    }
+    plint split = minSplit;
+    double bestDeviation = std::fabs(leftCost-leftTarget);
+    for (plint i=minSplit; i<maxSplit; ++i) {
+        leftCost += blocks[begin+i].cost;
+        double deviation = std::fabs(leftCost-leftTarget);
+        if (deviation < bestDeviation) {
+            bestDeviation = deviation;
+            split = i+1;
+        }
+    }
+
+    bisectByCost(blocks, begin, begin+split, firstProc, leftProcs);
+    bisectByCost(blocks, begin+split, end, firstProc+leftProcs, numProcs-leftProcs);
+}
+
+/// Move blocks to the neighboring process with which they share the largest
+///   overlap volume, as long as no process exceeds the admitted cost.
+void refineByOverlap( std::vector<CostBlock>& blocks, SparseBlockStructure3D const& sparseBlock,
+                      plint envelopeWidth, plint numProcs, double imbalanceTolerance )
+{
+    std::map<plint,plint> idToIndex;
+    for (pluint i=0; i<blocks.size(); ++i) {
+        idToIndex[blocks[i].id] = (plint)i;
+    }
+    // Number of cells in the envelope of each block which belong to a neighbor.
+    std::vector<std::vector<std::pair<plint,plint> > > overlaps(blocks.size());
+    for (pluint i=0; i<blocks.size(); ++i) {
+        std::vector<plint> neighbors;
+        sparseBlock.findNeighbors(blocks[i].id, envelopeWidth, neighbors);
+        Box3D envelope(blocks[i].bulk.enlarge(envelopeWidth));
+        for (pluint iNeighbor=0; iNeighbor<neighbors.size(); ++iNeighbor) {
+            std::map<plint,plint>::const_iterator it = idToIndex.find(neighbors[iNeighbor]);
+            Box3D inters;
+            if (it!=idToIndex.end() && intersect(envelope, blocks[it->second].bulk, inters)) {
+                overlaps[i].push_back(std::make_pair(it->second, inters.nCells()));
+            }
+        }
+    }
+
+    std::vector<double> procCost(numProcs, 0.);
+    std::vector<plint> procNumBlocks(numProcs, 0);
+    double totalCost = 0.;
+    for (pluint i=0; i<blocks.size(); ++i) {
+        procCost[blocks[i].proc] += blocks[i].cost;
+        ++procNumBlocks[blocks[i].proc];
+        totalCost += blocks[i].cost;
+    }
+    double maxCost = std::max( totalCost/(double)numProcs*(1.+imbalanceTolerance),
+                               *std::max_element(procCost.begin(), procCost.end()) );
+
+    static const plint maxPasses = 10;
+    for (plint iPass=0; iPass<maxPasses; ++iPass) {
+        bool hasMoved = false;
+        for (pluint i=0; i<blocks.size(); ++i) {
+            plint proc = blocks[i].proc;
+            if (procNumBlocks[proc]==1) {
+                continue;
+            }
+            std::map<plint,plint> procOverlap;
+            for (pluint iOverlap=0; iOverlap<overlaps[i].size(); ++iOverlap) {
+                procOverlap[blocks[overlaps[i][iOverlap].first].proc] += overlaps[i][iOverlap].second;
+            }
+            plint internalOverlap = procOverlap[proc];
+            plint bestProc = proc, bestGain = 0;
+            std::map<plint,plint>::const_iterator it = procOverlap.begin();
+            for (; it != procOverlap.end(); ++it) {
+                plint gain = it->second-internalOverlap;
+                if (it->first!=proc && gain>bestGain &&
+                    procCost[it->first]+blocks[i].cost <= maxCost)
+                {
+                    bestProc = it->first;
+                    bestGain = gain;
+                }
+            }
+            if (bestProc != proc) {
+                procCost[proc] -= blocks[i].cost;
+                --procNumBlocks[proc];
+                procCost[bestProc] += blocks[i].cost;
+                ++procNumBlocks[bestProc];
+                blocks[i].proc = bestProc;
+                hasMoved = true;
+            }
+        }
+        if (!hasMoved) {
+            break;
+        }
+    }
+}
+
+}  // namespace
+
+CostWeightedRedistribute3D::CostWeightedRedistribute3D (
+        std::map<plint,double> const& blockCosts_,
+        double imbalanceTolerance_, plint numProcesses_ )
+    : blockCosts(blockCosts_),
+      imbalanceTolerance(imbalanceTolerance_),
+      numProcesses(numProcesses_)
+{
+    PLB_PRECONDITION( numProcesses >= 1 );
+}
+
+ExplicitThreadAttribution* CostWeightedRedistribute3D::computeAttribution (
+        SparseBlockStructure3D const& sparseBlock, plint envelopeWidth ) const
+{
+    std::map<plint,Box3D> const& bulks = sparseBlock.getBulks();
+    std::vector<CostBlock> blocks;
+    blocks.reserve(bulks.size());
+    std::map<plint,Box3D>::const_iterator it = bulks.begin();
+    for (; it != bulks.end(); ++it) {
+        CostBlock block;
+        block.id = it->first;
+        block.bulk = it->second;
+        std::map<plint,double>::const_iterator costIt = blockCosts.find(block.id);
+        block.cost = costIt==blockCosts.end() ? (double)block.bulk.nCells() : costIt->second;
+        block.proc = 0;
+        blocks.push_back(block);
+    }
+
+    bisectByCost(blocks, 0, (plint)blocks.size(), 0, numProcesses);
+    // Restore the order of the block ids, to make the refinement independent
+    //   of the bisection.
+    std::sort(blocks.begin(), blocks.end(), CostBlockIdLess());
+    refineByOverlap(blocks, sparseBlock, envelopeWidth, numProcesses, imbalanceTolerance);
+
+    ExplicitThreadAttribution* attribution = new ExplicitThreadAttribution;
+    for (pluint i=0; i<blocks.size(); ++i) {
+        attribution->addBlock(blocks[i].id, blocks[i].proc);
+    }
+    return attribution;
+}
+
+MultiBlockManagement3D CostWeightedRedistribute3D::redistribute (
+        MultiBlockManagement3D const& original ) const
+{
+    if (original.isPartial()) {
+        plbLogicError("A partial multi-block management cannot be redistributed.");
+    }
+    SparseBlockStructure3D const& sparseBlock = original.getSparseBlockStructure();
+    return MultiBlockManagement3D (
+            sparseBlock, computeAttribution(sparseBlock, original.getEnvelopeWidth()),
+            original.getEnvelopeWidth(), original.getRefinementLevel() );
+}
+
+namespace {
+
+struct ProcessPlacementLess {
+    ProcessPlacementLess(std::vector<int> const& nodeIds_, std::vector<int> const& numaIds_)
+        : nodeIds(nodeIds_), numaIds(numaIds_)
+    { }
+    bool operator()(int a, int b) const {
+        if (nodeIds[a] != nodeIds[b]) {
+            return nodeIds[a] < nodeIds[b];
+        }
+        if (numaIds[a] != numaIds[b]) {
+            return numaIds[a] < numaIds[b];
+        }
+        return a < b;
+    }
+    std::vector<int> const& nodeIds;
+    std::vector<int> const& numaIds;
+};
+
+}  // namespace
+
+SpaceFillingCurveRedistribute3D::SpaceFillingCurveRedistribute3D (
+        spaceFillingCurve::CurveT curve_, bool placeOnTopology,
+        std::map<plint,double> const& blockCosts_ )
+    : curve(curve_),
+      blockCosts(blockCosts_),
+      processOrder(global::mpi().getSize())
+{
+    for (pluint iProc=0; iProc<processOrder.size(); ++iProc) {
+        processOrder[iProc] = (int)iProc;
+    }
+    if (placeOnTopology) {
+        std::vector<int> nodeIds, numaIds;
+        global::mpi().getProcessTopology(nodeIds, numaIds);
+        std::stable_sort( processOrder.begin(), processOrder.end(),
+                          ProcessPlacementLess(nodeIds, numaIds) );
+    }
+}
+
+ExplicitThreadAttribution* SpaceFillingCurveRedistribute3D::computeAttribution (
+        SparseBlockStructure3D const& sparseBlock ) const
+{
+    std::vector<plint> orderedIds = orderAlongCurve(sparseBlock, curve);
+    std::map<plint,Box3D> const& bulks = sparseBlock.getBulks();
+    std::vector<double> costs(orderedIds.size());
+    double totalCost = 0.;
+    for (pluint i=0; i<orderedIds.size(); ++i) {
+        std::map<plint,double>::const_iterator it = blockCosts.find(orderedIds[i]);
+        costs[i] = it != blockCosts.end() ? it->second
+                                          : (double)bulks.find(orderedIds[i])->second.nCells();
+        totalCost += costs[i];
+    }
+
+    // Each block goes to the segment which contains the middle of its cost
+    //   interval along the curve.
+    plint numProcesses = (plint)processOrder.size();
+    ExplicitThreadAttribution* attribution = new ExplicitThreadAttribution;
+    double cumulatedCost = 0.;
+    for (pluint i=0; i<orderedIds.size(); ++i) {
+        plint segment = 0;
+        if (totalCost > 0.) {
+            segment = (plint)( (cumulatedCost+0.5*costs[i]) / totalCost * (double)numProcesses );
+        }
+        else {
+            segment = (plint)i * numProcesses / (plint)orderedIds.size();
+        }
+        segment = std::min(segment, numProcesses-1);
+        attribution->addBlock(orderedIds[i], processOrder[segment]);
+        cumulatedCost += costs[i];
+    }
+    return attribution;
+}
+
+MultiBlockManagement3D SpaceFillingCurveRedistribute3D::redistribute (
+        MultiBlockManagement3D const& original ) const
+{
+    if (original.isPartial()) {
+        plbLogicError("A partial multi-block management cannot be redistributed.");
+    }
+    SparseBlockStructure3D const& sparseBlock = original.getSparseBlockStructure();
+    return MultiBlockManagement3D (
+            sparseBlock, computeAttribution(sparseBlock),
+            original.getEnvelopeWidth(), original.getRefinementLevel() );
+}
+
+std::vector<int> const& SpaceFillingCurveRedistribute3D::getProcessOrder() const {
+    return processOrder;
+}
+
+void migrateBlocks( std::vector<MultiBlock3D*> multiBlocks,
+                    ThreadAttribution const& newAttribution )
+{
+    if (multiBlocks.empty()) {
+        return;
+    }
+    std::set<id_t> migratedIds;
+    for (pluint iBlock=0; iBlock<multiBlocks.size(); ++iBlock) {
+        migratedIds.insert(multiBlocks[iBlock]->getId());
+    }
+    // The processors which are re-created on the arriving blocks must only
+    //   refer to multi-blocks which have the new distribution.
+    for (pluint iBlock=0; iBlock<multiBlocks.size(); ++iBlock) {
+        if (multiBlocks[iBlock]->getMultiBlockManagement().isPartial()) {
+            plbLogicError("The blocks of a partial multi-block management cannot be migrated.");
+        }
+        PLB_PRECONDITION( multiBlocks[iBlock]->getSparseBlockStructure().equals(
+                              multiBlocks[0]->getSparseBlockStructure() ) );
+        std::vector<MultiBlock3D::ProcessorStorage3D> const& processors =
+            multiBlocks[iBlock]->getStoredProcessors();
+        for (pluint iProcessor=0; iProcessor<processors.size(); ++iProcessor) {
+            std::vector<id_t> const& ids = processors[iProcessor].getMultiBlockIds();
+            for (pluint iId=0; iId<ids.size(); ++iId) {
+                if (migratedIds.find(ids[iId]) == migratedIds.end()) {
+                    plbLogicError( "Blocks can only be migrated together with all the "
+                                   "multi-blocks to which they are coupled by data processors." );
+                }
+            }
+        }
+    }
+
+    std::vector<std::vector<plint> > arrivedBlocks(multiBlocks.size());
+    for (pluint iBlock=0; iBlock<multiBlocks.size(); ++iBlock) {
+        multiBlocks[iBlock]->migrateComponents(newAttribution, arrivedBlocks[iBlock]);
+    }
+    for (pluint iBlock=0; iBlock<multiBlocks.size(); ++iBlock) {
+        reintegrateInternalProcessors(*multiBlocks[iBlock], arrivedBlocks[iBlock]);
+    }
+}
+
+}  // namespace plb
@@ -32,9 +32,14 @@
 #include "parallelism/mpiManager.h"
 #include "core/globalDefs.h"
 #include "multiBlock/multiBlockManagement3D.h"
+#include <map>
+#include <vector>
 
 namespace plb {
 
+class MultiBlock3D;
+template<typename T, template<typename U> class Descriptor> class MultiBlockLattice3D;
+
 struct MultiBlockRedistribute3D {
     virtual ~MultiBlockRedistribute3D() { }
     virtual MultiBlockManagement3D redistribute(MultiBlockManagement3D const& original) const=0;
@@ -48,6 +53,97 @@ private:
     pluint rseed;
 };
 
+/// Attribute the blocks to the MPI processes so as to balance their cost,
+///   while keeping the overlap volume between processes small.
+/** The cost of a block is taken from the map blockCosts, which is for example
+ *  filled with measured execution times, or computed with computeDynamicsCosts().
+ *  Blocks without an entry cost as much as their number of cells.
+ *
+ *  The blocks are first split by weighted recursive coordinate bisection: the
+ *  set of blocks is cut orthogonally to its longest extent, at the position
+ *  which splits the cost in proportion to the number of processes on each side.
+ *  The resulting sets are compact, which keeps the envelopes that are exchanged
+ *  between processes small. A greedy refinement then moves blocks to the process
+ *  with which they share the largest overlap volume, as long as no process
+ *  exceeds the average cost by more than the imbalance tolerance (or the maximum
+ *  cost after bisection, if this one is larger). The balance that can be achieved
+ *  is limited by the cost of the largest blocks: to be effective, the multi-block
+ *  should contain several blocks per process.
+ *
+ *  The partition is computed from replicated data, identically on all processes,
+ *  and does not communicate.
+ **/
+class CostWeightedRedistribute3D : public MultiBlockRedistribute3D {
+public:
+    CostWeightedRedistribute3D( std::map<plint,double> const& blockCosts_,
+                                double imbalanceTolerance_=0.05,
+                                plint numProcesses_=global::mpi().getSize() );
+    virtual MultiBlockManagement3D redistribute(MultiBlockManagement3D const& original) const;
+    /// Compute the attribution of the blocks of a sparse block-structure to the processes.
+    ExplicitThreadAttribution* computeAttribution (
+            SparseBlockStructure3D const& sparseBlock, plint envelopeWidth ) const;
+private:
+    std::map<plint,double> blockCosts;
+    double imbalanceTolerance;
+    plint numProcesses;
+};
+
+/// Attribute contiguous segments of a space-filling curve through the blocks
+///   to the MPI processes.
+/** The blocks are ordered along the curve (see orderAlongCurve()), and the
+ *  curve is cut into one segment per process, with equal costs up to the cost
+ *  of one block. Blocks without an entry in blockCosts cost as much as their
+ *  number of cells. With placeOnTopology=true, the segments are handed out to
+ *  the processes in the order of their node and NUMA domain (see
+ *  MpiManager::getProcessTopology()): consecutive segments, which are close in
+ *  space, then end up on the same NUMA domain and node, and most of the envelope
+ *  exchanges stay inside a node. The topology is queried in the constructor,
+ *  which must therefore be called collectively. The curve runs through all
+ *  blocks, which a partial management (see MultiBlockManagement3D::isPartial())
+ *  does not know: redistribute() raises an error on it.
+ **/
+class SpaceFillingCurveRedistribute3D : public MultiBlockRedistribute3D {
+public:
+    SpaceFillingCurveRedistribute3D (
+            spaceFillingCurve::CurveT curve_=spaceFillingCurve::hilbert,
+            bool placeOnTopology=true,
+            std::map<plint,double> const& blockCosts_=std::map<plint,double>() );
+    virtual MultiBlockManagement3D redistribute(MultiBlockManagement3D const& original) const;
+    /// Compute the attribution of the blocks of a sparse block-structure to the processes.
+    ExplicitThreadAttribution* computeAttribution(SparseBlockStructure3D const& sparseBlock) const;
+    /// The processes, in the order in which they receive the segments of the curve.
+    std::vector<int> const& getProcessOrder() const;
+private:
+    spaceFillingCurve::CurveT curve;
+    std::map<plint,double> blockCosts;
+    std::vector<int> processOrder;
+};
+
+/// Attribute the atomic-blocks of a set of multi-blocks to new processes, and
+///   move the blocks which change process without re-creating the multi-blocks.
+/** The multi-blocks must have the same sparse block-structure and thread
+ *  attribution, and all multi-blocks which are coupled to them through internal
+ *  data processors must be part of the set. Only the blocks which change process
+ *  are transmitted (see MultiBlock3D::migrateComponents()). The internal processors
+ *  of the blocks which arrive on a process are re-created from the processors
+ *  stored in the multi-blocks, and the communication patterns are re-computed
+ *  at the next envelope update. This function must be called collectively.
+ **/
+void migrateBlocks( std::vector<MultiBlock3D*> multiBlocks,
+                    ThreadAttribution const& newAttribution );
+
+/// Compute the cost of each block of a lattice as the sum, over its bulk, of
+///   the weights of the dynamics in the cells.
+/** The weights are indexed by the id of the dynamics (see Dynamics::getId()).
+ *  Dynamics which do not appear in the table have the weight defaultWeight.
+ *  This function must be called collectively: the result is the same on all
+ *  processes, and can be handed over to CostWeightedRedistribute3D.
+ **/
+template<typename T, template<typename U> class Descriptor>
+std::map<plint,double> computeDynamicsCosts (
+        MultiBlockLattice3D<T,Descriptor> const& lattice,
+        std::map<int,double> const& dynamicsWeights, double defaultWeight=1. );
+
 }  // namespace plb
 
 #endif  // REDISTRIBUTION_3D_H
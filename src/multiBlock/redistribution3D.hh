@@ -0,0 +1,98 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+ * Utilities for 3D multi data distributions -- generic implementation.
+ */
+
+#ifndef REDISTRIBUTION_3D_HH
+#define REDISTRIBUTION_3D_HH
+
+#include "multiBlock/redistribution3D.h"
+#include "multiBlock/multiBlockLattice3D.h"
+#include "atomicBlock/blockLattice3D.h"
+#include "core/dynamics.h"
+#include "core/runTimeDiagnostics.h"
+
+namespace plb {
+
+template<typename T, template<typename U> class Descriptor>
+std::map<plint,double> computeDynamicsCosts (
+        MultiBlockLattice3D<T,Descriptor> const& lattice,
+        std::map<int,double> const& dynamicsWeights, double defaultWeight )
+{
+    MultiBlockManagement3D const& management = lattice.getMultiBlockManagement();
+    if (management.isPartial()) {
+        plbLogicError("The dynamics costs cannot be computed on a partial multi-block management.");
+    }
+    std::map<plint,Box3D> const& bulks = management.getSparseBlockStructure().getBulks();
+    std::vector<double> costs(bulks.size(), 0.);
+
+    std::map<plint,Box3D>::const_iterator it = bulks.begin();
+    for (pluint pos=0; it != bulks.end(); ++it, ++pos) {
+        plint blockId = it->first;
+        if (!management.getThreadAttribution().isLocal(blockId)) {
+            continue;
+        }
+        SmartBulk3D bulk(management, blockId);
+        Box3D domain(bulk.toLocal(bulk.getBulk()));
+        BlockLattice3D<T,Descriptor> const& component = lattice.getComponent(blockId);
+        // Neighboring cells mostly share their dynamics object: the weight
+        //   table is only looked up when the dynamics changes.
+        Dynamics<T,Descriptor> const* previousDynamics = 0;
+        double weight = defaultWeight;
+        double cost = 0.;
+        for (plint iX=domain.x0; iX<=domain.x1; ++iX) {
+            for (plint iY=domain.y0; iY<=domain.y1; ++iY) {
+                for (plint iZ=domain.z0; iZ<=domain.z1; ++iZ) {
+                    Dynamics<T,Descriptor> const* dynamics =
+                        &component.get(iX,iY,iZ).getDynamics();
+                    if (dynamics != previousDynamics) {
+                        std::map<int,double>::const_iterator weightIt =
+                            dynamicsWeights.find(dynamics->getId());
+                        weight = weightIt==dynamicsWeights.end() ?
+                                     defaultWeight : weightIt->second;
+                        previousDynamics = dynamics;
+                    }
+                    cost += weight;
+                }
+            }
+        }
+        costs[pos] = cost;
+    }
+#ifdef PLB_MPI_PARALLEL
+    global::mpi().allReduceVect(costs, MPI_SUM);
+#endif
+
+    std::map<plint,double> blockCosts;
+    it = bulks.begin();
+    for (pluint pos=0; it != bulks.end(); ++it, ++pos) {
+        blockCosts[it->first] = costs[pos];
+    }
+    return blockCosts;
+}
+
+}  // namespace plb
+
+#endif  // REDISTRIBUTION_3D_HH
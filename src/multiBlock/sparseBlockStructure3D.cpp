@@ -28,7 +28,8 @@
 
 #include "multiBlock/sparseBlockStructure3D.h"
 #include "multiBlock/defaultMultiBlockPolicy3D.h"
-#include <set>
+#include <algorithm>
+#include <utility>
 
 namespace plb {
 
@@ -77,6 +78,7 @@ SparseBlockStructure3D::SparseBlockStructure3D (
     gridNz = (plint)( 0.5 + (double)rhs.gridNz * (double)boundingBox.getNz()
                                                / (double)rhs.boundingBox.getNz() );
     if (gridNz < 1) gridNz = 1;
+    iniGridParameters();
 }
 
 void SparseBlockStructure3D::addBlock(Box3D const& bulk, plint blockId) 
@@ -98,6 +100,7 @@ void SparseBlockStructure3D::addBlock(Box3D const& bulk,
     bulks[blockId] = bulk;
     uniqueBulks[blockId] = uniqueBulk;
     integrateBlock(blockId, bulk);
+    adaptGrid();
 }
 
 void SparseBlockStructure3D::removeBlock(plint blockId) {
@@ -175,15 +178,14 @@ std::vector<plint> SparseBlockStructure3D::getLocalBlocks(ThreadAttribution cons
 }
 
 plint SparseBlockStructure3D::locate(plint iX, plint iY, plint iZ) const {
-    GridT::const_iterator gridIter
-        = grid.find(Dot3D(gridPosX(iX), gridPosY(iY), gridPosZ(iZ)));
-    if (gridIter != grid.end()) {
-        std::vector<plint> const& blockList = gridIter->second;
-        for (pluint iBlock=0; iBlock<blockList.size(); ++iBlock) {
-            Box3D const& bulk = bulks.find(blockList[iBlock])->second;
-            if (contained(iX,iY,iZ, bulk)) {
-                return blockList[iBlock];
-            }
+    if (!contained(iX,iY,iZ, boundingBox)) {
+        return -1;
+    }
+    std::vector<GridEntry> const& blockList =
+        grid[gridIndex(gridPosX(iX), gridPosY(iY), gridPosZ(iZ))];
+    for (pluint iBlock=0; iBlock<blockList.size(); ++iBlock) {
+        if (contained(iX,iY,iZ, blockList[iBlock].bulk)) {
+            return blockList[iBlock].id;
         }
     }
     return -1;
@@ -215,6 +217,10 @@ void SparseBlockStructure3D::iniGridParameters()
     if (boundingBox.getNz() % gridNz != 0) {
         ++gridLz;
     }
+    grid.clear();
+    grid.resize(gridNx*gridNy*gridNz);
+    numOccupiedCells = 0;
+    numGridEntries = 0;
 }
 
 plint SparseBlockStructure3D::gridPosX(plint realX) const {
@@ -231,40 +237,69 @@ plint SparseBlockStructure3D::gridPosZ(plint realZ) const {
 
 Box3D SparseBlockStructure3D::getGridBox(Box3D const& realBlock) const
 {
-    return Box3D ( gridPosX(realBlock.x0), gridPosX(realBlock.x1),
-                   gridPosY(realBlock.y0), gridPosY(realBlock.y1),
-                   gridPosZ(realBlock.z0), gridPosZ(realBlock.z1) );
+    // Domains which exceed the bounding box (envelopes, periodic images) are
+    //   clamped to the border cells: they never miss a block they intersect.
+    return Box3D ( std::max((plint)0, std::min(gridNx-1, gridPosX(realBlock.x0))),
+                   std::max((plint)0, std::min(gridNx-1, gridPosX(realBlock.x1))),
+                   std::max((plint)0, std::min(gridNy-1, gridPosY(realBlock.y0))),
+                   std::max((plint)0, std::min(gridNy-1, gridPosY(realBlock.y1))),
+                   std::max((plint)0, std::min(gridNz-1, gridPosZ(realBlock.z0))),
+                   std::max((plint)0, std::min(gridNz-1, gridPosZ(realBlock.z1))) );
 }
 
-void SparseBlockStructure3D::intersect (
-        Box3D const& bulk,
-        std::vector<plint>& ids, std::vector<Box3D>& intersections ) const
-{
-    Box3D gridBox = getGridBox(bulk);
-    Box3D intersection; // Temporary variable.
+plint SparseBlockStructure3D::gridIndex(plint gridX, plint gridY, plint gridZ) const {
+    return (gridX*gridNy + gridY)*gridNz + gridZ;
+}
+
+namespace {
 
-    std::set<plint> idsToTest;
+struct GridEntryIdLess {
+    bool operator()( SparseBlockStructure3D::GridEntry const* a,
+                     SparseBlockStructure3D::GridEntry const* b ) const
+    {
+        return a->id < b->id;
+    }
+};
+
+}  // namespace
+
+void SparseBlockStructure3D::findCandidates (
+        Box3D const& domain, std::vector<GridEntry const*>& candidates ) const
+{
+    Box3D gridBox = getGridBox(domain);
     for (plint gridX=gridBox.x0; gridX<=gridBox.x1; ++gridX) {
         for (plint gridY=gridBox.y0; gridY<=gridBox.y1; ++gridY) {
             for (plint gridZ=gridBox.z0; gridZ<=gridBox.z1; ++gridZ) {
-                GridT::const_iterator gridIter
-                    = grid.find(Dot3D(gridX,gridY,gridZ));
-                if (gridIter != grid.end()) {
-                    std::vector<plint> const& blockList = gridIter->second;
-                    idsToTest.insert(blockList.begin(), blockList.end());
+                std::vector<GridEntry> const& blockList = grid[gridIndex(gridX,gridY,gridZ)];
+                for (pluint iBlock=0; iBlock<blockList.size(); ++iBlock) {
+                    // A block which covers several grid cells is only taken
+                    //   from the first of these cells which lies in the domain.
+                    Box3D blockGridBox = getGridBox(blockList[iBlock].bulk);
+                    if ( gridX == std::max(gridBox.x0, blockGridBox.x0) &&
+                         gridY == std::max(gridBox.y0, blockGridBox.y0) &&
+                         gridZ == std::max(gridBox.z0, blockGridBox.z0) )
+                    {
+                        candidates.push_back(&blockList[iBlock]);
+                    }
                 }
             }
         }
     }
+    std::sort(candidates.begin(), candidates.end(), GridEntryIdLess());
+}
 
-
-    std::set<plint>::const_iterator it = idsToTest.begin();
-    for (; it != idsToTest.end(); ++it) {
-        Box3D testBlock = bulks.find(*it)->second;
-        if (plb::intersect(bulk, testBlock, intersection) )
+void SparseBlockStructure3D::intersect (
+        Box3D const& bulk,
+        std::vector<plint>& ids, std::vector<Box3D>& intersections ) const
+{
+    Box3D intersection; // Temporary variable.
+    std::vector<GridEntry const*> candidates;
+    findCandidates(bulk, candidates);
+    for (pluint iCandidate=0; iCandidate<candidates.size(); ++iCandidate) {
+        if (plb::intersect(bulk, candidates[iCandidate]->bulk, intersection) )
         {
             intersections.push_back(intersection);
-            ids.push_back(*it);
+            ids.push_back(candidates[iCandidate]->id);
         }
     }
 }
@@ -333,35 +368,14 @@ void SparseBlockStructure3D::findNeighbors (
         std::vector<plint>& neighbors, plint excludeId ) const
 {
     Box3D extendedBlock(bulk.enlarge(neighborhoodWidth));
-    Box3D gridBox = getGridBox(extendedBlock);
-
-    std::set<plint> idsToTest;
-    for (plint gridX=gridBox.x0; gridX<=gridBox.x1; ++gridX) {
-        for (plint gridY=gridBox.y0; gridY<=gridBox.y1; ++gridY) {
-            for (plint gridZ=gridBox.z0; gridZ<=gridBox.z1; ++gridZ) {
-                GridT::const_iterator gridIter
-                    = grid.find(Dot3D(gridX,gridY,gridZ));
-                if (gridIter != grid.end()) {
-                    std::vector<plint> const& blockList = gridIter->second;
-                    idsToTest.insert(blockList.begin(), blockList.end());
-                }
-            }
-        }
-    }
-
-    if (excludeId>=0) {
-        std::set<plint>::iterator excludeIter = idsToTest.find(excludeId);
-        if (excludeIter != idsToTest.end()) {
-            idsToTest.erase(excludeIter);
-        }
-    }
-
-    std::set<plint>::const_iterator it = idsToTest.begin();
-    for (; it != idsToTest.end(); ++it) {
-        Box3D testBlock = bulks.find(*it)->second;
-        if (plb::doesIntersect(extendedBlock, testBlock) )
+    std::vector<GridEntry const*> candidates;
+    findCandidates(extendedBlock, candidates);
+    for (pluint iCandidate=0; iCandidate<candidates.size(); ++iCandidate) {
+        plint id = candidates[iCandidate]->id;
+        if ( id != excludeId &&
+             plb::doesIntersect(extendedBlock, candidates[iCandidate]->bulk) )
         {
-            neighbors.push_back(*it);
+            neighbors.push_back(id);
         }
     }
 }
@@ -383,17 +397,17 @@ void SparseBlockStructure3D::swap(SparseBlockStructure3D& rhs) {
     std::swap(gridNy, rhs.gridNy);
     std::swap(gridNz, rhs.gridNz);
     grid.swap(rhs.grid);
+    std::swap(numOccupiedCells, rhs.numOccupiedCells);
+    std::swap(numGridEntries, rhs.numGridEntries);
     bulks.swap(rhs.bulks);
     uniqueBulks.swap(rhs.uniqueBulks);
 }
 
 bool SparseBlockStructure3D::equals(SparseBlockStructure3D const& rhs) const {
+    // The grid is only an index of the blocks, which depends on the
+    //   history of the structure; it is not compared.
     return
         boundingBox == rhs.boundingBox &&
-        gridNx == rhs.gridNx &&
-        gridNy == rhs.gridNy &&
-        gridNz == rhs.gridNz &&
-        grid == rhs.grid &&
         bulks == rhs.bulks;
 }
 
@@ -403,7 +417,12 @@ void SparseBlockStructure3D::integrateBlock(plint blockId, Box3D bulk) {
     for (plint gridX=gridBox.x0; gridX<=gridBox.x1; ++gridX) {
         for (plint gridY=gridBox.y0; gridY<=gridBox.y1; ++gridY) {
             for (plint gridZ=gridBox.z0; gridZ<=gridBox.z1; ++gridZ) {
-                grid[Dot3D(gridX,gridY,gridZ)].push_back(blockId);
+                std::vector<GridEntry>& blockList = grid[gridIndex(gridX,gridY,gridZ)];
+                if (blockList.empty()) {
+                    ++numOccupiedCells;
+                }
+                blockList.push_back(GridEntry(blockId, bulk));
+                ++numGridEntries;
             }
         }
     }
@@ -416,15 +435,48 @@ void SparseBlockStructure3D::extractBlock(plint blockId) {
     for (plint gridX=gridBox.x0; gridX<=gridBox.x1; ++gridX) {
         for (plint gridY=gridBox.y0; gridY<=gridBox.y1; ++gridY) {
             for (plint gridZ=gridBox.z0; gridZ<=gridBox.z1; ++gridZ) {
-                std::vector<plint>& blockList = grid[Dot3D(gridX,gridY,gridZ)];
-                // Use remove-erase idiom (because blockList is a std::vector).
-                blockList.erase(std::remove(blockList.begin(), blockList.end(), blockId),
-                                blockList.end());
+                std::vector<GridEntry>& blockList = grid[gridIndex(gridX,gridY,gridZ)];
+                for (pluint iBlock=0; iBlock<blockList.size(); ++iBlock) {
+                    if (blockList[iBlock].id == blockId) {
+                        blockList.erase(blockList.begin()+iBlock);
+                        --numGridEntries;
+                        break;
+                    }
+                }
+                if (blockList.empty()) {
+                    --numOccupiedCells;
+                }
             }
         }
     }
 }
 
+void SparseBlockStructure3D::adaptGrid() {
+    // Average number of blocks per non-empty grid cell above which the grid is refined.
+    static const plint maxCellOccupancy = 4;
+    // Maximum number of grid cells per block, which bounds the memory of the grid.
+    static const plint maxCellsPerBlock = 4;
+    while (numGridEntries > maxCellOccupancy*numOccupiedCells) {
+        plint newGridNx = gridLx>1 ? 2*gridNx : gridNx;
+        plint newGridNy = gridLy>1 ? 2*gridNy : gridNy;
+        plint newGridNz = gridLz>1 ? 2*gridNz : gridNz;
+        plint numCells = newGridNx*newGridNy*newGridNz;
+        if ( numCells == gridNx*gridNy*gridNz ||
+             numCells > maxCellsPerBlock*(plint)bulks.size() )
+        {
+            return;
+        }
+        gridNx = newGridNx;
+        gridNy = newGridNy;
+        gridNz = newGridNz;
+        iniGridParameters();
+        std::map<plint,Box3D>::const_iterator it = bulks.begin();
+        for (; it != bulks.end(); ++it) {
+            integrateBlock(it->first, it->second);
+        }
+    }
+}
+
 SparseBlockStructure3D scale(SparseBlockStructure3D const& sparseBlock, plint relativeLevel)
 {
     SparseBlockStructure3D newSparseBlock (
@@ -788,6 +840,107 @@ SparseBlockStructure3D alignDistribution3D (
     return newSparseBlock;
 }
 
+namespace {
+
+/// Number of bits per dimension in the curve keys (3*21 bits fit into 64 bits).
+const int maxCurveBits = 21;
+
+pluint mortonKey(pluint x, pluint y, pluint z, int numBits)
+{
+    pluint key = 0;
+    for (int bit=numBits-1; bit>=0; --bit) {
+        key = (key<<3) | (((x>>bit)&1)<<2) | (((y>>bit)&1)<<1) | ((z>>bit)&1);
+    }
+    return key;
+}
+
+/// Position along the Hilbert curve, computed with the transposition
+///   algorithm of J. Skilling, "Programming the Hilbert curve" (2004).
+pluint hilbertKey(pluint x, pluint y, pluint z, int numBits)
+{
+    pluint X[3] = { x, y, z };
+    pluint M = (pluint)1 << (numBits-1);
+    // Inverse undo excess work.
+    for (pluint Q=M; Q>1; Q>>=1) {
+        pluint P = Q-1;
+        for (int i=0; i<3; ++i) {
+            if (X[i] & Q) {
+                X[0] ^= P;
+            }
+            else {
+                pluint t = (X[0]^X[i]) & P;
+                X[0] ^= t;
+                X[i] ^= t;
+            }
+        }
+    }
+    // Gray encode.
+    X[1] ^= X[0];
+    X[2] ^= X[1];
+    pluint t = 0;
+    for (pluint Q=M; Q>1; Q>>=1) {
+        if (X[2] & Q) {
+            t ^= Q-1;
+        }
+    }
+    for (int i=0; i<3; ++i) {
+        X[i] ^= t;
+    }
+    return mortonKey(X[0], X[1], X[2], numBits);
+}
+
+}  // namespace
+
+std::vector<plint> orderAlongCurve( SparseBlockStructure3D const& sparseBlock,
+                                    spaceFillingCurve::CurveT curve )
+{
+    Box3D boundingBox = sparseBlock.getBoundingBox();
+    // Twice the block centers, relative to the bounding box, are integers.
+    pluint maxCoord = (pluint) (2*std::max(boundingBox.getNx(),
+                                std::max(boundingBox.getNy(), boundingBox.getNz())));
+    int numBits = 1;
+    while (numBits<64 && (maxCoord>>numBits) > 0) {
+        ++numBits;
+    }
+    int shift = std::max(0, numBits-maxCurveBits);
+    numBits -= shift;
+
+    std::map<plint,Box3D> const& bulks = sparseBlock.getBulks();
+    std::vector<std::pair<pluint,plint> > keys;
+    keys.reserve(bulks.size());
+    std::map<plint,Box3D>::const_iterator it = bulks.begin();
+    for (; it != bulks.end(); ++it) {
+        Box3D const& bulk = it->second;
+        pluint x = (pluint) (bulk.x0+bulk.x1-2*boundingBox.x0) >> shift;
+        pluint y = (pluint) (bulk.y0+bulk.y1-2*boundingBox.y0) >> shift;
+        pluint z = (pluint) (bulk.z0+bulk.z1-2*boundingBox.z0) >> shift;
+        pluint key = curve==spaceFillingCurve::morton ? mortonKey(x,y,z, numBits)
+                                                      : hilbertKey(x,y,z, numBits);
+        keys.push_back(std::make_pair(key, it->first));
+    }
+    std::sort(keys.begin(), keys.end());
+
+    std::vector<plint> orderedIds(keys.size());
+    for (pluint i=0; i<keys.size(); ++i) {
+        orderedIds[i] = keys[i].second;
+    }
+    return orderedIds;
+}
+
+SparseBlockStructure3D renumberAlongCurve (
+        SparseBlockStructure3D const& sparseBlock, spaceFillingCurve::CurveT curve )
+{
+    std::vector<plint> orderedIds = orderAlongCurve(sparseBlock, curve);
+    SparseBlockStructure3D newSparseBlock(sparseBlock.getBoundingBox());
+    for (pluint newId=0; newId<orderedIds.size(); ++newId) {
+        Box3D bulk, uniqueBulk;
+        sparseBlock.getBulk(orderedIds[newId], bulk);
+        sparseBlock.getUniqueBulk(orderedIds[newId], uniqueBulk);
+        newSparseBlock.addBlock(bulk, uniqueBulk, (plint)newId);
+    }
+    return newSparseBlock;
+}
+
 
 EuclideanIterator3D::EuclideanIterator3D(SparseBlockStructure3D const& sparseBlock_)
     : sparseBlock(sparseBlock_)
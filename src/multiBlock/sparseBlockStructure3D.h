@@ -38,9 +38,22 @@
 
 namespace plb {
 
+/// Block decomposition of a sparse multi-block, with a spatial index of the blocks.
+/** The blocks are indexed in a regular grid which covers the bounding box. Each
+ *  grid cell lists the blocks which intersect it, together with their bulks, so
+ *  that spatial queries access a fixed number of contiguous lists. The grid is
+ *  refined automatically when its cells contain too many blocks on average,
+ *  as long as its size remains proportional to the number of blocks.
+ **/
 class SparseBlockStructure3D {
 public:
-    typedef std::map<Dot3D, std::vector<plint> > GridT;
+    struct GridEntry {
+        GridEntry() { }
+        GridEntry(plint id_, Box3D const& bulk_) : id(id_), bulk(bulk_) { }
+        plint id;
+        Box3D bulk;
+    };
+    typedef std::vector<std::vector<GridEntry> > GridT;
 public:
     /// Sparse grid structure with default internal implementation.
     SparseBlockStructure3D(plint nx, plint ny, plint nz);
@@ -104,7 +117,7 @@ public:
 private:
     /// Default resolution of the sparse grid.
     void defaultGridN();
-    /// Compute gridLx, gridLy, and gridLz.
+    /// Compute gridLx, gridLy, and gridLz, and allocate an empty grid.
     void iniGridParameters();
     /// Convert block x-coordinate into coordinate of the sparse-block grid.
     plint gridPosX(plint realX) const;
@@ -112,8 +125,15 @@ private:
     plint gridPosY(plint realY) const;
     /// Convert block z-coordinate into coordinate of the sparse-block grid.
     plint gridPosZ(plint realZ) const;
-    /// Convert block coordinates into coordinates of the sparse-block grid.
+    /// Convert block coordinates into coordinates of the sparse-block grid,
+    ///   restricted to the extent of the grid.
     Box3D getGridBox(Box3D const& realBlock) const;
+    /// Position of a grid cell in the array of grid cells.
+    plint gridIndex(plint gridX, plint gridY, plint gridZ) const;
+    /// Collect all blocks which intersect a domain, each one once, in the order of their ids.
+    void findCandidates(Box3D const& domain, std::vector<GridEntry const*>& candidates) const;
+    /// Refine the grid if its cells contain too many blocks on average.
+    void adaptGrid();
     /// Extend bulk by an envelope layer in a given direction, in view of
     ///   computing overlaps with neighbors.
     void computeEnvelopeTerm (
@@ -128,6 +148,8 @@ private:
     plint gridLx, gridLy, gridLz;
     plint gridNx, gridNy, gridNz;
     GridT grid;
+    /// Number of non-empty grid cells, and total length of their block lists.
+    plint numOccupiedCells, numGridEntries;
     // Attention: If replacing the map by a hashed_map, remember that
     // nextIncrementalId() uses the fact that elements are ordered inside
     // the map. Therefore, nextIncrementalId() must then be rewritten.
@@ -185,6 +207,24 @@ SparseBlockStructure3D alignDistribution3D (
                            std::vector<plint>& newIds,
                            std::map<plint,std::vector<plint> >& remappedFromPartner );
 
+namespace spaceFillingCurve {
+    enum CurveT { morton, hilbert };
+}
+
+/// Ids of all blocks, ordered along a space-filling curve through the block centers.
+/** Blocks which are close on the curve are close in space. The Hilbert curve
+ *  has no jumps and yields more compact segments than the Morton (z-order) curve.
+ **/
+std::vector<plint> orderAlongCurve( SparseBlockStructure3D const& sparseBlock,
+                                    spaceFillingCurve::CurveT curve=spaceFillingCurve::hilbert );
+
+/// Copy of the block structure in which the blocks are numbered 0, 1, 2, ...
+///   along a space-filling curve. Local blocks are executed in the order of their
+///   ids, which is then a spatially coherent order.
+SparseBlockStructure3D renumberAlongCurve (
+        SparseBlockStructure3D const& sparseBlock,
+        spaceFillingCurve::CurveT curve=spaceFillingCurve::hilbert );
+
 
 /// Iterate in a structured way over a sparse multi-block structure.
 class EuclideanIterator3D {
@@ -191,6 +191,24 @@ plint cumNcells(std::vector<Box3D> const& domains) {
     return sum;
 }
 
+void coverRegularBlock( Box3D const& regularBlock, std::vector<Box3D> intersections,
+                        std::vector<Box3D>& newBlocks )
+{
+    // It is possible that the current block fully covers the domain of the old
+    // distribution. In this case, simply add current block, in order to avoid
+    // fragmentation. Note that this explicit test is really necessary, because
+    // the function mergeIntersection, which is called below, is not always able
+    // to reconstruct a full block from its fragments.
+    if (regularBlock.nCells() == cumNcells(intersections)) {
+        newBlocks.push_back(regularBlock);
+    }
+    else {
+        // Construct bigger blocks if possible, in order to avoid fragmentation.
+        mergeIntersections(intersections);
+        newBlocks.insert(newBlocks.end(), intersections.begin(), intersections.end());
+    }
+}
+
 SparseBlockStructure3D reparallelize(SparseBlockStructure3D const& originalStructure,
                                      plint blockLx, plint blockLy, plint blockLz)
 {
@@ -201,7 +219,7 @@ SparseBlockStructure3D reparallelize(SparseBlockStructure3D const& originalStruc
     util::linearBlockRepartition(boundingBox.z0, boundingBox.z1, blockLz, rangesZ);
     SparseBlockStructure3D newStructure(boundingBox);
     std::vector<plint> ids;
-    std::vector<Box3D> intersections;
+    std::vector<Box3D> intersections, newBlocks;
     for (pluint blockX=0; blockX<rangesX.size(); ++blockX) {
         for (pluint blockY=0; blockY<rangesY.size(); ++blockY) {
             for (pluint blockZ=0; blockZ<rangesZ.size(); ++blockZ) {
@@ -211,22 +229,11 @@ SparseBlockStructure3D reparallelize(SparseBlockStructure3D const& originalStruc
                 ids.clear();
                 intersections.clear();
                 originalStructure.intersect(currentBlock, ids, intersections);
-                // It is possible that the current block fully covers the domain of the old
-                // distribution. In this case, simply add current block, in order to avoid
-                // fragmentation. Note that this explicit test is really necessary, because
-                // the function mergeIntersection, which is called below, is not always able
-                // to reconstruct a full block from its fragments.
-                if (currentBlock.nCells() == cumNcells(intersections)) {
+                newBlocks.clear();
+                coverRegularBlock(currentBlock, intersections, newBlocks);
+                for (pluint iNew=0; iNew<newBlocks.size(); ++iNew) {
                     plint nextId = newStructure.nextIncrementalId();
-                    newStructure.addBlock(currentBlock, nextId);
-                }
-                else {
-                    // Construct bigger blocks if possible, in order to avoid fragmentation.
-                    mergeIntersections(intersections);
-                    for(pluint iInters=0; iInters<intersections.size(); ++iInters) {
-                        plint nextId = newStructure.nextIncrementalId();
-                        newStructure.addBlock(intersections[iInters], nextId);
-                    }
+                    newStructure.addBlock(newBlocks[iNew], nextId);
                 }
             }
         }
@@ -70,6 +70,12 @@ SparseBlockStructure3D createRegularDistributionXZ3D (
 SparseBlockStructure3D createRegularDistributionXY3D (
         plint nx, plint ny, plint nz, int numProc = global::mpi().getSize() );
 
+/// Cover the part of a regular block which lies in a distribution, given the
+///   intersections of the regular block with the blocks of the distribution,
+///   ordered by block id. The new blocks are appended to newBlocks.
+void coverRegularBlock( Box3D const& regularBlock, std::vector<Box3D> intersections,
+                        std::vector<Box3D>& newBlocks );
+
 /// Re-create a distribution by covering it with regular blocks.
 SparseBlockStructure3D reparallelize(SparseBlockStructure3D const& originalStructure,
                                      plint blockLx, plint blockLy, plint blockLz);
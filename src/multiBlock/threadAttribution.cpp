@@ -45,7 +45,8 @@ int SerialThreadAttribution::getMpiProcess(plint blockId) const {
 }
 
 int SerialThreadAttribution::getLocalThreadId(plint blockId) const {
-    return 0;
+    // All blocks are local: spread them over the threads in order of their id.
+    return blockId;
 }
 
 ThreadAttribution* SerialThreadAttribution::merge (
@@ -138,9 +139,9 @@ ExplicitThreadAttribution::ExplicitThreadAttribution (
     : mpiProcessAttribution(mpiProcessAttribution_)
 {
     std::map<plint,plint>::const_iterator it = mpiProcessAttribution.begin();
-    // Default local threads to zero.
+    // Distribute the blocks of each process over its local threads.
     for (; it != mpiProcessAttribution.end(); ++it) {
-        localThreadAttribution[it->first] = 0;
+        localThreadAttribution[it->first] = numBlocksPerProcess[it->second]++;
     }
 }
 
@@ -149,11 +150,21 @@ ExplicitThreadAttribution::ExplicitThreadAttribution (
         std::map<plint,plint> const& localThreadAttribution_ )
     : mpiProcessAttribution(mpiProcessAttribution_),
       localThreadAttribution(localThreadAttribution_)
-{ }
+{
+    std::map<plint,plint>::const_iterator it = mpiProcessAttribution.begin();
+    for (; it != mpiProcessAttribution.end(); ++it) {
+        ++numBlocksPerProcess[it->second];
+    }
+}
 
 void ExplicitThreadAttribution::addBlock (
         plint blockId, plint mpiProcess, plint localThread )
 {
+    plint& numBlocks = numBlocksPerProcess[mpiProcess];
+    if (localThread<0) {
+        localThread = numBlocks;
+    }
+    ++numBlocks;
     mpiProcessAttribution[blockId] = mpiProcess;
     localThreadAttribution[blockId] = localThread;
 }
@@ -210,6 +221,7 @@ ThreadAttribution* ExplicitThreadAttribution::merge (
         = new ExplicitThreadAttribution();
     newThreadAttribution->mpiProcessAttribution = mpiProcessAttribution;
     newThreadAttribution->localThreadAttribution = localThreadAttribution;
+    newThreadAttribution->numBlocksPerProcess = numBlocksPerProcess;
 
     std::map<plint,std::vector<plint> >::const_iterator it = remappedIds.begin();
     for (; it != remappedIds.end(); ++it) {
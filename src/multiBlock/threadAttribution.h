@@ -45,7 +45,8 @@ struct ThreadAttribution {
     /// Specifies on which MPI process a given block is located.
     virtual int getMpiProcess(plint blockId) const =0;
     /// Specifies to which of the local shared-memory threads the blockId
-    ///   belongs.
+    ///   belongs. The id is taken modulo the number of threads of the
+    ///   MPI process (see global::smp()).
     virtual int getLocalThreadId(plint blockId) const =0;
     /// Merge current attribution with rhs. From rhs, select explicitly
     ///   the specified blocks, and remap them to fit into the new
@@ -98,7 +99,10 @@ public:
     ExplicitThreadAttribution(std::map<plint,plint> const& mpiProcessAttribution_);
     ExplicitThreadAttribution(std::map<plint,plint> const& mpiProcessAttribution_,
                               std::map<plint,plint> const& localThreadAttribution_ );
-    void addBlock(plint blockId, plint mpiProcess, plint localThread=0);
+    /// Attribute a block to an MPI process. If no local thread is
+    ///   specified, the blocks of a process are distributed over the
+    ///   threads in the order in which they are added.
+    void addBlock(plint blockId, plint mpiProcess, plint localThread=-1);
     virtual bool isLocal(plint blockId) const;
     virtual bool allBlocksAreLocal() const;
     virtual int getMpiProcess(plint blockId) const;
@@ -128,6 +132,7 @@ public:
 private:
     std::map<plint,plint> mpiProcessAttribution;
     std::map<plint,plint> localThreadAttribution;
+    std::map<plint,plint> numBlocksPerProcess;
     std::map<plint,int> coProcessors;
 };
 
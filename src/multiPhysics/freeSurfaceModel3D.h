@@ -639,6 +639,9 @@ void initializeInterfaceLists3D(MultiContainerBlock3D& interfaceListBlock) {
     applyProcessingFunctional (
             new InitializeInterfaceLists3D<T,Descriptor>,
             interfaceListBlock.getBoundingBox(), arg );
+    // The lists are only filled during an iteration: blocks which migrate
+    //   to another process between iterations start with empty lists.
+    interfaceListBlock.setDataPrototype(new InterfaceLists<T,Descriptor>);
 }
 
 /// Addition of the external forces.
@@ -27,6 +27,7 @@
  * Groups all the include files for 3D parallelism.
  */
 #include "parallelism/mpiManager.h"
+#include "parallelism/smpManager.h"
 #include "parallelism/parallelDynamics.h"
 #include "parallelism/parallelBlockCommunicator3D.h"
 #include "parallelism/parallelMultiBlockLattice3D.h"
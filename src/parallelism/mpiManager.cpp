@@ -29,6 +29,7 @@
 #ifdef PLB_MPI_PARALLEL
 
 #include "parallelism/mpiManager.h"
+#include "parallelism/smpManager.h"
 #include "core/plbDebug.h"
 #include "core/plbComplex.h"
 #include "core/plbComplex.hh"
@@ -60,7 +61,13 @@ void MpiManager::init(int *argc, char ***argv, bool verbous) {
     if (verbous) {
         std::cerr << "Constructing an MPI thread" << std::endl;
     }
+#ifdef PLB_SMP_THREADS
+    // MPI is only called outside the parallel regions, by the main thread.
+    int provided;
+    int ok1 = MPI_Init_thread(argc, argv, MPI_THREAD_FUNNELED, &provided);
+#else
     int ok1 = MPI_Init(argc, argv);
+#endif
     // If I'm the one who calls MPI_Init, then I need to be
     // the one who calls MPI_Finalize.
     responsibleForMpiMachine = true;
@@ -2764,12 +2771,120 @@ void MpiManager::scan<Complex<__float128> >(Complex<__float128> sendVal, Complex
 }
 #endif
 
+void MpiManager::iAllReduce(double* buf, int count, MPI_Op op, MPI_Request* request)
+{
+    if (!ok) return;
+#if MPI_VERSION >= 3
+    MPI_Iallreduce(MPI_IN_PLACE, static_cast<void*>(buf), count, MPI_DOUBLE, op, getGlobalCommunicator(), request);
+#else
+    MPI_Allreduce(MPI_IN_PLACE, static_cast<void*>(buf), count, MPI_DOUBLE, op, getGlobalCommunicator());
+    *request = MPI_REQUEST_NULL;
+#endif
+}
+
 void MpiManager::wait(MPI_Request* request, MPI_Status* status)
 {
     if (!ok) return;
     MPI_Wait(request, status);
 }
 
+void MpiManager::sendInit(char *buf, int count, int dest, MPI_Request* request, int tag)
+{
+    if (!ok) return;
+    MPI_Send_init(static_cast<void*>(buf), count, MPI_CHAR, dest, tag, getGlobalCommunicator(), request);
+}
+
+void MpiManager::recvInit(char *buf, int count, int source, MPI_Request* request, int tag)
+{
+    if (!ok) return;
+    MPI_Recv_init(static_cast<void*>(buf), count, MPI_CHAR, source, tag, getGlobalCommunicator(), request);
+}
+
+void MpiManager::start(MPI_Request* request)
+{
+    if (!ok) return;
+    MPI_Start(request);
+}
+
+void MpiManager::requestFree(MPI_Request* request)
+{
+    if (!ok) return;
+    int finalized = 0;
+    MPI_Finalized(&finalized);
+    if (!finalized) {
+        MPI_Request_free(request);
+    }
+}
+
+void MpiManager::allToAllV( std::vector<std::vector<char> > const& sendBuffers,
+                            std::vector<std::vector<char> >& recvBuffers )
+{
+    if (!ok) {
+        recvBuffers = sendBuffers;
+        return;
+    }
+    int numProcs = getSize();
+    PLB_PRECONDITION( (int)sendBuffers.size() == numProcs );
+    std::vector<int> sendCounts(numProcs), recvCounts(numProcs);
+    std::vector<int> sendDispls(numProcs), recvDispls(numProcs);
+    for (int iProc=0; iProc<numProcs; ++iProc) {
+        sendCounts[iProc] = (int)sendBuffers[iProc].size();
+    }
+    MPI_Alltoall( &sendCounts[0], 1, MPI_INT, &recvCounts[0], 1, MPI_INT,
+                  getGlobalCommunicator() );
+    int sendSize = 0, recvSize = 0;
+    for (int iProc=0; iProc<numProcs; ++iProc) {
+        sendDispls[iProc] = sendSize;
+        sendSize += sendCounts[iProc];
+        recvDispls[iProc] = recvSize;
+        recvSize += recvCounts[iProc];
+    }
+    // One extra byte, so that the addresses of the buffers are always valid.
+    std::vector<char> sendData(sendSize+1), recvData(recvSize+1);
+    for (int iProc=0; iProc<numProcs; ++iProc) {
+        std::copy(sendBuffers[iProc].begin(), sendBuffers[iProc].end(),
+                  sendData.begin()+sendDispls[iProc]);
+    }
+    MPI_Alltoallv( &sendData[0], &sendCounts[0], &sendDispls[0], MPI_CHAR,
+                   &recvData[0], &recvCounts[0], &recvDispls[0], MPI_CHAR,
+                   getGlobalCommunicator() );
+    recvBuffers.resize(numProcs);
+    for (int iProc=0; iProc<numProcs; ++iProc) {
+        recvBuffers[iProc].assign( recvData.begin()+recvDispls[iProc],
+                                   recvData.begin()+recvDispls[iProc]+recvCounts[iProc] );
+    }
+}
+
+void MpiManager::getProcessTopology(std::vector<int>& nodeIds, std::vector<int>& numaIds)
+{
+    nodeIds.assign(getSize(), 0);
+    numaIds.assign(getSize(), 0);
+    if (!ok) return;
+    int rank = getRank();
+    int nodeId = rank;
+    int numaId = rank;
+#if MPI_VERSION >= 3
+    MPI_Comm nodeCommunicator;
+    MPI_Comm_split_type( getGlobalCommunicator(), MPI_COMM_TYPE_SHARED, rank,
+                         MPI_INFO_NULL, &nodeCommunicator );
+    MPI_Allreduce(&rank, &nodeId, 1, MPI_INT, MPI_MIN, nodeCommunicator);
+    numaId = nodeId;
+#if defined(OPEN_MPI) && OMPI_MAJOR_VERSION >= 2
+    // Processes which are not bound to a single NUMA domain get a null communicator.
+    MPI_Comm numaCommunicator;
+    MPI_Comm_split_type( nodeCommunicator, OMPI_COMM_TYPE_NUMA, rank,
+                         MPI_INFO_NULL, &numaCommunicator );
+    if (numaCommunicator != MPI_COMM_NULL) {
+        MPI_Allreduce(&rank, &numaId, 1, MPI_INT, MPI_MIN, numaCommunicator);
+        MPI_Comm_free(&numaCommunicator);
+    }
+#endif
+    MPI_Comm_free(&nodeCommunicator);
+#endif
+    MPI_Allgather(&nodeId, 1, MPI_INT, &nodeIds[0], 1, MPI_INT, getGlobalCommunicator());
+    MPI_Allgather(&numaId, 1, MPI_INT, &numaIds[0], 1, MPI_INT, getGlobalCommunicator());
+}
+
 }  // namespace global
 
 }  // namespace plb
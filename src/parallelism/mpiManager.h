@@ -33,9 +33,9 @@
 
 #ifdef PLB_MPI_PARALLEL
 #include "mpi.h"
-#include <vector>
 #include <string>
 #endif
+#include <vector>
 
 
 namespace plb {
@@ -149,9 +149,37 @@ public:
     template <typename T>
     void scan( T sendVal, T& recvVal, MPI_Op op );
 
+    /// In-place reduction of the count values at *buf, available on all MPI
+    ///   threads once the request is completed with wait(). Without MPI-3, the
+    ///   reduction is blocking and the request is null.
+    void iAllReduce( double* buf, int count, MPI_Op op, MPI_Request* request );
+
     /// Complete a non-blocking MPI operation
     void wait(MPI_Request* request, MPI_Status* status);
 
+    /// Create a persistent send request for the bytes at *buf
+    void sendInit( char *buf, int count, int dest, MPI_Request* request, int tag = 0 );
+
+    /// Create a persistent receive request for the bytes at *buf
+    void recvInit( char *buf, int count, int source, MPI_Request* request, int tag = 0 );
+
+    /// (Re-)activate a persistent request; complete it with wait()
+    void start(MPI_Request* request);
+
+    /// Release a persistent request. Does nothing once MPI is finalized.
+    void requestFree(MPI_Request* request);
+
+    /// Personalized exchange of byte buffers between all processes: sendBuffers[iProc]
+    ///   is sent to process iProc, and recvBuffers[iProc] is received from it.
+    void allToAllV( std::vector<std::vector<char> > const& sendBuffers,
+                    std::vector<std::vector<char> >& recvBuffers );
+
+    /// Location of all processes on the hardware: for each process, the id of
+    ///   its shared-memory node, and of its NUMA domain. A node or a NUMA domain
+    ///   is identified by the lowest id of the processes it hosts. When the NUMA
+    ///   domains cannot be queried, each node counts as one domain. Collective.
+    void getProcessTopology(std::vector<int>& nodeIds, std::vector<int>& numaIds);
+
 private:
     /// Implementation code for Scatter
     template <typename T>
@@ -200,6 +228,17 @@ public:
     void sendToMaster( std::string& message, bool iAmRoot ) { }
     /// Synchronizes the processes
     void barrier() { }
+    /// Personalized exchange of byte buffers between all processes.
+    void allToAllV( std::vector<std::vector<char> > const& sendBuffers,
+                    std::vector<std::vector<char> >& recvBuffers )
+    {
+        recvBuffers = sendBuffers;
+    }
+    /// Location of all processes on the hardware.
+    void getProcessTopology(std::vector<int>& nodeIds, std::vector<int>& numaIds) {
+        nodeIds.assign(1, 0);
+        numaIds.assign(1, 0);
+    }
 
 friend MpiManager& mpi();
 };
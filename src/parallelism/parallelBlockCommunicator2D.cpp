@@ -175,9 +175,9 @@ void ParallelBlockCommunicator2D::communicate (
             originMultiBlock.getMultiBlockManagement(),
             destinationMultiBlock.getMultiBlockManagement(),
             originMultiBlock.sizeOfCell() );
-    global::profiler().start("mpiCommunication");
+    global::profiler().start(global::prof::mpiCommunication);
     communicate(communication, originMultiBlock, destinationMultiBlock, whichData);
-    global::profiler().stop("mpiCommunication");
+    global::profiler().stop(global::prof::mpiCommunication);
 }
 
 void ParallelBlockCommunicator2D::communicate (
@@ -47,46 +47,14 @@ CommunicationStructure3D::CommunicationStructure3D (
         MultiBlockManagement3D const& destinationManagement,
         plint sizeOfCell )
 {
-    plint fromEnvelopeWidth = originManagement.getEnvelopeWidth();
-    plint toEnvelopeWidth = destinationManagement.getEnvelopeWidth();
-    SparseBlockStructure3D const& fromSparseBlock
-        = originManagement.getSparseBlockStructure();
-    SparseBlockStructure3D const& toSparseBlock
-        = destinationManagement.getSparseBlockStructure();
+    ThreadAttribution const& fromAttribution = originManagement.getThreadAttribution();
+    ThreadAttribution const& toAttribution = destinationManagement.getThreadAttribution();
 
     SendRecvPool sendPool, recvPool;
     for (pluint iOverlap=0; iOverlap<overlaps.size(); ++iOverlap) {
-        Overlap3D const& overlap = overlaps[iOverlap];
         CommunicationInfo3D info;
-
-        info.fromBlockId = overlap.getOriginalId();
-        info.toBlockId   = overlap.getOverlapId();
-
-        SmartBulk3D originalBulk(fromSparseBlock, fromEnvelopeWidth, info.fromBlockId);
-        SmartBulk3D overlapBulk(toSparseBlock, toEnvelopeWidth, info.toBlockId);
-
-        Box3D originalCoordinates(overlap.getOriginalCoordinates());
-        Box3D overlapCoordinates(overlap.getOverlapCoordinates());
-        info.fromDomain = originalBulk.toLocal(originalCoordinates);
-        info.toDomain   = overlapBulk.toLocal(overlapCoordinates);
-        info.absoluteOffset = Dot3D (
-                overlapCoordinates.x0 - originalCoordinates.x0,
-                overlapCoordinates.y0 - originalCoordinates.y0,
-                overlapCoordinates.z0 - originalCoordinates.z0 );
-
-        plint lx = info.fromDomain.x1-info.fromDomain.x0+1;
-        plint ly = info.fromDomain.y1-info.fromDomain.y0+1;
-        plint lz = info.fromDomain.z1-info.fromDomain.z0+1;
-        PLB_PRECONDITION(lx == info.toDomain.x1-info.toDomain.x0+1);
-        PLB_PRECONDITION(ly == info.toDomain.y1-info.toDomain.y0+1);
-        PLB_PRECONDITION(lz == info.toDomain.z1-info.toDomain.z0+1);
-
-        plint numberOfCells = lx*ly*lz;
-
-        ThreadAttribution const& fromAttribution = originManagement.getThreadAttribution();
-        ThreadAttribution const& toAttribution = destinationManagement.getThreadAttribution();
-        info.fromProcessId = fromAttribution.getMpiProcess(info.fromBlockId);
-        info.toProcessId   = toAttribution.getMpiProcess(info.toBlockId);
+        computeInfo(overlaps[iOverlap], originManagement, destinationManagement, info);
+        plint numberOfCells = info.fromDomain.nCells();
 
         if ( fromAttribution.isLocal(info.fromBlockId) &&
              toAttribution.isLocal(info.toBlockId))
@@ -109,6 +77,116 @@ CommunicationStructure3D::CommunicationStructure3D (
     recvComm = RecvPoolCommunicator(recvPool);
 }
 
+/** The recipient of an overlap has a valid copy of the cells of its own bulk
+ *  and of the overlap itself. Sender and recipient both evaluate the
+ *  incoming populations from this information, in their own coordinates, and
+ *  therefore agree on the size and layout of the message.
+ */
+CommunicationStructure3D::CommunicationStructure3D (
+        std::vector<Overlap3D> const& overlaps,
+        MultiBlock3D const& multiBlock )
+{
+    MultiBlockManagement3D const& management = multiBlock.getMultiBlockManagement();
+    ThreadAttribution const& attribution = management.getThreadAttribution();
+    SparseBlockStructure3D const& sparseBlock = management.getSparseBlockStructure();
+    PeriodicitySwitch3D const& periodicity = multiBlock.periodicity();
+    plint envelopeWidth = management.getEnvelopeWidth();
+
+    // Populations are streamed from the whole bounding box, and across the
+    //   periodic boundaries. Along a periodic direction, the source of a
+    //   population which enters a periodic image is known to the sender even
+    //   if it lies beyond the envelope of the recipient, so that the domain
+    //   is extended by a full period on each side.
+    Box3D boundingBox(sparseBlock.getBoundingBox());
+    plint period[3] = { boundingBox.getNx(), boundingBox.getNy(), boundingBox.getNz() };
+    Box3D streamedDomain(boundingBox);
+    for (plint iDim=0; iDim<3; ++iDim) {
+        if (periodicity.get(iDim)) {
+            streamedDomain = streamedDomain.enlarge(period[iDim]+envelopeWidth, iDim);
+        }
+    }
+
+    SendRecvPool sendPool, recvPool;
+    for (pluint iOverlap=0; iOverlap<overlaps.size(); ++iOverlap) {
+        CommunicationInfo3D info;
+        computeInfo(overlaps[iOverlap], management, management, info);
+
+        SmartBulk3D overlapBulk(sparseBlock, envelopeWidth, info.toBlockId);
+        std::vector<Box3D> shared;
+        shared.push_back(overlapBulk.toLocal(overlapBulk.getBulk()));
+        shared.push_back(info.toDomain);
+        IncomingPopulations3D toIncoming(overlapBulk.toLocal(streamedDomain), shared);
+
+        if ( attribution.isLocal(info.fromBlockId) &&
+             attribution.isLocal(info.toBlockId))
+        {
+            sendRecvPackage.push_back(info);
+        }
+        else if (attribution.isLocal(info.fromBlockId))
+        {
+            IncomingPopulations3D fromIncoming = toIncoming.shift (
+                    info.fromDomain.x0 - info.toDomain.x0,
+                    info.fromDomain.y0 - info.toDomain.y0,
+                    info.fromDomain.z0 - info.toDomain.z0 );
+            BlockDataTransfer3D const& transfer =
+                multiBlock.getComponent(info.fromBlockId).getDataTransfer();
+            sendPackage.push_back(info);
+            sendIncoming.push_back(fromIncoming);
+            sendPool.subscribeMessage( info.toProcessId,
+                                       transfer.incomingSize(info.fromDomain, fromIncoming) );
+        }
+        else if (attribution.isLocal(info.toBlockId))
+        {
+            BlockDataTransfer3D const& transfer =
+                multiBlock.getComponent(info.toBlockId).getDataTransfer();
+            recvPackage.push_back(info);
+            recvIncoming.push_back(toIncoming);
+            recvPool.subscribeMessage( info.fromProcessId,
+                                       transfer.incomingSize(info.toDomain, toIncoming) );
+        }
+    }
+
+    sendComm = SendPoolCommunicator(sendPool);
+    recvComm = RecvPoolCommunicator(recvPool);
+}
+
+void CommunicationStructure3D::computeInfo (
+        Overlap3D const& overlap,
+        MultiBlockManagement3D const& originManagement,
+        MultiBlockManagement3D const& destinationManagement,
+        CommunicationInfo3D& info ) const
+{
+    plint fromEnvelopeWidth = originManagement.getEnvelopeWidth();
+    plint toEnvelopeWidth = destinationManagement.getEnvelopeWidth();
+    SparseBlockStructure3D const& fromSparseBlock
+        = originManagement.getSparseBlockStructure();
+    SparseBlockStructure3D const& toSparseBlock
+        = destinationManagement.getSparseBlockStructure();
+
+    info.fromBlockId = overlap.getOriginalId();
+    info.toBlockId   = overlap.getOverlapId();
+
+    SmartBulk3D originalBulk(fromSparseBlock, fromEnvelopeWidth, info.fromBlockId);
+    SmartBulk3D overlapBulk(toSparseBlock, toEnvelopeWidth, info.toBlockId);
+
+    Box3D originalCoordinates(overlap.getOriginalCoordinates());
+    Box3D overlapCoordinates(overlap.getOverlapCoordinates());
+    info.fromDomain = originalBulk.toLocal(originalCoordinates);
+    info.toDomain   = overlapBulk.toLocal(overlapCoordinates);
+    info.absoluteOffset = Dot3D (
+            overlapCoordinates.x0 - originalCoordinates.x0,
+            overlapCoordinates.y0 - originalCoordinates.y0,
+            overlapCoordinates.z0 - originalCoordinates.z0 );
+
+    PLB_PRECONDITION(info.fromDomain.getNx() == info.toDomain.getNx());
+    PLB_PRECONDITION(info.fromDomain.getNy() == info.toDomain.getNy());
+    PLB_PRECONDITION(info.fromDomain.getNz() == info.toDomain.getNz());
+
+    ThreadAttribution const& fromAttribution = originManagement.getThreadAttribution();
+    ThreadAttribution const& toAttribution = destinationManagement.getThreadAttribution();
+    info.fromProcessId = fromAttribution.getMpiProcess(info.fromBlockId);
+    info.toProcessId   = toAttribution.getMpiProcess(info.toBlockId);
+}
 
 
 CommunicationPattern3D::CommunicationPattern3D (
@@ -176,17 +254,20 @@ CommunicationPattern3D::CommunicationPattern3D (
 
 ParallelBlockCommunicator3D::ParallelBlockCommunicator3D()
     : overlapsModified(true),
-      communication(0)
+      communication(0),
+      streamedCommunication(0)
 { }
 
 ParallelBlockCommunicator3D::ParallelBlockCommunicator3D (
         ParallelBlockCommunicator3D const& rhs )
     : overlapsModified(true),
-      communication(0)
+      communication(0),
+      streamedCommunication(0)
 { }
 
 ParallelBlockCommunicator3D::~ParallelBlockCommunicator3D() {
     delete communication;
+    delete streamedCommunication;
 }
 
 ParallelBlockCommunicator3D& ParallelBlockCommunicator3D::operator= (
@@ -199,6 +280,7 @@ ParallelBlockCommunicator3D& ParallelBlockCommunicator3D::operator= (
 void ParallelBlockCommunicator3D::swap(ParallelBlockCommunicator3D& rhs) {
     std::swap(overlapsModified,rhs.overlapsModified);
     std::swap(communication,rhs.communication);
+    std::swap(streamedCommunication,rhs.streamedCommunication);
 }
 
 ParallelBlockCommunicator3D* ParallelBlockCommunicator3D::clone() const {
@@ -208,28 +290,81 @@ ParallelBlockCommunicator3D* ParallelBlockCommunicator3D::clone() const {
 void ParallelBlockCommunicator3D::duplicateOverlaps( MultiBlock3D& multiBlock,
                                                      modif::ModifT whichData ) const
 {
-    MultiBlockManagement3D const& multiBlockManagement = multiBlock.getMultiBlockManagement();
-    PeriodicitySwitch3D const& periodicity             = multiBlock.periodicity();
+    startDuplicateOverlaps(multiBlock, whichData);
+    completeDuplicateOverlaps(multiBlock, whichData);
+}
 
+void ParallelBlockCommunicator3D::startDuplicateOverlaps( MultiBlock3D& multiBlock,
+                                                          modif::ModifT whichData ) const
+{
     // Implement a caching mechanism for the communication structure.
-    if (overlapsModified) {
-        overlapsModified = false;
-        LocalMultiBlockInfo3D const& localInfo = multiBlockManagement.getLocalInfo();
-        std::vector<Overlap3D> overlaps(multiBlockManagement.getLocalInfo().getNormalOverlaps());
-        for (pluint iOverlap=0; iOverlap<localInfo.getPeriodicOverlaps().size(); ++iOverlap) {
-            PeriodicOverlap3D const& pOverlap = localInfo.getPeriodicOverlaps()[iOverlap];
-            if (periodicity.get(pOverlap.normalX,pOverlap.normalY,pOverlap.normalZ)) {
-                overlaps.push_back(pOverlap.overlap);
-            }
-        }
-        delete communication;
+    checkOverlaps();
+    if (!communication) {
+        std::vector<Overlap3D> overlaps;
+        computeEnvelopeOverlaps(multiBlock, overlaps);
         communication = new CommunicationStructure3D (
                                 overlaps,
-                                multiBlockManagement, multiBlockManagement,
+                                multiBlock.getMultiBlockManagement(),
+                                multiBlock.getMultiBlockManagement(),
                                 multiBlock.sizeOfCell() );
     }
 
-    communicate(*communication, multiBlock, multiBlock, whichData);
+    startCommunication(*communication, multiBlock, whichData);
+}
+
+void ParallelBlockCommunicator3D::completeDuplicateOverlaps( MultiBlock3D& multiBlock,
+                                                             modif::ModifT whichData ) const
+{
+    PLB_PRECONDITION( communication );
+    completeCommunication(*communication, multiBlock, multiBlock, whichData);
+}
+
+void ParallelBlockCommunicator3D::duplicateStreamedOverlaps(MultiBlock3D& multiBlock) const
+{
+    startDuplicateStreamedOverlaps(multiBlock);
+    completeDuplicateStreamedOverlaps(multiBlock);
+}
+
+void ParallelBlockCommunicator3D::startDuplicateStreamedOverlaps(MultiBlock3D& multiBlock) const
+{
+    checkOverlaps();
+    if (!streamedCommunication) {
+        std::vector<Overlap3D> overlaps;
+        computeEnvelopeOverlaps(multiBlock, overlaps);
+        streamedCommunication = new CommunicationStructure3D(overlaps, multiBlock);
+    }
+
+    startCommunication(*streamedCommunication, multiBlock, modif::staticVariables);
+}
+
+void ParallelBlockCommunicator3D::completeDuplicateStreamedOverlaps(MultiBlock3D& multiBlock) const
+{
+    PLB_PRECONDITION( streamedCommunication );
+    completeCommunication(*streamedCommunication, multiBlock, multiBlock, modif::staticVariables);
+}
+
+void ParallelBlockCommunicator3D::computeEnvelopeOverlaps (
+        MultiBlock3D const& multiBlock, std::vector<Overlap3D>& overlaps ) const
+{
+    LocalMultiBlockInfo3D const& localInfo = multiBlock.getMultiBlockManagement().getLocalInfo();
+    PeriodicitySwitch3D const& periodicity = multiBlock.periodicity();
+    overlaps = localInfo.getNormalOverlaps();
+    for (pluint iOverlap=0; iOverlap<localInfo.getPeriodicOverlaps().size(); ++iOverlap) {
+        PeriodicOverlap3D const& pOverlap = localInfo.getPeriodicOverlaps()[iOverlap];
+        if (periodicity.get(pOverlap.normalX,pOverlap.normalY,pOverlap.normalZ)) {
+            overlaps.push_back(pOverlap.overlap);
+        }
+    }
+}
+
+void ParallelBlockCommunicator3D::checkOverlaps() const {
+    if (overlapsModified) {
+        overlapsModified = false;
+        delete communication;
+        communication = 0;
+        delete streamedCommunication;
+        streamedCommunication = 0;
+    }
 }
 
 void ParallelBlockCommunicator3D::communicate (
@@ -253,21 +388,51 @@ void ParallelBlockCommunicator3D::communicate (
         MultiBlock3D const& originMultiBlock,
         MultiBlock3D& destinationMultiBlock, modif::ModifT whichData ) const
 {
-    global::profiler().start("mpiCommunication");
+    startCommunication(communication, originMultiBlock, whichData);
+    completeCommunication(communication, originMultiBlock, destinationMultiBlock, whichData);
+}
+
+void ParallelBlockCommunicator3D::startCommunication (
+        CommunicationStructure3D& communication,
+        MultiBlock3D const& originMultiBlock, modif::ModifT whichData ) const
+{
+    global::profiler().start(global::prof::mpiCommunication);
     bool staticMessage = whichData == modif::staticVariables;
     // 1. Non-blocking receives.
     communication.recvComm.startBeingReceptive(staticMessage);
 
-    // 2. Non-blocking sends.
+    // 2. Non-blocking sends. Static data is packed straight into the
+    //    persistent send buffer of the destination process.
+    bool incomingOnly = !communication.sendIncoming.empty();
     for (unsigned iSend=0; iSend<communication.sendPackage.size(); ++iSend) {
         CommunicationInfo3D const& info = communication.sendPackage[iSend];
         AtomicBlock3D const& fromBlock = originMultiBlock.getComponent(info.fromBlockId);
-        fromBlock.getDataTransfer().send (
-                info.fromDomain, communication.sendComm.getSendBuffer(info.toProcessId),
-                whichData );
+        if (incomingOnly) {
+            fromBlock.getDataTransfer().sendIncoming (
+                    info.fromDomain, communication.sendIncoming[iSend],
+                    communication.sendComm.getStaticSendBuffer(info.toProcessId) );
+        }
+        else if (staticMessage) {
+            fromBlock.getDataTransfer().sendStatic (
+                    info.fromDomain, communication.sendComm.getStaticSendBuffer(info.toProcessId) );
+        }
+        else {
+            fromBlock.getDataTransfer().send (
+                    info.fromDomain, communication.sendComm.getSendBuffer(info.toProcessId),
+                    whichData );
+        }
         communication.sendComm.acceptMessage(info.toProcessId, staticMessage);
     }
+    global::profiler().stop(global::prof::mpiCommunication);
+}
 
+void ParallelBlockCommunicator3D::completeCommunication (
+        CommunicationStructure3D& communication,
+        MultiBlock3D const& originMultiBlock,
+        MultiBlock3D& destinationMultiBlock, modif::ModifT whichData ) const
+{
+    global::profiler().start(global::prof::mpiCommunication);
+    bool staticMessage = whichData == modif::staticVariables;
     // 3. Local copies which require no communication.
     for (unsigned iSendRecv=0; iSendRecv<communication.sendRecvPackage.size(); ++iSendRecv) {
         CommunicationInfo3D const& info = communication.sendRecvPackage[iSendRecv];
@@ -281,19 +446,35 @@ void ParallelBlockCommunicator3D::communicate (
                 whichData, info.absoluteOffset );
     }
 
-    // 4. Finalize the receives.
+    // 4. Finalize the receives. Static data is unpacked in place from the
+    //    persistent receive buffer.
+    bool incomingOnly = !communication.recvIncoming.empty();
     for (unsigned iRecv=0; iRecv<communication.recvPackage.size(); ++iRecv) {
         CommunicationInfo3D const& info = communication.recvPackage[iRecv];
         AtomicBlock3D& toBlock = destinationMultiBlock.getComponent(info.toBlockId);
-        toBlock.getDataTransfer().receive (
-                info.toDomain,
-                communication.recvComm.receiveMessage(info.fromProcessId, staticMessage),
-                whichData, info.absoluteOffset );
+        if (incomingOnly) {
+            toBlock.getDataTransfer().receiveIncoming (
+                    info.toDomain, communication.recvIncoming[iRecv],
+                    communication.recvComm.receiveStaticMessage(info.fromProcessId),
+                    info.absoluteOffset );
+        }
+        else if (staticMessage) {
+            toBlock.getDataTransfer().receiveStatic (
+                    info.toDomain,
+                    communication.recvComm.receiveStaticMessage(info.fromProcessId),
+                    info.absoluteOffset );
+        }
+        else {
+            toBlock.getDataTransfer().receive (
+                    info.toDomain,
+                    communication.recvComm.receiveMessage(info.fromProcessId, staticMessage),
+                    whichData, info.absoluteOffset );
+        }
     }
 
     // 5. Finalize the sends.
     communication.sendComm.finalize(staticMessage);
-    global::profiler().stop("mpiCommunication");
+    global::profiler().stop(global::prof::mpiCommunication);
 }
 
 void ParallelBlockCommunicator3D::signalPeriodicity() const {
@@ -33,6 +33,7 @@
 #include "multiBlock/blockCommunicator3D.h"
 #include "multiBlock/multiBlockManagement3D.h"
 #include "multiBlock/multiBlock3D.h"
+#include "atomicBlock/atomicBlock3D.h"
 #include "parallelism/sendRecvPool.h"
 #include "parallelism/communicationPackage3D.h"
 #include <vector>
@@ -59,11 +60,26 @@ struct CommunicationStructure3D
             MultiBlockManagement3D const& originManagement,
             MultiBlockManagement3D const& destinationManagement,
             plint sizeOfCell );
+    /// Structure for the envelope update after a collide-and-stream step, in
+    ///   which only the incoming populations are transmitted.
+    CommunicationStructure3D (
+            std::vector<Overlap3D> const& overlaps,
+            MultiBlock3D const& multiBlock );
     CommunicationPackage3D sendPackage;
     CommunicationPackage3D recvPackage;
     CommunicationPackage3D sendRecvPackage;
+    /// Incoming populations of each entry of sendPackage and recvPackage, in
+    ///   the local coordinates of the sending and receiving block respectively.
+    ///   Empty if the full static data is transmitted.
+    std::vector<IncomingPopulations3D> sendIncoming;
+    std::vector<IncomingPopulations3D> recvIncoming;
     SendPoolCommunicator sendComm;
     RecvPoolCommunicator recvComm;
+private:
+    void computeInfo( Overlap3D const& overlap,
+                      MultiBlockManagement3D const& originManagement,
+                      MultiBlockManagement3D const& destinationManagement,
+                      CommunicationInfo3D& info ) const;
 };
 
 
@@ -77,21 +93,40 @@ public:
     void swap(ParallelBlockCommunicator3D& rhs);
     virtual ParallelBlockCommunicator3D* clone() const;
     virtual void duplicateOverlaps(MultiBlock3D& multiBlock, modif::ModifT whichData) const;
+    virtual void startDuplicateOverlaps(MultiBlock3D& multiBlock, modif::ModifT whichData) const;
+    virtual void completeDuplicateOverlaps(MultiBlock3D& multiBlock, modif::ModifT whichData) const;
+    virtual void duplicateStreamedOverlaps(MultiBlock3D& multiBlock) const;
+    virtual void startDuplicateStreamedOverlaps(MultiBlock3D& multiBlock) const;
+    virtual void completeDuplicateStreamedOverlaps(MultiBlock3D& multiBlock) const;
     virtual void communicate( std::vector<Overlap3D> const& overlaps,
                               MultiBlock3D const& originMultiBlock,
                               MultiBlock3D& destinationMultiBlock,
                               modif::ModifT whichData ) const;
     virtual void signalPeriodicity() const;
 private:
+    /// Normal overlaps, and periodic overlaps along the periodic directions.
+    void computeEnvelopeOverlaps(MultiBlock3D const& multiBlock,
+                                 std::vector<Overlap3D>& overlaps) const;
+    /// Discard the cached communication structures if the overlaps changed.
+    void checkOverlaps() const;
     void communicate( CommunicationStructure3D& communication,
                       MultiBlock3D const& originMultiBlock,
                       MultiBlock3D& destinationMultiBlock, modif::ModifT whichData ) const;
+    /// Post the non-blocking receives and sends.
+    void startCommunication( CommunicationStructure3D& communication,
+                             MultiBlock3D const& originMultiBlock,
+                             modif::ModifT whichData ) const;
+    /// Execute the local copies, and wait for the receives and sends.
+    void completeCommunication( CommunicationStructure3D& communication,
+                                MultiBlock3D const& originMultiBlock,
+                                MultiBlock3D& destinationMultiBlock, modif::ModifT whichData ) const;
     void subscribeOverlap (
         Overlap3D const& overlap, MultiBlockManagement3D const& multiBlockManagement,
         SendRecvPool& sendPool, SendRecvPool& recvPool, plint sizeOfCell ) const;
 private:
     mutable bool overlapsModified;
     mutable CommunicationStructure3D* communication;
+    mutable CommunicationStructure3D* streamedCommunication;
 };
 
 
@@ -27,12 +27,47 @@
  */
 #include "parallelism/mpiManager.h"
 #include "parallelism/parallelStatistics.h"
+#include "core/plbDebug.h"
 #include <cmath>
 
 namespace plb {
 
 #ifdef PLB_MPI_PARALLEL
 
+namespace {
+
+/// Start the in-place all-reduce of a buffer. An empty buffer gets a null
+///   request, which completes immediately.
+void startAllReduce(std::vector<double>& buffer, MPI_Op op, MPI_Request* request)
+{
+    if (buffer.empty()) {
+        *request = MPI_REQUEST_NULL;
+    }
+    else {
+        global::mpi().iAllReduce(&buffer[0], (int)buffer.size(), op, request);
+    }
+}
+
+}  // namespace
+
+ParallelCombinedStatistics::ParallelCombinedStatistics()
+    : pending(false)
+{ }
+
+ParallelCombinedStatistics::ParallelCombinedStatistics(ParallelCombinedStatistics const& rhs)
+    : CombinedStatistics(rhs),
+      pending(false)
+{ }
+
+ParallelCombinedStatistics::~ParallelCombinedStatistics()
+{
+    if (pending) {
+        MPI_Status status;
+        global::mpi().wait(&sumRequest, &status);
+        global::mpi().wait(&maxRequest, &status);
+    }
+}
+
 ParallelCombinedStatistics* ParallelCombinedStatistics::clone() const
 {
     return new ParallelCombinedStatistics(*this);
@@ -45,41 +80,115 @@ void ParallelCombinedStatistics::reduceStatistics (
             std::vector<double>& maxObservables,
             std::vector<plint>& intSumObservables ) const
 {
+    // Independent of a reduction which may be in progress.
+    std::vector<double> localSums, localMaxima;
+    pack(averageObservables, sumWeights, sumObservables, maxObservables, intSumObservables,
+         localSums, localMaxima);
+    MPI_Request localSumRequest, localMaxRequest;
+    MPI_Status status;
+    startAllReduce(localSums, MPI_SUM, &localSumRequest);
+    startAllReduce(localMaxima, MPI_MAX, &localMaxRequest);
+    global::mpi().wait(&localSumRequest, &status);
+    global::mpi().wait(&localMaxRequest, &status);
+    unpack(localSums, localMaxima, averageObservables, sumWeights, sumObservables,
+           maxObservables, intSumObservables);
+}
+
+void ParallelCombinedStatistics::startReduction (
+            std::vector<double>& averageObservables,
+            std::vector<double>& sumWeights,
+            std::vector<double>& sumObservables,
+            std::vector<double>& maxObservables,
+            std::vector<plint>& intSumObservables ) const
+{
+    PLB_PRECONDITION( !pending );
+    pack(averageObservables, sumWeights, sumObservables, maxObservables, intSumObservables,
+         sumBuffer, maxBuffer);
+    startAllReduce(sumBuffer, MPI_SUM, &sumRequest);
+    startAllReduce(maxBuffer, MPI_MAX, &maxRequest);
+    pending = true;
+}
+
+void ParallelCombinedStatistics::completeReduction (
+            std::vector<double>& averageObservables,
+            std::vector<double>& sumWeights,
+            std::vector<double>& sumObservables,
+            std::vector<double>& maxObservables,
+            std::vector<plint>& intSumObservables ) const
+{
+    PLB_PRECONDITION( pending );
+    MPI_Status status;
+    global::mpi().wait(&sumRequest, &status);
+    global::mpi().wait(&maxRequest, &status);
+    pending = false;
+    unpack(sumBuffer, maxBuffer, averageObservables, sumWeights, sumObservables,
+           maxObservables, intSumObservables);
+}
+
+void ParallelCombinedStatistics::pack (
+            std::vector<double> const& averageObservables,
+            std::vector<double> const& sumWeights,
+            std::vector<double> const& sumObservables,
+            std::vector<double> const& maxObservables,
+            std::vector<plint> const& intSumObservables,
+            std::vector<double>& sums, std::vector<double>& maxima )
+{
+    pluint numAverages = averageObservables.size();
+    sums.resize(2*numAverages + sumObservables.size() + intSumObservables.size());
+
+    double* entry = sums.empty() ? 0 : &sums[0];
+    for (pluint iAverage=0; iAverage<numAverages; ++iAverage) {
+        *entry++ = averageObservables[iAverage]*sumWeights[iAverage];
+    }
+    for (pluint iAverage=0; iAverage<numAverages; ++iAverage) {
+        *entry++ = sumWeights[iAverage];
+    }
+    for (pluint iSum=0; iSum<sumObservables.size(); ++iSum) {
+        *entry++ = sumObservables[iSum];
+    }
+    // Integer sums are exactly represented as long as they stay below 2^53.
+    for (pluint iSum=0; iSum<intSumObservables.size(); ++iSum) {
+        *entry++ = (double) intSumObservables[iSum];
+    }
+    maxima = maxObservables;
+}
+
+void ParallelCombinedStatistics::unpack (
+            std::vector<double> const& sums,
+            std::vector<double> const& maxima,
+            std::vector<double>& averageObservables,
+            std::vector<double>& sumWeights,
+            std::vector<double>& sumObservables,
+            std::vector<double>& maxObservables,
+            std::vector<plint>& intSumObservables )
+{
+    pluint numAverages = averageObservables.size();
+    double const* entry = sums.empty() ? 0 : &sums[0];
     // Averages
-    for (pluint iAverage=0; iAverage<averageObservables.size(); ++iAverage) {
-        double globalAverage, globalWeight;
-        global::mpi().reduce(averageObservables[iAverage]*sumWeights[iAverage], globalAverage, MPI_SUM);
-        global::mpi().reduce(sumWeights[iAverage], globalWeight, MPI_SUM);
-        if (global::mpi().isMainProcessor() && std::fabs(globalWeight) > 0.5) {
+    for (pluint iAverage=0; iAverage<numAverages; ++iAverage) {
+        double globalAverage = entry[iAverage];
+        double globalWeight = entry[numAverages+iAverage];
+        if (std::fabs(globalWeight) > 0.5) {
             globalAverage /= globalWeight;
         }
-        global::mpi().bCast(&globalAverage, 1);
         averageObservables[iAverage] = globalAverage;
+        sumWeights[iAverage] = globalWeight;
     }
+    entry += 2*numAverages;
 
     // Sum
     for (pluint iSum=0; iSum<sumObservables.size(); ++iSum) {
-        double globalSum;
-        global::mpi().reduce(sumObservables[iSum], globalSum, MPI_SUM);
-        global::mpi().bCast(&globalSum, 1);
-        sumObservables[iSum] = globalSum;
-    }
-
-    // Max
-    for (pluint iMax=0; iMax<maxObservables.size(); ++iMax) {
-        double globalMax;
-        global::mpi().reduce(maxObservables[iMax], globalMax, MPI_MAX);
-        global::mpi().bCast(&globalMax, 1);
-        maxObservables[iMax] = globalMax;
+        sumObservables[iSum] = *entry++;
     }
 
     // Integer sum
     for (pluint iSum=0; iSum<intSumObservables.size(); ++iSum) {
-        plint globalSum;
-        global::mpi().reduce(intSumObservables[iSum], globalSum, MPI_SUM);
-        global::mpi().bCast(&globalSum, 1);
-        intSumObservables[iSum] = globalSum;
+        double globalSum = *entry++;
+        intSumObservables[iSum] = (plint) (globalSum<0. ? globalSum-0.5 : globalSum+0.5);
     }
+
+    // Max
+    maxObservables = maxima;
 }
 
 #endif  // PLB_MPI_PARALLEL
@@ -30,14 +30,22 @@
 
 #include "core/globalDefs.h"
 #include "multiBlock/combinedStatistics.h"
+#include "parallelism/mpiManager.h"
 #include <vector>
 
 namespace plb {
 
 #ifdef PLB_MPI_PARALLEL
 
+/// Reduces all observables at once: the sums (including the weighted averages
+///   and their weights) are packed into one buffer, and the maxima into another.
+///   They are combined with two concurrent, non-blocking all-reduce operations.
 class ParallelCombinedStatistics : public CombinedStatistics {
 public:
+    ParallelCombinedStatistics();
+    /// A pending reduction is not copied.
+    ParallelCombinedStatistics(ParallelCombinedStatistics const& rhs);
+    ~ParallelCombinedStatistics();
     virtual ParallelCombinedStatistics* clone() const;
 protected:
     virtual void reduceStatistics (
@@ -46,6 +54,42 @@ protected:
             std::vector<double>& sumObservables,
             std::vector<double>& maxObservables,
             std::vector<plint>& intSumObservables ) const;
+    virtual void startReduction (
+            std::vector<double>& averageObservables,
+            std::vector<double>& sumWeights,
+            std::vector<double>& sumObservables,
+            std::vector<double>& maxObservables,
+            std::vector<plint>& intSumObservables ) const;
+    virtual void completeReduction (
+            std::vector<double>& averageObservables,
+            std::vector<double>& sumWeights,
+            std::vector<double>& sumObservables,
+            std::vector<double>& maxObservables,
+            std::vector<plint>& intSumObservables ) const;
+private:
+    ParallelCombinedStatistics& operator=(ParallelCombinedStatistics const& rhs);
+    static void pack (
+            std::vector<double> const& averageObservables,
+            std::vector<double> const& sumWeights,
+            std::vector<double> const& sumObservables,
+            std::vector<double> const& maxObservables,
+            std::vector<plint> const& intSumObservables,
+            std::vector<double>& sums, std::vector<double>& maxima );
+    static void unpack (
+            std::vector<double> const& sums,
+            std::vector<double> const& maxima,
+            std::vector<double>& averageObservables,
+            std::vector<double>& sumWeights,
+            std::vector<double>& sumObservables,
+            std::vector<double>& maxObservables,
+            std::vector<plint>& intSumObservables );
+private:
+    /// Packed sums: weighted averages, weights, sums, and integer sums.
+    mutable std::vector<double> sumBuffer;
+    /// Packed maxima.
+    mutable std::vector<double> maxBuffer;
+    mutable MPI_Request sumRequest, maxRequest;
+    mutable bool pending;
 };
  
 #endif  // PLB_MPI_PARALLEL
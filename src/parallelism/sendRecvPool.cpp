@@ -50,17 +50,35 @@ std::vector<char>& SendPoolCommunicator::getSendBuffer(int toProc) {
     return entry.messages[entry.currentMessage];
 }
 
+char* SendPoolCommunicator::getStaticSendBuffer(int toProc) {
+    std::map<int,CommunicatorEntry>::iterator entryPtr = subscriptions.find(toProc);
+    PLB_ASSERT( entryPtr != subscriptions.end() );
+    CommunicatorEntry& entry = entryPtr->second;
+    PLB_ASSERT( entry.currentMessage < (int)entry.messages.size() );
+    entry.packedInPlace = true;
+    if (entry.lengths[entry.currentMessage]==0) {
+        return 0;
+    }
+    return &entry.staticData[0] + entry.offsets[entry.currentMessage];
+}
+
 void SendPoolCommunicator::acceptMessage(int toProc, bool staticMessage)
 {
     std::map<int,CommunicatorEntry>::iterator entryPtr = subscriptions.find(toProc);
     PLB_ASSERT( entryPtr != subscriptions.end() );
     CommunicatorEntry& entry = entryPtr->second;
     PLB_ASSERT( entry.currentMessage < (int)entry.messages.size() );
-    // If communication is static, make sure that the message has
-    //   the right size.
-    PLB_ASSERT( !staticMessage ||
-                ( (int)entry.messages[entry.currentMessage].size() ==
-                  entry.lengths[entry.currentMessage] ) );
+    if (staticMessage && !entry.packedInPlace) {
+        // If communication is static, make sure that the message has
+        //   the right size.
+        std::vector<char> const& message = entry.messages[entry.currentMessage];
+        PLB_ASSERT( (int)message.size() == entry.lengths[entry.currentMessage] );
+        if (!message.empty()) {
+            std::copy(message.begin(), message.end(),
+                      entry.staticData.begin()+entry.offsets[entry.currentMessage]);
+        }
+    }
+    entry.packedInPlace = false;
     entry.currentMessage++;
 
     if (entry.currentMessage==(int)entry.lengths.size()) {
@@ -74,9 +92,14 @@ void SendPoolCommunicator::finalize(bool staticMessage) {
     std::map<int, CommunicatorEntry >::iterator iter = subscriptions.begin();
     for (; iter != subscriptions.end(); ++iter) {
         CommunicatorEntry& entry = iter->second;
-        if (!staticMessage) {
-            global::mpi().wait(&entry.sizeRequest, &entry.sizeStatus);
+        if (staticMessage) {
+            // Empty messages are neither sent nor received.
+            if (entry.hasStaticRequest) {
+                global::mpi().wait(&entry.staticRequest, &entry.messageStatus);
+            }
+            continue;
         }
+        global::mpi().wait(&entry.sizeRequest, &entry.sizeStatus);
         // Empty messages are neither sent nor received.
         if (!entry.data.empty()) {
             global::mpi().wait(&entry.messageRequest, &entry.messageStatus);
@@ -90,24 +113,21 @@ void SendPoolCommunicator::startCommunication(int toProc, bool staticMessage)
     PLB_ASSERT( entryPtr != subscriptions.end() );
     CommunicatorEntry& entry = entryPtr->second;
     if (staticMessage) {
-        entry.data.resize(entry.cumDataLength);
-    }
-    else {
-        // If the communicated data is non-static, the overall size of transmitted
-        //   data must be computed.
-        int dynamicDataLength = 0;
-        entry.dynamicDataSizes.resize(entry.messages.size());
-        for (pluint iMessage=0; iMessage<entry.messages.size(); ++iMessage) {
-            dynamicDataLength += entry.messages[iMessage].size();
-            entry.dynamicDataSizes[iMessage] = entry.messages[iMessage].size();
-        }
-        entry.data.resize(dynamicDataLength);
+        startStaticCommunication(toProc, entry);
+        return;
+    }
+    // If the communicated data is non-static, the overall size of transmitted
+    //   data must be computed.
+    int dynamicDataLength = 0;
+    entry.dynamicDataSizes.resize(entry.messages.size());
+    for (pluint iMessage=0; iMessage<entry.messages.size(); ++iMessage) {
+        dynamicDataLength += entry.messages[iMessage].size();
+        entry.dynamicDataSizes[iMessage] = entry.messages[iMessage].size();
     }
+    entry.data.resize(dynamicDataLength);
     // Merge the individual messages into a single vector.
     int pos=0;
     for (pluint iMessage=0; iMessage<entry.messages.size(); ++iMessage) {
-        PLB_ASSERT( !staticMessage ||
-                    ( (int)entry.messages[iMessage].size() == entry.lengths[iMessage] ));
         PLB_ASSERT(pos+entry.messages[iMessage].size() <= entry.data.size());
         if( !entry.messages[iMessage].empty() && !entry.data.empty() ) {
             std::copy(entry.messages[iMessage].begin(),
@@ -115,19 +135,34 @@ void SendPoolCommunicator::startCommunication(int toProc, bool staticMessage)
         }
         pos+=entry.messages[iMessage].size();
     }
-    if (!staticMessage) {
-        PLB_ASSERT(entry.dynamicDataSizes.size()>0);
-        global::profiler().increment("mpiSendChar", (plint)entry.dynamicDataSizes.size());
-        global::mpi().iSend(&entry.dynamicDataSizes[0], entry.dynamicDataSizes.size(), toProc,
-                            &entry.sizeRequest);
-    }
+    PLB_ASSERT(entry.dynamicDataSizes.size()>0);
+    global::profiler().increment(global::prof::mpiSendChar, (plint)entry.dynamicDataSizes.size());
+    global::mpi().iSend(&entry.dynamicDataSizes[0], entry.dynamicDataSizes.size(), toProc,
+                        &entry.sizeRequest);
     // Empty messages are neither sent nor received.
     if (!entry.data.empty()) {
-        global::profiler().increment("mpiSendChar", (plint)entry.data.size());
+        global::profiler().increment(global::prof::mpiSendChar, (plint)entry.data.size());
         global::mpi().iSend(&entry.data[0], entry.data.size(), toProc, &entry.messageRequest);
     }
 }
 
+void SendPoolCommunicator::startStaticCommunication(int toProc, CommunicatorEntry& entry)
+{
+    // Empty messages are neither sent nor received.
+    if (entry.staticData.empty()) {
+        return;
+    }
+    // The messages have been packed in place, and the request is set up once
+    //   for all subsequent exchanges.
+    if (!entry.hasStaticRequest) {
+        global::mpi().sendInit(&entry.staticData[0], entry.staticData.size(), toProc,
+                               &entry.staticRequest);
+        entry.hasStaticRequest = true;
+    }
+    global::profiler().increment(global::prof::mpiSendChar, (plint)entry.staticData.size());
+    global::mpi().start(&entry.staticRequest);
+}
+
 RecvPoolCommunicator::RecvPoolCommunicator(SendRecvPool const& pool)
     : subscriptions(pool.begin(), pool.end())
 { }
@@ -144,12 +179,15 @@ void RecvPoolCommunicator::startBeingReceptive(bool staticMessage)
     for (; iter != subscriptions.end(); ++iter) {
         int fromProc = iter->first;
         CommunicatorEntry& entry = iter->second;
-        entry.data.resize(entry.cumDataLength);
         // Empty messages are neither sent nor received.
-        if (!entry.data.empty()) {
-            global::profiler().increment("mpiReceiveChar", (plint)entry.data.size());
-            global::mpi().iRecv(&entry.data[0], entry.data.size(),
-                                fromProc, &entry.messageRequest);
+        if (!entry.staticData.empty()) {
+            if (!entry.hasStaticRequest) {
+                global::mpi().recvInit(&entry.staticData[0], entry.staticData.size(),
+                                       fromProc, &entry.staticRequest);
+                entry.hasStaticRequest = true;
+            }
+            global::profiler().increment(global::prof::mpiReceiveChar, (plint)entry.staticData.size());
+            global::mpi().start(&entry.staticRequest);
         }
     }
 }
@@ -169,7 +207,12 @@ std::vector<char> const& RecvPoolCommunicator::receiveMessage (
             receiveDynamic(fromProc);
         }
     }
-    std::vector<char> const& message = entry.messages[entry.currentMessage];
+    std::vector<char>& message = entry.messages[entry.currentMessage];
+    if (staticMessage && !message.empty()) {
+        std::vector<char>::const_iterator begin =
+            entry.staticData.begin()+entry.offsets[entry.currentMessage];
+        std::copy(begin, begin+message.size(), message.begin());
+    }
     entry.currentMessage++;
     if (entry.currentMessage==(int)entry.lengths.size()) {
         entry.reset();
@@ -195,7 +238,7 @@ void RecvPoolCommunicator::receiveDynamic(int fromProc)
     entry.data.resize(totalSize);
     // Empty messages are neither sent nor received.
     if (!entry.data.empty()) {
-        global::profiler().increment("mpiReceiveChar", (plint)totalSize);
+        global::profiler().increment(global::prof::mpiReceiveChar, (plint)totalSize);
         global::mpi().receive(&entry.data[0], totalSize, fromProc);
     }
 
@@ -213,30 +256,37 @@ void RecvPoolCommunicator::receiveDynamic(int fromProc)
     }
 }
 
+char const* RecvPoolCommunicator::receiveStaticMessage(int fromProc)
+{
+    std::map<int,CommunicatorEntry>::iterator entryPtr = subscriptions.find(fromProc);
+    PLB_ASSERT( entryPtr!= subscriptions.end() );
+    CommunicatorEntry& entry = entryPtr->second;
+    PLB_ASSERT( entry.currentMessage < (int)entry.messages.size() );
+    if (entry.currentMessage==0) {
+        finalizeStatic(fromProc);
+    }
+    char const* message = 0;
+    if (entry.lengths[entry.currentMessage]>0) {
+        message = &entry.staticData[0] + entry.offsets[entry.currentMessage];
+    }
+    entry.currentMessage++;
+    if (entry.currentMessage==(int)entry.lengths.size()) {
+        entry.reset();
+    }
+    return message;
+}
+
 void RecvPoolCommunicator::finalizeStatic(int fromProc)
 {
     std::map<int,CommunicatorEntry>::iterator entryPtr = subscriptions.find(fromProc);
     PLB_ASSERT( entryPtr != subscriptions.end() );
     CommunicatorEntry& entry = entryPtr->second;
 
+    // Make sure the package of messages has been received. The individual
+    //   messages are read in place from staticData.
     // Empty messages are neither sent nor received.
-    if (!entry.data.empty()) {
-        // 1. Make sure the package of messages has been received.
-        global::mpi().wait(&entry.messageRequest, &entry.messageStatus);
-        
-        // 2. The message package is split into individual messages.
-        int pos=0;
-        PLB_ASSERT(entry.messages.size() == entry.lengths.size());
-        for (pluint iMessage=0; iMessage<entry.messages.size(); ++iMessage) {
-            int length = entry.lengths[iMessage];
-            entry.messages[iMessage].resize(length);
-            PLB_ASSERT(pos+length <= (int)entry.data.size());
-            if (!entry.messages[iMessage].empty()) {
-                std::copy( entry.data.begin()+pos, entry.data.begin()+pos+length,
-                           entry.messages[iMessage].begin() );
-            }
-            pos+=length;
-        }
+    if (entry.hasStaticRequest) {
+        global::mpi().wait(&entry.staticRequest, &entry.messageStatus);
     }
 }
 
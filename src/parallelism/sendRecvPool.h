@@ -35,6 +35,7 @@
 #include <map>
 #include <vector>
 #include <sstream>
+#include <algorithm>
 
 namespace plb {
 
@@ -83,18 +84,67 @@ struct CommunicatorEntry {
           cumDataLength(0),
           messages(),
           data(),
-          currentMessage(0)
+          offsets(),
+          staticData(),
+          currentMessage(0),
+          packedInPlace(false),
+          hasStaticRequest(false)
     { } 
     CommunicatorEntry(PoolEntry const& poolEntry)
         : lengths(poolEntry.lengths),
           cumDataLength(poolEntry.cumDataLength),
           messages(lengths.size()),
-          currentMessage(0)
+          offsets(lengths.size()),
+          staticData(cumDataLength),
+          currentMessage(0),
+          packedInPlace(false),
+          hasStaticRequest(false)
     {
+        int pos=0;
         for (pluint iMessage=0; iMessage<messages.size(); ++iMessage) {
             messages[iMessage].resize(lengths[iMessage]);
+            offsets[iMessage] = pos;
+            pos += lengths[iMessage];
         }
     }
+    /// The persistent request is bound to the address of staticData, and
+    ///   is therefore not copied: the copy creates its own on first use.
+    CommunicatorEntry(CommunicatorEntry const& rhs)
+        : lengths(rhs.lengths),
+          cumDataLength(rhs.cumDataLength),
+          messages(rhs.messages),
+          data(rhs.data),
+          offsets(rhs.offsets),
+          staticData(rhs.staticData),
+          dynamicDataSizes(rhs.dynamicDataSizes),
+          currentMessage(rhs.currentMessage),
+          packedInPlace(rhs.packedInPlace),
+          hasStaticRequest(false)
+    { }
+    CommunicatorEntry& operator=(CommunicatorEntry const& rhs) {
+        CommunicatorEntry(rhs).swap(*this);
+        return *this;
+    }
+    ~CommunicatorEntry() {
+        if (hasStaticRequest) {
+            global::mpi().requestFree(&staticRequest);
+        }
+    }
+    void swap(CommunicatorEntry& rhs) {
+        lengths.swap(rhs.lengths);
+        std::swap(cumDataLength, rhs.cumDataLength);
+        messages.swap(rhs.messages);
+        data.swap(rhs.data);
+        offsets.swap(rhs.offsets);
+        // Swapping the vectors keeps the storage in place, so that the
+        //   persistent requests remain valid.
+        staticData.swap(rhs.staticData);
+        dynamicDataSizes.swap(rhs.dynamicDataSizes);
+        std::swap(currentMessage, rhs.currentMessage);
+        std::swap(packedInPlace, rhs.packedInPlace);
+        std::swap(hasStaticRequest, rhs.hasStaticRequest);
+        std::swap(staticRequest, rhs.staticRequest);
+    }
     void reset() {
         currentMessage=0;
     }
@@ -115,6 +165,12 @@ struct CommunicatorEntry {
     ///   blocking communication pattern and avoids unnecessery de- and re-
     ///   allocations.
     std::vector<char> data;
+    /// Position of each message inside staticData.
+    std::vector<int> offsets;
+    /// Contiguous buffer for static messages. It is allocated once with the
+    ///   final size, and the messages are packed and unpacked in place, so
+    ///   that it can be registered with a persistent MPI request.
+    std::vector<char> staticData;
     /// If the data is dynamic, it must be sent and received piecewise,
     ///   and the individual sizes must be known. 
     ///   Having data here guarantees its persistence throughout the non-
@@ -122,8 +178,13 @@ struct CommunicatorEntry {
     ///   allocations.
     std::vector<int> dynamicDataSizes;
     int currentMessage;
+    /// Whether the current static message was packed directly into staticData.
+    bool packedInPlace;
     MPI_Request sizeRequest, messageRequest;
     MPI_Status  sizeStatus, messageStatus;
+    /// Persistent request on staticData, created on the first static exchange.
+    bool hasStaticRequest;
+    MPI_Request staticRequest;
 };
 
 /// The "in-action" device for all messages sent from a processor.
@@ -132,10 +193,15 @@ public:
     SendPoolCommunicator() { }
     SendPoolCommunicator(SendRecvPool const& pool);
     std::vector<char>& getSendBuffer(int toProc);
+    /// Location at which the next static message to toProc is packed. It
+    ///   must be filled with exactly the subscribed number of bytes, and
+    ///   then be confirmed with acceptMessage(toProc, true).
+    char* getStaticSendBuffer(int toProc);
     void acceptMessage(int toProc, bool staticMessage);
     void finalize(bool staticMessage);
 private:
     void startCommunication(int toProc, bool staticMessage);
+    void startStaticCommunication(int toProc, CommunicatorEntry& entry);
 private:
     std::map<int, CommunicatorEntry > subscriptions;
 };
@@ -148,6 +214,10 @@ public:
     /// Initiate non-blocking communication.
     void startBeingReceptive(bool staticMessage);
     std::vector<char> const& receiveMessage(int fromProc, bool staticMessage);
+    /// Location of the next static message from fromProc, unpacked in place
+    ///   from the receive buffer. The pointer is valid until the next call
+    ///   to startBeingReceptive().
+    char const* receiveStaticMessage(int fromProc);
 private:
     void finalizeStatic(int fromProc);
     void receiveDynamic(int fromProc);
@@ -0,0 +1,100 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+ * Management of the shared-memory threads of an MPI process -- implementation.
+ */
+
+#include "parallelism/smpManager.h"
+#include "core/plbDebug.h"
+#include <cstdlib>
+
+#ifdef PLB_SMP_THREADS
+#include <omp.h>
+#endif
+
+namespace plb {
+
+namespace global {
+
+SmpManager::SmpManager()
+    : numThreads(1),
+      threadedProcessorsFlag(false)
+{
+#ifdef PLB_SMP_THREADS
+    // The OpenMP runtime defaults to one thread per core, which oversubscribes
+    //   the node when several MPI processes are started on it. Threads are
+    //   therefore only used when they are explicitly requested.
+    if (std::getenv("OMP_NUM_THREADS")) {
+        numThreads = omp_get_max_threads();
+    }
+    // The work is split statically among the threads, which requires all of
+    //   them to be present in each parallel region.
+    omp_set_dynamic(0);
+#endif
+}
+
+int SmpManager::getNumThreads() const {
+    return numThreads;
+}
+
+void SmpManager::setNumThreads(int numThreads_) {
+    PLB_PRECONDITION( numThreads_ >= 1 );
+    PLB_PRECONDITION( !inParallelRegion() );
+#ifdef PLB_SMP_THREADS
+    numThreads = numThreads_;
+#endif
+}
+
+int SmpManager::getThreadId() const {
+#ifdef PLB_SMP_THREADS
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+bool SmpManager::isMainThread() const {
+    return getThreadId() == 0;
+}
+
+bool SmpManager::inParallelRegion() const {
+#ifdef PLB_SMP_THREADS
+    return omp_in_parallel();
+#else
+    return false;
+#endif
+}
+
+void SmpManager::toggleThreadedProcessors(bool flag) {
+    threadedProcessorsFlag = flag;
+}
+
+bool SmpManager::threadedProcessors() const {
+    return threadedProcessorsFlag;
+}
+
+}  // namespace global
+
+}  // namespace plb
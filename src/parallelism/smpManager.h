@@ -0,0 +1,85 @@
+/* This file is part of the Palabos library.
+ *
+ * Copyright (C) 2011-2017 FlowKit Sarl
+ * Route d'Oron 2
+ * 1010 Lausanne, Switzerland
+ * E-mail contact: contact@flowkit.com
+ *
+ * The most recent release of Palabos can be downloaded at 
+ * <http://www.palabos.org/>
+ *
+ * The library Palabos is free software: you can redistribute it and/or
+ * modify it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * The library is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+/** \file
+ * Management of the shared-memory threads of an MPI process.
+ */
+
+#ifndef SMP_MANAGER_H
+#define SMP_MANAGER_H
+
+#include "core/globalDefs.h"
+
+// Shared-memory threads are only available if the library is compiled with
+//   PLB_SMP_PARALLEL and OpenMP support. Otherwise, each MPI process runs
+//   exactly one thread, and the threaded loops degenerate to plain loops.
+#if defined(PLB_SMP_PARALLEL) && defined(_OPENMP)
+#define PLB_SMP_THREADS
+#endif
+
+namespace plb {
+
+namespace global {
+
+/// Threads which execute the local atomic blocks of an MPI process.
+/** The number of threads defaults to one. It is taken from the environment
+ *  variable OMP_NUM_THREADS if it is set, and can be changed at any time
+ *  between two parallel regions through setNumThreads(). Only the main
+ *  thread communicates with MPI (MPI_THREAD_FUNNELED).
+ */
+class SmpManager {
+public:
+    /// Number of threads used in the parallel regions.
+    int getNumThreads() const;
+    /// Change the number of threads used in the parallel regions.
+    void setNumThreads(int numThreads_);
+    /// Id of the calling thread, between 0 and getNumThreads()-1.
+    int getThreadId() const;
+    /// Tells whether the calling thread is the main thread of the process.
+    bool isMainThread() const;
+    /// Tells whether the call happens inside a parallel region.
+    bool inParallelRegion() const;
+    /// Decide whether data processors of different atomic blocks are
+    ///   executed concurrently (default: false). This requires all data
+    ///   processors of the simulation to be thread-safe.
+    void toggleThreadedProcessors(bool flag);
+    bool threadedProcessors() const;
+private:
+    SmpManager();
+private:
+    int numThreads;
+    bool threadedProcessorsFlag;
+friend SmpManager& smp();
+};
+
+inline SmpManager& smp() {
+    static SmpManager instance;
+    return instance;
+}
+
+}  // namespace global
+
+}  // namespace plb
+
+#endif  // SMP_MANAGER_H
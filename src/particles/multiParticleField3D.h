@@ -62,6 +62,9 @@ public:
     static std::string blockName();
     static std::string basicType();
     static std::string descriptorType();
+protected:
+    virtual void allocateComponent(plint blockId);
+    virtual void releaseComponent(plint blockId);
 private:
     void allocateBlocks();
     void deAllocateBlocks();
@@ -167,6 +167,27 @@ void MultiParticleField3D<ParticleFieldT>::deAllocateBlocks()
     }
 }
 
+template<class ParticleFieldT>
+void MultiParticleField3D<ParticleFieldT>::allocateComponent(plint blockId)
+{
+    SmartBulk3D bulk(this->getMultiBlockManagement(), blockId);
+    Box3D envelope = bulk.computeEnvelope();
+    ParticleFieldT* newBlock =
+        new ParticleFieldT (
+                envelope.getNx(), envelope.getNy(), envelope.getNz() );
+    newBlock -> setLocation(Dot3D(envelope.x0, envelope.y0, envelope.z0));
+    blocks[blockId] = newBlock;
+}
+
+template<class ParticleFieldT>
+void MultiParticleField3D<ParticleFieldT>::releaseComponent(plint blockId)
+{
+    typename BlockMap::iterator it = blocks.find(blockId);
+    PLB_ASSERT( it != blocks.end() );
+    delete it->second;
+    blocks.erase(it);
+}
+
 template<class ParticleFieldT>
 ParticleFieldT& MultiParticleField3D<ParticleFieldT>::getComponent(plint blockId)
 {
@@ -29,6 +29,7 @@
 #include "core/functions.h"
 #include "particles/multiParticleField3D.h"
 #include "offLattice/triangleBoundary3D.h"
+#include "io/vtkDataOutput.h"
 #include <vector>
 #include <string>
 
@@ -227,6 +228,65 @@ void writeSelectedParticleVtk (
                              deltaX, offset);
 }
 
+/// Particles of all local atomic-blocks, restricted to their bulk or
+///   including their envelope.
+template<typename T, template<typename U> class Descriptor>
+void findLocalParticles (
+        MultiParticleField3D<DenseParticleField3D<T,Descriptor> >& particles,
+        bool includeEnvelope, std::vector<Particle3D<T,Descriptor>*>& found );
+
+/// Write the particles in parallel, as one .vtp file per process and a
+///   .pvtp file which assembles them; fName is given without extension.
+/** Each process writes its own particles, and nothing is gathered on the
+ *  main process.
+ */
+template<typename T, template<typename U> class Descriptor>
+void writeParallelParticleVtk (
+        MultiParticleField3D<DenseParticleField3D<T,Descriptor> >& particles,
+        std::string const& fName,
+        std::map<plint,std::string> const& additionalScalars,
+        std::map<plint,std::string> const& additionalVectors,
+        T deltaX, Array<T,3> const& offset,
+        VtkCompression::CompressionT compression = VtkCompression::none );
+
+template<typename T, template<typename U> class Descriptor>
+void writeParallelParticleVtk (
+        MultiParticleField3D<DenseParticleField3D<T,Descriptor> >& particles,
+        std::string const& fName, T deltaX = T(1),
+        VtkCompression::CompressionT compression = VtkCompression::none )
+{
+    std::map<plint,std::string> additionalScalars;
+    std::map<plint,std::string> additionalVectors;
+    additionalVectors[0] = "Velocity";
+    Array<T,3> offset;
+    offset.resetToZero();
+    writeParallelParticleVtk(particles, fName, additionalScalars, additionalVectors,
+                             deltaX, offset, compression);
+}
+
+/// Parallel counterpart of writeSurfaceVTK: one .vtp file per process and
+///   a .pvtp file which assembles them; fName is given without extension.
+/** A triangle is written by the process which owns the atomic-block whose
+ *  bulk contains the mesh position of its first vertex, or by the main
+ *  process if this position is outside all blocks, so that each triangle
+ *  is written exactly once. With a partial management (see
+ *  MultiBlockManagement3D::isPartial()), triangles outside all blocks are
+ *  not written. The vertices are taken from the bulk or the
+ *  envelope of the local atomic-blocks, which is where the vertices of a
+ *  triangle crossing a block boundary are found after the particle
+ *  communication. A vertex which is not found is taken from the mesh, with
+ *  zero data, as in the serial version.
+ */
+template<typename T, template<typename U> class Descriptor>
+void writeParallelSurfaceVtk( TriangleBoundary3D<T> const& boundary,
+                              MultiParticleField3D<DenseParticleField3D<T,Descriptor> >& particles,
+                              std::vector<std::string> const& scalars,
+                              std::vector<std::string> const& vectors,
+                              std::string const& fName, bool dynamicMesh, plint tag,
+                              std::vector<T> const& scalarFactor = std::vector<T>(),
+                              std::vector<T> const& vectorFactor = std::vector<T>(),
+                              VtkCompression::CompressionT compression = VtkCompression::none );
+
 }  // namespace plb
 
 #endif  // PARTICLE_VTK_3D_H
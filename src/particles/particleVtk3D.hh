@@ -28,9 +28,12 @@
 #include "core/globalDefs.h"
 #include "particles/particleVtk3D.h"
 #include "particles/particleNonLocalTransfer3D.h"
+#include "io/vtkDataOutput.h"
+#include "core/plbProfiler.h"
 
 #include <cstdio>
 #include <cstdlib>
+#include <map>
 
 #define frand() ((double) rand() / (RAND_MAX + 1.0))
 
@@ -537,6 +540,204 @@ void writeSelectedParticleVtk (
                                     deltaX, offset, 0);
 }
 
+template<typename T, template<typename U> class Descriptor>
+void findLocalParticles (
+        MultiParticleField3D<DenseParticleField3D<T,Descriptor> >& particles,
+        bool includeEnvelope, std::vector<Particle3D<T,Descriptor>*>& found )
+{
+    found.clear();
+    MultiBlockManagement3D const& management = particles.getMultiBlockManagement();
+    std::vector<plint> const& localBlocks = particles.getLocalInfo().getBlocks();
+    for (pluint iBlock=0; iBlock<localBlocks.size(); ++iBlock) {
+        plint blockId = localBlocks[iBlock];
+        ParticleField3D<T,Descriptor>& component =
+            dynamic_cast<ParticleField3D<T,Descriptor>&>(particles.getComponent(blockId));
+        std::vector<Particle3D<T,Descriptor>*> blockParticles;
+        if (includeEnvelope) {
+            component.findParticles(component.getBoundingBox(), blockParticles);
+        }
+        else {
+            SmartBulk3D bulk(management, blockId);
+            component.findParticles(bulk.toLocal(bulk.getBulk()), blockParticles);
+        }
+        found.insert(found.end(), blockParticles.begin(), blockParticles.end());
+    }
+}
+
+template<typename T, template<typename U> class Descriptor>
+void writeParallelParticleVtk (
+        MultiParticleField3D<DenseParticleField3D<T,Descriptor> >& particles,
+        std::string const& fName,
+        std::map<plint,std::string> const& additionalScalars,
+        std::map<plint,std::string> const& additionalVectors,
+        T deltaX, Array<T,3> const& offset,
+        VtkCompression::CompressionT compression )
+{
+    global::profiler().start(global::prof::io);
+    std::vector<Particle3D<T,Descriptor>*> found;
+    findLocalParticles(particles, false, found);
+    plint numParticles = (plint)found.size();
+
+    PartitionedVtkPolyDataWriter3D vtkOut(fName, compression);
+    std::vector<T> coordinates(3*numParticles);
+    for (plint iParticle=0; iParticle<numParticles; ++iParticle) {
+        Array<T,3> pos(found[iParticle]->getPosition());
+        pos = deltaX * pos + offset;
+        pos.to_cArray(&coordinates[3*iParticle]);
+    }
+    vtkOut.setPoints(coordinates);
+
+    std::vector<T> data;
+    std::map<plint,std::string>::const_iterator vectorIt = additionalVectors.begin();
+    for (; vectorIt != additionalVectors.end(); ++vectorIt) {
+        data.resize(3*numParticles);
+        for (plint iParticle=0; iParticle<numParticles; ++iParticle) {
+            Array<T,3> vectorValue;
+            found[iParticle]->getVector(vectorIt->first, vectorValue);
+            vectorValue.to_cArray(&data[3*iParticle]);
+        }
+        vtkOut.appendPointData(vectorIt->second, 3, data);
+    }
+    std::vector<plint> tags(numParticles);
+    for (plint iParticle=0; iParticle<numParticles; ++iParticle) {
+        tags[iParticle] = found[iParticle]->getTag();
+    }
+    vtkOut.appendPointData("Tag", 1, tags);
+    std::map<plint,std::string>::const_iterator scalarIt = additionalScalars.begin();
+    for (; scalarIt != additionalScalars.end(); ++scalarIt) {
+        data.resize(numParticles);
+        for (plint iParticle=0; iParticle<numParticles; ++iParticle) {
+            found[iParticle]->getScalar(scalarIt->first, data[iParticle]);
+        }
+        vtkOut.appendPointData(scalarIt->second, 1, data);
+    }
+    vtkOut.writeFiles();
+    global::profiler().stop(global::prof::io);
+}
+
+template<typename T, template<typename U> class Descriptor>
+void writeParallelSurfaceVtk( TriangleBoundary3D<T> const& boundary,
+                              MultiParticleField3D<DenseParticleField3D<T,Descriptor> >& particles,
+                              std::vector<std::string> const& scalars,
+                              std::vector<std::string> const& vectors,
+                              std::string const& fName, bool dynamicMesh, plint tag,
+                              std::vector<T> const& scalarFactor, std::vector<T> const& vectorFactor,
+                              VtkCompression::CompressionT compression )
+{
+    PLB_ASSERT( scalarFactor.empty() || scalarFactor.size()==scalars.size() );
+    PLB_ASSERT( vectorFactor.empty() || vectorFactor.size()==vectors.size() );
+    global::profiler().start(global::prof::io);
+    // All vertices available locally, in the bulk and the envelope.
+    std::vector<Particle3D<T,Descriptor>*> found;
+    findLocalParticles(particles, true, found);
+    std::map<plint, Particle3D<T,Descriptor>*> localVertices;
+    for (pluint iParticle=0; iParticle<found.size(); ++iParticle) {
+        localVertices[found[iParticle]->getTag()] = found[iParticle];
+    }
+
+    if (dynamicMesh) {
+        boundary.pushSelect(0,1); // 0=Open, 1=Dynamic.
+    }
+    else {
+        boundary.pushSelect(0,0); // Open, Static.
+    }
+    TriangularSurfaceMesh<T> const& mesh = boundary.getMesh();
+    MultiBlockManagement3D const& management = particles.getMultiBlockManagement();
+    // Vertices of the local triangles, renumbered in the order of appearance.
+    std::map<plint,plint> pointIds;
+    std::vector<plint> vertexIds;
+    std::vector<plint> triangles;
+    for (plint iTriangle=0; iTriangle<mesh.getNumTriangles(); ++iTriangle) {
+        if (tag>=0 && boundary.getTag(iTriangle)!=tag) {
+            continue;
+        }
+        // The owner of a triangle is decided from the mesh position of its
+        //   first vertex, which is known to all processes, and not from the
+        //   particles, which may be missing from all bulks.
+        Array<T,3> const& firstVertex = mesh.getVertex(iTriangle, 0);
+        plint blockId = management.getSparseBlockStructure().locate (
+                util::roundToInt(firstVertex[0]),
+                util::roundToInt(firstVertex[1]),
+                util::roundToInt(firstVertex[2]) );
+        // A partial management does not know the remote blocks, and the
+        //   main process cannot tell that the position is outside all blocks.
+        bool isOwner = blockId>=0 ? management.getThreadAttribution().isLocal(blockId)
+                                  : !management.isPartial() && global::mpi().isMainProcessor();
+        if (isOwner) {
+            for (plint iLocal=0; iLocal<3; ++iLocal) {
+                plint iVertex = mesh.getVertexId(iTriangle, iLocal);
+                std::map<plint,plint>::const_iterator it = pointIds.find(iVertex);
+                if (it==pointIds.end()) {
+                    it = pointIds.insert(std::make_pair(iVertex, (plint)vertexIds.size())).first;
+                    vertexIds.push_back(iVertex);
+                }
+                triangles.push_back(it->second);
+            }
+        }
+    }
+
+    plint numPoints = (plint)vertexIds.size();
+    std::vector<T> coordinates(3*numPoints);
+    std::vector<std::vector<T> > scalarData(scalars.size(), std::vector<T>(numPoints, T()));
+    std::vector<std::vector<T> > vectorData(vectors.size(), std::vector<T>(3*numPoints, T()));
+    plint numMissing = 0;
+    for (plint iPoint=0; iPoint<numPoints; ++iPoint) {
+        Array<T,3> pos;
+        typename std::map<plint, Particle3D<T,Descriptor>*>::const_iterator it =
+            localVertices.find(vertexIds[iPoint]);
+        if (it==localVertices.end()) {
+            pos = mesh.getVertex(vertexIds[iPoint]);
+            ++numMissing;
+        }
+        else {
+            Particle3D<T,Descriptor> const& particle = *it->second;
+            pos = particle.getPosition();
+            for (pluint iScalar=0; iScalar<scalars.size(); ++iScalar) {
+                T scalar;
+                particle.getScalar(iScalar, scalar);
+                if (!scalarFactor.empty()) {
+                    scalar *= scalarFactor[iScalar];
+                }
+                scalarData[iScalar][iPoint] = scalar;
+            }
+            for (pluint iVector=0; iVector<vectors.size(); ++iVector) {
+                Array<T,3> vector;
+                particle.getVector(iVector, vector);
+                if (!vectorFactor.empty()) {
+                    vector *= vectorFactor[iVector];
+                }
+                vector.to_cArray(&vectorData[iVector][3*iPoint]);
+            }
+        }
+        pos *= boundary.getDx();
+        pos += boundary.getPhysicalLocation();
+        pos.to_cArray(&coordinates[3*iPoint]);
+    }
+    // Restore mesh selection which was active before calling
+    //   this function.
+    boundary.popSelect();
+
+#ifdef PLB_MPI_PARALLEL
+    global::mpi().reduceAndBcast(numMissing, MPI_SUM);
+#endif
+    if (numMissing>0) {
+        pcout << "Warning: in writeParallelSurfaceVtk, " << numMissing << " vertices have no" << std::endl;
+        pcout << "associated particle. There might be black spots in the produced VTK file." << std::endl;
+    }
+
+    PartitionedVtkPolyDataWriter3D vtkOut(fName, compression);
+    vtkOut.setPoints(coordinates);
+    vtkOut.setTriangles(triangles);
+    for (pluint iVector=0; iVector<vectors.size(); ++iVector) {
+        vtkOut.appendPointData(vectors[iVector], 3, vectorData[iVector]);
+    }
+    for (pluint iScalar=0; iScalar<scalars.size(); ++iScalar) {
+        vtkOut.appendPointData(scalars[iScalar], 1, scalarData[iScalar]);
+    }
+    vtkOut.writeFiles();
+    global::profiler().stop(global::prof::io);
+}
+
 }  // namespace plb
 
 #undef frand